@@ -0,0 +1,123 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <floor/compute/compute_command_graph.hpp>
+#include <floor/compute/compute_kernel.hpp>
+#include <floor/core/logger.hpp>
+#include <cstring>
+
+uint32_t compute_command_graph::add_kernel_internal(const compute_kernel& kernel,
+													const bool is_cooperative,
+													const uint32_t work_dim,
+													const uint3 global_work_size,
+													const uint3 local_work_size,
+													const vector<compute_kernel_arg>& args) {
+	if (finalized) {
+		log_error("can't add commands to a finalized command graph");
+		return ~0u;
+	}
+	
+	command_t cmd {
+		.kernel = &kernel,
+		.is_cooperative = is_cooperative,
+		.work_dim = work_dim,
+		.global_work_size = global_work_size,
+		.local_work_size = local_work_size,
+		.args = args,
+	};
+	
+	// copy all generic arg data, since these are only referenced by the caller
+	size_t generic_arg_data_size = 0;
+	for (const auto& arg : args) {
+		if (holds_alternative<const void*>(arg.var)) {
+			generic_arg_data_size += arg.size;
+		}
+	}
+	if (generic_arg_data_size > 0) {
+		cmd.generic_arg_data = make_unique<uint8_t[]>(generic_arg_data_size);
+		auto generic_arg_data = cmd.generic_arg_data.get();
+		for (auto& arg : cmd.args) {
+			if (auto generic_arg_ptr = get_if<const void*>(&arg.var)) {
+				memcpy(generic_arg_data, *generic_arg_ptr, arg.size);
+				arg.var = (const void*)generic_arg_data;
+				generic_arg_data += arg.size;
+			}
+		}
+	}
+	
+	commands.emplace_back(move(cmd));
+	return uint32_t(commands.size() - 1u);
+}
+
+bool compute_command_graph::finalize() {
+	if (finalized) {
+		log_error("command graph has already been finalized");
+		return false;
+	}
+	if (!finalize_internal()) {
+		return false;
+	}
+	finalized = true;
+	return true;
+}
+
+bool compute_command_graph::set_arg(const uint32_t cmd_idx, const uint32_t arg_idx, const compute_kernel_arg& arg) {
+	if (cmd_idx >= commands.size()) {
+		log_error("invalid command index %u", cmd_idx);
+		return false;
+	}
+	auto& cmd = commands[cmd_idx];
+	if (arg_idx >= cmd.args.size()) {
+		log_error("invalid arg index %u for command #%u", arg_idx, cmd_idx);
+		return false;
+	}
+	
+	auto& cur_arg = cmd.args[arg_idx];
+	if (cur_arg.var.index() != arg.var.index()) {
+		log_error("arg kind mismatch for arg #%u of command #%u", arg_idx, cmd_idx);
+		return false;
+	}
+	if (auto generic_arg_ptr = get_if<const void*>(&arg.var)) {
+		// generic arg: copy into the existing storage
+		if (arg.size != cur_arg.size) {
+			log_error("arg size mismatch for arg #%u of command #%u: expected %u bytes, got %u bytes",
+					  arg_idx, cmd_idx, cur_arg.size, arg.size);
+			return false;
+		}
+		memcpy(const_cast<void*>(get<const void*>(cur_arg.var)), *generic_arg_ptr, arg.size);
+	} else {
+		cur_arg.var = arg.var;
+	}
+	
+	return (finalized ? update_command(cmd_idx) : true);
+}
+
+void compute_command_graph::replay() const {
+	if (!finalized) {
+		log_error("command graph must be finalized before it can be replayed");
+		return;
+	}
+	replay_internal();
+}
+
+void compute_command_graph::replay_internal() const {
+	for (const auto& cmd : commands) {
+		cmd.kernel->execute(cqueue, cmd.is_cooperative, cmd.work_dim, cmd.global_work_size, cmd.local_work_size, cmd.args);
+	}
+}
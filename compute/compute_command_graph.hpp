@@ -0,0 +1,143 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_COMPUTE_COMMAND_GRAPH_HPP__
+#define __FLOOR_COMPUTE_COMMAND_GRAPH_HPP__
+
+#include <floor/compute/compute_queue.hpp>
+
+FLOOR_PUSH_WARNINGS()
+FLOOR_IGNORE_WARNING(weak-vtables)
+
+//! a recorded list of kernel executions that can be replayed (in order) on the queue it was created for,
+//! with the arguments of individual commands being patchable in between replays
+//!
+//! usage:
+//!  * record all commands via add_kernel/add_cooperative_kernel (same signature as compute_queue::execute)
+//!  * call finalize() once, after which the graph is prepared for replay and no more commands can be added
+//!  * call replay() any number of times, optionally updating args via set_arg in between
+//!
+//! NOTE: generic (CPU storage) args are copied on recording/patching, buffers/images/argument buffers are referenced
+//!       and must stay alive as long as the graph is used
+//! NOTE: a graph must not be modified or destroyed while a replay of it is still in-flight (-> call finish() on the queue)
+class compute_command_graph {
+public:
+	explicit compute_command_graph(const compute_queue& cqueue_) : cqueue(cqueue_) {}
+	virtual ~compute_command_graph() = default;
+	
+	compute_command_graph(const compute_command_graph&) = delete;
+	compute_command_graph& operator=(const compute_command_graph&) = delete;
+	
+	//! records a kernel execution, returns the index of the recorded command (or ~0u on failure)
+	template <typename... Args, class work_size_type_global, class work_size_type_local,
+			  enable_if_t<((is_same_v<decay_t<work_size_type_global>, uint1> ||
+							is_same_v<decay_t<work_size_type_global>, uint2> ||
+							is_same_v<decay_t<work_size_type_global>, uint3>) &&
+						   is_same_v<decay_t<work_size_type_global>, decay_t<work_size_type_local>>)>* = nullptr>
+	uint32_t add_kernel(const compute_kernel& kernel,
+						work_size_type_global&& global_work_size,
+						work_size_type_local&& local_work_size,
+						const Args&... args)
+	__attribute__((enable_if(compute_queue::check_arg_types<Args...>(), "valid args"))) {
+		return add_kernel_internal(kernel, false, decay_t<work_size_type_global>::dim(),
+								   uint3 { global_work_size }, uint3 { local_work_size }, { args... });
+	}
+	
+	//! records a cooperative kernel execution, returns the index of the recorded command (or ~0u on failure)
+	template <typename... Args, class work_size_type_global, class work_size_type_local,
+			  enable_if_t<((is_same_v<decay_t<work_size_type_global>, uint1> ||
+							is_same_v<decay_t<work_size_type_global>, uint2> ||
+							is_same_v<decay_t<work_size_type_global>, uint3>) &&
+						   is_same_v<decay_t<work_size_type_global>, decay_t<work_size_type_local>>)>* = nullptr>
+	uint32_t add_cooperative_kernel(const compute_kernel& kernel,
+									work_size_type_global&& global_work_size,
+									work_size_type_local&& local_work_size,
+									const Args&... args)
+	__attribute__((enable_if(compute_queue::check_arg_types<Args...>(), "valid args"))) {
+		return add_kernel_internal(kernel, true, decay_t<work_size_type_global>::dim(),
+								   uint3 { global_work_size }, uint3 { local_work_size }, { args... });
+	}
+	
+	//! finishes recording and prepares all recorded commands for replay, returns true on success
+	bool finalize();
+	
+	//! replaces arg #arg_idx of the recorded command #cmd_idx, returns true on success
+	//! NOTE: the arg kind must match the recorded one (generic args must also have the same size)
+	bool set_arg(const uint32_t cmd_idx, const uint32_t arg_idx, const compute_kernel_arg& arg);
+	
+	//! replays (enqueues) all recorded commands on the queue of this graph
+	void replay() const;
+	
+	//! returns the queue this graph is replayed on
+	const compute_queue& get_queue() const {
+		return cqueue;
+	}
+	
+	//! returns the amount of recorded commands
+	uint32_t get_command_count() const {
+		return uint32_t(commands.size());
+	}
+	
+	//! returns true if this graph has been finalized
+	bool is_finalized() const {
+		return finalized;
+	}
+	
+protected:
+	const compute_queue& cqueue;
+	bool finalized { false };
+	
+	//! a single recorded kernel execution
+	struct command_t {
+		const compute_kernel* kernel { nullptr };
+		bool is_cooperative { false };
+		uint32_t work_dim { 1u };
+		uint3 global_work_size;
+		uint3 local_work_size;
+		//! NOTE: generic args point into "generic_arg_data"
+		vector<compute_kernel_arg> args;
+		unique_ptr<uint8_t[]> generic_arg_data;
+	};
+	vector<command_t> commands;
+	
+	uint32_t add_kernel_internal(const compute_kernel& kernel,
+								 const bool is_cooperative,
+								 const uint32_t work_dim,
+								 const uint3 global_work_size,
+								 const uint3 local_work_size,
+								 const vector<compute_kernel_arg>& args);
+	
+	//! called once all commands have been recorded, backends may prepare all commands for replay here
+	virtual bool finalize_internal() {
+		return true;
+	}
+	
+	//! called after an arg of command #cmd_idx has been updated (only after finalization)
+	virtual bool update_command(const uint32_t cmd_idx floor_unused) {
+		return true;
+	}
+	
+	//! replays all commands, by default this simply executes all recorded commands on the queue
+	virtual void replay_internal() const;
+	
+};
+
+FLOOR_POP_WARNINGS()
+
+#endif
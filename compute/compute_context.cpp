@@ -20,6 +20,7 @@
 #include <floor/graphics/graphics_pipeline.hpp>
 #include <floor/graphics/graphics_pass.hpp>
 #include <floor/graphics/graphics_renderer.hpp>
+#include <floor/core/file_io.hpp>
 
 const compute_device* compute_context::get_device(const compute_device::TYPE type) const {
 	switch(type) {
@@ -101,6 +102,64 @@ const compute_device* compute_context::get_corresponding_device(const compute_de
 	return nullptr;
 }
 
+shared_ptr<compute_buffer> compute_context::create_buffer_from_file(const compute_queue& cqueue,
+																	 const string& filename,
+																	 const COMPUTE_MEMORY_FLAG flags,
+																	 const bool write_back) const {
+	if (write_back) {
+		log_warn("write-back of file buffers is not supported by this backend");
+	}
+	
+	file_io file(filename, file_io::OPEN_TYPE::READ_BINARY);
+	if (!file.is_open()) {
+		log_error("failed to open file %s", filename);
+		return {};
+	}
+	auto filestream = file.get_filestream();
+	const auto file_size_ll = file.get_filesize();
+	if (!filestream || file_size_ll <= 0) {
+		log_error("failed to query the size of file %s (or file is empty)", filename);
+		return {};
+	}
+	const auto file_size = size_t(file_size_ll);
+	const auto buffer_size = compute_memory::align_size(file_size);
+	
+	// without host write access, the buffer can only be initialized on creation -> must read the whole file
+	if (!has_flag<COMPUTE_MEMORY_FLAG::HOST_WRITE>(flags)) {
+		auto data = make_unique<uint8_t[]>(buffer_size);
+		memset(data.get() + file_size, 0, buffer_size - file_size);
+		filestream->read((char*)data.get(), streamsize(file_size));
+		if (size_t(filestream->gcount()) != file_size) {
+			log_error("failed to read file %s", filename);
+			return {};
+		}
+		return create_buffer(cqueue, buffer_size, data.get(), flags);
+	}
+	
+	auto buffer = create_buffer(cqueue, buffer_size, flags);
+	if (!buffer) {
+		return {};
+	}
+	
+	// stream the file into the buffer in chunks
+	static constexpr const size_t chunk_size { 16u * 1024u * 1024u };
+	vector<uint8_t> chunk(std::min(chunk_size, buffer_size));
+	for (size_t offset = 0; offset < file_size; offset += chunk_size) {
+		const auto read_size = std::min(chunk_size, file_size - offset);
+		filestream->read((char*)chunk.data(), streamsize(read_size));
+		if (size_t(filestream->gcount()) != read_size) {
+			log_error("failed to read file %s", filename);
+			return {};
+		}
+		buffer->write(cqueue, chunk.data(), read_size, offset);
+	}
+	if (buffer_size > file_size) {
+		memset(chunk.data(), 0, buffer_size - file_size);
+		buffer->write(cqueue, chunk.data(), buffer_size - file_size, file_size);
+	}
+	return buffer;
+}
+
 shared_ptr<compute_buffer> compute_context::wrap_buffer(const compute_queue&, vulkan_buffer&, const COMPUTE_MEMORY_FLAG) const {
 	log_error("Vulkan buffer sharing is not supported by this backend");
 	return {};
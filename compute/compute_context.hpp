@@ -134,6 +134,16 @@ public:
 		return create_buffer(cqueue, sizeof(data_type) * n, (void*)&data[0], flags, opengl_type);
 	}
 	
+	//! constructs a buffer that contains the contents of the file "filename" (of the file size, aligned to min_multiple()),
+	//! by default, the file is streamed into the buffer in chunks (the file is never fully held in host memory),
+	//! host-compute directly maps the file into memory instead (pages are read lazily on first access)
+	//! NOTE: "write_back" is only supported by host-compute: modifications are written back to the file on unmap and destruction
+	virtual shared_ptr<compute_buffer> create_buffer_from_file(const compute_queue& cqueue,
+															   const string& filename,
+															   const COMPUTE_MEMORY_FLAG flags = (COMPUTE_MEMORY_FLAG::READ_WRITE |
+																								  COMPUTE_MEMORY_FLAG::HOST_READ_WRITE),
+															   const bool write_back = false) const;
+	
 	//! wraps an already existing opengl buffer, with the specified flags
 	//! NOTE: OPENGL_SHARING flag is always implied
 	virtual shared_ptr<compute_buffer> wrap_buffer(const compute_queue& cqueue,
@@ -147,6 +147,8 @@ public:
 	bool sub_group_shuffle_support { false };
 	//! true if the device supports cooperative kernel launchs
 	bool cooperative_kernel_support { false };
+	//! max total number of work-groups of a cooperative kernel launch (0 if this is only limited by occupancy)
+	uint32_t max_coop_group_count { 0u };
 	
 	//! true if images are supported by the device
 	bool image_support { false };
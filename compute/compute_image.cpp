@@ -20,6 +20,7 @@
 #include <floor/compute/compute_image.hpp>
 #include <floor/compute/compute_device.hpp>
 #include <floor/compute/compute_context.hpp>
+#include <floor/compute/image_conversion.hpp>
 #include <floor/compute/llvm_toolchain.hpp>
 #include <floor/core/logger.hpp>
 #include <floor/threading/task.hpp>
@@ -735,20 +736,25 @@ compute_image::opengl_image_info compute_image::get_opengl_image_info(const uint
 uint8_t* compute_image::rgb_to_rgba(const COMPUTE_IMAGE_TYPE& rgb_type,
 									const COMPUTE_IMAGE_TYPE& rgba_type,
 									const uint8_t* rgb_data,
+									uint8_t* dst_rgba_data,
 									const bool ignore_mip_levels) {
 	// need to copy/convert the RGB host data to RGBA
 	const auto rgba_size = image_data_size_from_types(image_dim, rgba_type, ignore_mip_levels);
 	const auto rgb_bytes_per_pixel = image_bytes_per_pixel(rgb_type);
 	const auto rgba_bytes_per_pixel = image_bytes_per_pixel(rgba_type);
+	const auto pixel_count = rgba_size / rgba_bytes_per_pixel;
 	
-	uint8_t* rgba_data_ptr = new uint8_t[rgba_size];
-	memset(rgba_data_ptr, 0xFF, rgba_size); // opaque
-	for(size_t i = 0, count = rgba_size / rgba_bytes_per_pixel; i < count; ++i) {
-		memcpy(&rgba_data_ptr[i * rgba_bytes_per_pixel],
-			   &((const uint8_t*)rgb_data)[i * rgb_bytes_per_pixel],
-			   rgb_bytes_per_pixel);
+	uint8_t* rgba_data_ptr = (dst_rgba_data != nullptr ? dst_rgba_data : new uint8_t[rgba_size]);
+	if(!image_conversion::convert(rgb_type, rgba_type, rgb_data, rgba_data_ptr, pixel_count)) {
+		// fallback for formats that aren't supported by the converter (e.g. packed formats)
+		memset(rgba_data_ptr, 0xFF, rgba_size); // opaque
+		for(size_t i = 0; i < pixel_count; ++i) {
+			memcpy(&rgba_data_ptr[i * rgba_bytes_per_pixel],
+				   &((const uint8_t*)rgb_data)[i * rgb_bytes_per_pixel],
+				   rgb_bytes_per_pixel);
+		}
 	}
-	return rgba_data_ptr;
+	return (dst_rgba_data != nullptr ? nullptr : rgba_data_ptr);
 }
 
 void compute_image::rgb_to_rgba_inplace(const COMPUTE_IMAGE_TYPE& rgb_type,
@@ -760,7 +766,11 @@ void compute_image::rgb_to_rgba_inplace(const COMPUTE_IMAGE_TYPE& rgb_type,
 	const auto rgb_bytes_per_pixel = image_bytes_per_pixel(rgb_type);
 	const auto rgba_bytes_per_pixel = image_bytes_per_pixel(rgba_type);
 	const auto alpha_size = rgba_bytes_per_pixel / 4;
+	if(image_conversion::convert_inplace(rgb_type, rgba_type, rgb_to_rgba_data, rgba_size / rgba_bytes_per_pixel)) {
+		return;
+	}
 	
+	// fallback for formats that aren't supported by the converter (e.g. packed formats)
 	// this needs to happen in reverse, otherwise we'd be overwriting the following RGB data
 	for(size_t count = rgba_size / rgba_bytes_per_pixel, i = count - 1; ; --i) {
 		for(size_t j = 0; j < rgb_bytes_per_pixel; ++j) {
@@ -783,11 +793,16 @@ uint8_t* compute_image::rgba_to_rgb(const COMPUTE_IMAGE_TYPE& rgba_type,
 	const auto rgb_bytes_per_pixel = image_bytes_per_pixel(rgb_type);
 	const auto rgba_bytes_per_pixel = image_bytes_per_pixel(rgba_type);
 	
+	const auto pixel_count = rgba_size / rgba_bytes_per_pixel;
+	
 	uint8_t* rgb_data_ptr = (dst_rgb_data != nullptr ? dst_rgb_data : new uint8_t[rgb_size]);
-	for(size_t i = 0, count = rgba_size / rgba_bytes_per_pixel; i < count; ++i) {
-		memcpy(&rgb_data_ptr[i * rgb_bytes_per_pixel],
-			   &((const uint8_t*)rgba_data)[i * rgba_bytes_per_pixel],
-			   rgb_bytes_per_pixel);
+	if(!image_conversion::convert(rgba_type, rgb_type, rgba_data, rgb_data_ptr, pixel_count)) {
+		// fallback for formats that aren't supported by the converter (e.g. packed formats)
+		for(size_t i = 0; i < pixel_count; ++i) {
+			memcpy(&rgb_data_ptr[i * rgb_bytes_per_pixel],
+				   &((const uint8_t*)rgba_data)[i * rgba_bytes_per_pixel],
+				   rgb_bytes_per_pixel);
+		}
 	}
 	return (dst_rgb_data != nullptr ? nullptr : rgb_data_ptr);
 }
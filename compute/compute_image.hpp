@@ -282,10 +282,12 @@ protected:
 	const size_t image_data_size_mip_maps;
 	size_t shim_image_data_size_mip_maps { 0 };
 	
-	//! converts RGB data to RGBA data and returns the owning RGBA image data pointer
+	//! converts RGB data to RGBA data. if "dst_rgba_data" is non-null, the RGBA data is directly written to it and no memory is
+	//! allocated and nullptr is returned. otherwise RGBA image data is allocated and an owning pointer to it is returned.
 	uint8_t* rgb_to_rgba(const COMPUTE_IMAGE_TYPE& rgb_type,
 						 const COMPUTE_IMAGE_TYPE& rgba_type,
 						 const uint8_t* rgb_data,
+						 uint8_t* dst_rgba_data = nullptr,
 						 const bool ignore_mip_levels = false);
 	
 	//! in-place converts RGB data to RGBA data
@@ -104,6 +104,12 @@ enum class COMPUTE_MEMORY_FLAG : uint32_t {
 	//! NOTE: for array images, this will automatically create aliased single-plane images of the whole image array
 	VULKAN_ALIASING				= (1u << 14u),
 	
+	//! host-compute-only: stores image data in a tiled layout (4x4 texel tiles for 2D, 4x4x4 texel bricks for 3D images),
+	//! which improves the cache locality of 2D/3D neighbourhood accesses in kernels
+	//! NOTE: map() always returns the linear (untiled) image data
+	//! NOTE: ignored for buffers, 1D/MSAA/compressed images and images that are shared with OpenGL or Metal
+	HOST_TILED_LAYOUT			= (1u << 15u),
+	
 };
 floor_global_enum_ext(COMPUTE_MEMORY_FLAG)
 
@@ -19,6 +19,8 @@
 #include <floor/compute/compute_queue.hpp>
 #include <floor/core/core.hpp>
 #include <floor/compute/compute_kernel.hpp>
+#include <floor/compute/compute_command_graph.hpp>
+#include <floor/core/trace.hpp>
 
 void compute_queue::start_profiling() {
 	finish();
@@ -30,23 +32,56 @@ uint64_t compute_queue::stop_profiling() {
 	return core::unix_timestamp_us() - us_prof_start;
 }
 
+vector<compute_queue::kernel_event_t> compute_queue::collect_kernel_events() const {
+	vector<kernel_event_t> events;
+	{
+		lock_guard<mutex> lock(kernel_events_lock);
+		events.swap(kernel_events);
+	}
+	return events;
+}
+
+void compute_queue::log_kernel_event(kernel_event_t&& evt) const {
+	lock_guard<mutex> lock(kernel_events_lock);
+	kernel_events.emplace_back(move(evt));
+}
+
+uint64_t compute_queue::get_kernel_event_time() {
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+shared_ptr<compute_command_graph> compute_queue::create_command_graph() const {
+	return make_shared<compute_command_graph>(*this);
+}
+
+//! returns the (interned) kernel name for tracing purposes
+static const char* trace_kernel_name(const compute_kernel& kernel, const compute_device& dev) {
+	if (const auto entry = kernel.get_kernel_entry(dev); entry != nullptr && entry->info != nullptr) {
+		return floor_trace::intern(entry->info->name);
+	}
+	return "<unknown kernel>";
+}
+
 void compute_queue::kernel_execute_forwarder(const compute_kernel& kernel,
 											 const bool is_cooperative,
 											 const uint1& global_size, const uint1& local_size,
-											 const vector<compute_kernel_arg>& args) const {
+											 const span<const compute_kernel_arg> args) const {
+	FLOOR_TRACE_SCOPE("enqueue", floor_trace::is_enabled() ? trace_kernel_name(kernel, get_device()) : "");
 	kernel.execute(*this, is_cooperative, 1, uint3 { global_size }, uint3 { local_size }, args);
 }
 
 void compute_queue::kernel_execute_forwarder(const compute_kernel& kernel,
 											 const bool is_cooperative,
 											 const uint2& global_size, const uint2& local_size,
-											 const vector<compute_kernel_arg>& args) const {
+											 const span<const compute_kernel_arg> args) const {
+	FLOOR_TRACE_SCOPE("enqueue", floor_trace::is_enabled() ? trace_kernel_name(kernel, get_device()) : "");
 	kernel.execute(*this, is_cooperative, 2, uint3 { global_size }, uint3 { local_size }, args);
 }
 
 void compute_queue::kernel_execute_forwarder(const compute_kernel& kernel,
 											 const bool is_cooperative,
 											 const uint3& global_size, const uint3& local_size,
-											 const vector<compute_kernel_arg>& args) const {
+											 const span<const compute_kernel_arg> args) const {
+	FLOOR_TRACE_SCOPE("enqueue", floor_trace::is_enabled() ? trace_kernel_name(kernel, get_device()) : "");
 	kernel.execute(*this, is_cooperative, 3, global_size, local_size, args);
 }
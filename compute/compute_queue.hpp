@@ -21,6 +21,10 @@
 
 #include <string>
 #include <vector>
+#include <array>
+#include <span>
+#include <atomic>
+#include <mutex>
 #include <floor/math/vector_lib.hpp>
 #include <floor/compute/compute_kernel_arg.hpp>
 
@@ -30,6 +34,7 @@ FLOOR_IGNORE_WARNING(weak-vtables)
 class compute_device;
 class compute_memory;
 class compute_kernel;
+class compute_command_graph;
 
 class compute_queue {
 public:
@@ -99,7 +104,7 @@ public:
 				 work_size_type_global&& global_work_size,
 				 work_size_type_local&& local_work_size,
 				 const Args&... args) const __attribute__((enable_if(check_arg_types<Args...>(), "valid args"))) {
-		kernel_execute_forwarder(kernel, false, global_work_size, local_work_size, { args... });
+		kernel_execute_forwarder(kernel, false, global_work_size, local_work_size, array<compute_kernel_arg, sizeof...(Args)> {{ args... }});
 	}
 	
 	//! enqueues (and executes) the specified kernel into this queue
@@ -113,7 +118,7 @@ public:
 				 work_size_type_global&& global_work_size,
 				 work_size_type_local&& local_work_size,
 				 const Args&... args) const __attribute__((enable_if(check_arg_types<Args...>(), "valid args"))) {
-		kernel_execute_forwarder(*kernel, false, global_work_size, local_work_size, { args... });
+		kernel_execute_forwarder(*kernel, false, global_work_size, local_work_size, array<compute_kernel_arg, sizeof...(Args)> {{ args... }});
 	}
 	
 	template <typename... Args, class work_size_type_global, class work_size_type_local,
@@ -143,7 +148,7 @@ public:
 							 work_size_type_global&& global_work_size,
 							 work_size_type_local&& local_work_size,
 							 const Args&... args) const __attribute__((enable_if(check_arg_types<Args...>(), "valid args"))) {
-		kernel_execute_forwarder(kernel, true, global_work_size, local_work_size, { args... });
+		kernel_execute_forwarder(kernel, true, global_work_size, local_work_size, array<compute_kernel_arg, sizeof...(Args)> {{ args... }});
 	}
 	
 	//! enqueues (and executes cooperatively) the specified kernel into this queue
@@ -157,7 +162,7 @@ public:
 							 work_size_type_global&& global_work_size,
 							 work_size_type_local&& local_work_size,
 							 const Args&... args) const __attribute__((enable_if(check_arg_types<Args...>(), "valid args"))) {
-		kernel_execute_forwarder(*kernel, true, global_work_size, local_work_size, { args... });
+		kernel_execute_forwarder(*kernel, true, global_work_size, local_work_size, array<compute_kernel_arg, sizeof...(Args)> {{ args... }});
 	}
 	
 	template <typename... Args, class work_size_type_global, class work_size_type_local,
@@ -180,6 +185,9 @@ public:
 	//! returns the compute device associated with this queue
 	const compute_device& get_device() const { return device; }
 	
+	//! creates a new (empty) command graph that records kernel executions for later replay on this queue
+	virtual shared_ptr<compute_command_graph> create_command_graph() const;
+	
 	//! returns true if this queue has profiling support
 	virtual bool has_profiling_support() const {
 		return false;
@@ -191,23 +199,69 @@ public:
 	//! stops the previously started profiling and returns the elapsed time in microseconds
 	virtual uint64_t stop_profiling();
 	
+	//! profiling event of a single kernel execution
+	//! NOTE: all times are in nanoseconds, "queued" is always taken from the host steady clock (see get_kernel_event_time()),
+	//!       "start" and "end" are taken from the device clock (the host steady clock for host-compute)
+	struct kernel_event_t {
+		//! name of the executed kernel function
+		string kernel_name;
+		//! time at which the kernel execution was enqueued
+		uint64_t queued { 0u };
+		//! time at which the kernel execution started on the device
+		uint64_t start { 0u };
+		//! time at which the kernel execution ended on the device
+		uint64_t end { 0u };
+	};
+	
+	//! returns true if this queue can log per-kernel profiling events
+	virtual bool has_kernel_event_support() const {
+		return false;
+	}
+	
+	//! enables or disables the logging of per-kernel profiling events for all subsequent kernel executions
+	//! NOTE: this does not serialize kernel executions, events are logged once an execution has completed
+	void set_kernel_event_logging(const bool enable) {
+		kernel_event_logging = enable;
+	}
+	
+	//! returns true if per-kernel profiling events are currently being logged
+	bool is_kernel_event_logging() const {
+		return kernel_event_logging;
+	}
+	
+	//! returns all kernel events that have been logged since the last call (in order of completion) and clears the log
+	//! NOTE: this does not wait for in-flight kernel executions, their events will be returned by a later call
+	//! NOTE: the log is unbounded, it should be collected regularly while logging is enabled
+	vector<kernel_event_t> collect_kernel_events() const;
+	
+	//! returns the current time of the host steady clock in nanoseconds
+	static uint64_t get_kernel_event_time();
+	
 protected:
 	const compute_device& device;
 	uint64_t us_prof_start { 0 };
 	
+	atomic<bool> kernel_event_logging { false };
+	mutable mutex kernel_events_lock;
+	mutable vector<kernel_event_t> kernel_events;
+	
+	//! adds a completed kernel execution to the event log
+	void log_kernel_event(kernel_event_t&& evt) const;
+	
 	//! internal forwarders to the actual kernel execution implementations
+	//! NOTE: "args" only needs to stay valid for the duration of the call (kernel implementations copy what they need)
 	void kernel_execute_forwarder(const compute_kernel& kernel,
 								  const bool is_cooperative,
 								  const uint1& global_size, const uint1& local_size,
-								  const vector<compute_kernel_arg>& args) const;
+								  const span<const compute_kernel_arg> args) const;
 	void kernel_execute_forwarder(const compute_kernel& kernel,
 								  const bool is_cooperative,
 								  const uint2& global_size, const uint2& local_size,
-								  const vector<compute_kernel_arg>& args) const;
+								  const span<const compute_kernel_arg> args) const;
 	void kernel_execute_forwarder(const compute_kernel& kernel,
 								  const bool is_cooperative,
 								  const uint3& global_size, const uint3& local_size,
-								  const vector<compute_kernel_arg>& args) const;
+								  const span<const compute_kernel_arg> args) const;
 	
 };
 
@@ -64,7 +64,7 @@ void cuda_kernel::execute(const compute_queue& cqueue,
 						  const uint32_t& dim floor_unused,
 						  const uint3& global_work_size,
 						  const uint3& local_work_size,
-						  const vector<compute_kernel_arg>& args) const {
+						  const span<const compute_kernel_arg> args) const {
 	// find entry for queue device
 	const auto kernel_iter = get_kernel(cqueue);
 	if(kernel_iter == kernels.cend()) {
@@ -131,6 +131,64 @@ namespace compute_algorithm {
 		return sub_group_reduce(lane_var, [](const auto& lhs, const auto& rhs) { return ::max(lhs, rhs); });
 	}
 #endif
+	
+#elif defined(FLOOR_COMPUTE_HOST)
+#if FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS != 0
+	//! performs a reduction inside the sub-group using the specific operation/function,
+	//! all lanes are reduced in the same order, so that all work-items in the sub-group obtain the same result
+	template <typename T, typename F>
+	floor_inline_always static T sub_group_reduce(T lane_var, F&& op) {
+		const auto values = floor_host_sub_group_values(lane_var);
+		const auto lane_count = get_sub_group_size();
+		auto ret = values[0];
+		for (uint32_t lane = 1; lane < lane_count; ++lane) {
+			ret = op(ret, values[lane]);
+		}
+		return ret;
+	}
+	
+	template <typename T> floor_inline_always static T sub_group_reduce_add(T lane_var) {
+		return sub_group_reduce(lane_var, plus<> {});
+	}
+	template <typename T> floor_inline_always static T sub_group_reduce_min(T lane_var) {
+		return sub_group_reduce(lane_var, [](const auto& lhs, const auto& rhs) { return ::min(lhs, rhs); });
+	}
+	template <typename T> floor_inline_always static T sub_group_reduce_max(T lane_var) {
+		return sub_group_reduce(lane_var, [](const auto& lhs, const auto& rhs) { return ::max(lhs, rhs); });
+	}
+	
+	//! performs an inclusive scan inside the sub-group using the specific operation/function
+	template <typename T, typename F>
+	floor_inline_always static T sub_group_inclusive_scan(T lane_var, F&& op) {
+		const auto values = floor_host_sub_group_values(lane_var);
+		const auto lane_id = get_sub_group_local_id();
+		auto ret = values[0];
+		for (uint32_t lane = 1; lane <= lane_id; ++lane) {
+			ret = op(ret, values[lane]);
+		}
+		return ret;
+	}
+	
+	//! performs an exclusive scan inside the sub-group using the specific operation/function
+	//! NOTE: lane #0 returns "zero_val"
+	template <typename T, typename F>
+	floor_inline_always static T sub_group_exclusive_scan(T lane_var, F&& op, const T zero_val = (T)0) {
+		const auto values = floor_host_sub_group_values(lane_var);
+		const auto lane_id = get_sub_group_local_id();
+		auto ret = zero_val;
+		for (uint32_t lane = 0; lane < lane_id; ++lane) {
+			ret = op(ret, values[lane]);
+		}
+		return ret;
+	}
+	
+	template <typename T> floor_inline_always static T sub_group_inclusive_scan_add(T lane_var) {
+		return sub_group_inclusive_scan(lane_var, plus<> {});
+	}
+	template <typename T> floor_inline_always static T sub_group_exclusive_scan_add(T lane_var) {
+		return sub_group_exclusive_scan(lane_var, plus<> {});
+	}
+#endif
 #endif
 	
 	//////////////////////////////////////////
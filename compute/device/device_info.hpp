@@ -248,7 +248,7 @@ namespace device_info {
 	}
 #endif
 	
-	//! returns true if the device supports sub-groups (opencl with extension; always true with cuda)
+	//! returns true if the device supports sub-groups (opencl with extension; always true with cuda and host-compute)
 	constexpr bool has_sub_groups() {
 #if FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS != 0
 		return true;
@@ -257,7 +257,7 @@ namespace device_info {
 #endif
 	}
 	
-	//! returns true if the device supports sub-group shuffle/swizzle (opencl with extension; cuda with sm_30+; metal 2.0+ on osx)
+	//! returns true if the device supports sub-group shuffle/swizzle (opencl with extension; cuda with sm_30+; metal 2.0+ on osx; host-compute)
 	constexpr bool has_sub_group_shuffle() {
 #if FLOOR_COMPUTE_INFO_HAS_SUB_GROUP_SHUFFLE != 0
 		return true;
@@ -266,7 +266,7 @@ namespace device_info {
 #endif
 	}
 	
-	//! returns true if the device supports cooperative kernel launchs (currently cuda 9.0+ with sm_60+)
+	//! returns true if the device supports cooperative kernel launchs (currently cuda 9.0+ with sm_60+ and host-compute)
 	constexpr bool has_cooperative_kernel_support() {
 #if FLOOR_COMPUTE_INFO_HAS_COOPERATIVE_KERNEL != 0
 		return true;
@@ -237,18 +237,19 @@ void image_read_mem_fence();
 void image_write_mem_fence();
 #else
 // host-compute device handling is slightly different
+// NOTE: global_barrier() is a grid-wide barrier in cooperative executions, so global memory fences use the work-group barrier
 extern "C" void global_barrier() __attribute__((noduplicate, sysv_abi));
+extern "C" void local_barrier() __attribute__((noduplicate, sysv_abi));
 floor_inline_always void global_mem_fence() {
-	global_barrier();
+	local_barrier();
 }
 floor_inline_always void global_read_mem_fence() {
-	global_barrier();
+	local_barrier();
 }
 floor_inline_always void global_write_mem_fence() {
-	global_barrier();
+	local_barrier();
 }
 
-extern "C" void local_barrier() __attribute__((noduplicate, sysv_abi));
 floor_inline_always void local_mem_fence() {
 	local_barrier();
 }
@@ -273,6 +274,71 @@ floor_inline_always void image_write_mem_fence() {
 }
 #endif
 
+// sub-group functionality (NOTE: exchange function implemented in host_kernel.cpp)
+// a sub-group consists of (up to) SIMD-width work-items that are consecutive in linear local id order,
+// the last sub-group of a work-group is smaller if the work-group size is not a multiple of the SIMD-width
+// NOTE: as with barriers, a sub-group operation must be encountered by all work-items of a sub-group
+#if defined(FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS) && FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS != 0
+//! writes "lane_value" of the calling work-item into the exchange memory of its sub-group, runs all other work-items
+//! of the sub-group up to the same point, then returns the exchange memory of the sub-group (containing all lane values)
+#if !defined(FLOOR_COMPUTE_HOST_DEVICE)
+extern "C" const void* floor_host_sub_group_exchange(const void* lane_value, const uint32_t value_size, const uint32_t sub_group_width);
+#else
+extern "C" const void* floor_host_sub_group_exchange(const void* lane_value, const uint32_t value_size, const uint32_t sub_group_width)
+__attribute__((noduplicate, sysv_abi));
+#endif
+
+floor_inline_always const_func static uint32_t floor_host_local_linear_id() {
+	return floor_local_idx.x + floor_local_work_size.x * (floor_local_idx.y + floor_local_work_size.y * floor_local_idx.z);
+}
+floor_inline_always const_func static uint32_t get_sub_group_id() {
+	return floor_host_local_linear_id() / FLOOR_COMPUTE_INFO_SIMD_WIDTH;
+}
+floor_inline_always const_func static uint32_t get_sub_group_local_id() {
+	return floor_host_local_linear_id() % FLOOR_COMPUTE_INFO_SIMD_WIDTH;
+}
+floor_inline_always const_func static uint32_t get_sub_group_size() {
+	const auto remaining_items = floor_local_work_size.extent() - get_sub_group_id() * FLOOR_COMPUTE_INFO_SIMD_WIDTH;
+	return (remaining_items < FLOOR_COMPUTE_INFO_SIMD_WIDTH ? remaining_items : FLOOR_COMPUTE_INFO_SIMD_WIDTH);
+}
+floor_inline_always const_func static uint32_t get_num_sub_groups() {
+	return (floor_local_work_size.extent() + FLOOR_COMPUTE_INFO_SIMD_WIDTH - 1u) / FLOOR_COMPUTE_INFO_SIMD_WIDTH;
+}
+
+//! exchanges "lane_var" with all work-items in the sub-group, returns the values of all lanes
+template <typename T>
+floor_inline_always static const T* floor_host_sub_group_values(const T& lane_var) {
+	static_assert(sizeof(T) <= 16u, "sub-group values must not be larger than 16 bytes");
+	return (const T*)floor_host_sub_group_exchange(&lane_var, sizeof(T), FLOOR_COMPUTE_INFO_SIMD_WIDTH);
+}
+
+// shuffle functionality
+// NOTE: if the source lane does not exist, the own value is returned
+template <typename T>
+floor_inline_always static T simd_shuffle(const T lane_var, const uint32_t lane_id) {
+	const auto values = floor_host_sub_group_values(lane_var);
+	return (lane_id < get_sub_group_size() ? values[lane_id] : lane_var);
+}
+template <typename T>
+floor_inline_always static T simd_shuffle_down(const T lane_var, const uint32_t delta) {
+	const auto values = floor_host_sub_group_values(lane_var);
+	const auto src_lane = get_sub_group_local_id() + delta;
+	return (src_lane < get_sub_group_size() ? values[src_lane] : lane_var);
+}
+template <typename T>
+floor_inline_always static T simd_shuffle_up(const T lane_var, const uint32_t delta) {
+	const auto values = floor_host_sub_group_values(lane_var);
+	const auto lane = get_sub_group_local_id();
+	return (lane >= delta ? values[lane - delta] : lane_var);
+}
+template <typename T>
+floor_inline_always static T simd_shuffle_xor(const T lane_var, const uint32_t mask) {
+	const auto values = floor_host_sub_group_values(lane_var);
+	const auto src_lane = get_sub_group_local_id() ^ mask;
+	return (src_lane < get_sub_group_size() ? values[src_lane] : lane_var);
+}
+#endif
+
 #if !defined(FLOOR_COMPUTE_HOST_DEVICE) // host-only (host-device deals with local memory differently)
 // local memory management (NOTE: implemented in host_kernel.cpp)
 uint8_t* __attribute__((aligned(1024))) floor_requisition_local_memory(const size_t size, uint32_t& offset) noexcept;
@@ -44,16 +44,32 @@ FLOOR_DLL_API inline auto& floor_thread_local_memory_offset_get() {
 #endif
 
 // id handling vars, as above, this is externally visible to aid vectorization
-extern FLOOR_DLL_API uint32_t floor_work_dim;
-extern FLOOR_DLL_API uint3 floor_global_work_size;
-extern FLOOR_DLL_API uint3 floor_local_work_size;
-extern FLOOR_DLL_API uint3 floor_group_size;
-
+// NOTE: sizes are per worker thread as well, since multiple kernels may be executed at the same time (on different queues)
 #if !defined(__WINDOWS__)
+extern thread_local uint32_t floor_work_dim;
+extern thread_local uint3 floor_global_work_size;
+extern thread_local uint3 floor_local_work_size;
+extern thread_local uint3 floor_group_size;
 extern thread_local uint3 floor_global_idx;
 extern thread_local uint3 floor_local_idx;
 extern thread_local uint3 floor_group_idx;
 #else // Windows workarounds for dllexport of TLS vars
+FLOOR_DLL_API inline auto& floor_work_dim_get() {
+	static thread_local uint32_t floor_work_dim_tls { 1u };
+	return floor_work_dim_tls;
+}
+FLOOR_DLL_API inline auto& floor_global_work_size_get() {
+	static thread_local uint3 floor_global_work_size_tls;
+	return floor_global_work_size_tls;
+}
+FLOOR_DLL_API inline auto& floor_local_work_size_get() {
+	static thread_local uint3 floor_local_work_size_tls;
+	return floor_local_work_size_tls;
+}
+FLOOR_DLL_API inline auto& floor_group_size_get() {
+	static thread_local uint3 floor_group_size_tls;
+	return floor_group_size_tls;
+}
 FLOOR_DLL_API inline auto& floor_global_idx_get() {
 	static thread_local uint3 floor_global_idx_tls;
 	return floor_global_idx_tls;
@@ -66,6 +82,10 @@ FLOOR_DLL_API inline auto& floor_group_idx_get() {
 	static thread_local uint3 floor_group_idx_tls;
 	return floor_group_idx_tls;
 }
+#define floor_work_dim floor_work_dim_get()
+#define floor_global_work_size floor_global_work_size_get()
+#define floor_local_work_size floor_local_work_size_get()
+#define floor_group_size floor_group_size_get()
 #define floor_global_idx floor_global_idx_get()
 #define floor_local_idx floor_local_idx_get()
 #define floor_group_idx floor_group_idx_get()
@@ -22,6 +22,8 @@
 #if defined(FLOOR_COMPUTE_HOST)
 
 #include <floor/constexpr/soft_f16.hpp>
+#include <floor/compute/device/host_image_tiling.hpp>
+#include <floor/compute/device/host_image_bcn.hpp>
 
 // ignore vectorization/optimization/etc. hints and infos
 FLOOR_PUSH_WARNINGS()
@@ -32,6 +34,14 @@ FLOOR_PUSH_WARNINGS()
 
 template <COMPUTE_IMAGE_TYPE, bool is_lod, bool is_lod_float, bool is_bias> struct host_device_image;
 
+//! addressing mode of batched image reads (see image::read_batch)
+enum class HOST_IMAGE_ADDRESS_MODE : uint32_t {
+	//! coordinates outside [0, 1] are clamped to the edge texels
+	CLAMP_TO_EDGE,
+	//! coordinates are wrapped around, i.e. the image is tiled infinitely
+	REPEAT,
+};
+
 namespace host_image_impl {
 	struct image_level_info {
 		const uint4 dim;
@@ -160,7 +170,12 @@ namespace host_image_impl {
 		
 		//! 2D, 2D depth, 2D depth+stencil
 		floor_inline_always static size_t coord_to_offset(const image_level_info& level_info, const uint2 coord) {
-			return level_info.offset + size_t(level_info.dim.x * coord.y + coord.x) * image_bytes_per_pixel(fixed_image_type);
+			if constexpr (has_flag<COMPUTE_IMAGE_TYPE::__HOST_TILED>(fixed_image_type)) {
+				return level_info.offset + size_t(host_image_tiling::texel_index(level_info.dim.x, level_info.dim.y,
+																				 coord.x, coord.y)) * image_bytes_per_pixel(fixed_image_type);
+			} else {
+				return level_info.offset + size_t(level_info.dim.x * coord.y + coord.x) * image_bytes_per_pixel(fixed_image_type);
+			}
 		}
 		
 		//! 2D array, 2D depth array
@@ -171,9 +186,14 @@ namespace host_image_impl {
 		//! 3D
 		template <COMPUTE_IMAGE_TYPE type = fixed_image_type, enable_if_t<!has_flag<COMPUTE_IMAGE_TYPE::FLAG_CUBE>(type)>* = nullptr>
 		floor_inline_always static size_t coord_to_offset(const image_level_info& level_info, const uint3 coord) {
-			return level_info.offset + size_t(level_info.dim.x * level_info.dim.y * coord.z +
-											  level_info.dim.x * coord.y +
-											  coord.x) * image_bytes_per_pixel(type);
+			if constexpr (has_flag<COMPUTE_IMAGE_TYPE::__HOST_TILED>(type)) {
+				return level_info.offset + size_t(host_image_tiling::texel_index(level_info.dim.x, level_info.dim.y, level_info.dim.z,
+																				 coord.x, coord.y, coord.z)) * image_bytes_per_pixel(type);
+			} else {
+				return level_info.offset + size_t(level_info.dim.x * level_info.dim.y * coord.z +
+												  level_info.dim.x * coord.y +
+												  coord.x) * image_bytes_per_pixel(type);
+			}
 		}
 		
 		//! cube, depth cube
@@ -764,6 +784,121 @@ FLOOR_POP_WARNINGS()
 			__builtin_memcpy(&img->data[offset], &raw_data, sizeof(raw_data));
 		}
 	};
+	
+	//! returns true if batched reads of the specified image format are handled by a specialized texel load (see load_batch_texel)
+	floor_inline_always static constexpr bool is_fast_batch_format(const COMPUTE_IMAGE_TYPE format_type) {
+		return (format_type == (COMPUTE_IMAGE_TYPE::FORMAT_8 | COMPUTE_IMAGE_TYPE::CHANNELS_4 |
+								COMPUTE_IMAGE_TYPE::UINT | COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED) ||
+				format_type == (COMPUTE_IMAGE_TYPE::FORMAT_16 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::FLOAT) ||
+				format_type == (COMPUTE_IMAGE_TYPE::FORMAT_32 | COMPUTE_IMAGE_TYPE::CHANNELS_1 | COMPUTE_IMAGE_TYPE::FLOAT) ||
+				format_type == (COMPUTE_IMAGE_TYPE::FORMAT_32 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::FLOAT));
+	}
+	
+	//! loads and converts a single texel of a fast batch format (RGBA8 unorm, RGBA16F, R32F, RGBA32F) to float4,
+	//! non-existing channels are set to 0 (alpha: 1)
+	template <COMPUTE_IMAGE_TYPE type>
+	floor_inline_always static float4 load_batch_texel(const uint8_t* texel) {
+		constexpr const auto format_type = (type & (COMPUTE_IMAGE_TYPE::__FORMAT_MASK |
+													COMPUTE_IMAGE_TYPE::__CHANNELS_MASK |
+													COMPUTE_IMAGE_TYPE::__DATA_TYPE_MASK |
+													COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED));
+		static_assert(is_fast_batch_format(format_type), "not a fast batch format");
+		if constexpr (format_type == (COMPUTE_IMAGE_TYPE::FORMAT_8 | COMPUTE_IMAGE_TYPE::CHANNELS_4 |
+									  COMPUTE_IMAGE_TYPE::UINT | COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED)) {
+			uchar4 raw_data;
+			__builtin_memcpy(&raw_data, texel, sizeof(raw_data));
+			return raw_data.cast<float>() * (1.0f / 255.0f);
+		} else if constexpr (format_type == (COMPUTE_IMAGE_TYPE::FORMAT_16 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::FLOAT)) {
+#if !defined(FLOOR_COMPUTE_HOST_DEVICE)
+			soft_f16 raw_data[4];
+#else
+			__fp16 raw_data[4];
+#endif
+			__builtin_memcpy(&raw_data[0], texel, sizeof(raw_data));
+			return { (float)raw_data[0], (float)raw_data[1], (float)raw_data[2], (float)raw_data[3] };
+		} else if constexpr (format_type == (COMPUTE_IMAGE_TYPE::FORMAT_32 | COMPUTE_IMAGE_TYPE::CHANNELS_1 | COMPUTE_IMAGE_TYPE::FLOAT)) {
+			float raw_data;
+			__builtin_memcpy(&raw_data, texel, sizeof(raw_data));
+			return { raw_data, 0.0f, 0.0f, 1.0f };
+		} else {
+			float4 raw_data;
+			__builtin_memcpy(&raw_data, texel, sizeof(raw_data));
+			return raw_data;
+		}
+	}
+	
+	//! applies the address mode to the integer texel coordinate "coord" in [-1, dim], returning a coordinate in [0, dim - 1]
+	template <HOST_IMAGE_ADDRESS_MODE address_mode>
+	floor_inline_always static uint32_t address_batch_coord(const int32_t coord, const int32_t dim) {
+		if constexpr (address_mode == HOST_IMAGE_ADDRESS_MODE::REPEAT) {
+			return uint32_t(coord < 0 ? dim - 1 : (coord >= dim ? 0 : coord));
+		} else {
+			return uint32_t(coord < 0 ? 0 : (coord >= dim ? dim - 1 : coord));
+		}
+	}
+	
+	//! batched 2D image read of "count" normalized coordinates with nearest or bilinear filtering:
+	//! texel coordinates and filter weights are computed for a whole group of coordinates at once (-> vectorizable),
+	//! then the texels are fetched via "fetch(x, y)" (returning float4) and filtered
+	template <bool sample_linear, HOST_IMAGE_ADDRESS_MODE address_mode, typename fetch_func_type>
+	floor_inline_always static void read_batch(const image_level_info& level_info,
+											   const float2* coords,
+											   float4* colors,
+											   const uint32_t count,
+											   fetch_func_type&& fetch) {
+		static constexpr const uint32_t group_size { 16u };
+		const int32_t width = int32_t(level_info.dim.x);
+		const int32_t height = int32_t(level_info.dim.y);
+		const float fwidth = level_info.clamp_dim_float.x;
+		const float fheight = level_info.clamp_dim_float.y;
+		
+		uint32_t x0[group_size], y0[group_size], x1[group_size], y1[group_size];
+		float tx[group_size], ty[group_size];
+		for (uint32_t group_offset = 0; group_offset < count; group_offset += group_size) {
+			// the last group is padded with its last coordinate, so that the coordinate loop always has the same trip count
+			const auto last_idx = ::min(group_size, count - group_offset) - 1u;
+			
+#pragma clang loop vectorize(enable) interleave(enable)
+			for (uint32_t i = 0; i < group_size; ++i) {
+				auto coord = coords[group_offset + ::min(i, last_idx)];
+				if constexpr (address_mode == HOST_IMAGE_ADDRESS_MODE::REPEAT) {
+					// -> [0, 1)
+					coord.x -= std::floor(coord.x);
+					coord.y -= std::floor(coord.y);
+				}
+				if constexpr (!sample_linear) {
+					// -> [0, dim - 0.5] (same as the non-batched read)
+					const auto fx = ::min(::max(coord.x * fwidth, 0.0f), fwidth - 0.5f);
+					const auto fy = ::min(::max(coord.y * fheight, 0.0f), fheight - 0.5f);
+					x0[i] = uint32_t(fx);
+					y0[i] = uint32_t(fy);
+				} else {
+					// texel centers are at (N + 0.5) / dim -> [-1, dim]
+					const auto fx = ::min(::max(coord.x * fwidth - 0.5f, -1.0f), fwidth);
+					const auto fy = ::min(::max(coord.y * fheight - 0.5f, -1.0f), fheight);
+					const auto floor_x = std::floor(fx);
+					const auto floor_y = std::floor(fy);
+					tx[i] = fx - floor_x;
+					ty[i] = fy - floor_y;
+					x0[i] = address_batch_coord<address_mode>(int32_t(floor_x), width);
+					y0[i] = address_batch_coord<address_mode>(int32_t(floor_y), height);
+					x1[i] = address_batch_coord<address_mode>(int32_t(floor_x) + 1, width);
+					y1[i] = address_batch_coord<address_mode>(int32_t(floor_y) + 1, height);
+				}
+			}
+			
+			for (uint32_t i = 0; i <= last_idx; ++i) {
+				if constexpr (!sample_linear) {
+					colors[group_offset + i] = fetch(x0[i], y0[i]);
+				} else {
+					// interpolate in x first, then y
+					const float4 colors_y0 = fetch(x0[i], y0[i]).interpolated(fetch(x1[i], y0[i]), tx[i]);
+					const float4 colors_y1 = fetch(x0[i], y1[i]).interpolated(fetch(x1[i], y1[i]), tx[i]);
+					colors[group_offset + i] = colors_y0.interpolated(colors_y1, ty[i]);
+				}
+			}
+		}
+	}
 }
 
 template <COMPUTE_IMAGE_TYPE sample_image_type, bool is_lod = false, bool is_lod_float = false, bool is_bias = false>
@@ -1085,11 +1220,81 @@ FLOOR_POP_WARNINGS()
 									COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED);
 	}
 	
+	//! returns true if images of this type may use the tiled storage layout (-> must instantiate both layouts)
+	floor_inline_always static constexpr bool has_tiled_layout() {
+		return (image_dim_count(sample_image_type) >= 2 &&
+				!has_flag<COMPUTE_IMAGE_TYPE::FLAG_BUFFER>(sample_image_type) &&
+				!has_flag<COMPUTE_IMAGE_TYPE::FLAG_MSAA>(sample_image_type));
+	}
+	
+	//! block-compressed (BCn) image read: the 4x4 block containing the texel is decoded as a whole and kept in a
+	//! small per-thread cache, so that neighboring reads (and linear filtering) don't decode the same block again
+	template <typename coord_type, typename offset_type>
+	static float4 read_compressed(const host_device_image_type* img,
+								  const coord_type& coord,
+								  const offset_type& coord_offset,
+								  const uint32_t layer,
+								  const int32_t lod_i,
+								  const float lod_or_bias_f) {
+		// compressed images are always 2D (or 2D array/cube/3D made up of 2D slices)
+		if constexpr (image_dim_count(sample_image_type) < 2) {
+			return {};
+		} else {
+			// NOTE: the storage format is irrelevant for lod selection and coordinate processing
+			typedef host_image_impl::fixed_image<(fixed_base_type() |
+												  COMPUTE_IMAGE_TYPE::FORMAT_8 |
+												  COMPUTE_IMAGE_TYPE::CHANNELS_4 |
+												  COMPUTE_IMAGE_TYPE::UINT |
+												  COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED), is_lod, is_lod_float, is_bias> fixed_image_type;
+			const auto block_size = image_bcn_block_size(img->runtime_image_type);
+			if (block_size == 0u) {
+				// unsupported compressed format
+				return {};
+			}
+			
+			const auto lod = fixed_image_type::select_lod(lod_i, lod_or_bias_f);
+			const auto& level_info = img->level_info[lod];
+			const auto texel = fixed_image_type::process_coord(level_info, coord, coord_offset);
+			
+			// array layer / cube face / 3D slice
+			uint32_t slice = 0;
+			if constexpr (has_flag<COMPUTE_IMAGE_TYPE::FLAG_CUBE>(sample_image_type)) {
+				slice = (has_flag<COMPUTE_IMAGE_TYPE::FLAG_ARRAY>(sample_image_type) ? layer * 6u : 0u) + texel.z;
+			} else if constexpr (image_dim_count(sample_image_type) == 3) {
+				slice = texel.z;
+			} else if constexpr (has_flag<COMPUTE_IMAGE_TYPE::FLAG_ARRAY>(sample_image_type)) {
+				slice = layer;
+			}
+			
+			const auto block_x = texel.x / 4u;
+			const auto block_y = texel.y / 4u;
+			const auto blocks_x = (level_info.dim.x + 3u) / 4u;
+			const auto blocks_y = (level_info.dim.y + 3u) / 4u;
+			const auto offset = level_info.offset + (size_t(slice * blocks_y + block_y) * blocks_x + block_x) * block_size;
+			const auto& block = host_image_bcn::decode_block_cached(&img->data[offset], block_size, img->runtime_image_type,
+																	host_image_bcn::cache_slot(block_x, block_y));
+			return block.texels[(texel.y & 3u) * 4u + (texel.x & 3u)];
+		}
+	}
+	
+	// NOTE: the storage layout is a run-time property as well -> select the tiled or linear instantiation
 #define FLOOR_RT_READ_IMAGE_CASE(rt_base_type) case (rt_base_type): \
+if constexpr (has_tiled_layout()) { \
+if (has_flag<COMPUTE_IMAGE_TYPE::__HOST_TILED>(img->runtime_image_type)) { \
+return host_image_impl::fixed_image<(rt_base_type | fixed_base_type() | COMPUTE_IMAGE_TYPE::__HOST_TILED), is_lod, is_lod_float, is_bias>::read( \
+(const host_device_image<(rt_base_type | fixed_base_type() | COMPUTE_IMAGE_TYPE::__HOST_TILED), is_lod, is_lod_float, is_bias>*)img, std::forward<Args>(args)...); \
+} \
+} \
 return host_image_impl::fixed_image<(rt_base_type | fixed_base_type()), is_lod, is_lod_float, is_bias>::read( \
 (const host_device_image<(rt_base_type | fixed_base_type()), is_lod, is_lod_float, is_bias>*)img, std::forward<Args>(args)...);
 
 #define FLOOR_RT_WRITE_IMAGE_CASE(rt_base_type) case (rt_base_type): \
+if constexpr (has_tiled_layout()) { \
+if (has_flag<COMPUTE_IMAGE_TYPE::__HOST_TILED>(img->runtime_image_type)) { \
+host_image_impl::fixed_image<(rt_base_type | fixed_base_type() | COMPUTE_IMAGE_TYPE::__HOST_TILED), is_lod, is_lod_float, is_bias>::write( \
+(const host_device_image<(rt_base_type | fixed_base_type() | COMPUTE_IMAGE_TYPE::__HOST_TILED), is_lod, is_lod_float, is_bias>*)img, std::forward<Args>(args)...); return; \
+} \
+} \
 host_image_impl::fixed_image<(rt_base_type | fixed_base_type()), is_lod, is_lod_float, is_bias>::write( \
 (const host_device_image<(rt_base_type | fixed_base_type()), is_lod, is_lod_float, is_bias>*)img, std::forward<Args>(args)...); return;
 
@@ -1104,6 +1309,11 @@ FLOOR_IGNORE_WARNING(switch) // ignore "case value not in enumerated type 'COMPU
 						   // !depth
 						   !has_flag<COMPUTE_IMAGE_TYPE::FLAG_DEPTH>(type))>* = nullptr>
 	static auto read(const host_device_image_type* img, Args&&... args) {
+		// block-compressed formats are decoded separately
+		if (image_compressed(img->runtime_image_type)) {
+			return read_compressed(img, std::forward<Args>(args)...);
+		}
+		
 		const auto runtime_base_type = img->runtime_image_type & (COMPUTE_IMAGE_TYPE::__FORMAT_MASK |
 																  COMPUTE_IMAGE_TYPE::__CHANNELS_MASK |
 																  COMPUTE_IMAGE_TYPE::__DATA_TYPE_MASK |
@@ -1429,6 +1639,85 @@ FLOOR_IGNORE_WARNING(switch) // ignore "case value not in enumerated type 'COMPU
 		}
 	}
 
+	//! batched read with a fast batch format "format_type", selecting the storage layout once per batch
+	template <COMPUTE_IMAGE_TYPE format_type, bool sample_linear, HOST_IMAGE_ADDRESS_MODE address_mode>
+	static void read_batch_fast(const host_device_image_type* img, const host_image_impl::image_level_info& level_info,
+								const float2* coords, float4* colors, const uint32_t count) {
+		const auto data = img->data;
+		if (has_flag<COMPUTE_IMAGE_TYPE::__HOST_TILED>(img->runtime_image_type)) {
+			constexpr const auto type = (format_type | fixed_base_type() | COMPUTE_IMAGE_TYPE::__HOST_TILED);
+			typedef host_image_impl::fixed_image<type, is_lod, is_lod_float, is_bias> fixed_image_type;
+			host_image_impl::read_batch<sample_linear, address_mode>(level_info, coords, colors, count,
+																	 [data, &level_info](const uint32_t x, const uint32_t y) {
+				return host_image_impl::load_batch_texel<type>(&data[fixed_image_type::coord_to_offset(level_info, uint2 { x, y })]);
+			});
+		} else {
+			constexpr const auto type = (format_type | fixed_base_type());
+			typedef host_image_impl::fixed_image<type, is_lod, is_lod_float, is_bias> fixed_image_type;
+			host_image_impl::read_batch<sample_linear, address_mode>(level_info, coords, colors, count,
+																	 [data, &level_info](const uint32_t x, const uint32_t y) {
+				return host_image_impl::load_batch_texel<type>(&data[fixed_image_type::coord_to_offset(level_info, uint2 { x, y })]);
+			});
+		}
+	}
+	
+	//! batched image read of "count" normalized 2D coordinates at mip-level "lod_input" (see image::read_batch):
+	//! the image format is only resolved once per batch, RGBA8 unorm, RGBA16F, R32F and RGBA32F images are read directly,
+	//! all other formats are read through the per-texel read path
+	template <bool sample_linear, HOST_IMAGE_ADDRESS_MODE address_mode, COMPUTE_IMAGE_TYPE type = sample_image_type,
+			  enable_if_t<(image_dim_count(type) == 2 &&
+						   !has_flag<COMPUTE_IMAGE_TYPE::FLAG_ARRAY>(type) &&
+						   !has_flag<COMPUTE_IMAGE_TYPE::FLAG_CUBE>(type) &&
+						   !has_flag<COMPUTE_IMAGE_TYPE::FLAG_MSAA>(type) &&
+						   !has_flag<COMPUTE_IMAGE_TYPE::FLAG_DEPTH>(type) &&
+						   (has_flag<COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED>(type) ||
+							(type & COMPUTE_IMAGE_TYPE::__DATA_TYPE_MASK) == COMPUTE_IMAGE_TYPE::FLOAT))>* = nullptr>
+	static void read_batch(const host_device_image_type* img,
+						   const float2* coords,
+						   float4* colors,
+						   const uint32_t count,
+						   const uint32_t lod_input) {
+		const auto lod = ::min(host_limits::max_mip_levels - 1u, lod_input);
+		const auto& level_info = img->level_info[lod];
+		const auto runtime_base_type = img->runtime_image_type & (COMPUTE_IMAGE_TYPE::__FORMAT_MASK |
+																  COMPUTE_IMAGE_TYPE::__CHANNELS_MASK |
+																  COMPUTE_IMAGE_TYPE::__DATA_TYPE_MASK |
+																  COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED);
+		switch (runtime_base_type) {
+			case (COMPUTE_IMAGE_TYPE::FORMAT_8 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::UINT | COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED):
+				read_batch_fast<(COMPUTE_IMAGE_TYPE::FORMAT_8 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::UINT | COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED),
+								sample_linear, address_mode>(img, level_info, coords, colors, count);
+				return;
+			case (COMPUTE_IMAGE_TYPE::FORMAT_16 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::FLOAT):
+				read_batch_fast<(COMPUTE_IMAGE_TYPE::FORMAT_16 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::FLOAT),
+								sample_linear, address_mode>(img, level_info, coords, colors, count);
+				return;
+			case (COMPUTE_IMAGE_TYPE::FORMAT_32 | COMPUTE_IMAGE_TYPE::CHANNELS_1 | COMPUTE_IMAGE_TYPE::FLOAT):
+				read_batch_fast<(COMPUTE_IMAGE_TYPE::FORMAT_32 | COMPUTE_IMAGE_TYPE::CHANNELS_1 | COMPUTE_IMAGE_TYPE::FLOAT),
+								sample_linear, address_mode>(img, level_info, coords, colors, count);
+				return;
+			case (COMPUTE_IMAGE_TYPE::FORMAT_32 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::FLOAT):
+				read_batch_fast<(COMPUTE_IMAGE_TYPE::FORMAT_32 | COMPUTE_IMAGE_TYPE::CHANNELS_4 | COMPUTE_IMAGE_TYPE::FLOAT),
+								sample_linear, address_mode>(img, level_info, coords, colors, count);
+				return;
+			default: break;
+		}
+		
+		// all other formats: fetch each texel through the run-time dispatched read (with an explicit lod)
+		typedef host_device_image<sample_image_type, true, false, false> lod_image_type;
+		const auto lod_img = (const lod_image_type*)img;
+		const auto channel_count = image_channel_count(runtime_base_type);
+		host_image_impl::read_batch<sample_linear, address_mode>(level_info, coords, colors, count,
+																 [lod_img, lod, channel_count](const uint32_t x, const uint32_t y) {
+			float4 color = lod_image_type::read(lod_img, int2 { int32_t(x), int32_t(y) }, int2 {}, 0u, int32_t(lod), 0.0f);
+			// non-existing channels are undefined in the per-texel read -> set them to 0 (alpha: 1)
+			for (uint32_t i = channel_count; i < 4u; ++i) {
+				color[i] = (i == 3u ? 1.0f : 0.0f);
+			}
+			return color;
+		});
+	}
+
 FLOOR_POP_WARNINGS()
 #undef FLOOR_RT_READ_IMAGE_CASE
 #undef FLOOR_RT_WRITE_IMAGE_CASE
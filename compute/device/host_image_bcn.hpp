@@ -0,0 +1,704 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_COMPUTE_DEVICE_HOST_IMAGE_BCN_HPP__
+#define __FLOOR_COMPUTE_DEVICE_HOST_IMAGE_BCN_HPP__
+
+//! BCn (BC1 - BC7) block decoders of host-compute image reads
+//! * each decoder decodes a complete 4x4 texel block at once, texels are returned in row-major order
+//! * BC1 - BC5 and BC7 return normalized values, BC6H returns (signed or unsigned) half float values
+//! * invalid/reserved BC6H and BC7 block modes decode to 0
+namespace host_image_bcn {
+	//! decoded 4x4 texel block
+	struct decoded_block {
+		float4 texels[16];
+	};
+	
+	//! little-endian 128-bit block bit reader
+	struct block_bit_reader {
+		uint64_t low;
+		uint64_t high;
+		uint32_t pos { 0u };
+		
+		floor_inline_always uint32_t read(const uint32_t count) {
+			if (count == 0u) {
+				return 0u;
+			}
+			const uint64_t mask = (1ull << count) - 1ull;
+			uint64_t ret;
+			if (pos + count <= 64u) {
+				ret = (low >> pos);
+			} else if (pos >= 64u) {
+				ret = (high >> (pos - 64u));
+			} else {
+				ret = (low >> pos) | (high << (64u - pos));
+			}
+			pos += count;
+			return uint32_t(ret & mask);
+		}
+	};
+	
+	floor_inline_always static uint64_t load_u64(const uint8_t* data) {
+		uint64_t ret = 0;
+#pragma unroll
+		for (uint32_t i = 0; i < 8u; ++i) {
+			ret |= uint64_t(data[i]) << (i * 8u);
+		}
+		return ret;
+	}
+	
+	//! 2-subset partitions (shared by BC6H and BC7): bit #i is the subset of texel #i
+	static constexpr const uint16_t partitions_2[64] {
+		0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+		0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+		0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+		0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+		0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+		0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+		0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+		0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+	};
+	
+	//! 3-subset partitions (BC7 only): bits #2i and #2i+1 are the subset of texel #i
+	static constexpr const uint32_t partitions_3[64] {
+		0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+		0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+		0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+		0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+		0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+		0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+		0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+		0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+	};
+	
+	//! anchor texel of the second subset of 2-subset partitions
+	static constexpr const uint8_t anchors_2_of_2[64] {
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+		15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+		 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+	};
+	//! anchor texel of the second subset of 3-subset partitions
+	static constexpr const uint8_t anchors_2_of_3[64] {
+		 3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+		 3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+		 8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+		 3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+	};
+	//! anchor texel of the third subset of 3-subset partitions
+	static constexpr const uint8_t anchors_3_of_3[64] {
+		15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+		15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+		15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+		15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+	};
+	
+	//! interpolation weights of 2-bit, 3-bit and 4-bit indices (BC6H and BC7)
+	static constexpr const uint8_t weights_2[4] { 0, 21, 43, 64 };
+	static constexpr const uint8_t weights_3[8] { 0, 9, 18, 27, 37, 46, 55, 64 };
+	static constexpr const uint8_t weights_4[16] { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	
+	floor_inline_always static const uint8_t* weights_for_bits(const uint32_t index_bits) {
+		return (index_bits == 2u ? weights_2 : (index_bits == 3u ? weights_3 : weights_4));
+	}
+	
+	//! returns the subset of texel #idx for the specified partition (subset_count must be 1, 2 or 3)
+	floor_inline_always static uint32_t texel_subset(const uint32_t subset_count, const uint32_t partition, const uint32_t idx) {
+		if (subset_count == 2u) {
+			return (partitions_2[partition] >> idx) & 1u;
+		} else if (subset_count == 3u) {
+			return (partitions_3[partition] >> (idx * 2u)) & 3u;
+		}
+		return 0u;
+	}
+	
+	//! returns true if texel #idx is an anchor texel (-> index is stored with one bit less)
+	floor_inline_always static bool is_anchor(const uint32_t subset_count, const uint32_t partition, const uint32_t idx) {
+		if (idx == 0u) {
+			return true;
+		}
+		if (subset_count == 2u) {
+			return (idx == anchors_2_of_2[partition]);
+		} else if (subset_count == 3u) {
+			return (idx == anchors_2_of_3[partition] || idx == anchors_3_of_3[partition]);
+		}
+		return false;
+	}
+	
+	//! decodes a BC1 color block (or the color part of a BC2/BC3 block) into the rgb components of "block"
+	//! NOTE: if "has_alpha" is true, the 3-color mode sets the alpha of its transparent black texels to 0, otherwise to 1
+	floor_inline_always static void decode_bc1_color(const uint8_t* data, decoded_block& block,
+													 const bool allow_3_color_mode, const bool has_alpha) {
+		const uint32_t c0 = uint32_t(data[0]) | (uint32_t(data[1]) << 8u);
+		const uint32_t c1 = uint32_t(data[2]) | (uint32_t(data[3]) << 8u);
+		const uint32_t indices = uint32_t(data[4]) | (uint32_t(data[5]) << 8u) | (uint32_t(data[6]) << 16u) | (uint32_t(data[7]) << 24u);
+		
+		// RGB565 -> normalized float
+		const float4 col0 { float((c0 >> 11u) & 0x1Fu) * (1.0f / 31.0f), float((c0 >> 5u) & 0x3Fu) * (1.0f / 63.0f),
+			float(c0 & 0x1Fu) * (1.0f / 31.0f), 1.0f };
+		const float4 col1 { float((c1 >> 11u) & 0x1Fu) * (1.0f / 31.0f), float((c1 >> 5u) & 0x3Fu) * (1.0f / 63.0f),
+			float(c1 & 0x1Fu) * (1.0f / 31.0f), 1.0f };
+		float4 palette[4] { col0, col1, {}, {} };
+		if (c0 > c1 || !allow_3_color_mode) {
+			palette[2] = (col0 * 2.0f + col1) * (1.0f / 3.0f);
+			palette[3] = (col0 + col1 * 2.0f) * (1.0f / 3.0f);
+		} else {
+			palette[2] = (col0 + col1) * 0.5f;
+			palette[3] = { 0.0f, 0.0f, 0.0f, (has_alpha ? 0.0f : 1.0f) };
+		}
+		
+#pragma clang loop unroll(full) vectorize(enable) interleave(enable)
+		for (uint32_t i = 0; i < 16u; ++i) {
+			block.texels[i] = palette[(indices >> (i * 2u)) & 3u];
+		}
+	}
+	
+	//! decodes a BC3 alpha/BC4 block into channel #channel of "block"
+	template <bool is_signed>
+	floor_inline_always static void decode_bc4_channel(const uint8_t* data, decoded_block& block, const uint32_t channel) {
+		const uint64_t bits = load_u64(data);
+		float palette[8];
+		if constexpr (!is_signed) {
+			const float a0 = float(data[0]) * (1.0f / 255.0f);
+			const float a1 = float(data[1]) * (1.0f / 255.0f);
+			palette[0] = a0;
+			palette[1] = a1;
+			if (data[0] > data[1]) {
+#pragma unroll
+				for (uint32_t i = 1; i <= 6u; ++i) {
+					palette[i + 1u] = (a0 * float(7u - i) + a1 * float(i)) * (1.0f / 7.0f);
+				}
+			} else {
+#pragma unroll
+				for (uint32_t i = 1; i <= 4u; ++i) {
+					palette[i + 1u] = (a0 * float(5u - i) + a1 * float(i)) * (1.0f / 5.0f);
+				}
+				palette[6] = 0.0f;
+				palette[7] = 1.0f;
+			}
+		} else {
+			// -128 is mapped to -127 (-> -1.0)
+			const int32_t s0 = (int8_t(data[0]) == -128 ? -127 : int8_t(data[0]));
+			const int32_t s1 = (int8_t(data[1]) == -128 ? -127 : int8_t(data[1]));
+			const float a0 = float(s0) * (1.0f / 127.0f);
+			const float a1 = float(s1) * (1.0f / 127.0f);
+			palette[0] = a0;
+			palette[1] = a1;
+			if (int8_t(data[0]) > int8_t(data[1])) {
+#pragma unroll
+				for (uint32_t i = 1; i <= 6u; ++i) {
+					palette[i + 1u] = (a0 * float(7u - i) + a1 * float(i)) * (1.0f / 7.0f);
+				}
+			} else {
+#pragma unroll
+				for (uint32_t i = 1; i <= 4u; ++i) {
+					palette[i + 1u] = (a0 * float(5u - i) + a1 * float(i)) * (1.0f / 5.0f);
+				}
+				palette[6] = -1.0f;
+				palette[7] = 1.0f;
+			}
+		}
+		
+#pragma clang loop unroll(full) vectorize(enable) interleave(enable)
+		for (uint32_t i = 0; i < 16u; ++i) {
+			block.texels[i][channel] = palette[(bits >> (16u + i * 3u)) & 7u];
+		}
+	}
+	
+	//! BC1: RGB(A) with 1-bit alpha, 8 bytes per block
+	floor_inline_always static void decode_bc1(const uint8_t* data, decoded_block& block, const bool has_alpha) {
+		decode_bc1_color(data, block, true, has_alpha);
+	}
+	
+	//! BC2: RGB + explicit 4-bit alpha, 16 bytes per block
+	floor_inline_always static void decode_bc2(const uint8_t* data, decoded_block& block) {
+		decode_bc1_color(data + 8, block, false, true);
+		const uint64_t alpha = load_u64(data);
+#pragma clang loop unroll(full) vectorize(enable) interleave(enable)
+		for (uint32_t i = 0; i < 16u; ++i) {
+			block.texels[i].w = float((alpha >> (i * 4u)) & 0xFu) * (1.0f / 15.0f);
+		}
+	}
+	
+	//! BC3: RGB + interpolated alpha, 16 bytes per block
+	floor_inline_always static void decode_bc3(const uint8_t* data, decoded_block& block) {
+		decode_bc1_color(data + 8, block, false, true);
+		decode_bc4_channel<false>(data, block, 3u);
+	}
+	
+	//! BC4 (1 channel, 8 bytes per block) / BC5 (2 channels, 16 bytes per block), unsigned or signed
+	template <bool is_signed>
+	floor_inline_always static void decode_bc4_bc5(const uint8_t* data, decoded_block& block, const uint32_t channel_count) {
+#pragma clang loop unroll(full) vectorize(enable) interleave(enable)
+		for (uint32_t i = 0; i < 16u; ++i) {
+			block.texels[i] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		}
+		decode_bc4_channel<is_signed>(data, block, 0u);
+		if (channel_count >= 2u) {
+			decode_bc4_channel<is_signed>(data + 8, block, 1u);
+		}
+	}
+	
+	//! BC7: RGB(A), 16 bytes per block
+	static inline void decode_bc7(const uint8_t* data, decoded_block& block) {
+		block_bit_reader reader { load_u64(data), load_u64(data + 8), 0u };
+		
+		// mode is determined by the position of the lowest set bit
+		uint32_t mode = 0;
+		while (mode < 8u && reader.read(1u) == 0u) {
+			++mode;
+		}
+		if (mode >= 8u) {
+			// invalid/reserved mode
+#pragma clang loop unroll(full) vectorize(enable) interleave(enable)
+			for (uint32_t i = 0; i < 16u; ++i) {
+				block.texels[i] = {};
+			}
+			return;
+		}
+		
+		//! per mode: subset count, partition bits, rotation bits, index selection bits, color bits, alpha bits,
+		//!           endpoint p-bits, shared p-bits, index bits, secondary index bits
+		struct mode_info_t {
+			uint8_t subset_count;
+			uint8_t partition_bits;
+			uint8_t rotation_bits;
+			uint8_t index_selection_bits;
+			uint8_t color_bits;
+			uint8_t alpha_bits;
+			uint8_t endpoint_pbits;
+			uint8_t shared_pbits;
+			uint8_t index_bits;
+			uint8_t index_bits_2;
+		};
+		static constexpr const mode_info_t mode_infos[8] {
+			{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+			{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+			{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+			{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+			{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+			{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+			{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+			{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+		};
+		const auto& info = mode_infos[mode];
+		const uint32_t partition = reader.read(info.partition_bits);
+		const uint32_t rotation = reader.read(info.rotation_bits);
+		const uint32_t index_selection = reader.read(info.index_selection_bits);
+		
+		// endpoints: [subset * 2 + endpoint][channel]
+		uint32_t endpoints[6][4] {};
+		const uint32_t endpoint_count = info.subset_count * 2u;
+		for (uint32_t channel = 0; channel < 3u; ++channel) {
+			for (uint32_t ep = 0; ep < endpoint_count; ++ep) {
+				endpoints[ep][channel] = reader.read(info.color_bits);
+			}
+		}
+		if (info.alpha_bits > 0u) {
+			for (uint32_t ep = 0; ep < endpoint_count; ++ep) {
+				endpoints[ep][3] = reader.read(info.alpha_bits);
+			}
+		}
+		
+		// p-bits + unquantize to 8-bit
+		uint32_t pbits[6] {};
+		if (info.endpoint_pbits > 0u) {
+			for (uint32_t ep = 0; ep < endpoint_count; ++ep) {
+				pbits[ep] = reader.read(1u);
+			}
+		} else if (info.shared_pbits > 0u) {
+			for (uint32_t subset = 0; subset < info.subset_count; ++subset) {
+				pbits[subset * 2u] = pbits[subset * 2u + 1u] = reader.read(1u);
+			}
+		}
+		const bool has_pbits = (info.endpoint_pbits > 0u || info.shared_pbits > 0u);
+		const uint32_t color_prec = info.color_bits + (has_pbits ? 1u : 0u);
+		const uint32_t alpha_prec = (info.alpha_bits > 0u ? info.alpha_bits + (has_pbits ? 1u : 0u) : 0u);
+		for (uint32_t ep = 0; ep < endpoint_count; ++ep) {
+			for (uint32_t channel = 0; channel < 4u; ++channel) {
+				const uint32_t prec = (channel < 3u ? color_prec : alpha_prec);
+				if (prec == 0u) {
+					endpoints[ep][channel] = 255u;
+					continue;
+				}
+				uint32_t val = endpoints[ep][channel];
+				if (has_pbits) {
+					val = (val << 1u) | pbits[ep];
+				}
+				val <<= (8u - prec);
+				endpoints[ep][channel] = val | (val >> prec);
+			}
+		}
+		
+		// indices
+		uint32_t indices[16];
+		uint32_t indices_2[16] {};
+		for (uint32_t i = 0; i < 16u; ++i) {
+			indices[i] = reader.read(info.index_bits - (is_anchor(info.subset_count, partition, i) ? 1u : 0u));
+		}
+		if (info.index_bits_2 > 0u) {
+			for (uint32_t i = 0; i < 16u; ++i) {
+				indices_2[i] = reader.read(info.index_bits_2 - (i == 0u ? 1u : 0u));
+			}
+		}
+		
+		// interpolate
+		const uint8_t* color_weights = weights_for_bits(info.index_bits);
+		const uint8_t* alpha_weights = color_weights;
+		const uint32_t* color_indices = indices;
+		const uint32_t* alpha_indices = indices;
+		if (info.index_bits_2 > 0u) {
+			if (index_selection == 0u) {
+				alpha_weights = weights_for_bits(info.index_bits_2);
+				alpha_indices = indices_2;
+			} else {
+				color_weights = weights_for_bits(info.index_bits_2);
+				color_indices = indices_2;
+				alpha_weights = weights_for_bits(info.index_bits);
+				alpha_indices = indices;
+			}
+		}
+		for (uint32_t i = 0; i < 16u; ++i) {
+			const uint32_t subset = texel_subset(info.subset_count, partition, i);
+			const auto& e0 = endpoints[subset * 2u];
+			const auto& e1 = endpoints[subset * 2u + 1u];
+			const uint32_t cw = color_weights[color_indices[i]];
+			const uint32_t aw = alpha_weights[alpha_indices[i]];
+			uint32_t rgba[4] {
+				(e0[0] * (64u - cw) + e1[0] * cw + 32u) >> 6u,
+				(e0[1] * (64u - cw) + e1[1] * cw + 32u) >> 6u,
+				(e0[2] * (64u - cw) + e1[2] * cw + 32u) >> 6u,
+				(e0[3] * (64u - aw) + e1[3] * aw + 32u) >> 6u,
+			};
+			if (rotation > 0u) {
+				// swap alpha with r/g/b
+				const uint32_t tmp = rgba[3];
+				rgba[3] = rgba[rotation - 1u];
+				rgba[rotation - 1u] = tmp;
+			}
+			block.texels[i] = {
+				float(rgba[0]) * (1.0f / 255.0f),
+				float(rgba[1]) * (1.0f / 255.0f),
+				float(rgba[2]) * (1.0f / 255.0f),
+				float(rgba[3]) * (1.0f / 255.0f),
+			};
+		}
+	}
+	
+	//! converts a half float (stored as uint16_t) to a float
+	floor_inline_always static float half_bits_to_float(const uint16_t bits) {
+#if !defined(FLOOR_COMPUTE_HOST_DEVICE)
+		soft_f16 val;
+		val.value = bits;
+		return (float)val;
+#else
+		return (float)*(const __fp16*)&bits;
+#endif
+	}
+	
+	floor_inline_always static int32_t sign_extend(const uint32_t val, const uint32_t bits) {
+		const uint32_t shift = 32u - bits;
+		return int32_t(val << shift) >> shift;
+	}
+	
+	//! BC6H: RGB half float (signed or unsigned), 16 bytes per block
+	template <bool is_signed>
+	static inline void decode_bc6h(const uint8_t* data, decoded_block& block) {
+		block_bit_reader reader { load_u64(data), load_u64(data + 8), 0u };
+		
+		// endpoint fields of the bit layouts below
+		enum : uint8_t { R0, G0, B0, R1, G1, B1, R2, G2, B2, R3, G3, B3, D, __FIELD_COUNT };
+		//! bit field segment: field, first bit, last bit (bits are stored from first to last, last < first -> reversed)
+		struct segment_t {
+			uint8_t field;
+			uint8_t first;
+			uint8_t last;
+		};
+		//! per mode: transformed endpoints, endpoint bits, delta bits (r, g, b), subset count, segments (up to 24)
+		struct mode_info_t {
+			bool transformed;
+			uint8_t endpoint_bits;
+			uint8_t delta_bits[3];
+			uint8_t subset_count;
+			uint8_t segment_count;
+			segment_t segments[24];
+		};
+		static constexpr const mode_info_t mode_infos[14] {
+			{ true, 10, { 5, 5, 5 }, 2, 20, {
+				{ G2, 4, 4 }, { B2, 4, 4 }, { B3, 4, 4 }, { R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 4 }, { G3, 4, 4 },
+				{ G2, 0, 3 }, { G1, 0, 4 }, { B3, 0, 0 }, { G3, 0, 3 }, { B1, 0, 4 }, { B3, 1, 1 }, { B2, 0, 3 }, { R2, 0, 4 },
+				{ B3, 2, 2 }, { R3, 0, 4 }, { B3, 3, 3 }, { D, 0, 4 } } },
+			{ true, 7, { 6, 6, 6 }, 2, 24, {
+				{ G2, 5, 5 }, { G3, 4, 4 }, { G3, 5, 5 }, { R0, 0, 6 }, { B3, 0, 0 }, { B3, 1, 1 }, { B2, 4, 4 }, { G0, 0, 6 },
+				{ B2, 5, 5 }, { B3, 2, 2 }, { G2, 4, 4 }, { B0, 0, 6 }, { B3, 3, 3 }, { B3, 5, 5 }, { B3, 4, 4 }, { R1, 0, 5 },
+				{ G2, 0, 3 }, { G1, 0, 5 }, { G3, 0, 3 }, { B1, 0, 5 }, { B2, 0, 3 }, { R2, 0, 5 }, { R3, 0, 5 }, { D, 0, 4 } } },
+			{ true, 11, { 5, 4, 4 }, 2, 19, {
+				{ R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 4 }, { R0, 10, 10 }, { G2, 0, 3 }, { G1, 0, 3 }, { G0, 10, 10 },
+				{ B3, 0, 0 }, { G3, 0, 3 }, { B1, 0, 3 }, { B0, 10, 10 }, { B3, 1, 1 }, { B2, 0, 3 }, { R2, 0, 4 }, { B3, 2, 2 },
+				{ R3, 0, 4 }, { B3, 3, 3 }, { D, 0, 4 } } },
+			{ true, 11, { 4, 5, 4 }, 2, 21, {
+				{ R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 3 }, { R0, 10, 10 }, { G3, 4, 4 }, { G2, 0, 3 }, { G1, 0, 4 },
+				{ G0, 10, 10 }, { G3, 0, 3 }, { B1, 0, 3 }, { B0, 10, 10 }, { B3, 1, 1 }, { B2, 0, 3 }, { R2, 0, 3 }, { B3, 0, 0 },
+				{ B3, 2, 2 }, { R3, 0, 3 }, { G2, 4, 4 }, { B3, 3, 3 }, { D, 0, 4 } } },
+			{ true, 11, { 4, 4, 5 }, 2, 21, {
+				{ R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 3 }, { R0, 10, 10 }, { B2, 4, 4 }, { G2, 0, 3 }, { G1, 0, 3 },
+				{ G0, 10, 10 }, { B3, 0, 0 }, { G3, 0, 3 }, { B1, 0, 4 }, { B0, 10, 10 }, { B2, 0, 3 }, { R2, 0, 3 }, { B3, 1, 1 },
+				{ B3, 2, 2 }, { R3, 0, 3 }, { B3, 4, 4 }, { B3, 3, 3 }, { D, 0, 4 } } },
+			{ true, 9, { 5, 5, 5 }, 2, 20, {
+				{ R0, 0, 8 }, { B2, 4, 4 }, { G0, 0, 8 }, { G2, 4, 4 }, { B0, 0, 8 }, { B3, 4, 4 }, { R1, 0, 4 }, { G3, 4, 4 },
+				{ G2, 0, 3 }, { G1, 0, 4 }, { B3, 0, 0 }, { G3, 0, 3 }, { B1, 0, 4 }, { B3, 1, 1 }, { B2, 0, 3 }, { R2, 0, 4 },
+				{ B3, 2, 2 }, { R3, 0, 4 }, { B3, 3, 3 }, { D, 0, 4 } } },
+			{ true, 8, { 6, 5, 5 }, 2, 20, {
+				{ R0, 0, 7 }, { G3, 4, 4 }, { B2, 4, 4 }, { G0, 0, 7 }, { B3, 2, 2 }, { G2, 4, 4 }, { B0, 0, 7 }, { B3, 3, 3 },
+				{ B3, 4, 4 }, { R1, 0, 5 }, { G2, 0, 3 }, { G1, 0, 4 }, { B3, 0, 0 }, { G3, 0, 3 }, { B1, 0, 4 }, { B3, 1, 1 },
+				{ B2, 0, 3 }, { R2, 0, 5 }, { R3, 0, 5 }, { D, 0, 4 } } },
+			{ true, 8, { 5, 6, 5 }, 2, 22, {
+				{ R0, 0, 7 }, { B3, 0, 0 }, { B2, 4, 4 }, { G0, 0, 7 }, { G2, 5, 5 }, { G2, 4, 4 }, { B0, 0, 7 }, { G3, 5, 5 },
+				{ B3, 4, 4 }, { R1, 0, 4 }, { G3, 4, 4 }, { G2, 0, 3 }, { G1, 0, 5 }, { G3, 0, 3 }, { B1, 0, 4 }, { B3, 1, 1 },
+				{ B2, 0, 3 }, { R2, 0, 4 }, { B3, 2, 2 }, { R3, 0, 4 }, { B3, 3, 3 }, { D, 0, 4 } } },
+			{ true, 8, { 5, 5, 6 }, 2, 22, {
+				{ R0, 0, 7 }, { B3, 1, 1 }, { B2, 4, 4 }, { G0, 0, 7 }, { B2, 5, 5 }, { G2, 4, 4 }, { B0, 0, 7 }, { B3, 5, 5 },
+				{ B3, 4, 4 }, { R1, 0, 4 }, { G3, 4, 4 }, { G2, 0, 3 }, { G1, 0, 4 }, { B3, 0, 0 }, { G3, 0, 3 }, { B1, 0, 5 },
+				{ B2, 0, 3 }, { R2, 0, 4 }, { B3, 2, 2 }, { R3, 0, 4 }, { B3, 3, 3 }, { D, 0, 4 } } },
+			{ false, 6, { 6, 6, 6 }, 2, 24, {
+				{ R0, 0, 5 }, { G3, 4, 4 }, { B3, 0, 0 }, { B3, 1, 1 }, { B2, 4, 4 }, { G0, 0, 5 }, { G2, 5, 5 }, { B2, 5, 5 },
+				{ B3, 2, 2 }, { G2, 4, 4 }, { B0, 0, 5 }, { G3, 5, 5 }, { B3, 3, 3 }, { B3, 5, 5 }, { B3, 4, 4 }, { R1, 0, 5 },
+				{ G2, 0, 3 }, { G1, 0, 5 }, { G3, 0, 3 }, { B1, 0, 5 }, { B2, 0, 3 }, { R2, 0, 5 }, { R3, 0, 5 }, { D, 0, 4 } } },
+			{ false, 10, { 10, 10, 10 }, 1, 6, {
+				{ R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 9 }, { G1, 0, 9 }, { B1, 0, 9 } } },
+			{ true, 11, { 9, 9, 9 }, 1, 9, {
+				{ R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 8 }, { R0, 10, 10 }, { G1, 0, 8 }, { G0, 10, 10 }, { B1, 0, 8 },
+				{ B0, 10, 10 } } },
+			{ true, 12, { 8, 8, 8 }, 1, 9, {
+				{ R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 7 }, { R0, 11, 10 }, { G1, 0, 7 }, { G0, 11, 10 }, { B1, 0, 7 },
+				{ B0, 11, 10 } } },
+			{ true, 16, { 4, 4, 4 }, 1, 9, {
+				{ R0, 0, 9 }, { G0, 0, 9 }, { B0, 0, 9 }, { R1, 0, 3 }, { R0, 15, 10 }, { G1, 0, 3 }, { G0, 15, 10 }, { B1, 0, 3 },
+				{ B0, 15, 10 } } },
+		};
+		
+		// decode mode: 2-bit modes 0 and 1, 5-bit modes otherwise
+		uint32_t mode_bits = reader.read(2u);
+		int32_t mode = -1;
+		if (mode_bits < 2u) {
+			mode = int32_t(mode_bits);
+		} else {
+			mode_bits |= reader.read(3u) << 2u;
+			switch (mode_bits) {
+				case 0x02u: mode = 2; break;
+				case 0x06u: mode = 3; break;
+				case 0x0Au: mode = 4; break;
+				case 0x0Eu: mode = 5; break;
+				case 0x12u: mode = 6; break;
+				case 0x16u: mode = 7; break;
+				case 0x1Au: mode = 8; break;
+				case 0x1Eu: mode = 9; break;
+				case 0x03u: mode = 10; break;
+				case 0x07u: mode = 11; break;
+				case 0x0Bu: mode = 12; break;
+				case 0x0Fu: mode = 13; break;
+				default: break;
+			}
+		}
+		if (mode < 0) {
+			// reserved mode
+#pragma clang loop unroll(full) vectorize(enable) interleave(enable)
+			for (uint32_t i = 0; i < 16u; ++i) {
+				block.texels[i] = { 0.0f, 0.0f, 0.0f, 1.0f };
+			}
+			return;
+		}
+		const auto& info = mode_infos[mode];
+		
+		// read all endpoint/partition fields
+		uint32_t fields[__FIELD_COUNT] {};
+		for (uint32_t seg_idx = 0; seg_idx < info.segment_count; ++seg_idx) {
+			const auto& seg = info.segments[seg_idx];
+			if (seg.first <= seg.last) {
+				for (uint32_t bit = seg.first; bit <= seg.last; ++bit) {
+					fields[seg.field] |= reader.read(1u) << bit;
+				}
+			} else {
+				for (uint32_t bit = seg.first + 1u; bit > seg.last; --bit) {
+					fields[seg.field] |= reader.read(1u) << (bit - 1u);
+				}
+			}
+		}
+		const uint32_t partition = fields[D];
+		
+		// endpoints: [subset * 2 + endpoint][channel]
+		const uint32_t endpoint_count = info.subset_count * 2u;
+		const uint32_t endpoint_mask = (1u << info.endpoint_bits) - 1u;
+		int32_t endpoints[4][3];
+		for (uint32_t ep = 0; ep < endpoint_count; ++ep) {
+			for (uint32_t channel = 0; channel < 3u; ++channel) {
+				const uint32_t val = fields[ep * 3u + channel];
+				if (ep == 0u) {
+					endpoints[0][channel] = (is_signed ? sign_extend(val, info.endpoint_bits) : int32_t(val));
+				} else if (info.transformed) {
+					// delta to endpoint #0
+					const uint32_t abs_val = (uint32_t(int32_t(fields[channel]) + sign_extend(val, info.delta_bits[channel])) &
+											  endpoint_mask);
+					endpoints[ep][channel] = (is_signed ? sign_extend(abs_val, info.endpoint_bits) : int32_t(abs_val));
+				} else {
+					endpoints[ep][channel] = (is_signed ? sign_extend(val, info.endpoint_bits) : int32_t(val));
+				}
+			}
+		}
+		
+		// unquantize
+		for (uint32_t ep = 0; ep < endpoint_count; ++ep) {
+			for (uint32_t channel = 0; channel < 3u; ++channel) {
+				int32_t val = endpoints[ep][channel];
+				if constexpr (!is_signed) {
+					if (info.endpoint_bits < 15u) {
+						if (val == 0) {
+							// stays 0
+						} else if (val == int32_t(endpoint_mask)) {
+							val = 0xFFFF;
+						} else {
+							val = ((val << 16) + 0x8000) >> info.endpoint_bits;
+						}
+					}
+				} else {
+					if (info.endpoint_bits < 16u) {
+						const bool negative = (val < 0);
+						int32_t abs_val = (negative ? -val : val);
+						if (abs_val == 0) {
+							// stays 0
+						} else if (abs_val >= int32_t((1u << (info.endpoint_bits - 1u)) - 1u)) {
+							abs_val = 0x7FFF;
+						} else {
+							abs_val = ((abs_val << 15) + 0x4000) >> (info.endpoint_bits - 1u);
+						}
+						val = (negative ? -abs_val : abs_val);
+					}
+				}
+				endpoints[ep][channel] = val;
+			}
+		}
+		
+		// indices + interpolation
+		const uint32_t index_bits = (info.subset_count == 1u ? 4u : 3u);
+		const uint8_t* weights = weights_for_bits(index_bits);
+		for (uint32_t i = 0; i < 16u; ++i) {
+			const uint32_t index = reader.read(index_bits - (is_anchor(info.subset_count, partition, i) ? 1u : 0u));
+			const uint32_t subset = texel_subset(info.subset_count, partition, i);
+			const auto& e0 = endpoints[subset * 2u];
+			const auto& e1 = endpoints[subset * 2u + 1u];
+			const int32_t w = weights[index];
+			float rgb[3];
+#pragma unroll
+			for (uint32_t channel = 0; channel < 3u; ++channel) {
+				const int32_t val = (e0[channel] * (64 - w) + e1[channel] * w + 32) >> 6;
+				// finish unquantization -> half float bits
+				uint16_t half_bits;
+				if constexpr (!is_signed) {
+					half_bits = uint16_t((val * 31) >> 6);
+				} else {
+					half_bits = (val < 0 ? uint16_t(0x8000u | uint32_t(((-val) * 31) >> 5)) : uint16_t((val * 31) >> 5));
+				}
+				rgb[channel] = half_bits_to_float(half_bits);
+			}
+			block.texels[i] = { rgb[0], rgb[1], rgb[2], 1.0f };
+		}
+	}
+	
+	//! decodes the 4x4 block at "data" of the specified BCn image type,
+	//! returns false if "image_type" is not a supported block-compressed format
+	static inline bool decode_block(const uint8_t* data, const COMPUTE_IMAGE_TYPE image_type, decoded_block& block) {
+		const auto data_type = (image_type & COMPUTE_IMAGE_TYPE::__DATA_TYPE_MASK);
+		switch (image_type & COMPUTE_IMAGE_TYPE::__COMPRESSION_MASK) {
+			case COMPUTE_IMAGE_TYPE::BC1:
+				decode_bc1(data, block, image_channel_count(image_type) == 4u);
+				return true;
+			case COMPUTE_IMAGE_TYPE::BC2:
+				decode_bc2(data, block);
+				return true;
+			case COMPUTE_IMAGE_TYPE::BC3:
+				decode_bc3(data, block);
+				return true;
+			case COMPUTE_IMAGE_TYPE::RGTC:
+				if (data_type == COMPUTE_IMAGE_TYPE::INT) {
+					decode_bc4_bc5<true>(data, block, image_channel_count(image_type));
+				} else {
+					decode_bc4_bc5<false>(data, block, image_channel_count(image_type));
+				}
+				return true;
+			case COMPUTE_IMAGE_TYPE::BPTC:
+				if (data_type != COMPUTE_IMAGE_TYPE::FLOAT) {
+					decode_bc7(data, block);
+				} else if (has_flag<COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED>(image_type)) {
+					decode_bc6h<false>(data, block);
+				} else {
+					decode_bc6h<true>(data, block);
+				}
+				return true;
+			default:
+				return false;
+		}
+	}
+	
+	//! per-thread cache of decoded blocks, direct-mapped by the block position (see cache_slot)
+	//! NOTE: entries are tagged with the raw block data and image type, so a cached block can never be stale
+	struct block_cache_entry {
+		uint64_t raw[2];
+		COMPUTE_IMAGE_TYPE image_type;
+		decoded_block block;
+	};
+	static constexpr const uint32_t block_cache_size { 16u };
+	
+	floor_inline_always static auto& block_cache() {
+#if !defined(FLOOR_COMPUTE_HOST_DEVICE)
+		static thread_local block_cache_entry cache[block_cache_size] {};
+#else
+		// each execution thread has its own memory space -> no need for TLS
+		static block_cache_entry cache[block_cache_size] {};
+#endif
+		return cache;
+	}
+	
+	//! returns the cache slot of the block at block coordinate (bx, by):
+	//! neighboring blocks in a 4x4 block area never share a slot
+	floor_inline_always static constexpr uint32_t cache_slot(const uint32_t bx, const uint32_t by) {
+		return (bx & 3u) | ((by & 3u) << 2u);
+	}
+	
+	//! returns the decoded block at "data" (of size "block_size"), either from the per-thread cache or by decoding it
+	floor_inline_always static const decoded_block& decode_block_cached(const uint8_t* data,
+																		 const uint32_t block_size,
+																		 const COMPUTE_IMAGE_TYPE image_type,
+																		 const uint32_t slot) {
+		const uint64_t raw_low = load_u64(data);
+		const uint64_t raw_high = (block_size > 8u ? load_u64(data + 8) : 0u);
+		auto& entry = block_cache()[slot];
+		if (entry.raw[0] != raw_low || entry.raw[1] != raw_high || entry.image_type != image_type) {
+			if (!decode_block(data, image_type, entry.block)) {
+				entry.block = {};
+			}
+			entry.raw[0] = raw_low;
+			entry.raw[1] = raw_high;
+			entry.image_type = image_type;
+		}
+		return entry.block;
+	}
+	
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_COMPUTE_DEVICE_HOST_IMAGE_TILING_HPP__
+#define __FLOOR_COMPUTE_DEVICE_HOST_IMAGE_TILING_HPP__
+
+//! tiled storage layout of host-compute images (COMPUTE_MEMORY_FLAG::HOST_TILED_LAYOUT), shared by the host and device side:
+//! * 2D images (and each layer/face of 2D array and cube images) are stored as rows of 4x4 texel tiles
+//! * 3D images are stored as slabs of 4 slices, each slab consisting of rows of 4x4x4 texel bricks
+//! * texels inside a tile/brick are stored in linear order
+//! tiles/bricks at the right/bottom/back edges are shrunk to the remaining texels, so that no padding is necessary
+//! and a tiled image has exactly the same size (and level/layer offsets) as a linear one
+namespace host_image_tiling {
+	//! tile/brick size in each dimension
+	static constexpr const uint32_t tile_size { 4u };
+	
+	//! returns the texel index of the texel (x, y) in a tiled 2D image of size (width, height)
+	floor_inline_always static constexpr uint64_t texel_index(const uint32_t width, const uint32_t height,
+															  const uint32_t x, const uint32_t y) {
+		const auto tile_x = (x & ~(tile_size - 1u));
+		const auto tile_y = (y & ~(tile_size - 1u));
+		const auto tile_width = (width - tile_x < tile_size ? width - tile_x : tile_size);
+		const auto tile_height = (height - tile_y < tile_size ? height - tile_y : tile_size);
+		return (uint64_t(tile_y) * uint64_t(width) +
+				uint64_t(tile_x) * uint64_t(tile_height) +
+				uint64_t((y - tile_y) * tile_width + (x - tile_x)));
+	}
+	
+	//! returns the texel index of the texel (x, y, z) in a tiled 3D image of size (width, height, depth)
+	floor_inline_always static constexpr uint64_t texel_index(const uint32_t width, const uint32_t height, const uint32_t depth,
+															  const uint32_t x, const uint32_t y, const uint32_t z) {
+		const auto tile_x = (x & ~(tile_size - 1u));
+		const auto tile_y = (y & ~(tile_size - 1u));
+		const auto tile_z = (z & ~(tile_size - 1u));
+		const auto tile_width = (width - tile_x < tile_size ? width - tile_x : tile_size);
+		const auto tile_height = (height - tile_y < tile_size ? height - tile_y : tile_size);
+		const auto tile_depth = (depth - tile_z < tile_size ? depth - tile_z : tile_size);
+		return (uint64_t(tile_z) * uint64_t(width) * uint64_t(height) +
+				uint64_t(tile_y) * uint64_t(width) * uint64_t(tile_depth) +
+				uint64_t(tile_x) * uint64_t(tile_height) * uint64_t(tile_depth) +
+				uint64_t(((z - tile_z) * tile_height + (y - tile_y)) * tile_width + (x - tile_x)));
+	}
+	
+}
+
+#endif
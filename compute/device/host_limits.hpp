@@ -19,6 +19,22 @@
 #ifndef __FLOOR_COMPUTE_DEVICE_HOST_LIMITS_HPP__
 #define __FLOOR_COMPUTE_DEVICE_HOST_LIMITS_HPP__
 
+// host compute exeuction model, choose wisely:
+
+// single-threaded, one logical cpu (the calling thread) corresponding to all work-items and work-groups
+// NOTE: no parallelism
+//#define FLOOR_HOST_COMPUTE_ST 1
+
+// multi-threaded, each logical cpu ("h/w thread") corresponding to one work-item in a work-group
+// NOTE: has intra-group parallelism, has no inter-group parallelism
+// NOTE: no fibers, barriers are sync'ed through spin locking
+//#define FLOOR_HOST_COMPUTE_MT_ITEM 1
+
+// multi-threaded, each logical cpu ("h/w thread") corresponding to one work-group
+// NOTE: has no intra-group parallelism, has inter-group parallelism
+// NOTE: uses fibers when encountering a barrier, running all fibers up to the barrier, then continuing
+#define FLOOR_HOST_COMPUTE_MT_GROUP 1
+
 // id/size ranges
 #define FLOOR_COMPUTE_INFO_GLOBAL_ID_RANGE_MIN 0u
 #define FLOOR_COMPUTE_INFO_GLOBAL_ID_RANGE_MAX 0xFFFFFFFFu
@@ -30,14 +46,19 @@
 #define FLOOR_COMPUTE_INFO_GROUP_ID_RANGE_MAX 0xFFFFFFFFu
 #define FLOOR_COMPUTE_INFO_GROUP_SIZE_RANGE_MIN 1u
 #define FLOOR_COMPUTE_INFO_GROUP_SIZE_RANGE_MAX 0xFFFFFFFFu
+
+// sub-groups consist of (up to) SIMD-width work-items that are consecutive in linear local id order
+// NOTE: these are set by the toolchain when compiling for the host-compute device
+#if !defined(FLOOR_COMPUTE_HOST_DEVICE)
 #define FLOOR_COMPUTE_INFO_SUB_GROUP_ID_RANGE_MIN 0u
-#define FLOOR_COMPUTE_INFO_SUB_GROUP_ID_RANGE_MAX 0xFFFFFFFFu
-#define FLOOR_COMPUTE_INFO_SUB_GROUP_LOCAL_ID_RANGE_MIN 1u
-#define FLOOR_COMPUTE_INFO_SUB_GROUP_LOCAL_ID_RANGE_MAX 0xFFFFFFFFu
-#define FLOOR_COMPUTE_INFO_SUB_GROUP_SIZE_RANGE_MIN 0u
-#define FLOOR_COMPUTE_INFO_SUB_GROUP_SIZE_RANGE_MAX 0xFFFFFFFFu
+#define FLOOR_COMPUTE_INFO_SUB_GROUP_ID_RANGE_MAX FLOOR_COMPUTE_INFO_LOCAL_ID_RANGE_MAX
+#define FLOOR_COMPUTE_INFO_SUB_GROUP_LOCAL_ID_RANGE_MIN 0u
+#define FLOOR_COMPUTE_INFO_SUB_GROUP_LOCAL_ID_RANGE_MAX FLOOR_COMPUTE_INFO_SIMD_WIDTH
+#define FLOOR_COMPUTE_INFO_SUB_GROUP_SIZE_RANGE_MIN 1u
+#define FLOOR_COMPUTE_INFO_SUB_GROUP_SIZE_RANGE_MAX (FLOOR_COMPUTE_INFO_SIMD_WIDTH + 1u)
 #define FLOOR_COMPUTE_INFO_NUM_SUB_GROUPS_RANGE_MIN 1u
-#define FLOOR_COMPUTE_INFO_NUM_SUB_GROUPS_RANGE_MAX 0xFFFFFFFFu
+#define FLOOR_COMPUTE_INFO_NUM_SUB_GROUPS_RANGE_MAX FLOOR_COMPUTE_INFO_LOCAL_SIZE_RANGE_MAX
+#endif
 
 #if !defined(__WINDOWS__)
 #define FLOOR_COMPUTE_INFO_LOCAL_ID_RANGE_MAX 1024u
@@ -198,15 +198,29 @@ floor_inline_always static std::locale locale_global(const std::locale& loc) {
 #define FLOOR_COMPUTE_INFO_HAS_DEDICATED_LOCAL_MEMORY 0
 #define FLOOR_COMPUTE_INFO_HAS_DEDICATED_LOCAL_MEMORY_0
 
-// host-compute doesn't support sub-groups or sub-group shuffle right now
+// sub-groups, sub-group shuffle and cooperative kernels are only supported by the mt-group execution model
+// (must match the device flags that are set in host_compute.cpp)
+// NOTE: these are set by the toolchain when compiling for the host-compute device
+#if !defined(FLOOR_COMPUTE_HOST_DEVICE)
+#if defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+// sub-group work-items exchange values through memory
+#define FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS 1
+#define FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS_1
+#define FLOOR_COMPUTE_INFO_HAS_SUB_GROUP_SHUFFLE 1
+#define FLOOR_COMPUTE_INFO_HAS_SUB_GROUP_SHUFFLE_1
+
+// global_barrier() is a grid-wide barrier in cooperative executions
+#define FLOOR_COMPUTE_INFO_HAS_COOPERATIVE_KERNEL 1
+#define FLOOR_COMPUTE_INFO_HAS_COOPERATIVE_KERNEL_1
+#else
 #define FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS 0
 #define FLOOR_COMPUTE_INFO_HAS_SUB_GROUPS_0
 #define FLOOR_COMPUTE_INFO_HAS_SUB_GROUP_SHUFFLE 0
 #define FLOOR_COMPUTE_INFO_HAS_SUB_GROUP_SHUFFLE_0
-
-// host-compute doesn't support cooperative kernels right now
 #define FLOOR_COMPUTE_INFO_HAS_COOPERATIVE_KERNEL 0
 #define FLOOR_COMPUTE_INFO_HAS_COOPERATIVE_KERNEL_0
+#endif
+#endif
 
 // handle simd-width, as this obviously needs to be known at compile-time (even though it might be different at run-time),
 // make this dependent on compiler specific defines
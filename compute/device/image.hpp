@@ -887,6 +887,25 @@ namespace floor_image {
 			return read_internal<true, false, true, true, compare_function>(coord, layer, 0, offset, 0.0f, 0, gradient, compare_value);
 		}
 		
+#if defined(FLOOR_COMPUTE_HOST)
+		//////////////////////////////////////////
+		// batched read functions (host-compute only)
+		
+		//! batched image read of "count" normalized coordinates with nearest/point sampling (2D, non-array, non-msaa, float or normalized)
+		//! at mip-level "lod", writing "count" float4 colors (non-existing channels are set to 0, alpha to 1)
+		//! NOTE: the image format is only resolved once per batch, RGBA8 unorm, RGBA16F, R32F and RGBA32F images use a vectorized path
+		template <HOST_IMAGE_ADDRESS_MODE address_mode = HOST_IMAGE_ADDRESS_MODE::CLAMP_TO_EDGE, COMPUTE_IMAGE_TYPE image_type_ = image_type>
+		void read_batch(const float2* coords, float4* colors, const uint32_t count, const uint32_t lod = 0) const {
+			host_device_image<image_type_>::template read_batch<false, address_mode>(r_img(), coords, colors, count, lod);
+		}
+		
+		//! batched image read of "count" normalized coordinates with bilinear sampling (see read_batch)
+		template <HOST_IMAGE_ADDRESS_MODE address_mode = HOST_IMAGE_ADDRESS_MODE::CLAMP_TO_EDGE, COMPUTE_IMAGE_TYPE image_type_ = image_type>
+		void read_batch_linear(const float2* coords, float4* colors, const uint32_t count, const uint32_t lod = 0) const {
+			host_device_image<image_type_>::template read_batch<true, address_mode>(r_img(), coords, colors, count, lod);
+		}
+#endif
+		
 	};
 	
 	//! read-write/write-only image container
@@ -27,6 +27,9 @@ enum class COMPUTE_IMAGE_TYPE : uint64_t {
 	//////////////////////////////////////////
 	// -> image flags and types
 	
+	//! bit 38: host-compute internal: image data is stored in the tiled layout (see COMPUTE_MEMORY_FLAG::HOST_TILED_LAYOUT)
+	__HOST_TILED			= (1ull << 38ull),
+	
 	//! bits 35-37: anisotropy (stored as power-of-two)
 	__ANISOTROPY_MASK		= (0x0000'0038'0000'0000ull),
 	__ANISOTROPY_SHIFT		= (35ull),
@@ -495,6 +498,19 @@ floor_inline_always static constexpr bool image_format_valid(const COMPUTE_IMAGE
 	return true;
 }
 
+//! returns the amount of bytes needed to store one 4x4 pixel block of a BCn (BC1 - BC7) compressed image format,
+//! or 0 if the specified format is not BCn compressed
+static constexpr uint32_t image_bcn_block_size(const COMPUTE_IMAGE_TYPE& image_type) {
+	switch (image_type & COMPUTE_IMAGE_TYPE::__COMPRESSION_MASK) {
+		case COMPUTE_IMAGE_TYPE::BC1: return 8;
+		case COMPUTE_IMAGE_TYPE::BC2:
+		case COMPUTE_IMAGE_TYPE::BC3: return 16;
+		case COMPUTE_IMAGE_TYPE::RGTC: return (image_channel_count(image_type) == 1 ? 8 : 16);
+		case COMPUTE_IMAGE_TYPE::BPTC: return 16;
+		default: return 0;
+	}
+}
+
 //! returns the amount of bits needed to store one pixel
 static constexpr uint32_t image_bits_per_pixel(const COMPUTE_IMAGE_TYPE& image_type) {
 	const auto format = image_type & COMPUTE_IMAGE_TYPE::__FORMAT_MASK;
@@ -529,6 +545,12 @@ static constexpr uint32_t image_bits_per_pixel(const COMPUTE_IMAGE_TYPE& image_t
 	} else {
 		switch (image_type & COMPUTE_IMAGE_TYPE::__COMPRESSION_MASK) {
 			case COMPUTE_IMAGE_TYPE::PVRTC: return (format == COMPUTE_IMAGE_TYPE::FORMAT_2 ? 2 : 4);
+			// BCn: block size in bits / 16 pixels
+			case COMPUTE_IMAGE_TYPE::BC1:
+			case COMPUTE_IMAGE_TYPE::BC2:
+			case COMPUTE_IMAGE_TYPE::BC3:
+			case COMPUTE_IMAGE_TYPE::RGTC:
+			case COMPUTE_IMAGE_TYPE::BPTC: return (image_bcn_block_size(image_type) * 8u) / 16u;
 			// TODO: other compressed formats
 			default: return 1;
 		}
@@ -581,6 +603,16 @@ static constexpr uint32_t image_bytes_per_pixel(const COMPUTE_IMAGE_TYPE& image_
 static constexpr size_t image_slice_data_size_from_types(const uint4& image_dim,
 														 const COMPUTE_IMAGE_TYPE& image_type) {
 	const auto dim_count = image_dim_count(image_type);
+	
+	// BCn formats are always stored as complete 4x4 pixel blocks
+	const auto bcn_block_size = image_bcn_block_size(image_type);
+	if (bcn_block_size > 0u) {
+		size_t block_count = (size_t(image_dim.x) + 3u) / 4u;
+		if (dim_count >= 2) block_count *= (size_t(image_dim.y) + 3u) / 4u;
+		if (dim_count == 3) block_count *= size_t(image_dim.z);
+		return block_count * bcn_block_size;
+	}
+	
 	size_t size = size_t(image_dim.x);
 	if (dim_count >= 2) size *= size_t(image_dim.y);
 	if (dim_count == 3) size *= size_t(image_dim.z);
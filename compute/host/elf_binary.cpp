@@ -25,10 +25,15 @@
 #include <floor/core/file_io.hpp>
 #include <floor/core/core.hpp>
 #include <string_view>
+#include <unordered_set>
+#include <mutex>
 
 #if !defined(__WINDOWS__)
 #include <dlfcn.h>
 #include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#endif
 #else
 #include <floor/core/platform_windows.hpp>
 #include <floor/core/essentials.hpp> // cleanup
@@ -449,6 +454,8 @@ static_assert(sizeof(elf64_relocation_addend_entry_t) == 24u, "invalid ELF64 rel
 struct relocation_t {
 	const elf64_relocation_addend_entry_t* reloc_ptr { nullptr };
 	const symbol_t* symbol_ptr { nullptr };
+	//! index of the section this relocation applies to (sh_info of the relocation section)
+	uint32_t target_section_idx { 0u };
 	
 	void dump(ostream& sstr, const vector<section_t>& sections, const vector<symbol_t>& symbols) const {
 		sstr << "reloc: symbol ";
@@ -487,10 +494,19 @@ struct elf_binary::elf_info_t {
 	vector<symbol_t> symbols;
 	vector<relocation_t> exec_relocations;
 	vector<relocation_t> rodata_relocations;
+	//! relocations of the function addresses in .stack_sizes sections: .stack_sizes section -> relocation
+	//! NOTE: these are never applied, they are only used to determine the functions of the stack size entries
+	vector<pair<const section_t*, relocation_t>> stack_size_relocations;
 	//! NOTE: this is only allocated/set when read-only data must _not_ be relocated (is global for all instances)
 	aligned_ptr<uint8_t> ro_memory;
 	bool relocate_rodata { false };
 	vector<string> function_names;
+	//! names of all functions that (potentially) make use of barriers
+	unordered_set<string> barrier_function_names;
+	//! set if a barrier is used outside of any known function, in which case all functions must be considered as using barriers
+	bool all_functions_use_barriers { false };
+	//! function name -> stack usage estimate (only contains functions for which an estimate exists)
+	unordered_map<string, uint64_t> function_stack_sizes;
 	bool parsed_successfully { false };
 	//! rodata section -> mapped address/pointer
 	//! NOTE: this only exists when read-only data is global (is not relocated)
@@ -601,6 +617,144 @@ const vector<string>& elf_binary::get_function_names() const {
 	return info->function_names;
 }
 
+bool elf_binary::uses_barrier(const string& func_name) const {
+	if (!info || !valid) {
+		return true;
+	}
+	return (info->all_functions_use_barriers || info->barrier_function_names.count(func_name) > 0);
+}
+
+uint64_t elf_binary::get_stack_size(const string& func_name) const {
+	if (!info || !valid) {
+		return 0u;
+	}
+	const auto iter = info->function_stack_sizes.find(func_name);
+	return (iter != info->function_stack_sizes.end() ? iter->second : 0u);
+}
+
+//! decodes the ULEB128-encoded value at "data" (of at most "size" bytes) into "value",
+//! returns the amount of bytes that were consumed, or 0 if the encoding is invalid/incomplete
+static uint32_t decode_uleb128(const uint8_t* data, const uint64_t size, uint64_t& value) {
+	value = 0u;
+	for (uint32_t i = 0; i < min(size, uint64_t(10u)); ++i) {
+		value |= uint64_t(data[i] & 0x7Fu) << (i * 7u);
+		if ((data[i] & 0x80u) == 0u) {
+			return i + 1u;
+		}
+	}
+	return 0u;
+}
+
+#if !defined(__WINDOWS__) && !defined(__APPLE__)
+FLOOR_PUSH_WARNINGS()
+FLOOR_IGNORE_WARNING(cast-align)
+
+//! stack usage estimates of all functions of a linked (executable or shared object) ELF module
+struct linked_module_stack_sizes_t {
+	//! true if function addresses are relative to the module base (shared objects and position-independent executables)
+	bool is_relative { false };
+	//! link-time function address -> stack size
+	unordered_map<uint64_t, uint64_t> stack_sizes;
+};
+
+//! reads the .stack_sizes sections of the linked ELF module "file_name" (only exist if compiled with -fstack-size-section),
+//! in a linked module, each entry consists of the 64-bit link-time function address followed by the ULEB128-encoded stack size
+static linked_module_stack_sizes_t read_linked_stack_sizes(const string& file_name) {
+	linked_module_stack_sizes_t ret;
+	auto [bin, bin_size] = file_io::file_to_buffer(file_name);
+	if (!bin || bin_size < sizeof(elf64_header_t)) {
+		return ret;
+	}
+	
+	// only 64-bit little endian executables (type 2) and shared objects / position-independent executables (type 3)
+	const auto& header = *(const elf64_header_t*)bin.get();
+	if (memcmp(header.magic, "\177ELF", 4u) != 0 ||
+		header.bitness != 2 ||
+		header.endianness != 1 ||
+		(header.type != 2 && header.type != 3) ||
+		header.section_header_table_entry_size != sizeof(elf64_section_header_entry_t) ||
+		header.section_header_table_offset + size_t(header.section_header_table_entry_count) * sizeof(elf64_section_header_entry_t) > bin_size ||
+		header.section_names_index >= header.section_header_table_entry_count) {
+		return ret;
+	}
+	ret.is_relative = (header.type == 3);
+	
+	const auto sections = (const elf64_section_header_entry_t*)&bin[header.section_header_table_offset];
+	const auto& names_section = sections[header.section_names_index];
+	if (names_section.offset + names_section.size > bin_size) {
+		return ret;
+	}
+	const string_view names { (const char*)&bin[names_section.offset], names_section.size };
+	for (uint32_t i = 0; i < header.section_header_table_entry_count; ++i) {
+		const auto& section = sections[i];
+		if (section.type != ELF_SECTION_TYPE::PROGRAM_DATA ||
+			section.name_offset >= names.size() ||
+			section.offset + section.size > bin_size) {
+			continue;
+		}
+		const auto name = names.substr(section.name_offset);
+		if (name.substr(0, name.find('\0')) != ".stack_sizes") {
+			continue;
+		}
+		
+		const auto section_data = &bin[section.offset];
+		for (uint64_t offset = 0; offset + 8u < section.size;) {
+			uint64_t func_addr = 0u, stack_size = 0u;
+			memcpy(&func_addr, &section_data[offset], sizeof(func_addr));
+			const auto byte_count = decode_uleb128(&section_data[offset + 8u], section.size - offset - 8u, stack_size);
+			if (byte_count == 0u) {
+				log_error("invalid stack sizes entry in %s", file_name);
+				return {};
+			}
+			auto& func_stack_size = ret.stack_sizes[func_addr];
+			func_stack_size = max(func_stack_size, stack_size);
+			offset += 8u + byte_count;
+		}
+	}
+	return ret;
+}
+
+FLOOR_POP_WARNINGS()
+#endif
+
+uint64_t elf_binary::get_loaded_stack_size(const void* func_ptr) {
+#if !defined(__WINDOWS__) && !defined(__APPLE__)
+	Dl_info dl_info {};
+	if (func_ptr == nullptr || dladdr(func_ptr, &dl_info) == 0 || dl_info.dli_fname == nullptr || dl_info.dli_fbase == nullptr) {
+		return 0u;
+	}
+	
+	// the .stack_sizes sections of each module are only read once
+	static mutex modules_lock;
+	static unordered_map<string, linked_module_stack_sizes_t> modules;
+	lock_guard<mutex> lock(modules_lock);
+	auto module_iter = modules.find(dl_info.dli_fname);
+	if (module_iter == modules.end()) {
+		auto module_stack_sizes = read_linked_stack_sizes(dl_info.dli_fname);
+#if defined(__linux__)
+		// NOTE: the reported file name of the main executable is argv[0], which isn't necessarily a valid path
+		//       -> if this is the main executable (contains its program headers), read it through /proc/self/exe instead
+		if (module_stack_sizes.stack_sizes.empty()) {
+			const auto exe_program_headers = (const void*)getauxval(AT_PHDR);
+			if (Dl_info exe_info {}; exe_program_headers != nullptr && dladdr(exe_program_headers, &exe_info) != 0 &&
+				exe_info.dli_fbase == dl_info.dli_fbase) {
+				module_stack_sizes = read_linked_stack_sizes("/proc/self/exe");
+			}
+		}
+#endif
+		module_iter = modules.emplace(dl_info.dli_fname, move(module_stack_sizes)).first;
+	}
+	
+	const auto& module_stack_sizes = module_iter->second;
+	const auto func_addr = uint64_t(uintptr_t(func_ptr)) - (module_stack_sizes.is_relative ? uint64_t(uintptr_t(dl_info.dli_fbase)) : 0u);
+	const auto iter = module_stack_sizes.stack_sizes.find(func_addr);
+	return (iter != module_stack_sizes.stack_sizes.end() ? iter->second : 0u);
+#else
+	(void)func_ptr;
+	return 0u;
+#endif
+}
+
 elf_binary::instance_t* elf_binary::get_instance(const uint32_t instance_idx) {
 	if (!info || !valid || instance_idx >= info->instances.size()) {
 		return nullptr;
@@ -608,6 +762,19 @@ elf_binary::instance_t* elf_binary::get_instance(const uint32_t instance_idx) {
 	return &info->instances[instance_idx].external_instance;
 }
 
+//! returns true if "name" is the name of a barrier function
+static bool is_barrier_symbol(const string& name) {
+	return (name == "global_barrier" ||
+			name == "local_barrier" ||
+			name == "barrier" ||
+			name == "image_barrier" ||
+			name == "host_compute_device_barrier" ||
+			name == "host_compute_device_global_barrier" ||
+			// sub-group operations switch between the work-items of a sub-group
+			name == "floor_host_sub_group_exchange" ||
+			name == "host_compute_device_sub_group_exchange");
+}
+
 FLOOR_PUSH_WARNINGS()
 FLOOR_IGNORE_WARNING(cast-align)
 
@@ -812,14 +979,25 @@ bool elf_binary::parse_elf() {
 					return false;
 				}
 				
-				// we only support relocations in the .text/exec and .rodata/read-only section
+				// sh_info of a relocation section specifies the section the relocations apply to
+				const auto target_section_idx = section.header_ptr->extra_info;
+				if (target_section_idx >= info->sections.size()) {
+					log_error("invalid relocation target section in %s", section.name);
+					return false;
+				}
+				
+				// we only support relocations in the .text/exec and .rodata/read-only section,
+				// and of the function addresses in the .stack_sizes section(s)
 				vector<relocation_t>* relocations = nullptr;
+				const section_t* stack_sizes_section = nullptr;
 				if (section.name == ".rela.text") {
 					relocations = &info->exec_relocations;
 				} else if (section.name == ".rela.rodata") {
 					relocations = &info->rodata_relocations;
 					// signal that we need to relocate read-only data (-> need rodata per instance)
 					info->relocate_rodata = true;
+				} else if (section.name == ".rela.stack_sizes") {
+					stack_sizes_section = &info->sections[target_section_idx];
 				} else {
 					log_error("relocations section %s is not supported", section.name);
 					return false;
@@ -829,6 +1007,7 @@ bool elf_binary::parse_elf() {
 				for (uint64_t rel_idx = 0, rel_count = section.header_ptr->size / sizeof(elf64_relocation_addend_entry_t); rel_idx < rel_count; ++rel_idx) {
 					relocation_t reloc {
 						.reloc_ptr = &relocs_start[rel_idx],
+						.target_section_idx = target_section_idx,
 					};
 					
 					if (reloc.reloc_ptr->symbol_index >= info->symbols.size()) {
@@ -837,7 +1016,11 @@ bool elf_binary::parse_elf() {
 					}
 					reloc.symbol_ptr = &info->symbols[reloc.reloc_ptr->symbol_index];
 					
-					relocations->emplace_back(move(reloc));
+					if (stack_sizes_section != nullptr) {
+						info->stack_size_relocations.emplace_back(stack_sizes_section, move(reloc));
+					} else {
+						relocations->emplace_back(move(reloc));
+					}
 				}
 			} else if (section.header_ptr->type == ELF_SECTION_TYPE::RELOCATION_ENTRIES) {
 				log_error("relocations without addend are not supported by the ABI");
@@ -877,6 +1060,19 @@ bool elf_binary::parse_elf() {
 			} else if (sec_header.type == ELF_SECTION_TYPE::PROGRAM_DATA) {
 				const auto is_rodata = (section.name.find(".rodata") == 0);
 				const auto is_exec = (section.name.find(".text") == 0);
+				if (section.name == ".stack_sizes") {
+					// stack usage information: never mapped/allocated
+					if ((sec_header.flags & (ELF_SECTION_FLAG::WRITE | ELF_SECTION_FLAG::ALLOCATE | ELF_SECTION_FLAG::EXECUTABLE)) !=
+						ELF_SECTION_FLAG::NONE) {
+						log_error("invalid stack sizes section flags");
+						return false;
+					}
+					if (sec_header.offset + sec_header.size > binary_size) {
+						log_error("stack sizes section is out-of-bounds");
+						return false;
+					}
+					continue;
+				}
 				if (!is_rodata && !is_exec) {
 					log_error("invalid program data section name");
 					return false;
@@ -945,6 +1141,93 @@ bool elf_binary::parse_elf() {
 			info->function_names.emplace_back(sym.name);
 		}
 		
+		// get the stack usage estimates of all functions (if the binary was compiled with -fstack-size-section):
+		// each .stack_sizes entry consists of the 64-bit function address (-> relocation) followed by the ULEB128-encoded stack size
+		for (const auto& [stack_sizes_section, reloc] : info->stack_size_relocations) {
+			const auto& sec_header = *stack_sizes_section->header_ptr;
+			const auto entry_offset = reloc.reloc_ptr->offset;
+			if (sec_header.type != ELF_SECTION_TYPE::PROGRAM_DATA || entry_offset + 8u >= sec_header.size) {
+				log_error("invalid stack sizes entry");
+				return false;
+			}
+			uint64_t stack_size = 0u;
+			if (decode_uleb128(&binary[sec_header.offset + entry_offset + 8u], sec_header.size - entry_offset - 8u, stack_size) == 0u) {
+				log_error("invalid stack sizes entry");
+				return false;
+			}
+			
+			// the relocation either directly references the function symbol or its section symbol + the function offset as addend
+			const auto target_section_idx = reloc.symbol_ptr->symbol_ptr->section_header_table_index;
+			const auto target_offset = reloc.symbol_ptr->symbol_ptr->value + uint64_t(reloc.reloc_ptr->addend);
+			for (const auto& sym : info->symbols) {
+				if (sym.name.empty() || !(sym.symbol_ptr->binding == ELF_SYMBOL_BINDING::GLOBAL && sym.symbol_ptr->type == ELF_SYMBOL_TYPE::CODE)) {
+					continue;
+				}
+				if (sym.symbol_ptr->section_header_table_index != target_section_idx || sym.symbol_ptr->value != target_offset) {
+					continue;
+				}
+				auto& func_stack_size = info->function_stack_sizes[sym.name];
+				func_stack_size = max(func_stack_size, stack_size);
+			}
+		}
+		
+		// determine which functions (potentially) make use of barriers:
+		// * each exec relocation is attributed to the global function containing the relocated offset (caller),
+		//   which must be defined in the section the relocation applies to (offsets are section-relative),
+		//   if no such function exists (e.g. a non-inlined local helper function), we can't know who calls it
+		//   -> attribute it to an "unknown" caller (empty name)
+		// * relocations referencing a barrier directly mark their caller, all other referenced symbols (i.e. calls or
+		//   address uses of other functions) form the call graph, through which barrier usage is propagated to all callers
+		// * if the "unknown" caller (potentially) uses barriers, all functions are conservatively flagged
+		unordered_map<string, unordered_set<string>> callers_of; // callee -> callers
+		unordered_set<string> barrier_users;
+		vector<string> barrier_worklist;
+		for (const auto& reloc : info->exec_relocations) {
+			const auto reloc_offset = reloc.reloc_ptr->offset;
+			string caller;
+			for (const auto& sym : info->symbols) {
+				if (sym.name.empty() || !(sym.symbol_ptr->binding == ELF_SYMBOL_BINDING::GLOBAL && sym.symbol_ptr->type == ELF_SYMBOL_TYPE::CODE)) {
+					continue;
+				}
+				if (sym.symbol_ptr->section_header_table_index != reloc.target_section_idx) {
+					continue;
+				}
+				if (!has_flag<ELF_SECTION_FLAG::EXECUTABLE>(info->sections[sym.symbol_ptr->section_header_table_index].header_ptr->flags)) {
+					continue;
+				}
+				if (reloc_offset >= sym.symbol_ptr->value && reloc_offset < sym.symbol_ptr->value + sym.symbol_ptr->size) {
+					caller = sym.name;
+					break;
+				}
+			}
+			
+			if (is_barrier_symbol(reloc.symbol_ptr->name)) {
+				if (barrier_users.emplace(caller).second) {
+					barrier_worklist.emplace_back(caller);
+				}
+			} else if (!reloc.symbol_ptr->name.empty() && reloc.symbol_ptr->name != caller) {
+				callers_of[reloc.symbol_ptr->name].emplace(caller);
+			}
+		}
+		while (!barrier_worklist.empty()) {
+			const auto callee = move(barrier_worklist.back());
+			barrier_worklist.pop_back();
+			const auto callers_iter = callers_of.find(callee);
+			if (callers_iter == callers_of.end()) {
+				continue;
+			}
+			for (const auto& caller : callers_iter->second) {
+				if (barrier_users.emplace(caller).second) {
+					barrier_worklist.emplace_back(caller);
+				}
+			}
+		}
+		if (barrier_users.count("") > 0) {
+			info->all_functions_use_barriers = true;
+		} else {
+			info->barrier_function_names = move(barrier_users);
+		}
+		
 		info->parsed_successfully = true;
 	}
 #if !defined(FLOOR_NO_EXCEPTIONS)
@@ -1189,10 +1472,12 @@ bool elf_binary::instantiate(const uint32_t instance_idx) {
 			ext_sym_ptr = &ext_instance.ids.instance_group_size;
 		} else if (sym.name == "floor_work_dim") {
 			ext_sym_ptr = &ext_instance.ids.instance_work_dim;
-		} else if (sym.name == "global_barrier" ||
-				   sym.name == "local_barrier" ||
-				   sym.name == "barrier" ||
-				   sym.name == "image_barrier") {
+		} else if (sym.name == "global_barrier") {
+			// NOTE: this is a grid-wide barrier in cooperative executions
+			ext_sym_ptr = get_external_symbol_ptr("host_compute_device_global_barrier");
+		} else if (sym.name == "floor_host_sub_group_exchange") {
+			ext_sym_ptr = get_external_symbol_ptr("host_compute_device_sub_group_exchange");
+		} else if (is_barrier_symbol(sym.name)) {
 			ext_sym_ptr = get_external_symbol_ptr("host_compute_device_barrier");
 		} else if (sym.name == "_GLOBAL_OFFSET_TABLE_") {
 			if (instance.GOT.empty()) {
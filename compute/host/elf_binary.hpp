@@ -41,6 +41,20 @@ public:
 	//! returns all function names inside this binary
 	const vector<string>& get_function_names() const;
 	
+	//! returns true if the specified function (potentially) makes use of barriers
+	//! NOTE: this is conservative, i.e. this may return true for functions that don't actually use barriers
+	bool uses_barrier(const string& func_name) const;
+	
+	//! returns the stack usage estimate of the specified function in bytes, 0 if unknown
+	//! NOTE: this only includes the stack frame of the function itself, not the stack usage of any called (non-inlined) functions
+	uint64_t get_stack_size(const string& func_name) const;
+	
+	//! returns the stack usage estimate of the function at "func_ptr" in bytes, which must be part of an executable or shared
+	//! object that is loaded into this process, 0 if unknown
+	//! NOTE: this is only known if the module was compiled with -fstack-size-section (ELF platforms only),
+	//!       as with get_stack_size(), this doesn't include the stack usage of any called (non-inlined) functions
+	static uint64_t get_loaded_stack_size(const void* func_ptr);
+	
 	//! per execution instance IDs and sizes
 	struct instance_ids_t {
 		uint3 instance_global_idx;
@@ -66,6 +80,15 @@ public:
 				   const uint3& group_size,
 				   const uint32_t& work_dim);
 		
+		//! returns the r/w / BSS memory (aka local memory) of this instance
+		uint8_t* get_rw_memory() const {
+			return rw_memory;
+		}
+		//! returns the size of the r/w / BSS memory in bytes
+		size_t get_rw_memory_size() const {
+			return rw_memory_size;
+		}
+		
 	protected:
 		friend elf_binary;
 		//! pointer to the allocated r/w / BSS memory for this instance
@@ -24,6 +24,8 @@
 #include <floor/compute/host/host_queue.hpp>
 #include <floor/compute/host/host_device.hpp>
 #include <floor/compute/host/host_compute.hpp>
+#include <floor/compute/host/host_memory.hpp>
+#include <floor/core/trace.hpp>
 
 #if !defined(FLOOR_NO_METAL)
 #include <floor/floor/floor.hpp>
@@ -53,11 +55,52 @@ compute_buffer(cqueue, size_, host_ptr_, flags_, opengl_type_, external_gl_objec
 	}
 }
 
+host_buffer::host_buffer(const compute_queue& cqueue,
+						 host_memory&& memory,
+						 const size_t& size_,
+						 const COMPUTE_MEMORY_FLAG flags_) :
+compute_buffer(cqueue, size_, nullptr, flags_, 0, 0, nullptr), buffer_memory(move(memory)) {
+	if (has_flag<COMPUTE_MEMORY_FLAG::OPENGL_SHARING>(flags) ||
+		has_flag<COMPUTE_MEMORY_FLAG::METAL_SHARING>(flags)) {
+		log_error("OpenGL/Metal sharing is not supported for buffers that use already allocated host memory");
+		buffer_memory.release();
+		return;
+	}
+	if (!buffer_memory || buffer_memory.allocation_size() < size) {
+		log_error("invalid host memory for a buffer of size %u", size);
+		buffer_memory.release();
+		return;
+	}
+	buffer = buffer_memory.get();
+}
+
 bool host_buffer::create_internal(const bool copy_host_data, const compute_queue& cqueue) {
-	// TODO: handle the remaining flags + host ptr
+	// -> use host memory: directly use the specified host pointer (zero-copy)
+	// NOTE: USE_HOST_MEMORY has already been cleared if OpenGL/Metal sharing is used
+	aliases_host_memory = false;
+	if (has_flag<COMPUTE_MEMORY_FLAG::USE_HOST_MEMORY>(flags)) {
+		if (host_ptr == nullptr) {
+			log_error("USE_HOST_MEMORY specified, but no host pointer was specified");
+			return false;
+		}
+		if ((uintptr_t(host_ptr) % host_memory_alignment) == 0u) {
+			buffer_memory.release();
+			buffer = (uint8_t*)host_ptr;
+			aliases_host_memory = true;
+			return true;
+		}
+		log_warn("host pointer %X is not aligned to %u bytes, USE_HOST_MEMORY buffer will use a copy of the host memory",
+				 host_ptr, host_memory_alignment);
+	}
 	
-	// always allocate host memory (even with OpenGL/Metal, memory needs to be copied somewhere)
-	buffer = new uint8_t[size] alignas(1024);
+	// allocate host memory (even with OpenGL/Metal, memory needs to be copied somewhere)
+	// NOTE: this also places the memory on the NUMA node(s) of the CPUs that execute kernels on this queue
+	buffer_memory = host_memory::allocate(size, cqueue);
+	if (!buffer_memory) {
+		log_error("failed to allocate host buffer memory");
+		return false;
+	}
+	buffer = buffer_memory.get();
 
 	// -> normal host buffer
 	if (!has_flag<COMPUTE_MEMORY_FLAG::OPENGL_SHARING>(flags) &&
@@ -66,7 +109,7 @@ bool host_buffer::create_internal(const bool copy_host_data, const compute_queue
 		if (copy_host_data &&
 			host_ptr != nullptr &&
 			!has_flag<COMPUTE_MEMORY_FLAG::NO_INITIAL_COPY>(flags)) {
-			memcpy(buffer, host_ptr, size);
+			host_memory::copy(&cqueue, buffer, host_ptr, size);
 		}
 	}
 #if !defined(FLOOR_NO_METAL)
@@ -95,6 +138,9 @@ bool host_buffer::create_internal(const bool copy_host_data, const compute_queue
 }
 
 host_buffer::~host_buffer() {
+	// copies/fills that are still pending in a queue may access this buffer
+	wait_for_pending_async_ops();
+	
 	// first, release and kill the opengl buffer
 	if(gl_object != 0) {
 		if(gl_object_state) {
@@ -103,42 +149,69 @@ host_buffer::~host_buffer() {
 		if(!gl_object_state) release_opengl_object(nullptr); // -> release to opengl
 		delete_gl_buffer();
 	}
-	// then, also kill the host buffer
-	if(buffer != nullptr) {
-		delete [] buffer;
-		buffer = nullptr;
-	}
+	// then, also kill the host buffer (writing back any modifications if this is a write-back file mapping)
+	buffer_memory.sync();
+	buffer_memory.release();
+	buffer = nullptr;
 }
 
 void host_buffer::read(const compute_queue& cqueue, const size_t size_, const size_t offset) {
 	read(cqueue, host_ptr, size_, offset);
 }
 
-void host_buffer::read(const compute_queue& cqueue floor_unused, void* dst, const size_t size_, const size_t offset) {
+void host_buffer::read(const compute_queue& cqueue, void* dst, const size_t size_, const size_t offset) {
 	if(buffer == nullptr) return;
 
 	const size_t read_size = (size_ == 0 ? size : size_);
 	if(!read_check(size, read_size, offset, flags)) return;
 
+	// reads into host memory are blocking -> wait until all prior work has completed
+	cqueue.finish();
+	
+	// nothing to copy when reading back into the aliased host memory itself
+	if (aliases_host_memory && dst == buffer + offset) {
+		return;
+	}
+	
+	FLOOR_TRACE_SCOPE("memory", "host_buffer::read");
 	GUARD(lock);
-	memcpy(dst, buffer + offset, read_size);
+	if (!aliases_host_memory) {
+		host_memory::copy(&cqueue, dst, buffer + offset, read_size);
+	} else {
+		// NOTE: source and destination may overlap when reading into the host pointer with an offset
+		memmove(dst, buffer + offset, read_size);
+	}
 }
 
 void host_buffer::write(const compute_queue& cqueue, const size_t size_, const size_t offset) {
 	write(cqueue, host_ptr, size_, offset);
 }
 
-void host_buffer::write(const compute_queue& cqueue floor_unused, const void* src, const size_t size_, const size_t offset) {
+void host_buffer::write(const compute_queue& cqueue, const void* src, const size_t size_, const size_t offset) {
 	if(buffer == nullptr) return;
 
 	const size_t write_size = (size_ == 0 ? size : size_);
 	if(!write_check(size, write_size, offset, flags)) return;
 	
+	// writes from host memory are blocking -> wait until all prior work (that may still use this buffer) has completed
+	cqueue.finish();
+	
+	// nothing to copy when writing from the aliased host memory itself
+	if (aliases_host_memory && src == buffer + offset) {
+		return;
+	}
+	
+	FLOOR_TRACE_SCOPE("memory", "host_buffer::write");
 	GUARD(lock);
-	memcpy(buffer + offset, src, write_size);
+	if (!aliases_host_memory) {
+		host_memory::copy(&cqueue, buffer + offset, src, write_size);
+	} else {
+		// NOTE: source and destination may overlap when writing from the host pointer with an offset
+		memmove(buffer + offset, src, write_size);
+	}
 }
 
-void host_buffer::copy(const compute_queue& cqueue floor_unused, const compute_buffer& src,
+void host_buffer::copy(const compute_queue& cqueue, const compute_buffer& src,
 					   const size_t size_, const size_t src_offset, const size_t dst_offset) {
 	if(buffer == nullptr) return;
 
@@ -147,64 +220,84 @@ void host_buffer::copy(const compute_queue& cqueue floor_unused, const compute_b
 	const size_t copy_size = (size_ == 0 ? std::min(src_size, size) : size_);
 	if(!copy_check(size, src_size, copy_size, dst_offset, src_offset)) return;
 	
-	src._lock();
-	_lock();
-	
-	memcpy(buffer + dst_offset, ((const host_buffer*)&src)->get_host_buffer_ptr() + src_offset, copy_size);
-	
-	_unlock();
-	src._unlock();
+	// NOTE: the queue executes this itself (-> outlives it), both buffers are kept alive by their pending op counts
+	const auto cqueue_ptr = &cqueue;
+	const auto src_buffer = (const host_buffer*)&src;
+	begin_async_op();
+	src_buffer->begin_async_op();
+	((const host_queue&)cqueue).enqueue([this, cqueue_ptr, src_buffer, copy_size, src_offset, dst_offset]() {
+		{
+			FLOOR_TRACE_SCOPE("memory", "host_buffer::copy");
+			src_buffer->_lock();
+			_lock();
+			
+			host_memory::copy(cqueue_ptr, buffer + dst_offset, src_buffer->get_host_buffer_ptr() + src_offset, copy_size);
+			
+			_unlock();
+			src_buffer->_unlock();
+		}
+		src_buffer->end_async_op();
+		end_async_op();
+	});
 }
 
-bool host_buffer::fill(const compute_queue& cqueue floor_unused,
-					   const void* pattern, const size_t& pattern_size,
+bool host_buffer::fill(const compute_queue& cqueue,
+					   const void* pattern_, const size_t& pattern_size,
 					   const size_t size_, const size_t offset) {
 	if(buffer == nullptr) return false;
 
 	const size_t fill_size = (size_ == 0 ? size : size_);
 	if(!fill_check(size, fill_size, pattern_size, offset)) return false;
 	
-	switch(pattern_size) {
-		case 1:
-			memset(buffer + offset, *(const uint8_t*)pattern, fill_size);
-			break;
-#if defined(__APPLE__) // TODO: check for availability on linux, *bsd, windows
-		// NOTE: memset_pattern* will simple truncate any overspill, so size checking is not necessary
-		// NOTE: 3rd parameter is the fill/buffer size and has nothing to do with the pattern count
-		case 4:
-			memset_pattern4(buffer + offset, (const void*)pattern, fill_size);
-			break;
-		case 8:
-			memset_pattern8(buffer + offset, (const void*)pattern, fill_size);
-			break;
-		case 16:
-			memset_pattern16(buffer + offset, (const void*)pattern, fill_size);
-			break;
-#endif
-		default: {
-			// not a pattern size that allows a fast memset
-			// -> copy pattern manually in a loop
-			const size_t pattern_count = fill_size / pattern_size;
-			uint8_t* write_ptr = buffer + offset;
-			for(size_t i = 0; i < pattern_count; ++i) {
-				memcpy(write_ptr, pattern, pattern_size);
-				write_ptr += pattern_size;
-			}
-			break;
+	// fill is executed asynchronously -> need to copy the pattern
+	vector<uint8_t> pattern_data((const uint8_t*)pattern_, (const uint8_t*)pattern_ + pattern_size);
+	const auto cqueue_ptr = &cqueue;
+	begin_async_op();
+	((const host_queue&)cqueue).enqueue([this, cqueue_ptr, pattern_data = move(pattern_data), pattern_size, fill_size, offset]() {
+		{
+			FLOOR_TRACE_SCOPE("memory", "host_buffer::fill");
+			GUARD(lock);
+			host_memory::fill(cqueue_ptr, buffer + offset, pattern_data.data(), pattern_size, fill_size);
 		}
-	}
-	
+		end_async_op();
+	});
 	return true;
 }
 
-bool host_buffer::zero(const compute_queue& cqueue floor_unused) {
+bool host_buffer::zero(const compute_queue& cqueue) {
 	if(buffer == nullptr) return false;
 
-	GUARD(lock);
-	memset(buffer, 0, size);
+	const auto cqueue_ptr = &cqueue;
+	begin_async_op();
+	((const host_queue&)cqueue).enqueue([this, cqueue_ptr]() {
+		{
+			FLOOR_TRACE_SCOPE("memory", "host_buffer::zero");
+			GUARD(lock);
+			host_memory::zero(cqueue_ptr, buffer, size);
+		}
+		end_async_op();
+	});
 	return true;
 }
 
+void host_buffer::begin_async_op() const {
+	GUARD(pending_async_ops_lock);
+	++pending_async_ops;
+}
+
+void host_buffer::end_async_op() const {
+	// NOTE: must notify while holding the lock: a waiter may destroy this buffer as soon as it observes 0
+	GUARD(pending_async_ops_lock);
+	if (--pending_async_ops == 0u) {
+		pending_async_ops_cv.notify_all();
+	}
+}
+
+void host_buffer::wait_for_pending_async_ops() const {
+	unique_lock<mutex> ops_lock(pending_async_ops_lock);
+	pending_async_ops_cv.wait(ops_lock, [this] { return (pending_async_ops == 0u); });
+}
+
 bool host_buffer::resize(const compute_queue& cqueue, const size_t& new_size_,
 						 const bool copy_old_data, const bool copy_host_data,
 						 void* new_host_ptr) {
@@ -224,11 +317,19 @@ bool host_buffer::resize(const compute_queue& cqueue, const size_t& new_size_,
 				  min_multiple(), new_size, new_size_);
 	}
 	
+	// pending work (on this or any other queue) may still use the old buffer
+	cqueue.finish();
+	wait_for_pending_async_ops();
+	
 	// store old buffer, size and host pointer for possible restore + cleanup later on
+	auto old_memory = move(buffer_memory);
 	const auto old_buffer = buffer;
 	const auto old_size = size;
 	const auto old_host_ptr = host_ptr;
-	const auto restore_old_buffer = [this, &old_buffer, &old_size, &old_host_ptr] {
+	const auto old_aliases_host_memory = aliases_host_memory;
+	const auto restore_old_buffer = [this, &old_memory, &old_buffer, &old_size, &old_host_ptr, &old_aliases_host_memory] {
+		buffer_memory = move(old_memory);
+		aliases_host_memory = old_aliases_host_memory;
 		buffer = old_buffer;
 		size = old_size;
 		host_ptr = old_host_ptr;
@@ -252,17 +353,18 @@ bool host_buffer::resize(const compute_queue& cqueue, const size_t& new_size_,
 	// copy old data if specified
 	if(copy_old_data) {
 		// can only copy as many bytes as there are bytes
-		const size_t copy_size = std::min(size, new_size); // >= 4, established above
-		memcpy(buffer, old_buffer, copy_size);
+		const size_t copy_size = std::min(old_size, new_size); // >= 4, established above
+		if (buffer != old_buffer) {
+			// NOTE: old and new host memory may overlap when both are aliased host memory
+			memmove(buffer, old_buffer, copy_size);
+		}
 	}
-	else if(!copy_old_data && copy_host_data && is_host_buffer && host_ptr != nullptr) {
-		memcpy(buffer, host_ptr, size);
+	else if(!copy_old_data && copy_host_data && is_host_buffer && host_ptr != nullptr && !aliases_host_memory) {
+		host_memory::copy(&cqueue, buffer, host_ptr, size);
 	}
 	
 	// kill the old buffer
-	if(old_buffer != nullptr) {
-		delete [] old_buffer;
-	}
+	old_memory.release();
 	
 	return true;
 }
@@ -283,6 +385,7 @@ void* __attribute__((aligned(128))) host_buffer::map(const compute_queue& cqueue
 	// NOTE: this is returning a raw pointer to the internal buffer memory and specifically not creating+copying a new buffer
 	// -> the user is always responsible for proper sync when mapping a buffer multiple times and this way, it should be
 	// easier to detect any problems (race conditions, etc.)
+	// NOTE: with USE_HOST_MEMORY, this is a pointer into the user specified host memory
 	return buffer + offset;
 }
 
@@ -290,7 +393,8 @@ bool host_buffer::unmap(const compute_queue& cqueue floor_unused, void* __attrib
 	if(buffer == nullptr) return false;
 	if(mapped_ptr == nullptr) return false;
 
-	// nop
+	// nop, unless this is a write-back file mapping -> write modifications back to the file
+	buffer_memory.sync();
 	return true;
 }
 
@@ -24,6 +24,9 @@
 #if !defined(FLOOR_NO_HOST_COMPUTE)
 
 #include <floor/compute/compute_buffer.hpp>
+#include <floor/compute/host/host_memory.hpp>
+#include <mutex>
+#include <condition_variable>
 
 class host_device;
 class host_buffer final : public compute_buffer {
@@ -45,6 +48,14 @@ public:
 				compute_buffer* shared_buffer_ = nullptr) :
 	host_buffer(cqueue, size_, nullptr, flags_, opengl_type_, 0, shared_buffer_) {}
 	
+	//! constructs a buffer of the specified size that uses the already allocated/mapped "memory" (e.g. a mapped file)
+	//! NOTE: OpenGL/Metal sharing is not supported for these buffers
+	host_buffer(const compute_queue& cqueue,
+				host_memory&& memory,
+				const size_t& size_,
+				const COMPUTE_MEMORY_FLAG flags_ = (COMPUTE_MEMORY_FLAG::READ_WRITE |
+													COMPUTE_MEMORY_FLAG::HOST_READ_WRITE));
+	
 	template <typename data_type>
 	host_buffer(const compute_queue& cqueue,
 				const vector<data_type>& data,
@@ -104,9 +115,37 @@ public:
 	uint8_t* __attribute__((aligned(128))) get_host_buffer_ptr() const {
 		return buffer;
 	}
+	
+	//! returns true if this buffer directly uses the memory of the specified host pointer (USE_HOST_MEMORY)
+	bool is_aliasing_host_memory() const {
+		return aliases_host_memory;
+	}
+	
+	//! minimum alignment of a host pointer so that it can be used directly with USE_HOST_MEMORY,
+	//! less aligned host pointers fall back to a private copy
+	static constexpr const size_t host_memory_alignment { 128u };
 
 protected:
 	uint8_t* __attribute__((aligned(1024))) buffer { nullptr };
+	//! backing memory of "buffer" (empty if "aliases_host_memory")
+	host_memory buffer_memory;
+	//! true if "buffer" is the user specified host pointer
+	bool aliases_host_memory { false };
+	
+	//! amount of enqueued asynchronous operations (copy/fill/zero) that still access this buffer
+	//! NOTE: this includes copies that use this buffer as their source
+	mutable uint32_t pending_async_ops { 0u };
+	//! guards "pending_async_ops"
+	mutable mutex pending_async_ops_lock;
+	//! signaled once "pending_async_ops" drops to 0
+	mutable condition_variable pending_async_ops_cv;
+	//! registers an enqueued asynchronous operation that accesses this buffer
+	void begin_async_op() const;
+	//! signals the completion of an asynchronous operation that was registered via begin_async_op()
+	void end_async_op() const;
+	//! blocks until all enqueued asynchronous operations that access this buffer have been executed
+	//! NOTE: called on destruction and resize, so that no operation can access a dead or replaced buffer
+	void wait_for_pending_async_ops() const;
 	
 	//! separate create buffer function, b/c it's called by the constructor and resize
 	bool create_internal(const bool copy_host_data, const compute_queue& cqueue);
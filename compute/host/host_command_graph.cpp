@@ -0,0 +1,70 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <floor/compute/host/host_command_graph.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/compute/host/host_queue.hpp>
+#include <floor/core/logger.hpp>
+
+host_command_graph::host_command_graph(const compute_queue& cqueue_) : compute_command_graph(cqueue_) {
+}
+
+bool host_command_graph::prepare_command(const uint32_t cmd_idx) {
+	const auto& cmd = commands[cmd_idx];
+	auto kernel_args = ((const host_kernel*)cmd.kernel)->create_kernel_args((const host_queue&)cqueue, cmd.is_cooperative, cmd.work_dim,
+																			cmd.global_work_size, cmd.local_work_size, cmd.args);
+	if (!kernel_args) {
+		log_error("failed to prepare command #%u", cmd_idx);
+		return false;
+	}
+	prepared_args[cmd_idx] = move(kernel_args);
+	return true;
+}
+
+bool host_command_graph::finalize_internal() {
+	prepared_args.clear();
+	prepared_args.resize(commands.size());
+	for (uint32_t cmd_idx = 0, cmd_count = uint32_t(commands.size()); cmd_idx < cmd_count; ++cmd_idx) {
+		if (!prepare_command(cmd_idx)) {
+			prepared_args.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool host_command_graph::update_command(const uint32_t cmd_idx) {
+	return prepare_command(cmd_idx);
+}
+
+void host_command_graph::replay_internal() const {
+	if (commands.empty()) {
+		return;
+	}
+	const auto queued_time = (cqueue.is_kernel_event_logging() ? compute_queue::get_kernel_event_time() : 0u);
+	((const host_queue&)cqueue).submit([this, queued_time]() {
+		for (size_t cmd_idx = 0, cmd_count = commands.size(); cmd_idx < cmd_count; ++cmd_idx) {
+			((const host_kernel*)commands[cmd_idx].kernel)->execute_internal(*prepared_args[cmd_idx], queued_time);
+		}
+	});
+}
+
+#endif
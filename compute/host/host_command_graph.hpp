@@ -0,0 +1,52 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_HOST_COMMAND_GRAPH_HPP__
+#define __FLOOR_HOST_COMMAND_GRAPH_HPP__
+
+#include <floor/compute/host/host_common.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/compute/compute_command_graph.hpp>
+#include <floor/compute/host/host_kernel.hpp>
+
+//! host-compute command graph: the kernel args of all commands are prepared once (and on updates),
+//! a replay then submits a single queue command that executes all prepared kernel executions in order
+class host_command_graph final : public compute_command_graph {
+public:
+	explicit host_command_graph(const compute_queue& cqueue);
+	~host_command_graph() override = default;
+	
+protected:
+	//! prepared kernel args of each command
+	vector<host_kernel_args_ptr> prepared_args;
+	
+	bool finalize_internal() override;
+	bool update_command(const uint32_t cmd_idx) override;
+	void replay_internal() const override;
+	
+	//! prepares the kernel args of command #cmd_idx
+	bool prepare_command(const uint32_t cmd_idx);
+	
+};
+
+#endif
+
+#endif
@@ -27,6 +27,8 @@
 #include <floor/core/file_io.hpp>
 #include <floor/compute/device/host_limits.hpp>
 #include <floor/compute/host/elf_binary.hpp>
+#include <floor/compute/host/host_worker_pool.hpp>
+#include <floor/compute/host/host_numa.hpp>
 
 #if defined(__APPLE__)
 #include <floor/darwin/darwin_helper.hpp>
@@ -155,6 +157,15 @@ host_compute::host_compute() : compute_context() {
 	device.max_mem_alloc = device.global_mem_size;
 	device.constant_mem_size = device.global_mem_size; // not different from normal ram
 	
+	// create all worker threads up front (pinned to their respective CPU), these are reused for all kernel executions
+	// NOTE: workers are ordered by NUMA node, so that the workers of each node form a contiguous CPU range
+	const auto& numa_topology = host_numa_topology::get();
+	if (numa_topology.get_worker_cpus().size() == device.units) {
+		device.worker_pool = make_shared<host_worker_pool>(numa_topology.get_worker_cpus());
+	} else {
+		device.worker_pool = make_shared<host_worker_pool>(device.units);
+	}
+	
 	const auto lc_cpu_name = core::str_to_lower(device.name);
 	if(lc_cpu_name.find("intel") != string::npos) {
 		device.vendor = COMPUTE_VENDOR::INTEL;
@@ -180,6 +191,16 @@ host_compute::host_compute() : compute_context() {
 #else // mt-group
 	device.max_total_local_size = host_limits::max_total_local_size;
 	device.max_local_size = { host_limits::max_total_local_size };
+#endif
+#if defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+	// cooperative kernels: all work-groups must be resident at once, with a limited amount of work-groups per CPU
+	// (-> queues restricted to a CPU range are further limited, see host_queue::get_max_cooperative_group_count)
+	device.cooperative_kernel_support = true;
+	device.max_coop_total_local_size = host_limits::max_total_local_size;
+	device.max_coop_group_count = device.units * host_queue::max_cooperative_groups_per_cpu;
+	// sub-groups: consecutive work-items of a work-group, exchanging values through memory
+	device.sub_group_support = true;
+	device.sub_group_shuffle_support = true;
 #endif
 	device.max_image_1d_buffer_dim = { (size_t)std::min(device.max_mem_alloc, uint64_t(0xFFFFFFFFu)) };
 	
@@ -221,9 +242,40 @@ host_compute::host_compute() : compute_context() {
 }
 
 shared_ptr<compute_queue> host_compute::create_queue(const compute_device& dev floor_unused) const {
+	// NOTE: each host_queue owns a scheduler thread -> generic queue requests share the default queue,
+	//       independent queues must be created explicitly via create_queue(dev, cpu_offset, cpu_count)
 	return main_queue;
 }
 
+shared_ptr<compute_queue> host_compute::create_queue(const compute_device& dev, const uint32_t cpu_offset, const uint32_t cpu_count) const {
+	if (cpu_count == 0 || cpu_offset + cpu_count > dev.units) {
+		log_error("invalid cpu range [%u, %u) for device with %u units", cpu_offset, cpu_offset + cpu_count, dev.units);
+		return {};
+	}
+	return make_shared<host_queue>(dev, cpu_offset, cpu_count);
+}
+
+shared_ptr<compute_queue> host_compute::create_numa_node_queue(const compute_device& dev, const uint32_t node_idx) const {
+	const auto& nodes = host_numa_topology::get().get_nodes();
+	if (node_idx >= nodes.size()) {
+		log_error("invalid NUMA node index %u (there are %u nodes)", node_idx, nodes.size());
+		return {};
+	}
+	return create_queue(dev, nodes[node_idx].cpu_offset, nodes[node_idx].cpu_count);
+}
+
+uint32_t host_compute::get_numa_node_count() const {
+	return uint32_t(host_numa_topology::get().get_nodes().size());
+}
+
+void host_compute::set_memory_policy(const host_memory::policy_t& policy) const {
+	host_memory::set_policy(policy);
+}
+
+host_memory::policy_t host_compute::get_memory_policy() const {
+	return host_memory::get_policy();
+}
+
 shared_ptr<compute_buffer> host_compute::create_buffer(const compute_queue& cqueue,
 													   const size_t& size, const COMPUTE_MEMORY_FLAG flags,
 													   const uint32_t opengl_type) const {
@@ -237,6 +289,18 @@ shared_ptr<compute_buffer> host_compute::create_buffer(const compute_queue& cque
 	return make_shared<host_buffer>(cqueue, size, data, flags, opengl_type);
 }
 
+shared_ptr<compute_buffer> host_compute::create_buffer_from_file(const compute_queue& cqueue,
+																 const string& filename,
+																 const COMPUTE_MEMORY_FLAG flags,
+																 const bool write_back) const {
+	size_t file_size = 0;
+	auto file_memory = host_memory::map_file(filename, write_back, file_size);
+	if (!file_memory) {
+		return {};
+	}
+	return make_shared<host_buffer>(cqueue, move(file_memory), compute_memory::align_size(file_size), flags);
+}
+
 shared_ptr<compute_buffer> host_compute::wrap_buffer(const compute_queue& cqueue,
 													 const uint32_t opengl_buffer,
 													 const uint32_t opengl_type,
@@ -445,6 +509,15 @@ host_program::host_program_entry host_compute::create_host_program_internal(cons
 		log_error("failed to load ELF binary");
 		return {};
 	}
+	
+	// flag all functions that (potentially) use barriers, all others can be executed without fibers
+	for (auto& func : ret.functions) {
+		if (bin->uses_barrier(func.name)) {
+			func.flags |= llvm_toolchain::FUNCTION_FLAGS::USES_BARRIER;
+		} else {
+			func.flags &= ~llvm_toolchain::FUNCTION_FLAGS::USES_BARRIER;
+		}
+	}
 	ret.program = move(bin);
 	
 	if (!silence_debug_output) {
@@ -71,6 +71,12 @@ public:
 																				COMPUTE_MEMORY_FLAG::HOST_READ_WRITE),
 											 const uint32_t opengl_type = 0) const override;
 	
+	shared_ptr<compute_buffer> create_buffer_from_file(const compute_queue& cqueue,
+													   const string& filename,
+													   const COMPUTE_MEMORY_FLAG flags = (COMPUTE_MEMORY_FLAG::READ_WRITE |
+																						  COMPUTE_MEMORY_FLAG::HOST_READ_WRITE),
+													   const bool write_back = false) const override;
+	
 	shared_ptr<compute_buffer> wrap_buffer(const compute_queue& cqueue,
 										   const uint32_t opengl_buffer,
 										   const uint32_t opengl_type,
@@ -159,6 +165,25 @@ public:
 	//! returns true if host-compute device support is available
 	bool has_host_device_support() const;
 	
+	//! creates a new queue that only executes kernels on the CPUs [cpu_offset, cpu_offset + cpu_count) of the specified device
+	//! NOTE: kernels on queues with disjoint CPU ranges are executed concurrently
+	//! NOTE: unlike create_queue(dev), which always returns the shared default queue, this creates an independent queue
+	//!       with its own scheduler thread
+	shared_ptr<compute_queue> create_queue(const compute_device& dev, const uint32_t cpu_offset, const uint32_t cpu_count) const;
+	
+	//! returns the amount of NUMA nodes of the host (1 on non-NUMA systems)
+	uint32_t get_numa_node_count() const;
+	
+	//! creates a queue that only executes kernels on the CPUs of the specified NUMA node (in [0, get_numa_node_count()))
+	//! NOTE: buffers and images that are created with this queue are placed on the memory of that node
+	shared_ptr<compute_queue> create_numa_node_queue(const compute_device& dev, const uint32_t node_idx) const;
+	
+	//! sets the allocation policy (huge page backing, pre-faulting) for all subsequently created buffers and images
+	void set_memory_policy(const host_memory::policy_t& policy) const;
+	
+	//! returns the current allocation policy for buffers and images
+	host_memory::policy_t get_memory_policy() const;
+	
 protected:
 	atomic_spin_lock programs_lock;
 	vector<shared_ptr<host_program>> programs GUARDED_BY(programs_lock);
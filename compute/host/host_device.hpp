@@ -27,6 +27,7 @@ FLOOR_PUSH_WARNINGS()
 FLOOR_IGNORE_WARNING(weak-vtables)
 
 class compute_context;
+class host_worker_pool;
 
 class host_device final : public compute_device {
 public:
@@ -41,6 +42,9 @@ public:
 #endif
 	};
 	
+	//! persistent worker threads (one per unit) that are used to execute kernels on this device
+	shared_ptr<host_worker_pool> worker_pool;
+	
 	//! returns true if the specified object is the same object as this
 	bool operator==(const host_device& dev) const {
 		return (this == &dev);
@@ -0,0 +1,141 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <floor/compute/host/host_group_scheduler.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/logger.hpp>
+
+//! chooses the chunk size based on the amount of groups per worker:
+//! aim for ~32 chunks per worker (enough to balance skewed workloads), but always take at least 1 and at most 256 groups
+static uint32_t compute_chunk_size(const uint32_t group_count, const uint32_t worker_count) {
+	static constexpr const uint32_t chunks_per_worker { 32u };
+	static constexpr const uint32_t max_chunk_size { 256u };
+	const auto groups_per_worker = group_count / std::max(worker_count, 1u);
+	return std::clamp(groups_per_worker / chunks_per_worker, 1u, max_chunk_size);
+}
+
+host_group_scheduler::host_group_scheduler(const uint32_t group_count_, const uint32_t worker_count_,
+										   const uint32_t chunk_size_, const bool collect_stats_) :
+group_count(group_count_), worker_count(std::max(worker_count_, 1u)),
+chunk_size(chunk_size_ > 0u ? chunk_size_ : compute_chunk_size(group_count_, worker_count_)),
+collect_stats(collect_stats_), start_time(floor_timer::start()), workers(make_unique<worker_t[]>(worker_count)) {
+	// initial distribution: contiguous, evenly sized ranges (keeps neighbouring groups on the same worker)
+	const auto groups_per_worker = group_count / worker_count;
+	const auto remainder = group_count % worker_count;
+	uint32_t begin = 0;
+	for (uint32_t worker_idx = 0; worker_idx < worker_count; ++worker_idx) {
+		const auto end = begin + groups_per_worker + (worker_idx < remainder ? 1u : 0u);
+		workers[worker_idx].range.store(make_range(begin, end), memory_order_relaxed);
+		begin = end;
+	}
+}
+
+bool host_group_scheduler::next(const uint32_t worker_idx, uint32_t& group_begin, uint32_t& group_end) {
+	auto& range = workers[worker_idx].range;
+	for (;;) {
+		// take a chunk from the front of our own range
+		// NOTE: this only contends with workers that are currently stealing from us
+		auto cur_range = range.load(memory_order_acquire);
+		auto begin = range_begin(cur_range);
+		auto end = range_end(cur_range);
+		while (begin < end) {
+			const auto chunk_end = std::min(end, begin + chunk_size);
+			if (range.compare_exchange_weak(cur_range, make_range(chunk_end, end), memory_order_acq_rel, memory_order_acquire)) {
+				group_begin = begin;
+				group_end = chunk_end;
+				return true;
+			}
+			begin = range_begin(cur_range);
+			end = range_end(cur_range);
+		}
+		
+		// own range is empty -> steal
+		if (!steal(worker_idx)) {
+			return false;
+		}
+	}
+}
+
+bool host_group_scheduler::steal(const uint32_t worker_idx) {
+	// visit all other workers once, starting with the direct neighbour
+	for (uint32_t i = 1; i < worker_count; ++i) {
+		auto& victim_range = workers[(worker_idx + i) % worker_count].range;
+		auto cur_range = victim_range.load(memory_order_acquire);
+		auto begin = range_begin(cur_range);
+		auto end = range_end(cur_range);
+		while (begin < end) {
+			// steal the back half (or the last group)
+			const auto mid = begin + (end - begin) / 2u;
+			if (victim_range.compare_exchange_weak(cur_range, make_range(begin, mid), memory_order_acq_rel, memory_order_acquire)) {
+				// NOTE: our own range is empty at this point and other workers only modify non-empty ranges,
+				//       so this can't conflict with anything
+				auto& worker = workers[worker_idx];
+				worker.range.store(make_range(mid, end), memory_order_release);
+				++worker.steal_count;
+				return true;
+			}
+			begin = range_begin(cur_range);
+			end = range_end(cur_range);
+		}
+	}
+	// nothing left anywhere
+	// NOTE: other workers may still be executing their last chunk or may have just stolen groups, but these will
+	//       always be executed by them -> no groups are lost
+	return false;
+}
+
+vector<host_group_scheduler::worker_stats_t> host_group_scheduler::get_worker_stats() const {
+	vector<worker_stats_t> stats(worker_count);
+	if (!collect_stats) {
+		return stats;
+	}
+	
+	// total execution time is determined by the last finishing worker
+	uint64_t total_time = 0;
+	for (uint32_t worker_idx = 0; worker_idx < worker_count; ++worker_idx) {
+		total_time = std::max(total_time, workers[worker_idx].finish_time);
+	}
+	for (uint32_t worker_idx = 0; worker_idx < worker_count; ++worker_idx) {
+		const auto& worker = workers[worker_idx];
+		stats[worker_idx] = {
+			.busy_time = worker.busy_time,
+			.idle_time = (total_time > worker.busy_time ? total_time - worker.busy_time : 0u),
+			.group_count = worker.executed_group_count,
+			.steal_count = worker.steal_count,
+		};
+	}
+	return stats;
+}
+
+void host_group_scheduler::log_worker_stats(const string& name) const {
+	if (!collect_stats) {
+		return;
+	}
+	const auto stats = get_worker_stats();
+	log_debug("%s: %u groups, chunk size %u", name, group_count, chunk_size);
+	for (uint32_t worker_idx = 0; worker_idx < worker_count; ++worker_idx) {
+		const auto& worker_stats = stats[worker_idx];
+		log_debug("\tworker #%u: busy %fms, idle %fms, %u groups, %u steals", worker_idx,
+				  double(worker_stats.busy_time) / 1000000.0, double(worker_stats.idle_time) / 1000000.0,
+				  worker_stats.group_count, worker_stats.steal_count);
+	}
+}
+
+#endif
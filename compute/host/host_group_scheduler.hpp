@@ -0,0 +1,151 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __FLOOR_HOST_GROUP_SCHEDULER_HPP__
+#define __FLOOR_HOST_GROUP_SCHEDULER_HPP__
+
+#include <floor/compute/host/host_common.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/essentials.hpp>
+#include <floor/core/timer.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+using namespace std;
+
+//! work-stealing scheduler that distributes the work-groups of a single kernel execution onto the executing workers:
+//! each worker initially owns a contiguous range of groups, from which it takes chunks of groups at the front,
+//! once its own range is empty, it steals the back half of the range of another worker (starting with its neighbours)
+//! NOTE: one of these exists per kernel execution
+class host_group_scheduler {
+public:
+	//! per-worker execution statistics
+	struct worker_stats_t {
+		//! time spent executing groups (in ns)
+		uint64_t busy_time { 0u };
+		//! time not spent executing groups, from the start of the execution until all workers have finished (in ns)
+		uint64_t idle_time { 0u };
+		//! amount of executed groups
+		uint32_t group_count { 0u };
+		//! amount of successful steals
+		uint32_t steal_count { 0u };
+	};
+	
+	//! creates a scheduler for "group_count" groups that are executed by "worker_count" workers,
+	//! with "chunk_size" groups being taken at once by a worker (0 = choose adaptively based on the group and worker count)
+	//! NOTE: statistics are only gathered if "collect_stats" is true
+	host_group_scheduler(const uint32_t group_count, const uint32_t worker_count,
+						 const uint32_t chunk_size = 0u, const bool collect_stats = false);
+	
+	host_group_scheduler(const host_group_scheduler&) = delete;
+	host_group_scheduler& operator=(const host_group_scheduler&) = delete;
+	
+	//! executes groups on worker "worker_idx" (in [0, worker_count)) until no more groups are left,
+	//! calling "group_func(group_linear_idx)" for each group, which must return false to abort execution on this worker
+	template <typename F>
+	void run(const uint32_t worker_idx, F&& group_func) {
+		auto& worker = workers[worker_idx];
+		uint32_t group_begin = 0, group_end = 0;
+		if (!collect_stats) {
+			while (next(worker_idx, group_begin, group_end)) {
+				for (uint32_t group_linear_idx = group_begin; group_linear_idx < group_end; ++group_linear_idx) {
+					if (!group_func(group_linear_idx)) {
+						return;
+					}
+				}
+			}
+			return;
+		}
+		
+		for (;;) {
+			if (!next(worker_idx, group_begin, group_end)) {
+				break;
+			}
+			const auto chunk_start = floor_timer::start();
+			bool abort = false;
+			for (uint32_t group_linear_idx = group_begin; group_linear_idx < group_end; ++group_linear_idx) {
+				if (!group_func(group_linear_idx)) {
+					abort = true;
+					break;
+				}
+			}
+			worker.busy_time += floor_timer::stop<chrono::nanoseconds>(chunk_start);
+			worker.executed_group_count += group_end - group_begin;
+			if (abort) {
+				break;
+			}
+		}
+		worker.finish_time = floor_timer::stop<chrono::nanoseconds>(start_time);
+	}
+	
+	//! returns the amount of groups that are taken at once by a worker
+	uint32_t get_chunk_size() const {
+		return chunk_size;
+	}
+	
+	//! returns the statistics of all workers
+	//! NOTE: only valid if statistics are collected and once all workers have finished
+	vector<worker_stats_t> get_worker_stats() const;
+	
+	//! logs the statistics of all workers (if statistics are collected)
+	void log_worker_stats(const string& name) const;
+	
+protected:
+	const uint32_t group_count;
+	const uint32_t worker_count;
+	const uint32_t chunk_size;
+	const bool collect_stats;
+	const decltype(floor_timer::start()) start_time;
+	
+	//! per-worker state, placed on separate cache lines so that taking groups doesn't interfere with other workers
+	struct alignas(128) worker_t {
+		//! the remaining range of groups owned by this worker: [begin (low 32-bit), end (high 32-bit))
+		atomic<uint64_t> range { 0u };
+		//! statistics (only modified by the owning worker)
+		uint64_t busy_time { 0u };
+		uint64_t finish_time { 0u };
+		uint32_t executed_group_count { 0u };
+		uint32_t steal_count { 0u };
+	};
+	unique_ptr<worker_t[]> workers;
+	
+	static constexpr uint64_t make_range(const uint32_t begin, const uint32_t end) {
+		return (uint64_t(end) << 32ull) | uint64_t(begin);
+	}
+	static constexpr uint32_t range_begin(const uint64_t range) {
+		return uint32_t(range & 0xFFFF'FFFFull);
+	}
+	static constexpr uint32_t range_end(const uint64_t range) {
+		return uint32_t(range >> 32ull);
+	}
+	
+	//! retrieves the next chunk of groups [group_begin, group_end) for worker "worker_idx",
+	//! returns false if no groups are left
+	bool next(const uint32_t worker_idx, uint32_t& group_begin, uint32_t& group_end);
+	
+	//! tries to steal groups from other workers for worker "worker_idx", returns false if no groups are left
+	bool steal(const uint32_t worker_idx);
+	
+};
+
+#endif
+
+#endif
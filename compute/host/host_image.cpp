@@ -24,6 +24,10 @@
 #include <floor/compute/host/host_queue.hpp>
 #include <floor/compute/host/host_device.hpp>
 #include <floor/compute/host/host_compute.hpp>
+#include <floor/compute/host/host_memory.hpp>
+#include <floor/compute/device/host_image_tiling.hpp>
+#include <floor/compute/host/host_worker_pool.hpp>
+#include <floor/constexpr/soft_f16.hpp>
 
 #if !defined(FLOOR_NO_METAL)
 #include <floor/floor/floor.hpp>
@@ -62,9 +66,32 @@ compute_image(cqueue, image_dim_, image_type_, host_ptr_, flags_,
 }
 
 bool host_image::create_internal(const bool copy_host_data, const compute_queue& cqueue) {
-	image = new uint8_t[image_data_size_mip_maps + protection_size] alignas(1024);
+	// NOTE: this also places the memory on the NUMA node(s) of the CPUs that execute kernels on this queue
+	image_memory = host_memory::allocate(image_data_size_mip_maps + protection_size, cqueue);
+	if (!image_memory) {
+		log_error("failed to allocate host image memory");
+		return false;
+	}
+	image = image_memory.get();
+	
+	// check if the tiled layout can be used
+	is_tiled = false;
+	if (has_flag<COMPUTE_MEMORY_FLAG::HOST_TILED_LAYOUT>(flags)) {
+		if (image_dim_count(image_type) < 2 ||
+			has_flag<COMPUTE_IMAGE_TYPE::FLAG_BUFFER>(image_type) ||
+			has_flag<COMPUTE_IMAGE_TYPE::FLAG_MSAA>(image_type) ||
+			image_compressed(image_type) ||
+			(image_bits_per_pixel(image_type) % 8u) != 0u ||
+			has_flag<COMPUTE_MEMORY_FLAG::OPENGL_SHARING>(flags) ||
+			has_flag<COMPUTE_MEMORY_FLAG::METAL_SHARING>(flags)) {
+			log_warn("tiled layout is not supported for this image, using the linear layout instead");
+		} else {
+			is_tiled = true;
+		}
+	}
+	
 	program_info.buffer = image;
-	program_info.runtime_image_type = image_type;
+	program_info.runtime_image_type = image_type | (is_tiled ? COMPUTE_IMAGE_TYPE::__HOST_TILED : COMPUTE_IMAGE_TYPE::NONE);
 	
 	const auto dim_count = image_dim_count(image_type);
 	uint4 mip_image_dim {
@@ -107,10 +134,13 @@ bool host_image::create_internal(const bool copy_host_data, const compute_queue&
 		if(copy_host_data &&
 		   host_ptr != nullptr &&
 		   !has_flag<COMPUTE_MEMORY_FLAG::NO_INITIAL_COPY>(flags)) {
-			memcpy(image, host_ptr,
-				   // if mip-maps have to be created on the libfloor side (i.e. not provided by the user),
-				   // only copy the data that is actually provided by the user
-				   generate_mip_maps ? image_data_size : image_data_size_mip_maps);
+			// if mip-maps have to be created on the libfloor side (i.e. not provided by the user),
+			// only copy the data that is actually provided by the user
+			if (!is_tiled) {
+				host_memory::copy(&cqueue, image, host_ptr, generate_mip_maps ? image_data_size : image_data_size_mip_maps);
+			} else {
+				convert_tiled_layout(image, (const uint8_t*)host_ptr, true, generate_mip_maps ? 1u : mip_level_count);
+			}
 			
 			// manually create mip-map chain
 			if(generate_mip_maps) {
@@ -157,16 +187,15 @@ host_image::~host_image() {
 #endif
 	}
 	// then, also kill the host image
-	if(image != nullptr) {
-		delete [] image;
-	}
+	image_memory.release();
+	image = nullptr;
 }
 
 bool host_image::zero(const compute_queue& cqueue) {
 	if(image == nullptr) return false;
 	
 	cqueue.finish();
-	memset(image, 0, image_data_size_mip_maps);
+	host_memory::zero(&cqueue, image, image_data_size_mip_maps);
 	return true;
 }
 
@@ -175,6 +204,27 @@ void* __attribute__((aligned(128))) host_image::map(const compute_queue& cqueue,
 	if(image == nullptr) return nullptr;
 	
 	const bool blocking_map = has_flag<COMPUTE_MEMORY_MAP_FLAG::BLOCK>(flags_);
+	if (is_tiled) {
+		// kernels use the tiled layout -> map a linear copy of the image data
+		// NOTE: this always blocks when reading, since the current image data is needed for the conversion
+		auto linear_memory = host_memory::allocate(image_data_size_mip_maps, cqueue);
+		if (!linear_memory) {
+			log_error("failed to allocate memory for mapping a tiled image");
+			return nullptr;
+		}
+		if (!has_flag<COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE>(flags_)) {
+			cqueue.finish();
+			convert_tiled_layout(linear_memory.get(), image, false, mip_level_count);
+		} else if (blocking_map) {
+			cqueue.finish();
+		}
+		
+		auto mapped_ptr = linear_memory.get();
+		GUARD(lock);
+		tiled_mappings.emplace(mapped_ptr, make_pair(move(linear_memory), flags_));
+		return mapped_ptr;
+	}
+	
 	if(blocking_map) {
 		cqueue.finish();
 	}
@@ -185,6 +235,27 @@ bool host_image::unmap(const compute_queue& cqueue, void* __attribute__((aligned
 	if(image == nullptr) return false;
 	if(mapped_ptr == nullptr) return false;
 	
+	// tiled layout: write back the linear copy (if it was mapped for writing)
+	if (is_tiled) {
+		host_memory linear_memory;
+		COMPUTE_MEMORY_MAP_FLAG map_flags { COMPUTE_MEMORY_MAP_FLAG::NONE };
+		{
+			GUARD(lock);
+			const auto iter = tiled_mappings.find(mapped_ptr);
+			if (iter == tiled_mappings.end()) {
+				log_error("invalid mapped pointer: %X", mapped_ptr);
+				return false;
+			}
+			linear_memory = move(iter->second.first);
+			map_flags = iter->second.second;
+			tiled_mappings.erase(iter);
+		}
+		if (has_flag<COMPUTE_MEMORY_MAP_FLAG::WRITE>(map_flags) ||
+			has_flag<COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE>(map_flags)) {
+			convert_tiled_layout(image, linear_memory.get(), true, mip_level_count);
+		}
+	}
+	
 	// manually create mip-map chain
 	if(generate_mip_maps) {
 		generate_mip_map_chain(cqueue);
@@ -193,6 +264,252 @@ bool host_image::unmap(const compute_queue& cqueue, void* __attribute__((aligned
 	return true;
 }
 
+void host_image::convert_tiled_layout(uint8_t* dst, const uint8_t* src, const bool to_tiled, const uint32_t level_count) const {
+	const auto bytes_per_pixel = size_t(image_bytes_per_pixel(image_type));
+	const auto is_3d = (image_dim_count(image_type) == 3);
+	for (uint32_t level = 0; level < level_count; ++level) {
+		const auto& level_info = program_info.level_info[level];
+		const auto width = level_info.dim.x;
+		const auto height = level_info.dim.y;
+		const auto depth = (is_3d ? level_info.dim.z : 1u);
+		if (width == 0 || height == 0 || depth == 0) {
+			continue;
+		}
+		
+		// 3D images have no layers, for everything else: each layer/face is tiled individually
+		const auto slice_count = (is_3d ? 1u : layer_count);
+		const auto slice_size = size_t(width) * size_t(height) * size_t(depth) * bytes_per_pixel;
+		for (uint32_t slice = 0; slice < slice_count; ++slice) {
+			const auto slice_offset = level_info.offset + slice * slice_size;
+			auto dst_slice = dst + slice_offset;
+			auto src_slice = src + slice_offset;
+			
+			// each tile row (of a single texel row) is contiguous in both layouts
+			for (uint32_t z = 0; z < depth; ++z) {
+				for (uint32_t y = 0; y < height; ++y) {
+					for (uint32_t x = 0; x < width; x += host_image_tiling::tile_size) {
+						const auto run_size = size_t(std::min(host_image_tiling::tile_size, width - x)) * bytes_per_pixel;
+						const auto linear_offset = ((size_t(z) * size_t(height) + size_t(y)) * size_t(width) + size_t(x)) * bytes_per_pixel;
+						const auto tiled_offset = size_t(is_3d ?
+														 host_image_tiling::texel_index(width, height, depth, x, y, z) :
+														 host_image_tiling::texel_index(width, height, x, y)) * bytes_per_pixel;
+						if (to_tiled) {
+							memcpy(dst_slice + tiled_offset, src_slice + linear_offset, run_size);
+						} else {
+							memcpy(dst_slice + linear_offset, src_slice + tiled_offset, run_size);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+//! min amount of texels in a mip-level before its minification is split across the worker threads
+static constexpr const size_t minify_parallel_threshold { 64u * 1024u };
+
+//! source/destination info of a single mip-level minification
+struct minify_level_info {
+	uint8_t* dst;
+	const uint8_t* src;
+	//! level dims, with unused dims set to 1
+	uint3 dst_dim;
+	uint3 src_dim;
+	//! size of a single slice (layer/face) of the level in bytes
+	size_t dst_slice_size;
+	size_t src_slice_size;
+	bool is_tiled;
+};
+
+//! type used to sum up channels of type "channel_type"
+template <typename channel_type>
+using minify_sum_type = conditional_t<(is_same_v<channel_type, soft_f16> || is_floating_point_v<channel_type>), float,
+									  conditional_t<(sizeof(channel_type) < 4u),
+													conditional_t<is_signed_v<channel_type>, int32_t, uint32_t>,
+													conditional_t<is_signed_v<channel_type>, int64_t, uint64_t>>>;
+
+//! returns the average of 2^shift summed up channel values (integer: rounded to nearest)
+template <typename channel_type, uint32_t shift, typename sum_type>
+floor_inline_always static channel_type minify_average(const sum_type& sum) {
+	if constexpr (is_same_v<sum_type, float>) {
+		return channel_type(sum * (1.0f / float(1u << shift)));
+	} else {
+		return channel_type((sum + sum_type(1u << (shift - 1u))) >> sum_type(shift));
+	}
+}
+
+//! returns the texel index of (x, y, z) in a linear or tiled slice of size "dim"
+template <uint32_t dim_count>
+floor_inline_always static size_t minify_texel_index(const uint3& dim, const uint32_t x, const uint32_t y, const uint32_t z,
+													 const bool is_tiled) {
+	if (dim_count >= 2u && is_tiled) {
+		return size_t(dim_count == 3u ?
+					  host_image_tiling::texel_index(dim.x, dim.y, dim.z, x, y, z) :
+					  host_image_tiling::texel_index(dim.x, dim.y, x, y));
+	}
+	return (size_t(z) * size_t(dim.y) + size_t(y)) * size_t(dim.x) + size_t(x);
+}
+
+//! minifies the rows [row_begin, row_end) of a mip-level (rows of all slices are counted consecutively),
+//! with each texel being the average of the 2/4/8 (1D/2D/3D) texels of the previous level it covers
+//! NOTE: this is equivalent to the minification kernel, which linearly samples exactly in between these texels
+template <typename channel_type, uint32_t dim_count, uint32_t channel_count>
+static void minify_rows(const minify_level_info& info, const size_t row_begin, const size_t row_end) {
+	typedef minify_sum_type<channel_type> sum_type;
+	// 1/2/4 source rows per destination row, each contributing two texels
+	static constexpr const uint32_t src_row_count { 1u << (dim_count - 1u) };
+	const auto rows_per_slice = size_t(info.dst_dim.y) * size_t(info.dst_dim.z);
+	for (auto row = row_begin; row < row_end; ++row) {
+		const auto slice = row / rows_per_slice;
+		const auto slice_row = uint32_t(row - slice * rows_per_slice);
+		const auto z = slice_row / info.dst_dim.y;
+		const auto y = slice_row - z * info.dst_dim.y;
+		auto dst = (channel_type*)(info.dst + slice * info.dst_slice_size);
+		const auto src = (const channel_type*)(info.src + slice * info.src_slice_size);
+		
+		if (!info.is_tiled) {
+			// linear layout: all source texels lie in contiguous rows
+			auto dst_row = dst + minify_texel_index<dim_count>(info.dst_dim, 0u, y, z, false) * channel_count;
+			const channel_type* src_rows[src_row_count];
+			for (uint32_t i = 0; i < src_row_count; ++i) {
+				src_rows[i] = src + minify_texel_index<dim_count>(info.src_dim, 0u, y * 2u + (i & 1u), z * 2u + (i >> 1u), false) * channel_count;
+			}
+#pragma clang loop vectorize(enable) interleave(enable)
+			for (uint32_t x = 0; x < info.dst_dim.x; ++x) {
+				for (uint32_t ch = 0; ch < channel_count; ++ch) {
+					sum_type sum = 0;
+					for (uint32_t i = 0; i < src_row_count; ++i) {
+						sum += sum_type(src_rows[i][x * 2u * channel_count + ch]);
+						sum += sum_type(src_rows[i][(x * 2u + 1u) * channel_count + ch]);
+					}
+					dst_row[x * channel_count + ch] = minify_average<channel_type, dim_count>(sum);
+				}
+			}
+		} else {
+			// tiled layout: compute the position of each texel individually
+			for (uint32_t x = 0; x < info.dst_dim.x; ++x) {
+				const channel_type* src_texels[src_row_count * 2u];
+				for (uint32_t i = 0; i < src_row_count * 2u; ++i) {
+					src_texels[i] = src + minify_texel_index<dim_count>(info.src_dim, x * 2u + (i & 1u), y * 2u + ((i >> 1u) & 1u),
+																		z * 2u + (i >> 2u), true) * channel_count;
+				}
+				auto dst_texel = dst + minify_texel_index<dim_count>(info.dst_dim, x, y, z, true) * channel_count;
+				for (uint32_t ch = 0; ch < channel_count; ++ch) {
+					sum_type sum = 0;
+					for (uint32_t i = 0; i < src_row_count * 2u; ++i) {
+						sum += sum_type(src_texels[i][ch]);
+					}
+					dst_texel[ch] = minify_average<channel_type, dim_count>(sum);
+				}
+			}
+		}
+	}
+}
+
+//! returns the row minification function for the specified channel type, dim count and channel count
+template <typename channel_type>
+static auto minify_rows_function(const uint32_t dim_count, const uint32_t channel_count) {
+	typedef void (*minify_rows_func_type)(const minify_level_info&, const size_t, const size_t);
+	static constexpr const minify_rows_func_type funcs[3][4] {
+		{ &minify_rows<channel_type, 1, 1>, &minify_rows<channel_type, 1, 2>, &minify_rows<channel_type, 1, 3>, &minify_rows<channel_type, 1, 4> },
+		{ &minify_rows<channel_type, 2, 1>, &minify_rows<channel_type, 2, 2>, &minify_rows<channel_type, 2, 3>, &minify_rows<channel_type, 2, 4> },
+		{ &minify_rows<channel_type, 3, 1>, &minify_rows<channel_type, 3, 2>, &minify_rows<channel_type, 3, 3>, &minify_rows<channel_type, 3, 4> },
+	};
+	return funcs[dim_count - 1u][channel_count - 1u];
+}
+
+void host_image::generate_mip_map_chain(const compute_queue& cqueue) {
+	// only uniform 8/16/32-bit channel formats are handled natively, everything else uses the minification kernels
+	const auto dim_count = image_dim_count(image_type);
+	const auto channel_count = image_channel_count(image_type);
+	const auto format = (image_type & COMPUTE_IMAGE_TYPE::__FORMAT_MASK);
+	const auto data_type = (image_type & COMPUTE_IMAGE_TYPE::__DATA_TYPE_MASK);
+	void (*minify_func)(const minify_level_info&, const size_t, const size_t) = nullptr;
+	if (dim_count >= 1u && dim_count <= 3u && channel_count >= 1u && channel_count <= 4u &&
+		!has_flag<COMPUTE_IMAGE_TYPE::FLAG_CUBE>(image_type) &&
+		!has_flag<COMPUTE_IMAGE_TYPE::FLAG_MSAA>(image_type) &&
+		!has_flag<COMPUTE_IMAGE_TYPE::FLAG_BUFFER>(image_type) &&
+		!has_flag<COMPUTE_IMAGE_TYPE::FLAG_STENCIL>(image_type) &&
+		!image_compressed(image_type)) {
+		switch (format) {
+			case COMPUTE_IMAGE_TYPE::FORMAT_8:
+				if (data_type == COMPUTE_IMAGE_TYPE::UINT) minify_func = minify_rows_function<uint8_t>(dim_count, channel_count);
+				else if (data_type == COMPUTE_IMAGE_TYPE::INT) minify_func = minify_rows_function<int8_t>(dim_count, channel_count);
+				break;
+			case COMPUTE_IMAGE_TYPE::FORMAT_16:
+				if (data_type == COMPUTE_IMAGE_TYPE::UINT) minify_func = minify_rows_function<uint16_t>(dim_count, channel_count);
+				else if (data_type == COMPUTE_IMAGE_TYPE::INT) minify_func = minify_rows_function<int16_t>(dim_count, channel_count);
+				else if (data_type == COMPUTE_IMAGE_TYPE::FLOAT) minify_func = minify_rows_function<soft_f16>(dim_count, channel_count);
+				break;
+			case COMPUTE_IMAGE_TYPE::FORMAT_32:
+				if (data_type == COMPUTE_IMAGE_TYPE::UINT) minify_func = minify_rows_function<uint32_t>(dim_count, channel_count);
+				else if (data_type == COMPUTE_IMAGE_TYPE::INT) minify_func = minify_rows_function<int32_t>(dim_count, channel_count);
+				else if (data_type == COMPUTE_IMAGE_TYPE::FLOAT) minify_func = minify_rows_function<float>(dim_count, channel_count);
+				break;
+			default: break;
+		}
+	}
+	if (minify_func == nullptr) {
+		compute_image::generate_mip_map_chain(cqueue);
+		return;
+	}
+	
+	// level 0 may still be written by previously enqueued kernels
+	cqueue.finish();
+	
+	const auto& hst_queue = (const host_queue&)cqueue;
+	const auto& worker_pool = ((const host_device&)cqueue.get_device()).worker_pool;
+	const auto bytes_per_pixel = size_t(image_bytes_per_pixel(image_type));
+	const auto slice_count = (dim_count == 3u ? 1u : layer_count);
+	const auto level_dim = [dim_count](const uint4& dim) {
+		return uint3 {
+			dim.x,
+			dim_count >= 2u ? dim.y : 1u,
+			dim_count >= 3u ? dim.z : 1u,
+		};
+	};
+	for (uint32_t level = 1; level < mip_level_count; ++level) {
+		const auto& src_level_info = program_info.level_info[level - 1u];
+		const auto& dst_level_info = program_info.level_info[level];
+		const auto dst_dim = level_dim(dst_level_info.dim);
+		const auto src_dim = level_dim(src_level_info.dim);
+		// NOTE: same as the minification kernels, levels that have become empty in any dimension are skipped
+		if (dst_dim.x == 0u || dst_dim.y == 0u || dst_dim.z == 0u) {
+			continue;
+		}
+		
+		const minify_level_info info {
+			.dst = image + dst_level_info.offset,
+			.src = image + src_level_info.offset,
+			.dst_dim = dst_dim,
+			.src_dim = src_dim,
+			.dst_slice_size = size_t(dst_dim.x) * size_t(dst_dim.y) * size_t(dst_dim.z) * bytes_per_pixel,
+			.src_slice_size = size_t(src_dim.x) * size_t(src_dim.y) * size_t(src_dim.z) * bytes_per_pixel,
+			.is_tiled = is_tiled,
+		};
+		
+		// split rows (of all layers) across the worker threads if there is enough work
+		const auto row_count = size_t(dst_dim.y) * size_t(dst_dim.z) * size_t(slice_count);
+		const auto texel_count = row_count * size_t(dst_dim.x);
+		const auto cpu_count = hst_queue.get_cpu_count();
+		if (!worker_pool || cpu_count <= 1u || row_count <= 1u || texel_count < minify_parallel_threshold) {
+			minify_func(info, 0u, row_count);
+			continue;
+		}
+		const auto cpu_offset = hst_queue.get_cpu_offset();
+		const auto worker_count = uint32_t(std::min(size_t(cpu_count), row_count));
+		const auto rows_per_worker = (row_count + worker_count - 1u) / worker_count;
+		const host_worker_pool::job_type job = [&info, minify_func, row_count, cpu_offset, rows_per_worker](const uint32_t cpu_idx) {
+			const auto row_begin = std::min(size_t(cpu_idx - cpu_offset) * rows_per_worker, row_count);
+			const auto row_end = std::min(row_begin + rows_per_worker, row_count);
+			if (row_begin < row_end) {
+				minify_func(info, row_begin, row_end);
+			}
+		};
+		worker_pool->execute(cpu_offset, worker_count, job);
+	}
+}
+
 bool host_image::acquire_opengl_object(const compute_queue* cqueue floor_unused) {
 #if !defined(FLOOR_IOS)
 	if(gl_object == 0) return false;
@@ -310,7 +627,7 @@ bool host_image::acquire_metal_image(const compute_queue& cqueue, const metal_qu
 	
 	// read/copy Metal image data to host memory
 	auto img_data = shared_image->map(comp_mtl_queue, COMPUTE_MEMORY_MAP_FLAG::READ | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
-	memcpy(image, img_data, image_data_size);
+	host_memory::copy(&cqueue, image, img_data, image_data_size);
 	shared_image->unmap(comp_mtl_queue, img_data);
 	
 	// finish read
@@ -346,7 +663,7 @@ bool host_image::release_metal_image(const compute_queue& cqueue, const metal_qu
 	
 	// write/copy the host data to the Metal image
 	auto img_data = shared_image->map(comp_mtl_queue, COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
-	memcpy(img_data, image, image_data_size);
+	host_memory::copy(&cqueue, img_data, image, image_data_size);
 	shared_image->unmap(comp_mtl_queue, img_data);
 	
 	// finish write
@@ -381,7 +698,7 @@ bool host_image::sync_metal_image(const compute_queue* cqueue_, const metal_queu
 	
 	// write/copy the host data to the Metal image
 	auto img_data = shared_image->map(*comp_mtl_queue, COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
-	memcpy(img_data, image, image_data_size);
+	host_memory::copy(cqueue, img_data, image, image_data_size);
 	shared_image->unmap(*comp_mtl_queue, img_data);
 	
 	// finish write
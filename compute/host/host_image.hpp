@@ -25,6 +25,8 @@
 
 #include <floor/compute/compute_image.hpp>
 #include <floor/compute/device/host_limits.hpp>
+#include <floor/compute/host/host_memory.hpp>
+#include <unordered_map>
 
 class host_device;
 class host_image final : public compute_image {
@@ -66,8 +68,14 @@ public:
 	bool sync_metal_image(const compute_queue* cqueue = nullptr,
 						  const metal_queue* mtl_queue = nullptr) const override;
 	
+	//! creates the mip-map chain for this host image natively (without minification kernels) for all formats with
+	//! uniform 8-bit, 16-bit or 32-bit channels, falls back to the minification kernels for all other formats
+	void generate_mip_map_chain(const compute_queue& cqueue) override;
+	
 protected:
 	uint8_t* __attribute__((aligned(1024))) image { nullptr };
+	//! backing memory of "image"
+	host_memory image_memory;
 	
 	struct image_program_info {
 		uint8_t* __attribute__((aligned(128))) buffer;
@@ -86,6 +94,15 @@ protected:
 	//! separate create image function, b/c it's called by the constructor and resize
 	bool create_internal(const bool copy_host_data, const compute_queue& cqueue);
 	
+	//! true if the image data is stored in the tiled layout (see COMPUTE_MEMORY_FLAG::HOST_TILED_LAYOUT)
+	bool is_tiled { false };
+	//! tiled layout only: mapped pointer -> linear copy of the image data + map flags
+	unordered_map<void*, pair<host_memory, COMPUTE_MEMORY_MAP_FLAG>> tiled_mappings;
+	
+	//! converts the first "level_count" mip-levels (all layers) of the image data in "src" from the linear to the tiled layout
+	//! if "to_tiled" is true, or from the tiled to the linear layout otherwise, writing the result to "dst"
+	void convert_tiled_layout(uint8_t* dst, const uint8_t* src, const bool to_tiled, const uint32_t level_count) const;
+	
 #if !defined(FLOOR_NO_METAL)
 	// internal Metal image when using Metal memory sharing (and not wrapping an existing image)
 	shared_ptr<compute_image> host_mtl_image;
@@ -31,26 +31,25 @@
 #include <floor/compute/compute_queue.hpp>
 #include <floor/compute/compute_context.hpp>
 #include <floor/compute/host/host_buffer.hpp>
+#include <floor/compute/host/host_device.hpp>
 #include <floor/compute/host/host_image.hpp>
 #include <floor/compute/host/host_queue.hpp>
 #include <floor/compute/host/elf_binary.hpp>
 #include <floor/compute/host/host_argument_buffer.hpp>
+#include <floor/compute/host/host_worker_pool.hpp>
+#include <floor/compute/host/host_group_scheduler.hpp>
+#include <floor/compute/host/host_numa.hpp>
 #include <floor/compute/device/host_limits.hpp>
 #include <floor/compute/device/host_id.hpp>
+#include <floor/core/trace.hpp>
 
+// NOTE: when enabled, this will also log per-worker busy/idle times of the group scheduler
 //#define FLOOR_HOST_KERNEL_ENABLE_TIMING 1
 #if defined(FLOOR_HOST_KERNEL_ENABLE_TIMING)
 #include <floor/core/timer.hpp>
-#endif
-
-#if defined(__APPLE__)
-#include <mach/thread_policy.h>
-#include <mach/thread_act.h>
-#elif defined(__linux__) || defined(__FreeBSD__)
-#include <pthread.h>
-#if defined(__FreeBSD__)
-#include <pthread_np.h>
-#endif
+static constexpr const bool floor_host_kernel_collect_stats { true };
+#else
+static constexpr const bool floor_host_kernel_collect_stats { false };
 #endif
 
 #if !defined(_WIN32)
@@ -58,6 +57,11 @@
 static_assert(sizeof(ucontext_t) > 64, "ucontext_t should not be this small, something is wrong!");
 #endif
 
+#if !defined(__WINDOWS__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include <floor/core/platform_windows.hpp>
 #include <floor/core/essentials.hpp> // cleanup
 
@@ -65,12 +69,116 @@ static_assert(sizeof(ucontext_t) > 64, "ucontext_t should not be this small, som
 FLOOR_IGNORE_WARNING(deprecated-declarations)
 
 //
-static const function<void()>* cur_kernel_function { nullptr };
 extern "C" void run_mt_group_item(const uint32_t local_linear_idx);
+extern "C" void run_mt_single_item_groups(const uint32_t local_linear_idx);
 extern "C" void run_host_device_group_item(const uint32_t local_linear_idx);
+extern "C" void run_mt_coop_group_item(const uint32_t fiber_idx);
+extern "C" void run_host_device_coop_group_item(const uint32_t fiber_idx);
+
+// fiber implementation: hand-written context switching on x86-64 (SysV ABI) and AArch64 (AAPCS64),
+// Windows fibers on Windows and posix ucontext everywhere else
+#if defined(__WINDOWS__)
+#define FLOOR_HOST_FIBER_WINDOWS 1
+#elif defined(__x86_64__)
+#define FLOOR_HOST_FIBER_SYSV_X86_64 1
+#elif defined(__aarch64__)
+#define FLOOR_HOST_FIBER_AARCH64 1
+#else
+#define FLOOR_HOST_FIBER_UCONTEXT 1
+#endif
+
+// NOTE: due to rather fragile stack handling (sp), this is completely done in asm, so that the compiler can't do anything wrong
+#if defined(FLOOR_HOST_FIBER_AARCH64)
+// NOTE: only the callee-saved registers (x19 - x28, fp, lr, sp and the lower 64 bits of v8 - v15) need to be saved/restored,
+//       these are always switched at a function call boundary
+// NOTE: use newlines as instruction separators (';' starts a comment on Darwin/AArch64)
+asm("floor_get_context_aarch64:\n"
+	// store all registers in fiber_context* (x0)
+	"stp x19, x20, [x0, #0x00]\n"
+	"stp x21, x22, [x0, #0x10]\n"
+	"stp x23, x24, [x0, #0x20]\n"
+	"stp x25, x26, [x0, #0x30]\n"
+	"stp x27, x28, [x0, #0x40]\n"
+	"stp x29, x30, [x0, #0x50]\n"
+	// sp + pc (resume right after the call of this function -> lr)
+	"mov x9, sp\n"
+	"stp x9, x30, [x0, #0x60]\n"
+	"stp d8, d9, [x0, #0x70]\n"
+	"stp d10, d11, [x0, #0x80]\n"
+	"stp d12, d13, [x0, #0x90]\n"
+	"stp d14, d15, [x0, #0xA0]\n"
+	"ret\n");
+asm("floor_set_context_aarch64:\n"
+	// restore all registers from fiber_context* (x0)
+	"ldp x19, x20, [x0, #0x00]\n"
+	"ldp x21, x22, [x0, #0x10]\n"
+	"ldp x23, x24, [x0, #0x20]\n"
+	"ldp x25, x26, [x0, #0x30]\n"
+	"ldp x27, x28, [x0, #0x40]\n"
+	"ldp x29, x30, [x0, #0x50]\n"
+	"ldp d8, d9, [x0, #0x70]\n"
+	"ldp d10, d11, [x0, #0x80]\n"
+	"ldp d12, d13, [x0, #0x90]\n"
+	"ldp d14, d15, [x0, #0xA0]\n"
+	"ldp x9, x10, [x0, #0x60]\n"
+	"mov sp, x9\n"
+	// and jump to pc (x10)
+	"br x10\n");
+// combined get_context(x0) + set_context(x1): this is what barriers use to switch from one work-item to the next
+asm("floor_swap_context_aarch64:\n"
+	// store all registers in this fiber_context* (x0)
+	"stp x19, x20, [x0, #0x00]\n"
+	"stp x21, x22, [x0, #0x10]\n"
+	"stp x23, x24, [x0, #0x20]\n"
+	"stp x25, x26, [x0, #0x30]\n"
+	"stp x27, x28, [x0, #0x40]\n"
+	"stp x29, x30, [x0, #0x50]\n"
+	"mov x9, sp\n"
+	"stp x9, x30, [x0, #0x60]\n"
+	"stp d8, d9, [x0, #0x70]\n"
+	"stp d10, d11, [x0, #0x80]\n"
+	"stp d12, d13, [x0, #0x90]\n"
+	"stp d14, d15, [x0, #0xA0]\n"
+	// restore all registers from the next fiber_context* (x1)
+	"ldp x19, x20, [x1, #0x00]\n"
+	"ldp x21, x22, [x1, #0x10]\n"
+	"ldp x23, x24, [x1, #0x20]\n"
+	"ldp x25, x26, [x1, #0x30]\n"
+	"ldp x27, x28, [x1, #0x40]\n"
+	"ldp x29, x30, [x1, #0x50]\n"
+	"ldp d8, d9, [x1, #0x70]\n"
+	"ldp d10, d11, [x1, #0x80]\n"
+	"ldp d12, d13, [x1, #0x90]\n"
+	"ldp d14, d15, [x1, #0xA0]\n"
+	"ldp x9, x10, [x1, #0x60]\n"
+	"mov sp, x9\n"
+	// and jump to pc (x10)
+	"br x10\n");
+asm("floor_enter_context_aarch64:\n"
+	// retrieve fiber_context*
+	"ldr x19, [sp, #0x8]\n"
+	// fiber_context->init_func
+	"ldr x9, [x19, #0xC0]\n"
+	// fiber_context->init_arg
+	"ldr w0, [x19, #0xD8]\n"
+	// call init_func(init_arg)
+	"blr x9\n"
+	// context is done, -> exit to set exit context
+	// retrieve fiber_context* again (x19 is callee-saved, but don't rely on the kernel code here)
+	"ldr x19, [sp, #0x8]\n"
+	// exit fiber_context*
+	"ldr x0, [x19, #0xC8]\n"
+	// set_context(exit_context)
+	"bl floor_set_context_aarch64\n"
+	// it's a trap!
+	"brk #0\n");
+extern "C" void floor_get_context(void* ctx) asm("floor_get_context_aarch64");
+extern "C" void floor_set_context(void* ctx) asm("floor_set_context_aarch64");
+extern "C" void floor_swap_context(void* this_ctx, void* next_ctx) asm("floor_swap_context_aarch64");
+extern "C" void floor_enter_context() asm("floor_enter_context_aarch64");
+#endif
 
-// NOTE: due to rather fragile stack handling (rsp), this is completely done in asm, so that the compiler can't do anything wrong
-#if !defined(FLOOR_IOS) && !defined(__WINDOWS__)
+#if defined(FLOOR_HOST_FIBER_SYSV_X86_64)
 #if defined(__AVX512F__) && defined(__AVX512DQ__)
 asm("floor_get_context_sysv_x86_64:"
 	// store all registers in fiber_context*
@@ -189,6 +297,30 @@ asm("floor_set_context_sysv_x86_64:"
 	// and jump to rip (rcx)
 	"jmp *%rcx;");
 #endif
+// combined get_context(rdi) + set_context(rsi): this is what barriers use to switch from one work-item to the next
+asm("floor_swap_context_sysv_x86_64:"
+	// store all registers in this fiber_context* (rdi)
+	"movq %rbp, 0x0(%rdi);"
+	"movq %rbx, 0x8(%rdi);"
+	"movq %r12, 0x10(%rdi);"
+	"movq %r13, 0x18(%rdi);"
+	"movq %r14, 0x20(%rdi);"
+	"movq %r15, 0x28(%rdi);"
+	"leaq 0x8(%rsp), %rcx;"
+	"movq %rcx, 0x30(%rdi);" // rsp
+	"movq (%rsp), %rcx;"
+	"movq %rcx, 0x38(%rdi);" // rip
+	// restore all registers from the next fiber_context* (rsi)
+	"movq 0x0(%rsi), %rbp;"
+	"movq 0x8(%rsi), %rbx;"
+	"movq 0x10(%rsi), %r12;"
+	"movq 0x18(%rsi), %r13;"
+	"movq 0x20(%rsi), %r14;"
+	"movq 0x28(%rsi), %r15;"
+	"movq 0x30(%rsi), %rsp;"
+	"movq 0x38(%rsi), %rcx;"
+	// and jump to rip (rcx)
+	"jmp *%rcx;");
 asm(".extern exit;"
 	"floor_enter_context_sysv_x86_64:"
 	// retrieve fiber_context*
@@ -211,17 +343,116 @@ asm(".extern exit;"
 	"ud2;");
 extern "C" void floor_get_context(void* ctx) asm("floor_get_context_sysv_x86_64");
 extern "C" void floor_set_context(void* ctx) asm("floor_set_context_sysv_x86_64");
+extern "C" void floor_swap_context(void* this_ctx, void* next_ctx) asm("floor_swap_context_sysv_x86_64");
 extern "C" void floor_enter_context() asm("floor_enter_context_sysv_x86_64");
+
+// calls the kernel function "func" (rdi) with the "arg_count" (edx) pointer arguments stored in "args" (rsi),
+// with the first 6 args being passed in registers and all remaining args being passed on the stack
+// NOTE: "args" must always contain at least 6 readable entries (unused ones are loaded into registers, but ignored)
+asm("floor_call_kernel_sysv_x86_64:"
+	"pushq %rbp;"
+	"movq %rsp, %rbp;"
+	"movq %rdi, %r11;" // func
+	"movq %rsi, %r10;" // args
+	"movl %edx, %eax;" // arg_count
+	// push args #arg_count-1 ... #6 onto the stack (rsp must be 16-byte aligned at the call -> pad if the stack arg count is odd)
+	"cmpl $6, %eax;"
+	"jbe 2f;"
+	"testl $1, %eax;"
+	"jz 1f;"
+	"subq $0x8, %rsp;"
+	"1:"
+	"pushq -0x8(%r10,%rax,8);"
+	"decl %eax;"
+	"cmpl $6, %eax;"
+	"ja 1b;"
+	"2:"
+	// args #0 ... #5
+	"movq 0x0(%r10), %rdi;"
+	"movq 0x8(%r10), %rsi;"
+	"movq 0x10(%r10), %rdx;"
+	"movq 0x18(%r10), %rcx;"
+	"movq 0x20(%r10), %r8;"
+	"movq 0x28(%r10), %r9;"
+	// no vector registers are used (kernel_func_type is variadic)
+	"xorl %eax, %eax;"
+	"callq *%r11;"
+	"leaveq;"
+	"retq;");
+extern "C" void floor_call_kernel(host_kernel::kernel_func_type func, const void* const* args, const uint32_t arg_count)
+asm("floor_call_kernel_sysv_x86_64");
+//! there is no limit on the amount of kernel args (other than the stack size)
+static constexpr const uint32_t floor_max_kernel_arg_count { ~0u };
+#elif defined(FLOOR_HOST_FIBER_AARCH64)
+// calls the kernel function "func" (x0) with the "arg_count" (w2) pointer arguments stored in "args" (x1),
+// with the first 8 args being passed in registers (x0 - x7) and all remaining args being passed on the stack (8 bytes each)
+// NOTE: "args" must always contain at least 8 readable entries (unused ones are loaded into registers, but ignored)
+asm("floor_call_kernel_aarch64:\n"
+	"stp x29, x30, [sp, #-16]!\n"
+	"mov x29, sp\n"
+	"mov x9, x0\n" // func
+	"mov x10, x1\n" // args
+	// store args #8 ... #arg_count-1 on the stack (sp must stay 16-byte aligned -> reserve an even amount of slots)
+	"subs w11, w2, #8\n"
+	"b.ls 2f\n"
+	"add w12, w11, #1\n"
+	"and w12, w12, #0xFFFFFFFE\n"
+	"lsl x12, x12, #3\n"
+	"sub sp, sp, x12\n"
+	"add x13, x10, #64\n"
+	"mov x14, #0\n"
+	"1:\n"
+	"ldr x15, [x13, x14, lsl #3]\n"
+	"str x15, [sp, x14, lsl #3]\n"
+	"add x14, x14, #1\n"
+	"cmp x14, x11\n"
+	"b.lo 1b\n"
+	"2:\n"
+	// args #0 ... #7
+	"ldp x0, x1, [x10, #0x00]\n"
+	"ldp x2, x3, [x10, #0x10]\n"
+	"ldp x4, x5, [x10, #0x20]\n"
+	"ldp x6, x7, [x10, #0x30]\n"
+	"blr x9\n"
+	"mov sp, x29\n"
+	"ldp x29, x30, [sp], #16\n"
+	"ret\n");
+extern "C" void floor_call_kernel(host_kernel::kernel_func_type func, const void* const* args, const uint32_t arg_count)
+asm("floor_call_kernel_aarch64");
+//! there is no limit on the amount of kernel args (other than the stack size)
+static constexpr const uint32_t floor_max_kernel_arg_count { ~0u };
+#else
+//! generic kernel call (Windows and all other targets): expand the args into a direct call for each supported arg count
+static constexpr const uint32_t floor_max_kernel_arg_count { 64u };
+template <size_t... indices>
+static void floor_call_kernel_expanded(host_kernel::kernel_func_type func, const void* const* args floor_unused,
+									   index_sequence<indices...>) {
+	(*func)(args[indices]...);
+}
+template <size_t arg_count>
+static void floor_call_kernel_n(host_kernel::kernel_func_type func, const void* const* args) {
+	floor_call_kernel_expanded(func, args, make_index_sequence<arg_count>());
+}
+template <size_t... arg_counts>
+static constexpr auto make_floor_call_kernel_table(index_sequence<arg_counts...>) {
+	typedef void (*call_func_type)(host_kernel::kernel_func_type, const void* const*);
+	return array<call_func_type, sizeof...(arg_counts)> {{ &floor_call_kernel_n<arg_counts>... }};
+}
+static void floor_call_kernel(host_kernel::kernel_func_type func, const void* const* args, const uint32_t arg_count) {
+	static constexpr const auto call_table = make_floor_call_kernel_table(make_index_sequence<floor_max_kernel_arg_count + 1u>());
+	call_table[arg_count](func, args);
+}
 #endif
 
 struct alignas(128) fiber_context {
 	typedef void (*init_func_type)(const uint32_t);
 
-#if !defined(FLOOR_IOS) && !defined(__WINDOWS__)
-	// sysv x86-64 abi compliant implementation
+#if defined(FLOOR_HOST_FIBER_SYSV_X86_64) || defined(FLOOR_HOST_FIBER_AARCH64)
 	static constexpr const size_t min_stack_size { 8192 };
 	static_assert(min_stack_size % 16ull == 0, "stack must be 16-byte aligned");
 
+#if defined(FLOOR_HOST_FIBER_SYSV_X86_64)
+	// sysv x86-64 abi compliant implementation
 	// callee-saved registers
 	uint64_t rbp { 0 };
 	uint64_t rbx { 0 };
@@ -233,6 +464,20 @@ struct alignas(128) fiber_context {
 	uint64_t rsp { 0 };
 	// return address / instruction pointer
 	uint64_t rip { 0 };
+#else
+	// aapcs64 (aarch64) abi compliant implementation
+	// callee-saved registers x19 - x28
+	uint64_t x19_x28[10] {};
+	// frame pointer (x29) and link register (x30)
+	uint64_t fp { 0 };
+	uint64_t lr { 0 };
+	// stack pointer
+	uint64_t sp { 0 };
+	// return address / instruction pointer
+	uint64_t pc { 0 };
+	// callee-saved floating point registers d8 - d15 (lower 64 bits of v8 - v15)
+	uint64_t d8_d15[8] {};
+#endif
 
 	void init(void* stack_ptr_, const size_t& stack_size_,
 			  init_func_type init_func_, const uint32_t& init_arg_,
@@ -266,6 +511,7 @@ struct alignas(128) fiber_context {
 	}
 
 	void reset() noexcept {
+#if defined(FLOOR_HOST_FIBER_SYSV_X86_64)
 		// reset registers, set rip to enter_context and reset rsp
 #if defined(FLOOR_DEBUG) // this isn't actually necessary
 		rbp = 0;
@@ -281,6 +527,23 @@ struct alignas(128) fiber_context {
 		*(uint64_t*)(rsp + 8u) = (uint64_t)this;
 #if defined(FLOOR_DEBUG)
 		*(uint64_t*)(rsp) = 0x0123456789ABCDEFull;
+#endif
+#else
+		// reset registers, set pc to enter_context and reset sp
+#if defined(FLOOR_DEBUG) // this isn't actually necessary
+		memset(x19_x28, 0, sizeof(x19_x28));
+		memset(d8_d15, 0, sizeof(d8_d15));
+#endif
+		// terminate the frame chain
+		fp = 0;
+		lr = 0;
+		// same stack layout as on x86-64: two 64-bit values at the top + needs to be 16-byte aligned
+		sp = ((size_t)stack_ptr) + stack_size - 16u;
+		pc = (uint64_t)floor_enter_context;
+		*(uint64_t*)(sp + 8u) = (uint64_t)this;
+#if defined(FLOOR_DEBUG)
+		*(uint64_t*)(sp) = 0x0123456789ABCDEFull;
+#endif
 #endif
 	}
 
@@ -299,29 +562,13 @@ FLOOR_IGNORE_WARNING(missing-noreturn)
 FLOOR_POP_WARNINGS()
 
 	void swap_context(fiber_context* next_ctx) noexcept {
-		// NOTE: order of operation in here:
-		// * fiber #1 enters
-		// * set swapped to false
-		// * get_context() saves the current point of execution for later resume ("store pc", etc.)
-		// * swapped is still false here -> execute the if block
-		// * set swapped to true
-		// * switch to fiber #2 (next_ctx)
-		// * some other fiber -> resume fiber #1 after "get_context()"
-		// * swapped is now true -> don't execute the if block -> return
-		volatile bool swapped = false;
-		get_context();
-		if(!swapped) {
-			swapped = true;
-#if defined(__clang_analyzer__)
-			(void)swapped; // -> mark as used (will be read again)
-#endif
-			next_ctx->set_context();
-		}
+		// saves the current point of execution in this context and directly continues with "next_ctx",
+		// once some other fiber switches back to this context, this returns
+		// NOTE: this is a single save + restore, i.e. no get_context() + "swapped" flag + set_context() round trip is necessary
+		floor_swap_context(this, next_ctx);
 	}
 
-//#elif defined(FLOOR_IOS)
-	// TODO: aarch64/armv8 implementation
-#elif defined(__WINDOWS__)
+#elif defined(FLOOR_HOST_FIBER_WINDOWS)
 	static constexpr const size_t min_stack_size { 4096 };
 
 	// the windows fiber context
@@ -379,7 +626,9 @@ FLOOR_POP_WARNINGS()
 
 		// this is a worker fiber/context
 		// -> create a new windows fiber context for this
-		ctx = CreateFiberEx(stack_size, stack_size, 0, fiber_run, this);
+		// NOTE: only reserve "stack_size" bytes and initially commit a single page, the stack is then committed on demand
+		//       (the OS places a guard page below the committed region and grows the stack when it is touched)
+		ctx = CreateFiberEx(min_stack_size, stack_size, 0, fiber_run, this);
 		if(ctx == nullptr) {
 			log_error("failed to create worker fiber context: %u", GetLastError());
 			logger::flush();
@@ -467,42 +716,30 @@ FLOOR_POP_WARNINGS()
 	uint32_t init_arg { 0 };
 	
 };
-#if !defined(FLOOR_IOS) && !defined(__WINDOWS__)
+#if defined(FLOOR_HOST_FIBER_SYSV_X86_64)
 // make sure member variables are at the right offsets when using the sysv abi fiber approach
 static_assert(offsetof(fiber_context, init_func) == 0x50);
 static_assert(offsetof(fiber_context, exit_ctx) == 0x58);
 static_assert(offsetof(fiber_context, main_ctx) == 0x60);
 static_assert(offsetof(fiber_context, init_arg) == 0x68);
+#elif defined(FLOOR_HOST_FIBER_AARCH64)
+// make sure member variables are at the right offsets when using the aapcs64 fiber approach
+static_assert(offsetof(fiber_context, sp) == 0x60);
+static_assert(offsetof(fiber_context, pc) == 0x68);
+static_assert(offsetof(fiber_context, d8_d15) == 0x70);
+static_assert(offsetof(fiber_context, init_func) == 0xC0);
+static_assert(offsetof(fiber_context, exit_ctx) == 0xC8);
+static_assert(offsetof(fiber_context, main_ctx) == 0xD0);
+static_assert(offsetof(fiber_context, init_arg) == 0xD8);
 #endif
 
-// thread affinity handling
-static void floor_set_thread_affinity(const uint32_t& affinity) {
-#if defined(__APPLE__)
-	thread_port_t thread_port = pthread_mach_thread_np(pthread_self());
-	thread_affinity_policy thread_affinity { int(affinity) };
-	thread_policy_set(thread_port, THREAD_AFFINITY_POLICY, (thread_policy_t)&thread_affinity, THREAD_AFFINITY_POLICY_COUNT);
-#elif defined(__linux__) || defined(__FreeBSD__)
-	// use gnu extension
-	cpu_set_t cpu_set;
-	CPU_ZERO(&cpu_set);
-	CPU_SET(affinity - 1, &cpu_set);
-	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
-#elif defined(__OpenBSD__)
-	// TODO: pthread gnu extension not available here
-#elif defined(__WINDOWS__)
-	SetThreadAffinityMask(GetCurrentThread(), 1u << (affinity - 1u));
-#endif
-}
-
 // id handling vars
-uint32_t floor_work_dim { 1u };
-uint3 floor_global_work_size;
-static uint32_t floor_linear_global_work_size;
-uint3 floor_local_work_size;
-static uint32_t floor_linear_local_work_size;
-uint3 floor_group_size;
-static uint32_t floor_linear_group_size;
+// NOTE: these are set per worker thread from the active host_exec_context_t (see below)
 #if !defined(__WINDOWS__) // TLS dllexport vars are handled differently on Windows
+thread_local uint32_t floor_work_dim { 1u };
+thread_local uint3 floor_global_work_size;
+thread_local uint3 floor_local_work_size;
+thread_local uint3 floor_group_size;
 thread_local uint3 floor_global_idx;
 thread_local uint3 floor_local_idx;
 thread_local uint3 floor_group_idx;
@@ -513,27 +750,48 @@ thread_local uint3 floor_group_idx;
 static uint32_t floor_max_thread_count { 0 };
 
 // barrier handling vars
-// -> mt-item
-#if defined(FLOOR_HOST_COMPUTE_MT_ITEM)
-static atomic<uint32_t> barrier_counter { 0 };
-static atomic<uint32_t> barrier_gen { 0 };
-static uint32_t barrier_users { 0 };
-#endif
 // -> mt-group
 #if defined(FLOOR_HOST_COMPUTE_MT_GROUP)
 static thread_local uint32_t item_local_linear_idx { 0 };
 static thread_local fiber_context* item_contexts { nullptr };
+//! executes all work-groups of the current worker thread when using single work-item groups (see execute_host)
+static thread_local const function<void()>* single_item_groups_func { nullptr };
 #endif
 // -> sanity check for correct barrier use
 #if defined(FLOOR_DEBUG)
 static thread_local uint32_t unfinished_items { 0 };
 #endif
 
+// sub-group handling
+// -> mt-group
+#if defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+//! max size of a value that can be exchanged between the work-items of a sub-group
+static constexpr const uint32_t sub_group_max_value_size { 16u };
+//! per-worker-thread sub-group exchange memory
+//! NOTE: this is double-buffered, so that a sub-group operation never overwrites values of the previous operation
+//!       that may still be read by other work-items of the sub-group
+struct sub_group_exchange_t {
+	alignas(128) uint8_t data[2][host_limits::max_total_local_size * sub_group_max_value_size];
+	//! per work-item: index of the buffer that was used by the last sub-group operation
+	bool buffer_idx[host_limits::max_total_local_size];
+};
+static thread_local unique_ptr<sub_group_exchange_t> sub_group_exchange;
+
+//! must be called when starting the execution of a work-group
+static void reset_sub_group_exchange(const uint32_t local_size) {
+	if (sub_group_exchange) {
+		memset(sub_group_exchange->buffer_idx, 0, local_size * sizeof(bool));
+	}
+}
+#endif
+
 // local memory management
 static constexpr const size_t floor_local_memory_max_size { host_limits::local_memory_size };
-static uint32_t local_memory_alloc_offset { 0 };
-static bool local_memory_exceeded { false };
 static aligned_ptr<uint8_t> floor_local_memory_data;
+//! max amount of local memory (per worker thread) that has been requisitioned so far
+//! NOTE: local buffers are only allocated once, this is the amount of local memory that must be saved/restored when
+//!       switching between the work-groups of a cooperative execution
+static atomic<uint32_t> floor_local_memory_high_water { 0u };
 
 // extern in host_kernel.hpp and common.hpp
 #if !defined(__WINDOWS__) // TLS dllexport vars are handled differently on Windows
@@ -543,34 +801,475 @@ thread_local uint32_t floor_thread_local_memory_offset { 0 };
 
 // stack memory management
 // 4k - 8k stack should be enough, considering this runs on gpus (min 32k with ucontext)
-// TODO: stack protection?
+// NOTE: this is the default stack size, kernels with a known stack usage estimate are sized by it (see get_item_stack_size),
+//       i.e. kernels built by the host-compute device toolchain and host kernels compiled with -fstack-size-section
 static constexpr const size_t item_stack_size { fiber_context::min_stack_size };
-static aligned_ptr<uint8_t> floor_stack_memory_data;
+//! max per-item stack size
+static constexpr const size_t max_item_stack_size { 1024u * 1024u };
+//! stack space that is reserved in addition to the stack usage estimate of a kernel:
+//! the estimate doesn't include any called (non-inlined) functions or the fiber context switch
+static constexpr const size_t item_stack_reserve { 8192u };
 
+//! returns the per-item stack size that is required by a kernel with the specified stack usage estimate (0 if unknown)
+static size_t get_item_stack_size(const uint64_t stack_usage) {
+	if (stack_usage == 0u) {
+		return item_stack_size;
+	}
+	return std::clamp(size_t(stack_usage) + item_stack_reserve, item_stack_size, max_item_stack_size);
+}
+
+// NOTE: the local memory of each worker thread is placed on the NUMA node of its CPU
 static void floor_alloc_host_local_memory() {
 	if (!floor_local_memory_data) {
 		floor_local_memory_data = make_aligned_ptr<uint8_t>(floor_max_thread_count * floor_local_memory_max_size);
+		host_numa_topology::get().bind_worker_memory(floor_local_memory_data.get(), floor_local_memory_max_size,
+													 floor_max_thread_count);
 	}
 }
 
-static void floor_alloc_host_stack_memory() {
-#if defined(FLOOR_HOST_COMPUTE_MT_GROUP) || defined(FLOOR_COMPUTE_HOST_DEVICE)
-	if (!floor_stack_memory_data) {
-		floor_stack_memory_data = make_aligned_ptr<uint8_t>(floor_max_thread_count * item_stack_size * host_limits::max_total_local_size);
+//! the fiber stacks of a single worker thread:
+//! all stacks are reserved at once, but memory is only committed by the OS when a page is first touched,
+//! each used stack is preceded by an inaccessible guard page, so that a stack overflow faults instead of corrupting other stacks
+//! (guard pages are only created once, when a stack is first used, see protect_stack())
+//! NOTE: stacks are kept across kernel executions and are only re-reserved when a kernel requires larger stacks
+//! NOTE: on Windows, fibers manage their own stacks, this only reserves (never commits) the address range
+struct fiber_stacks_t {
+	uint8_t* memory { nullptr };
+	size_t memory_size { 0u };
+	//! usable size of each stack (multiple of the page size)
+	size_t stack_size { 0u };
+	
+	fiber_stacks_t() = default;
+	~fiber_stacks_t() {
+		release();
+	}
+	fiber_stacks_t(const fiber_stacks_t&) = delete;
+	fiber_stacks_t& operator=(const fiber_stacks_t&) = delete;
+	
+	static size_t get_page_size() {
+#if !defined(__WINDOWS__)
+		static const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+#else
+		static const size_t page_size = [] {
+			SYSTEM_INFO sys_info;
+			GetSystemInfo(&sys_info);
+			return size_t(sys_info.dwPageSize);
+		}();
+#endif
+		return page_size;
+	}
+	
+	//! reserves "count" stacks of at least "min_stack_size" bytes each for the worker on CPU "cpu_idx", returns true on success
+	bool reserve(const uint32_t cpu_idx, const uint32_t count, const size_t min_stack_size) {
+		release();
+		
+		const auto page_size = get_page_size();
+		const auto new_stack_size = ((min_stack_size + page_size - 1u) / page_size) * page_size;
+		const auto stride = new_stack_size + page_size;
+		const auto new_memory_size = stride * count;
+#if !defined(__WINDOWS__)
+		int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_NORESERVE)
+		map_flags |= MAP_NORESERVE;
+#endif
+		auto new_memory = mmap(nullptr, new_memory_size, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+		if (new_memory == MAP_FAILED) {
+			log_error("failed to reserve %u bytes of fiber stack memory: %s", new_memory_size, strerror(errno));
+			return false;
+		}
+#else
+		// NOTE: Windows fibers allocate and grow their own stacks (see fiber_context::reset), the memory reserved here
+		//       only provides the per-fiber stack addresses -> only reserve the address range, never commit it
+		auto new_memory = VirtualAlloc(nullptr, new_memory_size, MEM_RESERVE, PAGE_NOACCESS);
+		if (new_memory == nullptr) {
+			log_error("failed to reserve %u bytes of fiber stack memory: %u", new_memory_size, GetLastError());
+			return false;
+		}
+#endif
+		memory = (uint8_t*)new_memory;
+		memory_size = new_memory_size;
+		stack_size = new_stack_size;
+		
+		// place the stacks on the NUMA node of the worker
+		host_numa_topology::get().place_memory(memory, memory_size, cpu_idx, 1u);
+		return true;
+	}
+	
+	//! returns the start (lowest address) of the stack with the specified index
+	uint8_t* get_stack(const uint32_t idx) const {
+		const auto page_size = get_page_size();
+		return memory + page_size + idx * (stack_size + page_size);
 	}
+	
+	//! makes the guard page below the stack with the specified index inaccessible, returns true on success
+	//! NOTE: must only be called once per stack and reservation, before the stack is used
+	bool protect_stack(const uint32_t idx) const {
+#if !defined(__WINDOWS__)
+		const auto page_size = get_page_size();
+		if (mprotect(get_stack(idx) - page_size, page_size, PROT_NONE) != 0) {
+			log_error("failed to protect fiber stack guard page: %s", strerror(errno));
+			return false;
+		}
+#else
+		(void)idx;
+#endif
+		return true;
+	}
+	
+	void release() {
+		if (memory == nullptr) {
+			return;
+		}
+#if !defined(__WINDOWS__)
+		munmap(memory, memory_size);
+#else
+		VirtualFree(memory, 0, MEM_RELEASE);
+#endif
+		memory = nullptr;
+		memory_size = 0u;
+		stack_size = 0u;
+	}
+};
+
+// persistent per-worker-thread fiber state
+// NOTE: fibers are created and initialized once per worker thread (up to the largest local size used so far),
+//       subsequent executions only need to relink the last work-item and switch the item function,
+//       stacks are only re-reserved (and all fibers re-initialized) if a kernel requires larger stacks or more fibers
+//       (cooperative executions need one fiber per work-item of each work-group that is executed by the worker)
+struct worker_fibers_t {
+	fiber_context main_ctx;
+	bool main_ctx_init { false };
+	unique_ptr<fiber_context[]> items;
+	fiber_stacks_t stacks;
+	//! amount of fibers/stacks that are available
+	uint32_t capacity { 0u };
+	//! amount of initialized fibers/items
+	uint32_t item_count { 0u };
+	//! amount of fibers and item function the fibers are currently set up for
+	uint32_t local_size { 0u };
+	fiber_context::init_func_type item_func { nullptr };
+	
+	//! sets up the fibers of the calling worker thread (on CPU "cpu_idx") for executing "local_size_" work-items using "item_func_",
+	//! with each work-item requiring "stack_size" bytes of stack memory, returns false on failure
+	bool prepare(const uint32_t cpu_idx, const uint32_t local_size_, fiber_context::init_func_type item_func_, const size_t stack_size) {
+		static constexpr const uint32_t min_capacity { host_limits::max_total_local_size };
+		if (!items || stack_size > stacks.stack_size || local_size_ > capacity) {
+			// stack memory is only reserved once fibers are actually needed (barrier-free kernels never need it)
+			// NOTE: never shrink the stacks or the fiber count
+			const auto new_capacity = max(max(min_capacity, capacity), local_size_);
+			items = nullptr;
+			capacity = 0u;
+			if (!stacks.reserve(cpu_idx, new_capacity, max(stack_size, stacks.stack_size))) {
+				item_contexts = nullptr;
+				return false;
+			}
+			if (!main_ctx_init) {
+				main_ctx.init(nullptr, 0, nullptr, ~0u, nullptr, nullptr);
+				main_ctx_init = true;
+			}
+			items = make_unique<fiber_context[]>(new_capacity);
+			capacity = new_capacity;
+			item_count = 0u;
+			local_size = 0u;
+			item_func = item_func_;
+		}
+		
+		if (item_func != item_func_) {
+			for (uint32_t i = 0; i < item_count; ++i) {
+				items[i].init_func = item_func_;
+			}
+			item_func = item_func_;
+		}
+		
+		// initialize all not yet initialized fibers that are needed for this local size
+		// NOTE: this touches the top of each stack, i.e. only the stacks of used fibers are ever committed or guarded
+		for (uint32_t i = item_count; i < local_size_; ++i) {
+			if (!stacks.protect_stack(i)) {
+				item_count = i;
+				item_contexts = nullptr;
+				return false;
+			}
+			items[i].init(stacks.get_stack(i),
+						  stacks.stack_size,
+						  item_func_, i,
+						  // continue with next on return, or return to main ctx when the last item returns
+						  // TODO: add option to use randomized order?
+						  (i + 1 < capacity ? &items[i + 1] : &main_ctx),
+						  &main_ctx);
+		}
+		item_count = max(item_count, local_size_);
+		
+		if (local_size != local_size_) {
+			// relink: previous last item continues with the next item again, new last item returns to the main ctx
+			if (local_size > 0u) {
+				items[local_size - 1].exit_ctx = (local_size < capacity ? &items[local_size] : &main_ctx);
+			}
+			items[local_size_ - 1].exit_ctx = &main_ctx;
+			local_size = local_size_;
+		}
+		
+		item_contexts = items.get();
+		return true;
+	}
+};
+static thread_local worker_fibers_t worker_fibers;
+
+// grid-wide barrier for cooperative kernel executions
+// NOTE: there is one participant per worker thread, which is the last work-item of the last group of each worker
+struct host_grid_barrier_t {
+	const uint32_t participants;
+	atomic<uint32_t> counter;
+	atomic<uint32_t> gen { 0u };
+	atomic<bool> aborted { false };
+	
+	explicit host_grid_barrier_t(const uint32_t participants_) : participants(participants_), counter(participants_) {}
+	
+	//! waits until all participants have arrived, returns false if the execution has been aborted
+	bool wait() {
+		const auto cur_gen = gen.load(memory_order_acquire);
+		if (counter.fetch_sub(1u, memory_order_acq_rel) == 1u) {
+			// last to arrive: reset for the next use and release everyone else
+			counter.store(participants, memory_order_relaxed);
+			gen.fetch_add(1u, memory_order_release); // note: overflow doesn't matter
+			return !aborted.load(memory_order_acquire);
+		}
+		
+		// spin for a short while, then start yielding
+		static constexpr const uint32_t spin_count { 2048u };
+		for (uint32_t trial = 0; gen.load(memory_order_acquire) == cur_gen; ++trial) {
+			if (aborted.load(memory_order_acquire)) {
+				return false;
+			}
+			if (trial < spin_count) {
+#if defined(__x86_64__) || defined(__i386__)
+				asm volatile("pause" : : : "memory"); // x86
+#else
+				asm volatile("yield" : : : "memory"); // ARM
 #endif
+			} else {
+				this_thread::yield();
+			}
+		}
+		return !aborted.load(memory_order_acquire);
+	}
+	
+	//! aborts the execution, i.e. no participant will wait any longer
+	void abort() {
+		aborted.store(true, memory_order_release);
+	}
+};
+
+//! kernel function + the args it is called with (for each work-item)
+struct host_kernel_call_t {
+	host_kernel::kernel_func_type func { nullptr };
+	const void* const* args { nullptr };
+	uint32_t arg_count { 0u };
+	
+	explicit operator bool() const {
+		return (func != nullptr);
+	}
+	
+	void operator()() const {
+		floor_call_kernel(func, args, arg_count);
+	}
+};
+
+// host-compute "host" execution context
+// NOTE: one of these exists per kernel execution, all worker threads executing the kernel point to it
+struct host_exec_context_t {
+	host_kernel_call_t kernel_func;
+	uint32_t work_dim { 1u };
+	uint3 global_work_size;
+	uint3 local_work_size;
+	uint3 group_size;
+	uint32_t linear_local_work_size { 1u };
+	
+	// local memory management
+	atomic<uint32_t> local_memory_alloc_offset { 0u };
+	atomic<bool> local_memory_exceeded { false };
+	
+	// grid-wide barrier (only set for cooperative executions)
+	host_grid_barrier_t* grid_barrier { nullptr };
+	
+#if defined(FLOOR_HOST_COMPUTE_MT_ITEM)
+	// barrier handling
+	atomic<uint32_t> barrier_counter { 0 };
+	atomic<uint32_t> barrier_gen { 0 };
+	uint32_t barrier_users { 0 };
+#endif
+};
+static thread_local host_exec_context_t* host_exec_context { nullptr };
+
+//! makes "ctx" the execution context of the calling thread and sets up all id handling vars accordingly
+static void floor_set_host_exec_context(host_exec_context_t& ctx) {
+	host_exec_context = &ctx;
+	floor_work_dim = ctx.work_dim;
+	floor_global_work_size = ctx.global_work_size;
+	floor_local_work_size = ctx.local_work_size;
+	floor_group_size = ctx.group_size;
 }
 
 // host-compute device execution context
 struct device_exec_context_t {
 	elf_binary::instance_ids_t* ids { nullptr };
-	function<void()> kernel_func;
+	host_kernel_call_t kernel_func;
+	//! grid-wide barrier (only set for cooperative executions)
+	host_grid_barrier_t* grid_barrier { nullptr };
 };
 static thread_local device_exec_context_t device_exec_context;
 
+// cooperative execution state of a worker thread
+// NOTE: all work-groups of a cooperative execution must be resident at once, but there may be more groups than worker threads
+//       -> each worker executes a contiguous range of groups, with the work-items of all of its groups being fibers that are
+//          multiplexed onto the worker thread (group #i of the worker uses the fibers [i * local_size, (i + 1) * local_size)):
+//          when the last work-item of a group reaches a global barrier, execution continues with the next group of the worker,
+//          only the last group of the worker waits at the grid barrier, then execution continues with the first group again
+// NOTE: local memory only exists once per worker thread (host) or per CPU instance (host-compute device),
+//       it is therefore saved/restored when switching between groups
+struct coop_worker_state_t {
+	//! first group (linear index) and #groups that are executed by this worker
+	uint32_t group_offset { 0u };
+	uint32_t group_count { 0u };
+	//! currently executed group (relative to "group_offset")
+	uint32_t cur_group { 0u };
+	//! #work-items per group
+	uint32_t local_size { 0u };
+	uint3 group_dim;
+	//! instance ids when executing on the host-compute device, nullptr when executing host kernels
+	elf_binary::instance_ids_t* device_ids { nullptr };
+	//! local memory of the instance when executing on the host-compute device
+	//! NOTE: host kernels use the local memory of the worker thread up to the current high-water mark
+	uint8_t* device_local_memory { nullptr };
+	size_t device_local_memory_size { 0u };
+	//! saved local memory of all groups of this worker
+	vector<uint8_t> local_memory_storage;
+	
+	//! returns the first group and #groups that are executed by worker "worker_idx" when distributing "total_group_count" groups
+	//! onto "worker_count" workers (the first "total_group_count % worker_count" workers execute one additional group)
+	static pair<uint32_t, uint32_t> get_group_range(const uint32_t total_group_count, const uint32_t worker_count,
+													const uint32_t worker_idx) {
+		const auto base_count = total_group_count / worker_count;
+		const auto remainder = total_group_count % worker_count;
+		return {
+			worker_idx * base_count + std::min(worker_idx, remainder),
+			base_count + (worker_idx < remainder ? 1u : 0u)
+		};
+	}
+	
+	//! sets up the state for executing the groups of worker "worker_idx" (out of "worker_count"), returns the #groups of the worker
+	uint32_t init(const uint32_t worker_idx, const uint32_t worker_count, const uint3& group_dim_, const uint32_t local_size_,
+				  elf_binary::instance_t* device_instance) {
+		group_dim = group_dim_;
+		tie(group_offset, group_count) = get_group_range(group_dim.x * group_dim.y * group_dim.z, worker_count, worker_idx);
+		local_size = local_size_;
+		device_ids = (device_instance != nullptr ? &device_instance->ids : nullptr);
+		device_local_memory = (device_instance != nullptr ? device_instance->get_rw_memory() : nullptr);
+		device_local_memory_size = (device_instance != nullptr ? device_instance->get_rw_memory_size() : 0u);
+		if (group_count > 1u) {
+			const auto storage_size = get_local_memory_stride() * group_count;
+			if (local_memory_storage.size() < storage_size) {
+				local_memory_storage.resize(storage_size);
+			}
+		}
+		return group_count;
+	}
+	
+	//! sets the group ids and the fibers of the current group (must be called after init)
+	void set_cur_group(const uint32_t group) {
+		cur_group = group;
+		const auto group_linear_idx = group_offset + cur_group;
+		const uint3 group_id {
+			group_linear_idx % group_dim.x,
+			(group_linear_idx / group_dim.x) % group_dim.y,
+			group_linear_idx / (group_dim.x * group_dim.y)
+		};
+		if (device_ids != nullptr) {
+			device_ids->instance_group_idx = group_id;
+		} else {
+			floor_group_idx = group_id;
+		}
+		item_contexts = &worker_fibers.items[cur_group * local_size];
+	}
+	
+	//! switches from the current group to "next_group" (relative to "group_offset"): saves the local memory of the current group,
+	//! restores the local memory of the next group and sets its group ids and fibers
+	void switch_group(const uint32_t next_group) {
+		if (next_group == cur_group) {
+			return;
+		}
+		
+		const auto stride = get_local_memory_stride();
+		auto local_memory = device_local_memory;
+		auto local_memory_size = device_local_memory_size;
+		if (device_ids == nullptr) {
+			local_memory = floor_local_memory_data.get() + floor_thread_local_memory_offset;
+			local_memory_size = floor_local_memory_high_water.load(memory_order_relaxed);
+		}
+		if (local_memory_size > 0u) {
+			memcpy(&local_memory_storage[cur_group * stride], local_memory, local_memory_size);
+			memcpy(local_memory, &local_memory_storage[next_group * stride], local_memory_size);
+		}
+		set_cur_group(next_group);
+	}
+	
+	//! the last work-item of the current group has reached a global barrier:
+	//! continues with the next group of this worker or waits for all other workers if this is the last group,
+	//! returns once the last work-item of the current group is executed again (after all work-items of the group have passed
+	//! the barrier), exits to the main context if the execution has been aborted
+	void enter_global_barrier(host_grid_barrier_t& grid_barrier, const uint32_t local_linear_idx) {
+		fiber_context* this_ctx = &item_contexts[local_linear_idx];
+		if (cur_group + 1u < group_count) {
+			switch_group(cur_group + 1u);
+		} else {
+			if (!grid_barrier.wait()) {
+				this_ctx->exit_to_main();
+			}
+			switch_group(0u);
+		}
+		// NOTE: nothing to switch to if this is the only work-item of this worker
+		if (this_ctx != &item_contexts[0]) {
+			this_ctx->swap_context(&item_contexts[0]);
+		}
+	}
+	
+protected:
+	size_t get_local_memory_stride() const {
+		return (device_ids != nullptr ? device_local_memory_size : floor_local_memory_max_size);
+	}
+};
+static thread_local coop_worker_state_t coop_worker_state;
+
+//! runs all work-groups of a cooperative execution of the calling worker thread
+//! NOTE: "coop_worker_state" and "worker_fibers" must have been set up for this
+static void run_coop_worker_groups() {
+	auto& coop = coop_worker_state;
+	const auto fiber_count = coop.group_count * coop.local_size;
+	for (uint32_t i = 0; i < fiber_count; ++i) {
+		worker_fibers.items[i].reset();
+	}
+	reset_sub_group_exchange(coop.local_size);
+	coop.set_cur_group(0u);
+#if defined(FLOOR_DEBUG)
+	unfinished_items = fiber_count;
+#endif
+	
+	// run all fibers/work-items, returns here once the last work-item of the last group has finished,
+	// or when the execution has been aborted
+	static thread_local volatile bool done;
+	done = false;
+	worker_fibers.main_ctx.get_context();
+	if (!done) {
+		done = true;
+		
+		// start first fiber
+		worker_fibers.items[0].set_context();
+	}
+}
+
 //
 host_kernel::host_kernel(const void* kernel_, const string& func_name_, compute_kernel::kernel_entry&& entry_) :
-kernel((const kernel_func_type)const_cast<void*>(kernel_)), func_name(func_name_), entry(move(entry_)) {
+kernel((const kernel_func_type)const_cast<void*>(kernel_)), func_name(func_name_), entry(move(entry_)),
+stack_usage(elf_binary::get_loaded_stack_size(kernel_)) {
 }
 
 host_kernel::host_kernel(kernel_map_type&& kernels_) : kernels(move(kernels_)) {
@@ -589,70 +1288,97 @@ typename host_kernel::kernel_map_type::const_iterator host_kernel::get_kernel(co
 	return kernels.find((const host_device&)cqueue.get_device());
 }
 
-static function<void()> make_callable_kernel_function(const host_kernel::kernel_func_type kernel_ptr, const vector<const void*>& vptr_args) {
-	function<void()> kernel_func;
-	switch (vptr_args.size()) {
-		case 0: kernel_func = [kernel_ptr]() { (*kernel_ptr)(); }; break;
-
-#define EXPAND_1(var, offset) var[0 + offset]
-#define EXPAND_2(var, offset) var[0 + offset], var[1 + offset]
-#define EXPAND_3(var, offset) var[0 + offset], var[1 + offset], var[2 + offset]
-#define EXPAND_4(var, offset) var[0 + offset], var[1 + offset], var[2 + offset], var[3 + offset]
-#define EXPAND_5(var, offset) var[0 + offset], var[1 + offset], var[2 + offset], var[3 + offset], var[4 + offset]
-#define EXPAND_6(var, offset) var[0 + offset], var[1 + offset], var[2 + offset], var[3 + offset], var[4 + offset], var[5 + offset]
-#define EXPAND_7(var, offset) var[0 + offset], var[1 + offset], var[2 + offset], var[3 + offset], var[4 + offset], var[5 + offset], var[6 + offset]
-#define EXPAND_8(var, offset) var[0 + offset], var[1 + offset], var[2 + offset], var[3 + offset], var[4 + offset], var[5 + offset], var[6 + offset], var[7 + offset]
-		
-		case 1: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_1(vptr_args, 0)); }; break;
-		case 2: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_2(vptr_args, 0)); }; break;
-		case 3: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_3(vptr_args, 0)); }; break;
-		case 4: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_4(vptr_args, 0)); }; break;
-		case 5: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_5(vptr_args, 0)); }; break;
-		case 6: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_6(vptr_args, 0)); }; break;
-		case 7: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_7(vptr_args, 0)); }; break;
-		case 8: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0)); }; break;
-		
-		case 9: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_1(vptr_args, 8)); }; break;
-		case 10: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_2(vptr_args, 8)); }; break;
-		case 11: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_3(vptr_args, 8)); }; break;
-		case 12: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_4(vptr_args, 8)); }; break;
-		case 13: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_5(vptr_args, 8)); }; break;
-		case 14: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_6(vptr_args, 8)); }; break;
-		case 15: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_7(vptr_args, 8)); }; break;
-		case 16: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8)); }; break;
-		
-		case 17: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_1(vptr_args, 16)); }; break;
-		case 18: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_2(vptr_args, 16)); }; break;
-		case 19: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_3(vptr_args, 16)); }; break;
-		case 20: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_4(vptr_args, 16)); }; break;
-		case 21: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_5(vptr_args, 16)); }; break;
-		case 22: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_6(vptr_args, 16)); }; break;
-		case 23: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_7(vptr_args, 16)); }; break;
-		case 24: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16)); }; break;
-		
-		case 25: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_1(vptr_args, 24)); }; break;
-		case 26: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_2(vptr_args, 24)); }; break;
-		case 27: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_3(vptr_args, 24)); }; break;
-		case 28: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_4(vptr_args, 24)); }; break;
-		case 29: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_5(vptr_args, 24)); }; break;
-		case 30: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_6(vptr_args, 24)); }; break;
-		case 31: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_7(vptr_args, 24)); }; break;
-		case 32: kernel_func = [kernel_ptr, &vptr_args]() { (*kernel_ptr)(EXPAND_8(vptr_args, 0), EXPAND_8(vptr_args, 8), EXPAND_8(vptr_args, 16), EXPAND_8(vptr_args, 24)); }; break;
-		
-#undef EXPAND_1
-#undef EXPAND_2
-#undef EXPAND_3
-#undef EXPAND_4
-#undef EXPAND_5
-#undef EXPAND_6
-#undef EXPAND_7
-#undef EXPAND_8
+//! kernel args and execution parameters of a single kernel execution
+//! NOTE: these are pooled and reused by all executions, with storage being retained (grow-only),
+//!       so that no heap allocations are necessary once the pool has warmed up
+struct host_kernel_args_t {
+	//! amount of kernel args that can be stored without any allocation
+	//! NOTE: must be at least 8 (see floor_call_kernel)
+	static constexpr const uint32_t inline_arg_count { 32u };
+	//! amount of generic arg data (in bytes) that can be stored without any allocation
+	static constexpr const size_t inline_generic_data_size { 2048u };
+	//! each generic arg is stored with this alignment
+	static constexpr const size_t generic_arg_alignment { 64u };
+	
+	static constexpr size_t align_generic_arg_size(const size_t& size) {
+		return ((size + generic_arg_alignment - 1u) / generic_arg_alignment) * generic_arg_alignment;
+	}
+	
+	// execution parameters
+	const host_queue* queue { nullptr };
+	//! time at which this execution was enqueued (only set if kernel events are logged)
+	uint64_t queued_time { 0u };
+	bool is_cooperative { false };
+	uint32_t work_dim { 1u };
+	uint3 global_work_size;
+	uint3 local_work_size;
+	
+	//! -> inline_args or overflow_args
+	const void** args { nullptr };
+	uint32_t arg_count { 0u };
+	//! -> inline_generic_data or overflow_generic_data
+	uint8_t* generic_data { nullptr };
+	
+	alignas(generic_arg_alignment) uint8_t inline_generic_data[inline_generic_data_size];
+	const void* inline_args[inline_arg_count];
+	unique_ptr<const void*[]> overflow_args;
+	uint32_t overflow_arg_count { 0u };
+	aligned_ptr<uint8_t> overflow_generic_data;
+	size_t overflow_generic_data_size { 0u };
+	
+	//! sets up storage for "arg_count_" args and "generic_data_size" bytes of generic arg data
+	void prepare(const uint32_t arg_count_, const size_t generic_data_size) {
+		arg_count = arg_count_;
+		if (arg_count <= inline_arg_count) {
+			args = inline_args;
+		} else {
+			if (arg_count > overflow_arg_count) {
+				overflow_args = make_unique<const void*[]>(arg_count);
+				overflow_arg_count = arg_count;
+			}
+			args = overflow_args.get();
+		}
 		
-		default:
-			log_error("too many kernel parameters specified (only up to 32 parameters are supported)");
-			return {};
+		if (generic_data_size <= inline_generic_data_size) {
+			generic_data = inline_generic_data;
+		} else {
+			if (generic_data_size > overflow_generic_data_size) {
+				overflow_generic_data = make_aligned_ptr<uint8_t>(generic_data_size);
+				overflow_generic_data_size = generic_data_size;
+			}
+			generic_data = overflow_generic_data.get();
+		}
+	}
+	
+	//! returns a call of "func" with these args
+	host_kernel_call_t make_call(host_kernel::kernel_func_type func) const {
+		return { func, args, arg_count };
+	}
+};
+static_assert(host_kernel_args_t::inline_arg_count >= 8u, "must be able to store at least 8 args");
+
+//! all currently unused kernel args
+static struct {
+	mutex lock;
+	vector<unique_ptr<host_kernel_args_t>> unused;
+} host_kernel_args_pool;
+
+static host_kernel_args_ptr acquire_host_kernel_args() {
+	{
+		lock_guard<mutex> lock(host_kernel_args_pool.lock);
+		if (!host_kernel_args_pool.unused.empty()) {
+			host_kernel_args_ptr kernel_args(host_kernel_args_pool.unused.back().release());
+			host_kernel_args_pool.unused.pop_back();
+			return kernel_args;
+		}
 	}
-	return kernel_func;
+	return host_kernel_args_ptr(new host_kernel_args_t());
+}
+
+void host_kernel_args_deleter::operator()(host_kernel_args_t* kernel_args) const {
+	kernel_args->queue = nullptr;
+	lock_guard<mutex> lock(host_kernel_args_pool.lock);
+	host_kernel_args_pool.unused.emplace_back(kernel_args);
 }
 
 void host_kernel::execute(const compute_queue& cqueue,
@@ -660,122 +1386,230 @@ void host_kernel::execute(const compute_queue& cqueue,
 						  const uint32_t& work_dim,
 						  const uint3& global_work_size,
 						  const uint3& local_work_size,
-						  const vector<compute_kernel_arg>& args) const {
-	// no cooperative support yet
-	if (is_cooperative) {
-		log_error("cooperative kernel execution is not supported for Host-Compute");
+						  const span<const compute_kernel_arg> args) const {
+	const auto& hqueue = (const host_queue&)cqueue;
+	auto kernel_args = create_kernel_args(hqueue, is_cooperative, work_dim, global_work_size, local_work_size, args);
+	if (!kernel_args) {
 		return;
 	}
 	
+	// enqueue execution
+	// NOTE: everything is stored in the kernel args, so that the command itself fits into the small buffer of function<>
+	hqueue.submit([this, kernel_args_ptr = kernel_args.release()]() {
+		host_kernel_args_ptr exec_kernel_args(kernel_args_ptr);
+		execute_internal(*exec_kernel_args);
+	});
+}
+
+host_kernel_args_ptr host_kernel::create_kernel_args(const host_queue& cqueue,
+													 const bool is_cooperative,
+													 const uint32_t work_dim,
+													 const uint3& global_work_size,
+													 const uint3& local_work_size,
+													 const span<const compute_kernel_arg> args) const {
+#if !defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+	// cooperative execution is only supported with the mt-group execution model (or when using host-compute device kernels)
+	if (is_cooperative && kernel != nullptr) {
+		log_error("cooperative kernel execution is only supported for the mt-group execution model");
+		return {};
+	}
+#endif
+	
+	if (args.size() > floor_max_kernel_arg_count) {
+		log_error("too many kernel parameters specified (only up to %u parameters are supported)", floor_max_kernel_arg_count);
+		return {};
+	}
+	
+	// execution happens asynchronously (on the scheduler thread of the queue), but generic args are only referenced
+	// by the caller (usually on its stack) -> copy all generic arg data into storage that is owned by this execution
+	size_t generic_args_size = 0;
+	for (const auto& arg : args) {
+		if (holds_alternative<const void*>(arg.var)) {
+			generic_args_size += host_kernel_args_t::align_generic_arg_size(arg.size);
+		}
+	}
+	auto kernel_args = acquire_host_kernel_args();
+	kernel_args->queue = &cqueue;
+	kernel_args->queued_time = (cqueue.is_kernel_event_logging() ? compute_queue::get_kernel_event_time() : 0u);
+	kernel_args->is_cooperative = is_cooperative;
+	kernel_args->work_dim = work_dim;
+	kernel_args->global_work_size = global_work_size;
+	kernel_args->local_work_size = local_work_size;
+	kernel_args->prepare(uint32_t(args.size()), generic_args_size);
+	auto generic_arg_data = kernel_args->generic_data;
+	
 	// extract/handle kernel arguments
-	vector<const void*> vptr_args;
-	vptr_args.reserve(args.size());
+	auto vptr_args = kernel_args->args;
 	for (const auto& arg : args) {
 		if (auto buf_ptr = get_if<const compute_buffer*>(&arg.var)) {
-			vptr_args.emplace_back(((const host_buffer*)(*buf_ptr))->get_host_buffer_ptr());
+			*vptr_args++ = ((const host_buffer*)(*buf_ptr))->get_host_buffer_ptr();
 		} else if (auto vec_buf_ptrs = get_if<const vector<compute_buffer*>*>(&arg.var)) {
 			log_error("array of buffers is not yet supported for Host-Compute");
-			return;
+			return {};
 		} else if (auto vec_buf_sptrs = get_if<const vector<shared_ptr<compute_buffer>>*>(&arg.var)) {
 			log_error("array of buffers is not yet supported for Host-Compute");
-			return;
+			return {};
 		} else if (auto img_ptr = get_if<const compute_image*>(&arg.var)) {
-			vptr_args.emplace_back(((const host_image*)(*img_ptr))->get_host_image_program_info());
+			*vptr_args++ = ((const host_image*)(*img_ptr))->get_host_image_program_info();
 		} else if (auto vec_img_ptrs = get_if<const vector<compute_image*>*>(&arg.var)) {
 			log_error("array of images is not supported for Host-Compute");
-			return;
+			return {};
 		} else if (auto vec_img_sptrs = get_if<const vector<shared_ptr<compute_image>>*>(&arg.var)) {
 			log_error("array of images is not supported for Host-Compute");
-			return;
+			return {};
 		} else if (auto arg_buf_ptr = get_if<const argument_buffer*>(&arg.var)) {
 			const auto storage_buffer = (const host_buffer*)(*arg_buf_ptr)->get_storage_buffer();
-			vptr_args.emplace_back(storage_buffer->get_host_buffer_ptr());
+			*vptr_args++ = storage_buffer->get_host_buffer_ptr();
 		} else if (auto generic_arg_ptr = get_if<const void*>(&arg.var)) {
-			vptr_args.emplace_back(*generic_arg_ptr);
+			memcpy(generic_arg_data, *generic_arg_ptr, arg.size);
+			*vptr_args++ = generic_arg_data;
+			generic_arg_data += host_kernel_args_t::align_generic_arg_size(arg.size);
 		} else {
 			log_error("encountered invalid arg");
-			return;
+			return {};
 		}
 	}
 	
-	// init max thread count (once!)
-	if (floor_max_thread_count == 0) {
-		floor_max_thread_count = core::get_hw_thread_count();
+	return kernel_args;
+}
+
+void host_kernel::execute_internal(const host_kernel_args_t& kernel_args, const uint64_t queued_time) const {
+	const auto& cqueue = *kernel_args.queue;
+	const auto is_event_logging = cqueue.is_kernel_event_logging();
+	const auto is_tracing = floor_trace::is_enabled();
+	if (!is_event_logging && !is_tracing) {
+		dispatch(kernel_args);
+		return;
 	}
 	
-	// device cpu count must be <= h/w thread count, b/c local memory is only allocated for such many threads
-	const auto cpu_count = cqueue.get_device().units;
-	if (cpu_count > floor_max_thread_count) {
-		log_error("device cpu count exceeds h/w count");
-		return;
+	string kernel_name;
+	if (kernel != nullptr) {
+		kernel_name = func_name;
+	} else if (const auto kernel_iter = get_kernel(cqueue); kernel_iter != kernels.cend() && kernel_iter->second.info != nullptr) {
+		kernel_name = kernel_iter->second.info->name;
 	}
 	
-	// only a single kernel can be active/executed at one time
-	// TODO: can this be "fixed" by host-compute device execution?
-	static safe_mutex exec_lock {};
+	const auto start_time = compute_queue::get_kernel_event_time();
 	{
-		GUARD(exec_lock);
-		
-		const uint3 local_dim { check_local_work_size(entry, local_work_size).maxed(1u) };
-		const uint3 group_dim_overflow {
-			global_work_size.x > 0 ? std::min(uint32_t(global_work_size.x % local_dim.x), 1u) : 0u,
-			global_work_size.y > 0 ? std::min(uint32_t(global_work_size.y % local_dim.y), 1u) : 0u,
-			global_work_size.z > 0 ? std::min(uint32_t(global_work_size.z % local_dim.z), 1u) : 0u
-		};
-		uint3 group_dim { (global_work_size / local_dim) + group_dim_overflow };
-		group_dim.max(1u);
-		
-		const auto mod_groups = global_work_size % local_dim;
-		uint3 group_size = global_work_size / local_dim;
-		if (mod_groups.x > 0) ++group_size.x;
-		if (mod_groups.y > 0) ++group_size.y;
-		if (mod_groups.z > 0) ++group_size.z;
-		
-		// alloc stack memory (for all threads) if it hasn't been allocated yet
-		floor_alloc_host_stack_memory();
-
-		// device or host execution?
-		// NOTE: when using a kernel that has been compiled into the program (not host-compute device), "kernel" will be non-nullptr
-		if (kernel == nullptr) {
-			// -> device execution
-			const auto kernel_iter = get_kernel(cqueue);
-			if (kernel_iter == kernels.cend() || kernel_iter->second.program == nullptr) {
-				log_error("no program for this compute queue/device exists!");
-				return;
-			}
-			execute_device(kernel_iter->second, cpu_count, group_dim, local_dim, work_dim, vptr_args);
-		} else {
-			// -> host execution
-			auto kernel_func = make_callable_kernel_function(kernel, vptr_args);
-			if (!kernel_func) {
-				return;
-			}
-			
-			// setup/reset id and other global variables
-			floor_work_dim = work_dim;
-			floor_global_work_size = global_work_size;
-			floor_local_work_size = local_dim;
-			floor_group_size = group_size;
-			
-			floor_linear_global_work_size = floor_global_work_size.x * floor_global_work_size.y * floor_global_work_size.z;
-			floor_linear_local_work_size = local_dim.x * local_dim.y * local_dim.z;
-			floor_linear_group_size = floor_group_size.x * floor_group_size.y * floor_group_size.z;
-			
-			// setup local memory management
-			local_memory_alloc_offset = 0;
-			local_memory_exceeded = false;
-			// alloc local (for all threads) if it hasn't been allocated yet
-			floor_alloc_host_local_memory();
-			
-			cur_kernel_function = &kernel_func;
-			execute_host(cpu_count, group_dim, local_dim);
-			cur_kernel_function = nullptr;
+		floor_trace::scope trace_scope("kernel", is_tracing ? floor_trace::intern(kernel_name) : "");
+		dispatch(kernel_args);
+	}
+	const auto end_time = compute_queue::get_kernel_event_time();
+	
+	if (!is_event_logging) {
+		return;
+	}
+	cqueue.add_kernel_event({
+		.kernel_name = move(kernel_name),
+		.queued = (queued_time != 0u ? queued_time : (kernel_args.queued_time != 0u ? kernel_args.queued_time : start_time)),
+		.start = start_time,
+		.end = end_time,
+	});
+}
+
+void host_kernel::dispatch(const host_kernel_args_t& kernel_args) const {
+	const auto& cqueue = *kernel_args.queue;
+	const auto is_cooperative = kernel_args.is_cooperative;
+	const auto work_dim = kernel_args.work_dim;
+	const auto global_work_size = kernel_args.global_work_size;
+	const auto local_work_size = kernel_args.local_work_size;
+	
+	// init max thread count + alloc stack and local memory (for all threads) (once!)
+	static once_flag init_once;
+	call_once(init_once, [] {
+		floor_max_thread_count = core::get_hw_thread_count();
+		floor_alloc_host_local_memory();
+	});
+	
+	// the cpu range of the queue must be inside the h/w thread count, b/c local/stack memory is only allocated for such many threads
+	const auto& dev = (const host_device&)cqueue.get_device();
+	const auto cpu_offset = cqueue.get_cpu_offset();
+	const auto cpu_count = cqueue.get_cpu_count();
+	if (cpu_offset + cpu_count > floor_max_thread_count) {
+		log_error("queue cpu range exceeds h/w count");
+		return;
+	}
+	if (!dev.worker_pool || dev.worker_pool->get_worker_count() < cpu_offset + cpu_count) {
+		log_error("no or insufficient worker threads for device");
+		return;
+	}
+	auto& worker_pool = *dev.worker_pool;
+	
+	// NOTE: there is no global execution lock: all execution state is either kept in a per-execution context
+	// (host_exec_context_t or the per-CPU instance ids for host-compute device execution) or is owned by a worker thread,
+	// and each worker thread only executes one kernel at a time
+	// -> multiple queues can execute kernels concurrently (in parallel when using disjoint cpu ranges)
+	const uint3 local_dim { check_local_work_size(entry, local_work_size).maxed(1u) };
+	const uint3 group_dim_overflow {
+		global_work_size.x > 0 ? std::min(uint32_t(global_work_size.x % local_dim.x), 1u) : 0u,
+		global_work_size.y > 0 ? std::min(uint32_t(global_work_size.y % local_dim.y), 1u) : 0u,
+		global_work_size.z > 0 ? std::min(uint32_t(global_work_size.z % local_dim.z), 1u) : 0u
+	};
+	uint3 group_dim { (global_work_size / local_dim) + group_dim_overflow };
+	group_dim.max(1u);
+	
+	const auto mod_groups = global_work_size % local_dim;
+	uint3 group_size = global_work_size / local_dim;
+	if (mod_groups.x > 0) ++group_size.x;
+	if (mod_groups.y > 0) ++group_size.y;
+	if (mod_groups.z > 0) ++group_size.z;
+	
+	// cooperative execution: all work-groups must be resident at the same time, with each worker thread executing a fixed range
+	// of work-groups whose work-items are multiplexed as fibers onto the worker thread (see coop_worker_state_t)
+	// -> only use as many worker threads as there are groups, all of them take part in the grid-wide barrier
+	// NOTE: the grid size is limited by the amount of resident groups per CPU (see host_queue::get_max_cooperative_group_count
+	//       and compute_device::max_coop_group_count)
+	unique_ptr<host_grid_barrier_t> grid_barrier;
+	uint32_t exec_cpu_count = cpu_count;
+	if (is_cooperative) {
+		const auto group_count = group_dim.x * group_dim.y * group_dim.z;
+		const auto max_group_count = cqueue.get_max_cooperative_group_count();
+		if (group_count > max_group_count) {
+			log_error("cooperative kernel execution requires all work-groups to be resident at once: "
+					  "%u work-groups exceed the max cooperative group count of %u of the queue", group_count, max_group_count);
+			return;
 		}
+		exec_cpu_count = std::min(group_count, cpu_count);
+		grid_barrier = make_unique<host_grid_barrier_t>(exec_cpu_count);
+	}
+	
+	// device or host execution?
+	// NOTE: when using a kernel that has been compiled into the program (not host-compute device), "kernel" will be non-nullptr
+	if (kernel == nullptr) {
+		// -> device execution
+		const auto kernel_iter = get_kernel(cqueue);
+		if (kernel_iter == kernels.cend() || kernel_iter->second.program == nullptr) {
+			log_error("no program for this compute queue/device exists!");
+			return;
+		}
+		execute_device(worker_pool, kernel_iter->second, cpu_offset, exec_cpu_count, (const host_queue&)cqueue,
+					   grid_barrier.get(), group_dim, local_dim, work_dim, kernel_args);
+	} else {
+		// -> host execution
+		// setup execution context (ids, sizes, local memory management)
+		host_exec_context_t ctx;
+		ctx.kernel_func = kernel_args.make_call(kernel);
+		ctx.work_dim = work_dim;
+		ctx.global_work_size = global_work_size;
+		ctx.local_work_size = local_dim;
+		ctx.group_size = group_size;
+		ctx.linear_local_work_size = local_dim.x * local_dim.y * local_dim.z;
+		ctx.grid_barrier = grid_barrier.get();
+		
+		execute_host(worker_pool, ctx, cpu_offset, exec_cpu_count, (const host_queue&)cqueue, group_dim, local_dim);
 	}
 }
 
-void host_kernel::execute_host(const uint32_t& cpu_count, const uint3& group_dim, const uint3& local_dim) const {
+void host_kernel::execute_host(host_worker_pool& worker_pool floor_unused,
+							   host_exec_context_t& ctx,
+							   const uint32_t& cpu_offset floor_unused,
+							   const uint32_t& cpu_count floor_unused,
+							   const host_queue& cqueue floor_unused,
+							   const uint3& group_dim,
+							   const uint3& local_dim) const {
 #if defined(FLOOR_HOST_COMPUTE_ST) // single-threaded
+	floor_set_host_exec_context(ctx);
+	
 	// it's usually best to go from largest to smallest loop count (usually: X > Y > Z)
 	uint3& global_idx = floor_global_idx;
 	uint3& local_idx = floor_local_idx;
@@ -797,7 +1631,7 @@ void host_kernel::execute_host(const uint32_t& cpu_count, const uint3& group_dim
 						local_idx.x = 0;
 						global_idx.x = group_x * local_dim.x;
 						for(; local_idx.x < local_dim.x; ++local_idx.x, ++global_idx.x) {
-							kernel_func();
+							ctx.kernel_func();
 						}
 					}
 				}
@@ -813,9 +1647,9 @@ void host_kernel::execute_host(const uint32_t& cpu_count, const uint3& group_dim
 	atomic<uint32_t> group_id { ~0u };
 	
 	// init barrier vars
-	barrier_counter = local_size;
-	barrier_gen = 0;
-	barrier_users = local_size;
+	ctx.barrier_counter = local_size;
+	ctx.barrier_gen = 0;
+	ctx.barrier_users = local_size;
 	
 	// start worker threads
 	vector<unique_ptr<thread>> worker_threads(local_size);
@@ -823,7 +1657,9 @@ void host_kernel::execute_host(const uint32_t& cpu_count, const uint3& group_dim
 		worker_threads[local_linear_idx] = make_unique<thread>([&items_in_flight, &group_id,
 																local_linear_idx, local_size,
 																local_dim, group_dim,
-																this, &kernel_func] {
+																&ctx] {
+			floor_set_host_exec_context(ctx);
+			
 			// local id is fixed for all execution
 			const uint3 local_id {
 				local_linear_idx % local_dim.x,
@@ -881,7 +1717,7 @@ void host_kernel::execute_host(const uint32_t& cpu_count, const uint3& group_dim
 						floor_global_idx = global_id;
 						
 						// finally: execute work-item
-						kernel_func();
+						ctx.kernel_func();
 						
 						// work-item done
 						--items_in_flight;
@@ -899,101 +1735,160 @@ void host_kernel::execute_host(const uint32_t& cpu_count, const uint3& group_dim
 	const auto group_count = group_dim.x * group_dim.y * group_dim.z;
 	// #work-items per group
 	const uint32_t local_size = local_dim.x * local_dim.y * local_dim.z;
-	// group ticketing system, each worker thread will grab a new group id, once it's done with one group
-	atomic<uint32_t> group_idx { 0 };
+	// work-stealing group scheduler, each worker thread takes chunks of groups from its own range or steals from others
+	// NOTE: the scheduler isn't used by cooperative executions (each worker executes a fixed range of resident groups)
+	const auto collect_stats = (ctx.grid_barrier == nullptr &&
+								(floor_host_kernel_collect_stats || cqueue.is_scheduler_stats_collection()));
+	host_group_scheduler scheduler(group_count, cpu_count, cqueue.get_group_chunk_size(), collect_stats);
+	// per-item stack size: sized by the stack usage estimate of the kernel function if known, the default otherwise
+	const auto stack_size = get_item_stack_size(stack_usage);
 	
-	// start worker threads
+	// run on all worker threads
 #if defined(FLOOR_HOST_KERNEL_ENABLE_TIMING)
 	const auto time_start = floor_timer::start();
 #endif
-	vector<unique_ptr<thread>> worker_threads(cpu_count);
-	for(uint32_t cpu_idx = 0; cpu_idx < cpu_count; ++cpu_idx) {
-		worker_threads[cpu_idx] = make_unique<thread>([this, cpu_idx,
-													   &group_idx, group_count, group_dim,
-													   local_size, local_dim] {
-			// set cpu affinity for this thread to a particular cpu to prevent this thread from being constantly moved/scheduled
-			// on different cpus (starting at index 1, with 0 representing no affinity)
-			floor_set_thread_affinity(cpu_idx + 1);
+	const host_worker_pool::job_type job = [this, &ctx, &scheduler, cpu_offset, cpu_count, group_dim, local_size,
+											stack_size](const uint32_t cpu_idx) {
+		// set the tls thread index for this (needed to compute local memory offsets)
+		floor_thread_idx = cpu_idx;
+		floor_thread_local_memory_offset = cpu_idx * floor_local_memory_max_size;
+		floor_set_host_exec_context(ctx);
+		
+		// fast path: barriers and sub-group operations are no-ops in work-groups that consist of a single work-item
+		// -> no need to switch fibers per group, run all groups of this worker one after another inside a single fiber
+		// NOTE: host kernels aren't compiled by the toolchain, so there is no USES_BARRIER flag from which barrier-freedom of
+		//       larger work-groups could be determined, cooperative executions always need per-item fibers (grid barrier)
+		// NOTE: the fiber is still needed, so that an exceeded local memory allocation can exit to the main context
+		if (local_size == 1u && ctx.grid_barrier == nullptr) {
+			if (!worker_fibers.prepare(cpu_idx, 1u, run_mt_single_item_groups, stack_size)) {
+				log_error("failed to setup fibers for kernel \"%s\" on CPU #%u", func_name, cpu_idx);
+				return;
+			}
+			const function<void()> groups_func = [&scheduler, cpu_idx, cpu_offset, group_dim]() {
+				scheduler.run(cpu_idx - cpu_offset, [group_dim](const uint32_t group_linear_idx) {
+					floor_group_idx = {
+						group_linear_idx % group_dim.x,
+						(group_linear_idx / group_dim.x) % group_dim.y,
+						group_linear_idx / (group_dim.x * group_dim.y)
+					};
+					run_mt_group_item(0u);
+					return true;
+				});
+			};
+			single_item_groups_func = &groups_func;
+			worker_fibers.items[0].reset();
 			
-			// set the tls thread index for this (needed to compute local memory offsets)
-			floor_thread_idx = cpu_idx;
-			floor_thread_local_memory_offset = cpu_idx * floor_local_memory_max_size;
+			static thread_local volatile bool single_done;
+			single_done = false;
+			worker_fibers.main_ctx.get_context();
+			if(!single_done) {
+				single_done = true;
+				worker_fibers.items[0].set_context();
+			}
+			single_item_groups_func = nullptr;
 			
-			// init contexts (aka fibers)
-			fiber_context main_ctx;
-			main_ctx.init(nullptr, 0, nullptr, ~0u, nullptr, nullptr);
-			auto items = make_unique<fiber_context[]>(local_size);
-			item_contexts = items.get();
+			if(ctx.local_memory_exceeded) {
+				log_error("exceeded local memory allocation in kernel \"%s\" - requested %u bytes, limit is %u bytes",
+						  func_name, ctx.local_memory_alloc_offset.load(), floor_local_memory_max_size);
+			}
+			return;
+		}
+		
+		// cooperative: all groups of this worker are resident at once (see coop_worker_state_t), abort all others on failure
+		if (ctx.grid_barrier != nullptr) {
+			const auto worker_group_count = coop_worker_state.init(cpu_idx - cpu_offset, cpu_count, group_dim, local_size, nullptr);
+			if (!worker_fibers.prepare(cpu_idx, worker_group_count * local_size, run_mt_coop_group_item, stack_size)) {
+				log_error("failed to setup fibers for kernel \"%s\" on CPU #%u", func_name, cpu_idx);
+				ctx.grid_barrier->abort();
+				return;
+			}
 			
-			// init fibers
-			for(uint32_t i = 0; i < local_size; ++i) {
-				items[i].init(&floor_stack_memory_data.get()[(i + local_size * cpu_idx) * fiber_context::min_stack_size],
-							  fiber_context::min_stack_size,
-							  run_mt_group_item, i,
-							  // continue with next on return, or return to main ctx when the last item returns
-							  // TODO: add option to use randomized order?
-							  (i + 1 < local_size ? &items[i + 1] : &main_ctx),
-							  &main_ctx);
+			run_coop_worker_groups();
+			
+			if (ctx.grid_barrier->aborted) {
+				return;
+			}
+			if (ctx.local_memory_exceeded) {
+				log_error("exceeded local memory allocation in kernel \"%s\" - requested %u bytes, limit is %u bytes",
+						  func_name, ctx.local_memory_alloc_offset.load(), floor_local_memory_max_size);
+				ctx.grid_barrier->abort();
+				return;
 			}
+#if defined(FLOOR_DEBUG)
+			if (unfinished_items > 0) {
+				log_error("barrier misuse detected in kernel \"%s\" - %u unfinished items in the groups of CPU #%u",
+						  func_name, unfinished_items, cpu_idx);
+				ctx.grid_barrier->abort();
+			}
+#endif
+			return;
+		}
+		
+		// setup contexts (aka fibers)
+		if (!worker_fibers.prepare(cpu_idx, local_size, run_mt_group_item, stack_size)) {
+			log_error("failed to setup fibers for kernel \"%s\" on CPU #%u", func_name, cpu_idx);
+			return;
+		}
+		auto& main_ctx = worker_fibers.main_ctx;
+		auto items = worker_fibers.items.get();
+		
+		const auto group_func = [&](const uint32_t group_linear_idx) {
+			// setup group
+			const uint3 group_id {
+				group_linear_idx % group_dim.x,
+				(group_linear_idx / group_dim.x) % group_dim.y,
+				group_linear_idx / (group_dim.x * group_dim.y)
+			};
+			floor_group_idx = group_id;
 			
-			for(;;) {
-				// assign a new group to this thread/cpu and check if we're done
-				const auto group_linear_idx = group_idx++;
-				if(group_linear_idx >= group_count) break;
-				
-				// setup group
-				const uint3 group_id {
-					group_linear_idx % group_dim.x,
-					(group_linear_idx / group_dim.x) % group_dim.y,
-					group_linear_idx / (group_dim.x * group_dim.y)
-				};
-				floor_group_idx = group_id;
-				
-				// reset fibers
-				for(uint32_t i = 0; i < local_size; ++i) {
-					items[i].reset();
-				}
+			// reset fibers
+			for(uint32_t i = 0; i < local_size; ++i) {
+				items[i].reset();
+			}
+			reset_sub_group_exchange(local_size);
 #if defined(FLOOR_DEBUG)
-				unfinished_items = local_size;
+			unfinished_items = local_size;
 #endif
+			
+			// run fibers/work-items for this group
+			static thread_local volatile bool done;
+			done = false;
+			main_ctx.get_context();
+			if(!done) {
+				done = true;
 				
-				// run fibers/work-items for this group
-				static thread_local volatile bool done;
-				done = false;
-				main_ctx.get_context();
-				if(!done) {
-					done = true;
-					
-					// start first fiber
-					items[0].set_context();
-				}
-				
-				// exit due to excessive local memory allocation?
-				if(local_memory_exceeded) {
-					log_error("exceeded local memory allocation in kernel \"%s\" - requested %u bytes, limit is %u bytes",
-							  func_name, local_memory_alloc_offset, floor_local_memory_max_size);
-					break;
-				}
-				
-				// check if any items are still unfinished (in a valid program, all must be finished at this point)
-				// NOTE: this won't detect all barrier misuses, doing so would require *a lot* of work
+				// start first fiber
+				items[0].set_context();
+			}
+			
+			// exit due to excessive local memory allocation?
+			if(ctx.local_memory_exceeded) {
+				log_error("exceeded local memory allocation in kernel \"%s\" - requested %u bytes, limit is %u bytes",
+						  func_name, ctx.local_memory_alloc_offset.load(), floor_local_memory_max_size);
+				return false;
+			}
+			
+			// check if any items are still unfinished (in a valid program, all must be finished at this point)
+			// NOTE: this won't detect all barrier misuses, doing so would require *a lot* of work
 #if defined(FLOOR_DEBUG)
-				if(unfinished_items > 0) {
-					log_error("barrier misuse detected in kernel \"%s\" - %u unfinished items in group %v",
-							  func_name, unfinished_items, group_id);
-					break;
-				}
-#endif
+			if(unfinished_items > 0) {
+				log_error("barrier misuse detected in kernel \"%s\" - %u unfinished items in group %v",
+						  func_name, unfinished_items, group_id);
+				return false;
 			}
-		});
-	}
-	// wait for worker threads to finish
-	for(auto& item : worker_threads) {
-		item->join();
-	}
+#endif
+			return true;
+		};
+		scheduler.run(cpu_idx - cpu_offset, group_func);
+	};
+	worker_pool.execute(cpu_offset, cpu_count, job);
 #if defined(FLOOR_HOST_KERNEL_ENABLE_TIMING)
 	log_debug("kernel time: %ums", double(floor_timer::stop<chrono::microseconds>(time_start)) / 1000.0);
+	scheduler.log_worker_stats(func_name);
 #endif
+	if (collect_stats) {
+		cqueue.set_scheduler_stats(scheduler.get_worker_stats());
+	}
 #endif
 }
 
@@ -1015,7 +1910,7 @@ extern "C" void run_mt_group_item(const uint32_t local_linear_idx) {
 	floor_global_idx = global_id;
 	
 	// execute work-item / kernel function
-	(*cur_kernel_function)();
+	host_exec_context->kernel_func();
 	
 	// for barrier misuse checking
 #if defined(FLOOR_DEBUG)
@@ -1023,125 +1918,214 @@ extern "C" void run_mt_group_item(const uint32_t local_linear_idx) {
 #endif
 }
 
-void host_kernel::execute_device(const host_kernel_entry& func_entry,
+extern "C" void run_mt_single_item_groups(const uint32_t local_linear_idx floor_unused) {
+	(*single_item_groups_func)();
+}
+
+extern "C" void run_mt_coop_group_item(const uint32_t fiber_idx) {
+	auto& coop = coop_worker_state;
+	run_mt_group_item(fiber_idx - coop.cur_group * coop.local_size);
+	
+	// the last work-item of a group finishes last, its fiber continues with the first work-item of the next group of this worker
+	if (fiber_idx + 1u == (coop.cur_group + 1u) * coop.local_size && coop.cur_group + 1u < coop.group_count) {
+		coop.switch_group(coop.cur_group + 1u);
+	}
+}
+
+void host_kernel::execute_device(host_worker_pool& worker_pool,
+								 const host_kernel_entry& func_entry,
+								 const uint32_t& cpu_offset,
 								 const uint32_t& cpu_count,
+								 const host_queue& cqueue,
+								 host_grid_barrier_t* grid_barrier,
 								 const uint3& group_dim,
 								 const uint3& local_dim,
 								 const uint32_t& work_dim,
-								 const vector<const void*>& vptr_args) const {
+								 const host_kernel_args_t& kernel_args) const {
 	// #work-groups
 	const auto group_count = group_dim.x * group_dim.y * group_dim.z;
 	// #work-items per group
 	const uint32_t local_size = local_dim.x * local_dim.y * local_dim.z;
-	// group ticketing system, each worker thread will grab a new group id, once it's done with one group
-	atomic<uint32_t> group_idx { 0 };
+	// work-stealing group scheduler, each worker thread takes chunks of groups from its own range or steals from others
+	// NOTE: the scheduler isn't used by cooperative executions (each worker executes a fixed range of resident groups)
+	const auto collect_stats = (grid_barrier == nullptr &&
+								(floor_host_kernel_collect_stats || cqueue.is_scheduler_stats_collection()));
+	host_group_scheduler scheduler(group_count, cpu_count, cqueue.get_group_chunk_size(), collect_stats);
 	
-	// start worker threads
+	// run on all worker threads
 #if defined(FLOOR_HOST_KERNEL_ENABLE_TIMING)
 	const auto time_start = floor_timer::start();
 #endif
 	atomic<bool> success { true };
-	vector<unique_ptr<thread>> worker_threads(cpu_count);
-	for (uint32_t cpu_idx = 0; cpu_idx < cpu_count; ++cpu_idx) {
-		worker_threads[cpu_idx] = make_unique<thread>([this, &success, cpu_idx, &func_entry, &vptr_args,
-													   &group_idx, group_count, group_dim,
-													   local_size, local_dim, work_dim] {
-			// set cpu affinity for this thread to a particular cpu to prevent this thread from being constantly moved/scheduled
-			// on different cpus (starting at index 1, with 0 representing no affinity)
-			floor_set_thread_affinity(cpu_idx + 1);
-			
-			// retrieve the instance for this CPU + reset/init it
-			auto instance = func_entry.program->get_instance(cpu_idx);
-			if (!instance) {
-				log_error("no instance for CPU #%u", cpu_idx);
-				success = false;
-				return;
-			}
-			instance->reset(local_dim * group_dim, local_dim, group_dim, work_dim);
-			device_exec_context.ids = &instance->ids;
-			auto& ids = instance->ids;
-			
-			// get and set the (kernel) function for this instance
-			const auto& func_info = *func_entry.info;
-			const auto func_iter = instance->functions.find(func_info.name);
-			if (func_iter == instance->functions.end()) {
-				log_error("failed to find function \"%s\" for CPU #%u", func_name, cpu_idx);
-				success = false;
-				return;
-			}
-			const auto func_ptr = (const kernel_func_type)const_cast<void*>(func_iter->second);
-			device_exec_context.kernel_func = make_callable_kernel_function(func_ptr, vptr_args);
-			if (!device_exec_context.kernel_func) {
-				log_error("failed to create kernel function for CPU #%u", cpu_idx);
-				success = false;
-				return;
-			}
-			
-			// init contexts (aka fibers)
-			fiber_context main_ctx;
-			main_ctx.init(nullptr, 0, nullptr, ~0u, nullptr, nullptr);
-			auto items = make_unique<fiber_context[]>(local_size);
-			item_contexts = items.get();
-			
-			// init fibers
-			for (uint32_t i = 0; i < local_size; ++i) {
-				items[i].init(&floor_stack_memory_data.get()[(i + local_size * cpu_idx) * fiber_context::min_stack_size],
-							  fiber_context::min_stack_size,
-							  run_host_device_group_item, i,
-							  // continue with next on return, or return to main ctx when the last item returns
-							  (i + 1 < local_size ? &items[i + 1] : &main_ctx),
-							  &main_ctx);
+	const host_worker_pool::job_type job = [this, &success, &func_entry, &kernel_args,
+											&scheduler, grid_barrier, cpu_offset, cpu_count, group_dim,
+											local_size, local_dim, work_dim](const uint32_t cpu_idx) {
+		// on failure, no other worker may wait for this one in a cooperative execution
+		const auto fail = [&success, grid_barrier]() {
+			success = false;
+			if (grid_barrier != nullptr) {
+				grid_barrier->abort();
 			}
-			
-			for (; success;) {
-				// assign a new group to this thread/cpu and check if we're done
-				const auto group_linear_idx = group_idx++;
-				if (group_linear_idx >= group_count) {
-					break;
-				}
-				
-				// setup group
-				const uint3 group_id {
+		};
+		
+		// retrieve the instance for this CPU + reset/init it
+		auto instance = func_entry.program->get_instance(cpu_idx);
+		if (!instance) {
+			log_error("no instance for CPU #%u", cpu_idx);
+			fail();
+			return;
+		}
+		instance->reset(local_dim * group_dim, local_dim, group_dim, work_dim);
+		device_exec_context.ids = &instance->ids;
+		auto& ids = instance->ids;
+		
+		// get and set the (kernel) function for this instance
+		const auto& func_info = *func_entry.info;
+		const auto func_iter = instance->functions.find(func_info.name);
+		if (func_iter == instance->functions.end()) {
+			log_error("failed to find function \"%s\" for CPU #%u", func_name, cpu_idx);
+			fail();
+			return;
+		}
+		const auto func_ptr = (const kernel_func_type)const_cast<void*>(func_iter->second);
+		device_exec_context.kernel_func = kernel_args.make_call(func_ptr);
+		device_exec_context.grid_barrier = grid_barrier;
+		
+		// fast path: kernels that don't use barriers don't need fibers, simply execute all work-items one after another
+		// NOTE: work-items are always executed one at a time here, there are no kernel variants that execute multiple
+		//       work-items per call (SIMD across work-items): this would require whole-function vectorization in the
+		//       host-compute compiler, which only emits scalar per-work-item kernels (any vectorization happens inside
+		//       a work-item, using FLOOR_COMPUTE_INFO_SIMD_WIDTH only for sub-group emulation)
+		if (!has_flag<llvm_toolchain::FUNCTION_FLAGS::USES_BARRIER>(func_info.flags)) {
+			item_contexts = nullptr;
+			const auto group_func = [&](const uint32_t group_linear_idx) {
+				ids.instance_group_idx = {
 					group_linear_idx % group_dim.x,
 					(group_linear_idx / group_dim.x) % group_dim.y,
 					group_linear_idx / (group_dim.x * group_dim.y)
 				};
-				ids.instance_group_idx = group_id;
+				const auto group_offset = ids.instance_group_idx * local_dim;
 				
-				// reset fibers
-				for(uint32_t i = 0; i < local_size; ++i) {
-					items[i].reset();
+				uint32_t local_linear_idx = 0;
+				for (uint32_t z = 0; z < local_dim.z; ++z) {
+					for (uint32_t y = 0; y < local_dim.y; ++y) {
+						for (uint32_t x = 0; x < local_dim.x; ++x, ++local_linear_idx) {
+							ids.instance_local_idx = { x, y, z };
+							ids.instance_local_linear_idx = local_linear_idx;
+							ids.instance_global_idx = group_offset + ids.instance_local_idx;
+							device_exec_context.kernel_func();
+						}
+					}
 				}
-#if defined(FLOOR_DEBUG)
-				unfinished_items = local_size;
-#endif
-				
-				// run fibers/work-items for this group
-				static thread_local volatile bool done;
-				done = false;
-				main_ctx.get_context();
-				if(!done) {
-					done = true;
-					
-					// start first fiber
-					items[0].set_context();
+				return true;
+			};
+			if (grid_barrier != nullptr) {
+				// cooperative: without barriers, the groups of this worker can simply be executed one after another
+				const auto group_range = coop_worker_state_t::get_group_range(group_dim.x * group_dim.y * group_dim.z,
+																			  cpu_count, cpu_idx - cpu_offset);
+				for (uint32_t group = 0; group < group_range.second; ++group) {
+					group_func(group_range.first + group);
 				}
+			} else {
+				scheduler.run(cpu_idx - cpu_offset, group_func);
+			}
+			device_exec_context.kernel_func = {};
+			device_exec_context.grid_barrier = nullptr;
+			return;
+		}
+		
+		// cooperative: all groups of this worker are resident at once (see coop_worker_state_t), abort all others on failure
+		if (grid_barrier != nullptr) {
+			const auto worker_group_count = coop_worker_state.init(cpu_idx - cpu_offset, cpu_count, group_dim, local_size, instance);
+			if (!worker_fibers.prepare(cpu_idx, worker_group_count * local_size, run_host_device_coop_group_item,
+									   get_item_stack_size(func_entry.stack_usage))) {
+				log_error("failed to setup fibers for kernel \"%s\" on CPU #%u", func_info.name, cpu_idx);
+				fail();
+			} else {
+				run_coop_worker_groups();
 				
-				// check if any items are still unfinished (in a valid program, all must be finished at this point)
-				// NOTE: this won't detect all barrier misuses, doing so would require *a lot* of work
+				if (grid_barrier->aborted) {
+					success = false;
+				}
 #if defined(FLOOR_DEBUG)
-				if (unfinished_items > 0) {
-					log_error("barrier misuse detected in kernel \"%s\" - %u unfinished items in group %v",
-							  func_name, unfinished_items, group_id);
-					break;
+				else if (unfinished_items > 0) {
+					log_error("barrier misuse detected in kernel \"%s\" - %u unfinished items in the groups of CPU #%u",
+							  func_name, unfinished_items, cpu_idx);
+					fail();
 				}
 #endif
 			}
-		});
-	}
-	// wait for worker threads to finish
-	for(auto& item : worker_threads) {
-		item->join();
+			device_exec_context.kernel_func = {};
+			device_exec_context.grid_barrier = nullptr;
+			return;
+		}
+		
+		// setup contexts (aka fibers)
+		if (!worker_fibers.prepare(cpu_idx, local_size, run_host_device_group_item, get_item_stack_size(func_entry.stack_usage))) {
+			log_error("failed to setup fibers for kernel \"%s\" on CPU #%u", func_info.name, cpu_idx);
+			fail();
+			return;
+		}
+		auto& main_ctx = worker_fibers.main_ctx;
+		auto items = worker_fibers.items.get();
+		
+		const auto group_func = [&](const uint32_t group_linear_idx) {
+			if (!success) {
+				return false;
+			}
+			
+			// setup group
+			const uint3 group_id {
+				group_linear_idx % group_dim.x,
+				(group_linear_idx / group_dim.x) % group_dim.y,
+				group_linear_idx / (group_dim.x * group_dim.y)
+			};
+			ids.instance_group_idx = group_id;
+			
+			// reset fibers
+			for(uint32_t i = 0; i < local_size; ++i) {
+				items[i].reset();
+			}
+			reset_sub_group_exchange(local_size);
+#if defined(FLOOR_DEBUG)
+			unfinished_items = local_size;
+#endif
+			
+			// run fibers/work-items for this group
+			static thread_local volatile bool done;
+			done = false;
+			main_ctx.get_context();
+			if(!done) {
+				done = true;
+				
+				// start first fiber
+				items[0].set_context();
+			}
+			
+			// check if any items are still unfinished (in a valid program, all must be finished at this point)
+			// NOTE: this won't detect all barrier misuses, doing so would require *a lot* of work
+#if defined(FLOOR_DEBUG)
+			if (unfinished_items > 0) {
+				log_error("barrier misuse detected in kernel \"%s\" - %u unfinished items in group %v",
+						  func_name, unfinished_items, group_id);
+				return false;
+			}
+#endif
+			return true;
+		};
+		scheduler.run(cpu_idx - cpu_offset, group_func);
+		
+		// the kernel function references the kernel args, which are only valid during this execution
+		device_exec_context.kernel_func = {};
+		device_exec_context.grid_barrier = nullptr;
+	};
+	worker_pool.execute(cpu_offset, cpu_count, job);
+#if defined(FLOOR_HOST_KERNEL_ENABLE_TIMING)
+	log_debug("kernel time: %ums", double(floor_timer::stop<chrono::microseconds>(time_start)) / 1000.0);
+	scheduler.log_worker_stats(func_entry.info->name);
+#endif
+	if (collect_stats) {
+		cqueue.set_scheduler_stats(scheduler.get_worker_stats());
 	}
 }
 
@@ -1171,38 +2155,57 @@ extern "C" void run_host_device_group_item(const uint32_t local_linear_idx) {
 #endif
 }
 
+extern "C" void run_host_device_coop_group_item(const uint32_t fiber_idx) {
+	auto& coop = coop_worker_state;
+	run_host_device_group_item(fiber_idx - coop.cur_group * coop.local_size);
+	
+	// the last work-item of a group finishes last, its fiber continues with the first work-item of the next group of this worker
+	if (fiber_idx + 1u == (coop.cur_group + 1u) * coop.local_size && coop.cur_group + 1u < coop.group_count) {
+		coop.switch_group(coop.cur_group + 1u);
+	}
+}
+
 // -> kernel lib function implementations
 #include <floor/compute/device/host.hpp>
 
-// barrier handling (all the same)
+// barrier handling (all the same, except for global_barrier() in cooperative executions)
 // NOTE: the same barrier _must_ be encountered at the same point for all work-items
-void global_barrier() {
+static void host_group_barrier() {
 #if defined(FLOOR_HOST_COMPUTE_MT_ITEM)
+	auto& ctx = *host_exec_context;
+	
 	// save current barrier generation/id
-	const uint32_t cur_gen = barrier_gen;
+	const uint32_t cur_gen = ctx.barrier_gen;
 	
 	// dec counter, and:
-	if(--barrier_counter == 0) {
+	if(--ctx.barrier_counter == 0) {
 		// if this is the last thread to encounter the barrier,
 		// reset the counter and increase the gen/id, so that the other threads can continue
-		barrier_counter = barrier_users;
-		++barrier_gen; // note: overflow doesn't matter
+		ctx.barrier_counter = ctx.barrier_users;
+		++ctx.barrier_gen; // note: overflow doesn't matter
 	}
 	else {
 		// if this isn't the last thread to encounter the barrier,
 		// wait until the barrier gen/id changes, then continue
-		while(cur_gen == barrier_gen) {
+		while(cur_gen == ctx.barrier_gen) {
 			this_thread::yield();
 		}
 	}
 #elif defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+	// nothing to switch to in single work-item groups
+	if (host_exec_context->linear_local_work_size == 1u) {
+		return;
+	}
+	
 	// save indices, switch to next fiber and restore indices again
 	const auto saved_global_id = floor_global_idx;
 	const auto saved_local_id = floor_local_idx;
 	const auto save_item_local_linear_idx = item_local_linear_idx;
 	
+	// NOTE: the last work-item continues with the first one (no modulo, this is executed for every work-item)
+	const auto next_idx = item_local_linear_idx + 1u;
 	fiber_context* this_ctx = &item_contexts[item_local_linear_idx];
-	fiber_context* next_ctx = &item_contexts[(item_local_linear_idx + 1u) % floor_linear_local_work_size];
+	fiber_context* next_ctx = &item_contexts[next_idx != host_exec_context->linear_local_work_size ? next_idx : 0u];
 	this_ctx->swap_context(next_ctx);
 	
 	item_local_linear_idx = save_item_local_linear_idx;
@@ -1210,17 +2213,45 @@ void global_barrier() {
 	floor_global_idx = saved_global_id;
 #endif
 }
+void global_barrier() {
+#if defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+	// cooperative execution: this is a grid-wide barrier
+	// -> the last work-item in each group, which reaches the barrier after all other work-items in the group,
+	//    continues with the next group of the worker or waits for all other workers (see coop_worker_state_t)
+	auto grid_barrier = host_exec_context->grid_barrier;
+	if (grid_barrier != nullptr && item_local_linear_idx + 1u == host_exec_context->linear_local_work_size) {
+		// save indices, switch to the next group and restore indices again (the group id is restored by the group switch)
+		const auto saved_global_id = floor_global_idx;
+		const auto saved_local_id = floor_local_idx;
+		const auto save_item_local_linear_idx = item_local_linear_idx;
+		
+		coop_worker_state.enter_global_barrier(*grid_barrier, item_local_linear_idx);
+		
+		item_local_linear_idx = save_item_local_linear_idx;
+		floor_local_idx = saved_local_id;
+		floor_global_idx = saved_global_id;
+		return;
+	}
+#endif
+	host_group_barrier();
+}
 void local_barrier() {
-	global_barrier();
+	host_group_barrier();
 }
 void image_barrier() {
-	global_barrier();
+	host_group_barrier();
 }
 void barrier() {
-	global_barrier();
+	host_group_barrier();
 }
 
 void host_compute_device_barrier() {
+	if (item_contexts == nullptr) {
+		// this should never happen, since barrier detection is conservative
+		log_error("encountered a barrier in a kernel that was determined to be barrier-free");
+		return;
+	}
+	
 	auto& ids = *device_exec_context.ids;
 	
 	// save indices, switch to next fiber and restore indices again
@@ -1228,8 +2259,10 @@ void host_compute_device_barrier() {
 	const auto saved_local_id = ids.instance_local_idx;
 	const auto save_item_local_linear_idx = ids.instance_local_linear_idx;
 	
+	// NOTE: the last work-item continues with the first one (no modulo, this is executed for every work-item)
+	const auto next_idx = ids.instance_local_linear_idx + 1u;
 	fiber_context* this_ctx = &item_contexts[ids.instance_local_linear_idx];
-	fiber_context* next_ctx = &item_contexts[(ids.instance_local_linear_idx + 1u) % ids.instance_local_work_size.extent()];
+	fiber_context* next_ctx = &item_contexts[next_idx != ids.instance_local_work_size.extent() ? next_idx : 0u];
 	this_ctx->swap_context(next_ctx);
 	
 	ids.instance_local_linear_idx = save_item_local_linear_idx;
@@ -1237,6 +2270,102 @@ void host_compute_device_barrier() {
 	ids.instance_global_idx = saved_global_id;
 }
 
+void host_compute_device_global_barrier() {
+	// cooperative execution: this is a grid-wide barrier (see global_barrier() above)
+	auto grid_barrier = device_exec_context.grid_barrier;
+	if (grid_barrier != nullptr && item_contexts != nullptr) {
+		auto& ids = *device_exec_context.ids;
+		if (ids.instance_local_linear_idx + 1u == ids.instance_local_work_size.extent()) {
+			const auto saved_global_id = ids.instance_global_idx;
+			const auto saved_local_id = ids.instance_local_idx;
+			const auto save_item_local_linear_idx = ids.instance_local_linear_idx;
+			
+			coop_worker_state.enter_global_barrier(*grid_barrier, ids.instance_local_linear_idx);
+			
+			ids.instance_local_linear_idx = save_item_local_linear_idx;
+			ids.instance_local_idx = saved_local_id;
+			ids.instance_global_idx = saved_global_id;
+			return;
+		}
+	}
+	host_compute_device_barrier();
+}
+
+// sub-group handling
+#if defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+//! writes "lane_value" of work-item "local_linear_idx" into the exchange memory of its sub-group, then runs all other
+//! work-items of the sub-group up to the same point and returns the exchange memory of the sub-group (starting at lane #0)
+//! NOTE: unlike a barrier, this only switches between the fibers of the sub-group and not between all fibers of the work-group
+static const void* host_sub_group_exchange(const uint32_t local_linear_idx, const uint32_t local_extent,
+										   const void* lane_value, const uint32_t value_size, const uint32_t sub_group_width) {
+	if (!sub_group_exchange) {
+		sub_group_exchange = make_unique<sub_group_exchange_t>();
+	}
+	auto& exchange = *sub_group_exchange;
+	
+	const auto sub_group_start = local_linear_idx - (local_linear_idx % sub_group_width);
+	const auto sub_group_end = min(sub_group_start + sub_group_width, local_extent);
+	const auto buffer_idx = !exchange.buffer_idx[local_linear_idx];
+	exchange.buffer_idx[local_linear_idx] = buffer_idx;
+	auto sub_group_data = &exchange.data[buffer_idx][sub_group_start * sub_group_max_value_size];
+	memcpy(sub_group_data + (local_linear_idx - sub_group_start) * value_size, lane_value, value_size);
+	
+	if (sub_group_end - sub_group_start > 1u) {
+		// switch to the next work-item in the sub-group, the last one continues with the first one
+		fiber_context* this_ctx = &item_contexts[local_linear_idx];
+		fiber_context* next_ctx = &item_contexts[local_linear_idx + 1u < sub_group_end ? local_linear_idx + 1u : sub_group_start];
+		this_ctx->swap_context(next_ctx);
+	}
+	return sub_group_data;
+}
+#endif
+
+const void* floor_host_sub_group_exchange(const void* lane_value, const uint32_t value_size, const uint32_t sub_group_width) {
+#if defined(FLOOR_HOST_COMPUTE_MT_GROUP)
+	// save indices, exchange and restore indices again
+	const auto saved_global_id = floor_global_idx;
+	const auto saved_local_id = floor_local_idx;
+	const auto save_item_local_linear_idx = item_local_linear_idx;
+	
+	const auto ret = host_sub_group_exchange(item_local_linear_idx, host_exec_context->linear_local_work_size,
+											 lane_value, value_size, sub_group_width);
+	
+	item_local_linear_idx = save_item_local_linear_idx;
+	floor_local_idx = saved_local_id;
+	floor_global_idx = saved_global_id;
+	return ret;
+#else
+	// NOTE: only lane #0 / the calling work-item will contain a valid value
+	log_error("sub-group operations are only supported with the MT-Group execution model");
+	(void)value_size;
+	(void)sub_group_width;
+	return lane_value;
+#endif
+}
+
+const void* host_compute_device_sub_group_exchange(const void* lane_value, const uint32_t value_size, const uint32_t sub_group_width) {
+	if (item_contexts == nullptr) {
+		// this should never happen, since sub-group operations are treated like barriers
+		log_error("encountered a sub-group operation in a kernel that was determined to be barrier-free");
+		return lane_value;
+	}
+	
+	auto& ids = *device_exec_context.ids;
+	
+	// save indices, exchange and restore indices again
+	const auto saved_global_id = ids.instance_global_idx;
+	const auto saved_local_id = ids.instance_local_idx;
+	const auto save_item_local_linear_idx = ids.instance_local_linear_idx;
+	
+	const auto ret = host_sub_group_exchange(ids.instance_local_linear_idx, ids.instance_local_work_size.extent(),
+											 lane_value, value_size, sub_group_width);
+	
+	ids.instance_local_linear_idx = save_item_local_linear_idx;
+	ids.instance_local_idx = saved_local_id;
+	ids.instance_global_idx = saved_global_id;
+	return ret;
+}
+
 // memory fence handling (all the same)
 // NOTE: compared to a barrier, a memory fence does not have to be encountered by all work-items (no context/fiber switching is necessary)
 void global_mem_fence() {
@@ -1273,20 +2402,27 @@ void image_write_mem_fence() {
 // local memory management
 // NOTE: this is called when allocating storage for local buffers when using mt-group
 uint8_t* __attribute__((aligned(1024))) floor_requisition_local_memory(const size_t size, uint32_t& offset) noexcept {
+	auto& ctx = *host_exec_context;
+	
+	// align to 1024-bit / 128 bytes
+	const auto per_thread_alloc_size = uint32_t(size % 128 == 0 ? size : (((size / 128) + 1) * 128));
+	// set the offset to this allocation + adjust allocation offset for the next allocation
+	// NOTE: static local buffers may be initialized by multiple worker threads at the same time -> atomic
+	offset = ctx.local_memory_alloc_offset.fetch_add(per_thread_alloc_size);
+	
 	// check if this allocation exceeds the max size
 	// note: using the unaligned size, since the padding isn't actually used
-	if((local_memory_alloc_offset + size) > floor_local_memory_max_size) {
+	if((offset + size) > floor_local_memory_max_size) {
 		// if so, signal the main thread that things are bad and switch to it
-		local_memory_exceeded = true;
+		ctx.local_memory_exceeded = true;
 		item_contexts[item_local_linear_idx].exit_to_main();
 	}
 	
-	// align to 1024-bit / 128 bytes
-	const auto per_thread_alloc_size = (size % 128 == 0 ? size : (((size / 128) + 1) * 128));
-	// set the offset to this allocation
-	offset = local_memory_alloc_offset;
-	// adjust allocation offset for the next allocation
-	local_memory_alloc_offset += per_thread_alloc_size;
+	const auto alloc_end = offset + uint32_t(size);
+	auto high_water = floor_local_memory_high_water.load(memory_order_relaxed);
+	while (high_water < alloc_end && !floor_local_memory_high_water.compare_exchange_weak(high_water, alloc_end)) {
+		// retry
+	}
 	
 	return floor_local_memory_data.get();
 }
@@ -28,25 +28,22 @@
 #include <floor/threading/atomic_spin_lock.hpp>
 #include <floor/threading/task.hpp>
 #include <floor/compute/compute_kernel.hpp>
-
-// host compute exeuction model, choose wisely:
-
-// single-threaded, one logical cpu (the calling thread) corresponding to all work-items and work-groups
-// NOTE: no parallelism
-//#define FLOOR_HOST_COMPUTE_ST 1
-
-// multi-threaded, each logical cpu ("h/w thread") corresponding to one work-item in a work-group
-// NOTE: has intra-group parallelism, has no inter-group parallelism
-// NOTE: no fibers, barriers are sync'ed through spin locking
-//#define FLOOR_HOST_COMPUTE_MT_ITEM 1
-
-// multi-threaded, each logical cpu ("h/w thread") corresponding to one work-group
-// NOTE: has no intra-group parallelism, has inter-group parallelism
-// NOTE: uses fibers when encountering a barrier, running all fibers up to the barrier, then continuing
-#define FLOOR_HOST_COMPUTE_MT_GROUP 1
+// NOTE: the host compute execution model (FLOOR_HOST_COMPUTE_*) is selected in here
+#include <floor/compute/device/host_limits.hpp>
 
 class host_device;
 class elf_binary;
+class host_worker_pool;
+class host_queue;
+struct host_exec_context_t;
+
+//! kernel args and execution parameters of a single kernel execution (pooled, returned to the pool on destruction)
+struct host_kernel_args_t;
+struct host_kernel_args_deleter {
+	void operator()(host_kernel_args_t* kernel_args) const;
+};
+typedef unique_ptr<host_kernel_args_t, host_kernel_args_deleter> host_kernel_args_ptr;
+struct host_grid_barrier_t;
 
 class host_kernel final : public compute_kernel {
 public:
@@ -54,6 +51,8 @@ public:
 	
 	struct host_kernel_entry : kernel_entry {
 		shared_ptr<elf_binary> program;
+		//! stack usage estimate of this kernel in bytes (as reported by the toolchain), 0 if unknown
+		uint64_t stack_usage { 0u };
 	};
 	typedef flat_map<const host_device&, host_kernel_entry> kernel_map_type;
 	
@@ -68,31 +67,58 @@ public:
 				 const uint32_t& work_dim,
 				 const uint3& global_work_size,
 				 const uint3& local_work_size,
-				 const vector<compute_kernel_arg>& args) const override;
+				 const span<const compute_kernel_arg> args) const override;
 	
 	const kernel_entry* get_kernel_entry(const compute_device&) const override;
 	
+	//! creates the kernel args for an execution of this kernel with the specified parameters and args,
+	//! returns nullptr on failure
+	host_kernel_args_ptr create_kernel_args(const host_queue& cqueue,
+											const bool is_cooperative,
+											const uint32_t work_dim,
+											const uint3& global_work_size,
+											const uint3& local_work_size,
+											const span<const compute_kernel_arg> args) const;
+	
+	//! actual kernel execution with previously created kernel args (+ kernel event logging if enabled),
+	//! a non-zero "queued_time" overrides the queue time that was recorded when creating the kernel args
+	//! NOTE: must be called from the scheduler thread of the queue
+	void execute_internal(const host_kernel_args_t& kernel_args, const uint64_t queued_time = 0u) const;
+	
 protected:
+	//! executes the kernel on the worker threads of the queue
+	void dispatch(const host_kernel_args_t& kernel_args) const;
+	
 	const kernel_func_type kernel { nullptr };
 	const string func_name;
 	const compute_kernel::kernel_entry entry;
+	//! stack usage estimate of "kernel" in bytes (see elf_binary::get_loaded_stack_size), 0 if unknown
+	const uint64_t stack_usage { 0u };
 	
 	const kernel_map_type kernels {};
 	
 	COMPUTE_TYPE get_compute_type() const override { return COMPUTE_TYPE::HOST; }
 	
 	//! host-compute "host" execution
-	void execute_host(const uint32_t& cpu_count,
+	void execute_host(host_worker_pool& worker_pool,
+					  host_exec_context_t& ctx,
+					  const uint32_t& cpu_offset,
+					  const uint32_t& cpu_count,
+					  const host_queue& cqueue,
 					  const uint3& group_dim,
 					  const uint3& local_dim) const;
 	
 	//! host-compute "device" execution
-	void execute_device(const host_kernel_entry& func_entry,
+	void execute_device(host_worker_pool& worker_pool,
+						const host_kernel_entry& func_entry,
+						const uint32_t& cpu_offset,
 						const uint32_t& cpu_count,
+						const host_queue& cqueue,
+						host_grid_barrier_t* grid_barrier,
 						const uint3& group_dim,
 						const uint3& local_dim,
 						const uint32_t& work_dim,
-						const vector<const void*>& vptr_args) const;
+						const host_kernel_args_t& kernel_args) const;
 	
 	typename kernel_map_type::const_iterator get_kernel(const compute_queue& cqueue) const;
 	
@@ -105,6 +131,12 @@ protected:
 
 //! host-compute device specific barrier
 extern "C" void host_compute_device_barrier();
+//! host-compute device specific global barrier (grid-wide barrier in cooperative executions)
+extern "C" void host_compute_device_global_barrier();
+//! host-compute sub-group value exchange (see device/host.hpp)
+extern "C" const void* floor_host_sub_group_exchange(const void* lane_value, const uint32_t value_size, const uint32_t sub_group_width);
+//! host-compute device specific sub-group value exchange
+extern "C" const void* host_compute_device_sub_group_exchange(const void* lane_value, const uint32_t value_size, const uint32_t sub_group_width);
 
 #endif
 
@@ -0,0 +1,523 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <floor/compute/host/host_memory.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/logger.hpp>
+#include <floor/compute/host/host_queue.hpp>
+#include <floor/compute/host/host_device.hpp>
+#include <floor/compute/host/host_worker_pool.hpp>
+#include <floor/compute/host/host_numa.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <atomic>
+
+#if !defined(__WINDOWS__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#include <malloc.h>
+#endif
+
+#include <floor/core/platform_windows.hpp>
+#include <floor/core/essentials.hpp> // cleanup
+
+mutex host_memory::policy_lock;
+host_memory::policy_t host_memory::policy;
+
+//! huge page size (2 MiB on x86-64 and on AArch64 with 4 KiB base pages)
+static constexpr const size_t huge_page_size { 2u * 1024u * 1024u };
+
+static size_t get_page_size() {
+#if !defined(__WINDOWS__)
+	static const size_t page_size = [] {
+		const auto sys_page_size = sysconf(_SC_PAGESIZE);
+		return (sys_page_size > 0 ? size_t(sys_page_size) : size_t(4096u));
+	}();
+	return page_size;
+#else
+	return 4096u;
+#endif
+}
+
+static size_t round_up(const size_t size, const size_t alignment) {
+	return ((size + alignment - 1u) / alignment) * alignment;
+}
+
+void host_memory::set_policy(const policy_t& policy_) {
+	lock_guard<mutex> lock(policy_lock);
+	policy = policy_;
+}
+
+host_memory::policy_t host_memory::get_policy() {
+	lock_guard<mutex> lock(policy_lock);
+	return policy;
+}
+
+host_memory host_memory::allocate(const size_t size_, const compute_queue& cqueue) {
+	const auto cur_policy = get_policy();
+	const auto page_size = get_page_size();
+	host_memory mem;
+	
+#if defined(__linux__)
+	if (cur_policy.huge_page_threshold > 0u && size_ >= cur_policy.huge_page_threshold) {
+		const auto huge_size = round_up(size_, huge_page_size);
+#if defined(MAP_HUGETLB)
+		if (cur_policy.use_hugetlb) {
+			auto hugetlb_ptr = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (hugetlb_ptr != MAP_FAILED) {
+				mem.ptr = (uint8_t*)hugetlb_ptr;
+				mem.size = huge_size;
+				mem.type = ALLOCATION_TYPE::HUGETLB;
+			}
+			// else: not enough preallocated huge pages -> fall back to transparent huge pages
+		}
+#endif
+		if (!mem) {
+			// over-allocate, so that the mapping can be aligned to the huge page size
+			// (transparent huge pages can only be used for 2 MiB aligned ranges)
+			const auto map_size = huge_size + huge_page_size;
+			auto map_ptr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (map_ptr != MAP_FAILED) {
+				const auto map_begin = uintptr_t(map_ptr);
+				const auto aligned_begin = (map_begin + huge_page_size - 1u) & ~uintptr_t(huge_page_size - 1u);
+				const auto aligned_end = aligned_begin + huge_size;
+				// unmap the unaligned head and the unused tail
+				if (aligned_begin > map_begin) {
+					munmap(map_ptr, aligned_begin - map_begin);
+				}
+				if (map_begin + map_size > aligned_end) {
+					munmap((void*)aligned_end, map_begin + map_size - aligned_end);
+				}
+#if defined(MADV_HUGEPAGE)
+				// NOTE: failure is not an error here (THP might be disabled), this is still a valid page-aligned allocation
+				madvise((void*)aligned_begin, huge_size, MADV_HUGEPAGE);
+#endif
+				mem.ptr = (uint8_t*)aligned_begin;
+				mem.size = huge_size;
+				mem.type = ALLOCATION_TYPE::HUGE_PAGES;
+			}
+		}
+	}
+#endif
+	
+	if (!mem) {
+		const auto aligned_size = round_up(std::max(size_, size_t(1u)), page_size);
+		void* aligned_ptr = nullptr;
+#if !defined(__WINDOWS__)
+		if (posix_memalign(&aligned_ptr, page_size, aligned_size) != 0) {
+			aligned_ptr = nullptr;
+		}
+#else
+		aligned_ptr = _aligned_malloc(aligned_size, page_size);
+#endif
+		if (aligned_ptr == nullptr) {
+			log_error("failed to allocate %u bytes of host memory", size_);
+			return {};
+		}
+		mem.ptr = (uint8_t*)aligned_ptr;
+		mem.size = aligned_size;
+		mem.type = ALLOCATION_TYPE::ALIGNED;
+	}
+	
+	// place the memory on the NUMA node(s) of the CPUs that execute kernels on this queue (before it is first touched)
+	if (const auto hst_queue = dynamic_cast<const host_queue*>(&cqueue); hst_queue != nullptr) {
+		host_numa_topology::get().place_memory(mem.ptr, mem.size, hst_queue->get_cpu_offset(), hst_queue->get_cpu_count());
+		
+		if (cur_policy.prefault_threshold > 0u && size_ >= cur_policy.prefault_threshold) {
+			mem.prefault(*hst_queue);
+		}
+	}
+	
+	return mem;
+}
+
+void host_memory::prefault(const host_queue& cqueue) {
+	const auto& worker_pool = ((const host_device&)cqueue.get_device()).worker_pool;
+	const auto cpu_offset = cqueue.get_cpu_offset();
+	const auto cpu_count = cqueue.get_cpu_count();
+	if (!worker_pool || cpu_count == 0u) {
+		return;
+	}
+	
+	// each worker touches one contiguous chunk of pages
+	const auto page_size = get_page_size();
+	const auto page_count = (size + page_size - 1u) / page_size;
+	const auto pages_per_worker = (page_count + cpu_count - 1u) / cpu_count;
+	auto mem_ptr = ptr;
+	const host_worker_pool::job_type job = [mem_ptr, cpu_offset, page_size, page_count, pages_per_worker](const uint32_t cpu_idx) {
+		const auto page_begin = std::min(size_t(cpu_idx - cpu_offset) * pages_per_worker, page_count);
+		const auto page_end = std::min(page_begin + pages_per_worker, page_count);
+		for (auto page = page_begin; page < page_end; ++page) {
+			*(volatile uint8_t*)(mem_ptr + page * page_size) = 0u;
+		}
+	};
+	worker_pool->execute(cpu_offset, cpu_count, job);
+}
+
+//! the mapping of a file always extends at least this many bytes beyond the end of the file
+static constexpr const size_t file_padding { 64u };
+
+host_memory host_memory::map_file(const string& filename, const bool write_back, size_t& file_size) {
+#if !defined(__WINDOWS__)
+	const auto fd = open(filename.c_str(), write_back ? O_RDWR : O_RDONLY);
+	if (fd < 0) {
+		log_error("failed to open file %s: %s", filename, strerror(errno));
+		return {};
+	}
+	struct stat file_stat {};
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+		log_error("failed to query the size of file %s (or file is empty)", filename);
+		close(fd);
+		return {};
+	}
+	file_size = size_t(file_stat.st_size);
+	
+	// reserve the whole range first and then map the file over it: the mapping must extend beyond the end of the file,
+	// but accessing file-backed pages that lie completely beyond the end of the file would fail
+	const auto map_size = round_up(file_size + file_padding, get_page_size());
+	auto reserve_ptr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reserve_ptr == MAP_FAILED) {
+		log_error("failed to reserve memory for file %s: %s", filename, strerror(errno));
+		close(fd);
+		return {};
+	}
+	auto file_ptr = mmap(reserve_ptr, file_size, PROT_READ | PROT_WRITE, (write_back ? MAP_SHARED : MAP_PRIVATE) | MAP_FIXED, fd, 0);
+	const auto map_errno = errno;
+	// NOTE: the mapping stays valid after closing the file
+	close(fd);
+	if (file_ptr == MAP_FAILED) {
+		log_error("failed to map file %s: %s", filename, strerror(map_errno));
+		munmap(reserve_ptr, map_size);
+		return {};
+	}
+	
+	host_memory mem;
+	mem.ptr = (uint8_t*)file_ptr;
+	mem.size = map_size;
+	mem.type = (write_back ? ALLOCATION_TYPE::FILE_SHARED : ALLOCATION_TYPE::FILE_PRIVATE);
+	return mem;
+#else
+	auto file_handle = CreateFileA(filename.c_str(), GENERIC_READ | (write_back ? GENERIC_WRITE : 0u), FILE_SHARE_READ,
+								   nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		log_error("failed to open file %s: %u", filename, GetLastError());
+		return {};
+	}
+	LARGE_INTEGER file_size_li {};
+	if (!GetFileSizeEx(file_handle, &file_size_li) || file_size_li.QuadPart <= 0) {
+		log_error("failed to query the size of file %s (or file is empty)", filename);
+		CloseHandle(file_handle);
+		return {};
+	}
+	file_size = size_t(file_size_li.QuadPart);
+	
+	// a view can't extend beyond the end of the file (without growing it) and can't be placed over reserved memory,
+	// so the padding must fit into the (zero-filled) rest of the last page of the file
+	host_memory mem;
+	const auto page_size = get_page_size();
+	const auto map_size = round_up(file_size + file_padding, page_size);
+	if (round_up(file_size, page_size) == map_size) {
+		auto mapping_handle = CreateFileMappingA(file_handle, nullptr, write_back ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, nullptr);
+		if (mapping_handle == nullptr) {
+			log_error("failed to create a file mapping for file %s: %u", filename, GetLastError());
+			CloseHandle(file_handle);
+			return {};
+		}
+		auto file_ptr = MapViewOfFile(mapping_handle, write_back ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, 0);
+		const auto map_error = GetLastError();
+		// NOTE: the view stays valid after closing the file and the mapping
+		CloseHandle(mapping_handle);
+		CloseHandle(file_handle);
+		if (file_ptr == nullptr) {
+			log_error("failed to map file %s: %u", filename, map_error);
+			return {};
+		}
+		mem.ptr = (uint8_t*)file_ptr;
+		mem.size = map_size;
+		mem.type = (write_back ? ALLOCATION_TYPE::FILE_SHARED : ALLOCATION_TYPE::FILE_PRIVATE);
+		return mem;
+	}
+	
+	// otherwise: read the whole file into page-aligned memory (modifications can't be written back)
+	if (write_back) {
+		log_warn("file %s can't be mapped with write-back (the file size is too close to a page boundary)", filename);
+	}
+	auto aligned_ptr = (uint8_t*)_aligned_malloc(map_size, page_size);
+	if (aligned_ptr == nullptr) {
+		log_error("failed to allocate %u bytes of host memory for file %s", map_size, filename);
+		CloseHandle(file_handle);
+		return {};
+	}
+	mem.ptr = aligned_ptr;
+	mem.size = map_size;
+	mem.type = ALLOCATION_TYPE::ALIGNED;
+	memset(aligned_ptr + file_size, 0, map_size - file_size);
+	for (size_t offset = 0; offset < file_size;) {
+		const auto read_size = DWORD(std::min(file_size - offset, size_t(1u) << 30u));
+		DWORD actually_read = 0;
+		if (!ReadFile(file_handle, aligned_ptr + offset, read_size, &actually_read, nullptr) || actually_read == 0) {
+			log_error("failed to read file %s: %u", filename, GetLastError());
+			CloseHandle(file_handle);
+			return {};
+		}
+		offset += actually_read;
+	}
+	CloseHandle(file_handle);
+	return mem;
+#endif
+}
+
+void host_memory::sync() const noexcept {
+#if !defined(__WINDOWS__)
+	if (ptr != nullptr && type == ALLOCATION_TYPE::FILE_SHARED) {
+		if (msync(ptr, size, MS_SYNC) != 0) {
+			log_error("failed to write back file mapping: %s", strerror(errno));
+		}
+	}
+#else
+	if (ptr != nullptr && type == ALLOCATION_TYPE::FILE_SHARED) {
+		if (!FlushViewOfFile(ptr, 0)) {
+			log_error("failed to write back file mapping: %u", GetLastError());
+		}
+	}
+#endif
+}
+
+//! operations smaller than this are always executed on the calling thread
+static constexpr const size_t parallel_threshold { 4u * 1024u * 1024u };
+//! minimum amount of bytes that are processed by each worker thread
+static constexpr const size_t min_bytes_per_worker { 1024u * 1024u };
+//! operations of at least this size use non-temporal stores (the written data won't stay in the cache anyway)
+static constexpr const size_t non_temporal_threshold { 32u * 1024u * 1024u };
+//! size of the vector type that is used for stores (one cache line)
+static constexpr const size_t store_size { 64u };
+//! max size of the already filled memory that is used as the copy source when filling with arbitrary pattern sizes
+static constexpr const size_t fill_source_size { 32u * 1024u };
+typedef uint8_t store_type __attribute__((vector_size(store_size)));
+
+//! executes "op(begin, end)" for [0, size) either on the calling thread or split across the worker threads of "cqueue",
+//! with all chunk boundaries being multiples of "granularity"
+template <typename F>
+static void execute_bulk_op(const compute_queue* cqueue, const size_t size, const size_t granularity, F&& op) {
+	const auto hst_queue = dynamic_cast<const host_queue*>(cqueue);
+	if (hst_queue == nullptr || size < parallel_threshold || hst_queue->get_cpu_count() <= 1u) {
+		op(size_t(0u), size);
+		return;
+	}
+	const auto& worker_pool = ((const host_device&)hst_queue->get_device()).worker_pool;
+	if (!worker_pool) {
+		op(size_t(0u), size);
+		return;
+	}
+	
+	const auto cpu_offset = hst_queue->get_cpu_offset();
+	const auto worker_count = uint32_t(std::min(size_t(hst_queue->get_cpu_count()), std::max(size / min_bytes_per_worker, size_t(1u))));
+	const auto chunk_size = round_up((size + worker_count - 1u) / worker_count, granularity);
+	const host_worker_pool::job_type job = [&op, size, cpu_offset, chunk_size](const uint32_t cpu_idx) {
+		const auto begin = std::min(size_t(cpu_idx - cpu_offset) * chunk_size, size);
+		const auto end = std::min(begin + chunk_size, size);
+		if (begin < end) {
+			op(begin, end);
+		}
+	};
+	worker_pool->execute(cpu_offset, worker_count, job);
+}
+
+//! makes non-temporal stores visible to other threads
+static void non_temporal_fence() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_sfence();
+#else
+	atomic_thread_fence(memory_order_seq_cst);
+#endif
+}
+
+//! copies [src, src + size) to dst using non-temporal stores for all store-aligned parts
+//! NOTE: the caller must issue a non_temporal_fence() afterwards
+static void copy_range_non_temporal(uint8_t* dst, const uint8_t* src, const size_t size) {
+	if (size < store_size * 2u) {
+		memcpy(dst, src, size);
+		return;
+	}
+	
+	// copy up to the first store-aligned address
+	const auto head_size = (store_size - (uintptr_t(dst) % store_size)) % store_size;
+	memcpy(dst, src, head_size);
+	
+	// non-temporal aligned stores, unaligned loads
+	const auto store_count = (size - head_size) / store_size;
+	auto store_ptr = (store_type*)(dst + head_size);
+	auto load_ptr = src + head_size;
+	for (size_t i = 0; i < store_count; ++i, ++store_ptr, load_ptr += store_size) {
+		store_type data;
+		memcpy(&data, load_ptr, store_size);
+		__builtin_nontemporal_store(data, store_ptr);
+	}
+	
+	// remainder
+	const auto tail_offset = head_size + store_count * store_size;
+	memcpy(dst + tail_offset, src + tail_offset, size - tail_offset);
+}
+
+static void copy_range(uint8_t* dst, const uint8_t* src, const size_t size, const bool non_temporal) {
+	if (!non_temporal || size < store_size * 2u) {
+		memcpy(dst, src, size);
+		return;
+	}
+	copy_range_non_temporal(dst, src, size);
+	non_temporal_fence();
+}
+
+//! fills [dst, dst + size) with the pattern, starting at the beginning of the pattern
+static void fill_range(uint8_t* dst, const uint8_t* pattern, const size_t pattern_size, const size_t size, const bool non_temporal) {
+	if (pattern_size == 1u && !non_temporal) {
+		memset(dst, *pattern, size);
+		return;
+	}
+	
+	if (pattern_size <= store_size && (store_size % pattern_size) == 0u) {
+		// power-of-two pattern sizes up to the store size: replicate the pattern into a full store vector
+		// NOTE: "line" contains the pattern repeatedly, so that any pattern phase can be read from it
+		alignas(store_size) uint8_t line[store_size * 2u];
+		for (size_t i = 0; i < store_size * 2u; ++i) {
+			line[i] = pattern[i % pattern_size];
+		}
+		
+		const auto head_size = std::min((store_size - (uintptr_t(dst) % store_size)) % store_size, size);
+		memcpy(dst, line, head_size);
+		
+		store_type data;
+		memcpy(&data, line + (head_size % pattern_size), store_size);
+		const auto store_count = (size - head_size) / store_size;
+		auto store_ptr = (store_type*)(dst + head_size);
+		if (non_temporal) {
+			for (size_t i = 0; i < store_count; ++i, ++store_ptr) {
+				__builtin_nontemporal_store(data, store_ptr);
+			}
+			non_temporal_fence();
+		} else {
+			for (size_t i = 0; i < store_count; ++i, ++store_ptr) {
+				*store_ptr = data;
+			}
+		}
+		
+		// remainder (the pattern phase is the same as at the first aligned store)
+		const auto tail_offset = head_size + store_count * store_size;
+		memcpy(dst + tail_offset, line + (head_size % pattern_size), size - tail_offset);
+		return;
+	}
+	
+	// any other pattern size: write the pattern once, then repeatedly copy the already filled memory
+	// (limited to a cache-resident source size that is a multiple of the pattern size)
+	// NOTE: the source is built with regular stores, so that it stays in the cache, everything after it is then written
+	//       with non-temporal stores if requested
+	const auto first_size = std::min(pattern_size, size);
+	memcpy(dst, pattern, first_size);
+	const auto max_source_size = std::max(fill_source_size - (fill_source_size % pattern_size), pattern_size);
+	size_t filled_size = first_size;
+	while (filled_size < size && filled_size < max_source_size) {
+		const auto copy_size = std::min(std::min(filled_size, max_source_size - filled_size), size - filled_size);
+		memcpy(dst + filled_size, dst, copy_size);
+		filled_size += copy_size;
+	}
+	if (filled_size >= size) {
+		return;
+	}
+	
+	// full source from here on: "filled_size" is a multiple of the pattern size
+	if (non_temporal) {
+		// one fence for all copies
+		const auto copy_count = (size - filled_size) / max_source_size;
+		for (size_t i = 0; i < copy_count; ++i, filled_size += max_source_size) {
+			copy_range_non_temporal(dst + filled_size, dst, max_source_size);
+		}
+		non_temporal_fence();
+	}
+	while (filled_size < size) {
+		const auto copy_size = std::min(max_source_size, size - filled_size);
+		memcpy(dst + filled_size, dst, copy_size);
+		filled_size += copy_size;
+	}
+}
+
+void host_memory::copy(const compute_queue* cqueue, void* dst, const void* src, const size_t size) {
+	if (size == 0u) {
+		return;
+	}
+	const auto non_temporal = (size >= non_temporal_threshold);
+	execute_bulk_op(cqueue, size, get_page_size(), [dst, src, non_temporal](const size_t begin, const size_t end) {
+		copy_range((uint8_t*)dst + begin, (const uint8_t*)src + begin, end - begin, non_temporal);
+	});
+}
+
+void host_memory::fill(const compute_queue* cqueue, void* dst, const void* pattern, const size_t pattern_size, const size_t size) {
+	if (size == 0u || pattern_size == 0u) {
+		return;
+	}
+	const auto non_temporal = (size >= non_temporal_threshold);
+	// all chunks must start at the beginning of the pattern
+	const auto granularity = std::lcm(pattern_size, get_page_size());
+	execute_bulk_op(cqueue, size, granularity, [dst, pattern, pattern_size, non_temporal](const size_t begin, const size_t end) {
+		fill_range((uint8_t*)dst + begin, (const uint8_t*)pattern, pattern_size, end - begin, non_temporal);
+	});
+}
+
+void host_memory::zero(const compute_queue* cqueue, void* dst, const size_t size) {
+	static constexpr const uint8_t zero_pattern { 0u };
+	fill(cqueue, dst, &zero_pattern, 1u, size);
+}
+
+void host_memory::release() noexcept {
+	if (ptr == nullptr) {
+		return;
+	}
+	switch (type) {
+		case ALLOCATION_TYPE::ALIGNED:
+#if !defined(__WINDOWS__)
+			free(ptr);
+#else
+			_aligned_free(ptr);
+#endif
+			break;
+		case ALLOCATION_TYPE::HUGE_PAGES:
+		case ALLOCATION_TYPE::HUGETLB:
+		case ALLOCATION_TYPE::FILE_PRIVATE:
+		case ALLOCATION_TYPE::FILE_SHARED:
+#if !defined(__WINDOWS__)
+			munmap(ptr, size);
+#else
+			UnmapViewOfFile(ptr);
+#endif
+			break;
+		case ALLOCATION_TYPE::NONE:
+			break;
+	}
+	ptr = nullptr;
+	size = 0u;
+	type = ALLOCATION_TYPE::NONE;
+}
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_HOST_MEMORY_HPP__
+#define __FLOOR_HOST_MEMORY_HPP__
+
+#include <floor/compute/host/host_common.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/essentials.hpp>
+#include <mutex>
+#include <string>
+using namespace std;
+
+class compute_queue;
+class host_queue;
+
+//! backing memory of host-compute buffers and images:
+//! all allocations are at least page-aligned, large allocations are backed by huge pages (if supported by the OS),
+//! and are placed on the NUMA node(s) of the CPUs of the queue they are created with
+class host_memory {
+public:
+	//! context-wide allocation policy (see host_compute::set_memory_policy)
+	struct policy_t {
+		//! allocations of at least this size (in bytes) are backed by huge pages, 0 disables huge page backing
+		//! NOTE: on Linux, this uses transparent huge pages (madvise) unless "use_hugetlb" is set
+		size_t huge_page_threshold { 2u * 1024u * 1024u };
+		//! if set, huge page backed allocations use explicit huge pages (MAP_HUGETLB) from the preallocated huge page pool,
+		//! falling back to transparent huge pages if none are available
+		bool use_hugetlb { false };
+		//! allocations of at least this size (in bytes) are pre-faulted in parallel by the worker threads of the queue,
+		//! so that kernels don't take page faults on first touch (this also places each page on the NUMA node of the worker
+		//! that touches it, unless the memory is already bound to specific nodes), 0 disables pre-faulting
+		size_t prefault_threshold { 0u };
+	};
+	
+	//! sets the allocation policy for all subsequent allocations
+	static void set_policy(const policy_t& policy);
+	//! returns the current allocation policy
+	static policy_t get_policy();
+	
+	host_memory() noexcept = default;
+	host_memory(host_memory&& mem) noexcept {
+		swap(mem);
+	}
+	host_memory& operator=(host_memory&& mem) noexcept {
+		host_memory tmp(move(mem));
+		swap(tmp);
+		return *this;
+	}
+	~host_memory() {
+		release();
+	}
+	host_memory(const host_memory&) = delete;
+	host_memory& operator=(const host_memory&) = delete;
+	
+	//! allocates at least "size" bytes of memory that is used by kernels executed on "cqueue"
+	//! NOTE: returns an empty object on failure
+	static host_memory allocate(const size_t size, const compute_queue& cqueue);
+	
+	//! maps the file "filename" into memory (pages are read lazily on first access) and sets "file_size" to its size,
+	//! if "write_back" is set, modifications are written back to the file, otherwise they are private to this mapping
+	//! NOTE: the mapping always extends at least 64 bytes beyond the end of the file (zero-initialized, not part of the file)
+	//! NOTE: on Windows, files whose size is within 64 bytes of a page boundary are read into memory instead of being mapped,
+	//!       modifications of these are never written back
+	//! NOTE: returns an empty object on failure
+	static host_memory map_file(const string& filename, const bool write_back, size_t& file_size);
+	
+	//! synchronously writes back all modifications of a write-back file mapping to the file (no-op otherwise)
+	//! NOTE: on Windows, the dirty pages are written to the file, but this doesn't wait for them to reach the disk
+	void sync() const noexcept;
+	
+	//! frees the memory (no-op if empty)
+	void release() noexcept;
+	
+	explicit operator bool() const noexcept {
+		return (ptr != nullptr);
+	}
+	
+	//! returns a pointer to the allocated memory
+	uint8_t* get() const noexcept {
+		return ptr;
+	}
+	
+	//! returns the actual size of the allocation (>= the requested size)
+	size_t allocation_size() const noexcept {
+		return size;
+	}
+	
+	//! returns true if this memory is backed by huge pages
+	bool is_huge_page_backed() const noexcept {
+		return (type == ALLOCATION_TYPE::HUGE_PAGES || type == ALLOCATION_TYPE::HUGETLB);
+	}
+	
+	//////////////////////////////////////////
+	// bulk memory operations
+	// NOTE: large operations are split across the worker threads of "cqueue" (if it is a host-compute queue,
+	//       otherwise they are executed on the calling thread), and very large operations use non-temporal stores
+	// NOTE: these must not be called from a worker thread
+	
+	//! copies "size" bytes from "src" to "dst" (must not overlap)
+	static void copy(const compute_queue* cqueue, void* dst, const void* src, const size_t size);
+	
+	//! fills "size" bytes at "dst" with the repeated "pattern" of "pattern_size" bytes
+	static void fill(const compute_queue* cqueue, void* dst, const void* pattern, const size_t pattern_size, const size_t size);
+	
+	//! zeros "size" bytes at "dst"
+	static void zero(const compute_queue* cqueue, void* dst, const size_t size);
+	
+	void swap(host_memory& mem) noexcept {
+		std::swap(ptr, mem.ptr);
+		std::swap(size, mem.size);
+		std::swap(type, mem.type);
+	}
+	
+protected:
+	enum class ALLOCATION_TYPE : uint32_t {
+		NONE,
+		//! page-aligned heap allocation
+		ALIGNED,
+		//! anonymous mapping with transparent huge pages
+		HUGE_PAGES,
+		//! anonymous mapping with explicit huge pages
+		HUGETLB,
+		//! private (copy-on-write) file mapping
+		FILE_PRIVATE,
+		//! shared file mapping (modifications are written back to the file)
+		FILE_SHARED,
+	};
+	
+	uint8_t* ptr { nullptr };
+	size_t size { 0u };
+	ALLOCATION_TYPE type { ALLOCATION_TYPE::NONE };
+	
+	static mutex policy_lock;
+	static policy_t policy;
+	
+	//! touches all pages of this allocation in parallel using the worker threads of "cqueue"
+	void prefault(const host_queue& cqueue);
+	
+};
+
+#endif
+
+#endif
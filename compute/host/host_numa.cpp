@@ -0,0 +1,192 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <floor/compute/host/host_numa.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/core.hpp>
+#include <floor/core/file_io.hpp>
+#include <floor/core/logger.hpp>
+#include <mutex>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// memory policy modes and flags (linux/mempolicy.h)
+static constexpr const int floor_mpol_bind { 2 };
+static constexpr const int floor_mpol_interleave { 3 };
+static constexpr const unsigned int floor_mpol_mf_move { 1u << 1u };
+#endif
+
+const host_numa_topology& host_numa_topology::get() {
+	static host_numa_topology topology;
+	static once_flag discover_once;
+	call_once(discover_once, [] {
+		topology.discover(core::get_hw_thread_count());
+	});
+	return topology;
+}
+
+#if defined(__linux__)
+//! parses a sysfs list of indices (e.g. "0-7,16-23")
+static vector<uint32_t> parse_index_list(const string& list_str) {
+	vector<uint32_t> ret;
+	for (const auto& range_str : core::tokenize(core::trim(list_str), ',')) {
+		if (range_str.empty()) {
+			continue;
+		}
+		const auto dash_pos = range_str.find('-');
+		if (dash_pos == string::npos) {
+			ret.emplace_back(stou(range_str));
+			continue;
+		}
+		const auto first = stou(range_str.substr(0, dash_pos));
+		const auto last = stou(range_str.substr(dash_pos + 1));
+		for (uint32_t idx = first; idx <= last; ++idx) {
+			ret.emplace_back(idx);
+		}
+	}
+	return ret;
+}
+
+//! reads a sysfs index list file, returns an empty list if the file doesn't exist
+static vector<uint32_t> read_index_list(const string& filename) {
+	string list_str;
+	if (!file_io::is_file(filename) || !file_io::file_to_string_poll(filename, list_str)) {
+		return {};
+	}
+	return parse_index_list(list_str);
+}
+#endif
+
+void host_numa_topology::discover(const uint32_t cpu_count) {
+#if defined(__linux__)
+	static constexpr const char sysfs_node_path[] { "/sys/devices/system/node/" };
+	const auto online_nodes = read_index_list(sysfs_node_path + "online"s);
+	if (online_nodes.size() > 1u) {
+		vector<bool> assigned_cpus(cpu_count, false);
+		bool valid = true;
+		for (const auto& os_node_idx : online_nodes) {
+			// NOTE: nodes without CPUs (memory-only nodes) are ignored
+			const auto node_cpus = read_index_list(sysfs_node_path + "node"s + to_string(os_node_idx) + "/cpulist");
+			if (node_cpus.empty()) {
+				continue;
+			}
+			if (os_node_idx >= 64u) {
+				// can't be represented in our node mask
+				valid = false;
+				break;
+			}
+			
+			const auto node_idx = uint32_t(nodes.size());
+			nodes.emplace_back(node_t { os_node_idx, uint32_t(worker_cpus.size()), uint32_t(node_cpus.size()) });
+			for (const auto& cpu : node_cpus) {
+				if (cpu >= cpu_count || assigned_cpus[cpu]) {
+					valid = false;
+					break;
+				}
+				assigned_cpus[cpu] = true;
+				worker_cpus.emplace_back(cpu);
+				worker_nodes.emplace_back(node_idx);
+			}
+			if (!valid) {
+				break;
+			}
+		}
+		
+		if (!valid || worker_cpus.size() != cpu_count) {
+			log_warn("inconsistent NUMA topology information, falling back to a single node");
+			nodes.clear();
+			worker_cpus.clear();
+			worker_nodes.clear();
+		}
+	}
+#endif
+	
+	// single node fallback: all CPUs in order
+	if (nodes.empty()) {
+		nodes.emplace_back(node_t { 0u, 0u, cpu_count });
+		worker_cpus.resize(cpu_count);
+		worker_nodes.resize(cpu_count, 0u);
+		for (uint32_t cpu = 0; cpu < cpu_count; ++cpu) {
+			worker_cpus[cpu] = cpu;
+		}
+		return;
+	}
+	
+	for (const auto& node : nodes) {
+		log_debug("NUMA node #%u: %u CPUs (workers [%u, %u))",
+				  node.os_node_idx, node.cpu_count, node.cpu_offset, node.cpu_offset + node.cpu_count);
+	}
+}
+
+void host_numa_topology::bind_worker_memory(void* ptr, const size_t worker_slice_size, const uint32_t worker_count) const {
+	if (!is_numa() || ptr == nullptr) {
+		return;
+	}
+	const auto bound_worker_count = std::min(worker_count, uint32_t(worker_nodes.size()));
+	for (uint32_t worker_idx = 0; worker_idx < bound_worker_count; ++worker_idx) {
+		const auto& node = nodes[worker_nodes[worker_idx]];
+		if (!bind_memory((uint8_t*)ptr + worker_idx * worker_slice_size, worker_slice_size, 1ull << node.os_node_idx, false)) {
+			log_warn("failed to bind memory of worker #%u to NUMA node #%u", worker_idx, node.os_node_idx);
+			return;
+		}
+	}
+}
+
+void host_numa_topology::place_memory(void* ptr, const size_t size, const uint32_t cpu_offset, const uint32_t cpu_count) const {
+	if (!is_numa() || ptr == nullptr || size == 0u) {
+		return;
+	}
+	
+	uint64_t node_mask = 0u;
+	const auto end_worker_idx = std::min(cpu_offset + cpu_count, uint32_t(worker_nodes.size()));
+	for (uint32_t worker_idx = cpu_offset; worker_idx < end_worker_idx; ++worker_idx) {
+		node_mask |= 1ull << nodes[worker_nodes[worker_idx]].os_node_idx;
+	}
+	if (node_mask == 0u) {
+		return;
+	}
+	
+	// NOTE: failure is not an error here (e.g. if the memory range doesn't contain a whole page)
+	(void)bind_memory(ptr, size, node_mask, (node_mask & (node_mask - 1u)) != 0u /* > 1 node: interleave */);
+}
+
+bool host_numa_topology::bind_memory(void* ptr floor_unused, const size_t size floor_unused,
+									 const uint64_t node_mask floor_unused,
+									 const bool interleave floor_unused) {
+#if defined(__linux__)
+	// only whole pages inside [ptr, ptr + size) can be bound
+	const auto page_size = uintptr_t(sysconf(_SC_PAGESIZE));
+	const auto begin = (uintptr_t(ptr) + page_size - 1u) & ~(page_size - 1u);
+	const auto end = (uintptr_t(ptr) + size) & ~(page_size - 1u);
+	if (end <= begin) {
+		return false;
+	}
+	// NOTE: already allocated pages are moved to the specified node(s)
+	return (syscall(SYS_mbind, begin, end - begin, interleave ? floor_mpol_interleave : floor_mpol_bind,
+					&node_mask, sizeof(node_mask) * 8u + 1u, floor_mpol_mf_move) == 0);
+#else
+	return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_HOST_NUMA_HPP__
+#define __FLOOR_HOST_NUMA_HPP__
+
+#include <floor/compute/host/host_common.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/essentials.hpp>
+#include <vector>
+using namespace std;
+
+//! NUMA topology of the host as seen by the host-compute worker threads:
+//! workers are ordered by NUMA node, i.e. the workers of each node form a contiguous worker index range,
+//! which allows executing kernels on a single node by using a queue with the CPU range of that node
+//! NOTE: the topology is only discovered on Linux (via /sys/devices/system/node), on all other platforms
+//!       or if the topology information is inconsistent, there is a single node containing all CPUs in order
+class host_numa_topology {
+public:
+	//! a single NUMA node
+	struct node_t {
+		//! OS index of this node
+		uint32_t os_node_idx { 0u };
+		//! first worker index of this node
+		uint32_t cpu_offset { 0u };
+		//! amount of workers/CPUs of this node
+		uint32_t cpu_count { 0u };
+	};
+	
+	//! returns the host NUMA topology (discovered on first use)
+	static const host_numa_topology& get();
+	
+	//! returns true if there is more than one NUMA node
+	bool is_numa() const {
+		return (nodes.size() > 1u);
+	}
+	
+	//! returns all NUMA nodes (always at least one)
+	const vector<node_t>& get_nodes() const {
+		return nodes;
+	}
+	
+	//! returns the OS CPU index of the specified worker
+	uint32_t get_worker_cpu(const uint32_t worker_idx) const {
+		return worker_cpus[worker_idx];
+	}
+	
+	//! returns the CPU indices of all workers (in worker order)
+	const vector<uint32_t>& get_worker_cpus() const {
+		return worker_cpus;
+	}
+	
+	//! returns the node index (into get_nodes()) of the specified worker
+	uint32_t get_worker_node(const uint32_t worker_idx) const {
+		return worker_nodes[worker_idx];
+	}
+	
+	//! binds the memory slices of the workers [0, worker_count), each "worker_slice_size" bytes in size and starting at "ptr",
+	//! to the NUMA node of each worker
+	//! NOTE: no-op if this is not a NUMA system
+	void bind_worker_memory(void* ptr, const size_t worker_slice_size, const uint32_t worker_count) const;
+	
+	//! places memory that is used by the workers [cpu_offset, cpu_offset + cpu_count):
+	//! if all these workers belong to the same node, the memory is bound to that node,
+	//! otherwise its pages are interleaved across all nodes of these workers
+	//! NOTE: only whole pages inside [ptr, ptr + size) are placed, no-op if this is not a NUMA system
+	void place_memory(void* ptr, const size_t size, const uint32_t cpu_offset, const uint32_t cpu_count) const;
+	
+protected:
+	vector<node_t> nodes;
+	vector<uint32_t> worker_cpus;
+	vector<uint32_t> worker_nodes;
+	
+	host_numa_topology() = default;
+	
+	//! discovers the topology for "cpu_count" CPUs
+	void discover(const uint32_t cpu_count);
+	
+	//! binds/interleaves (depending on "interleave") whole pages inside [ptr, ptr + size) to the specified nodes
+	//! NOTE: "node_mask" is a bit mask of OS node indices
+	static bool bind_memory(void* ptr, const size_t size, const uint64_t node_mask, const bool interleave);
+	
+};
+
+#endif
+
+#endif
@@ -72,6 +72,7 @@ device(device_), programs(programs_), has_device_binary(!programs.empty()) {
 				host_kernel::host_kernel_entry entry;
 				entry.info = &info;
 				entry.program = prog.second.program;
+				entry.stack_usage = entry.program->get_stack_size(kernel_name);
 				if (info.has_valid_local_size()) {
 					const auto local_size_extent = info.local_size.extent();
 					if (local_size_extent > host_limits::max_total_local_size) {
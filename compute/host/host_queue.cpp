@@ -20,15 +20,140 @@
 
 #if !defined(FLOOR_NO_HOST_COMPUTE)
 
-host_queue::host_queue(const compute_device& device_) : compute_queue(device_) {
+#include <floor/core/logger.hpp>
+#include <floor/core/core.hpp>
+#include <floor/compute/host/host_command_graph.hpp>
+
+host_queue::host_queue(const compute_device& device_, const uint32_t cpu_offset_, const uint32_t cpu_count_) :
+compute_queue(device_), cpu_offset(std::min(cpu_offset_, device_.units - 1u)),
+cpu_count(cpu_count_ == 0u ? device_.units - cpu_offset : std::min(cpu_count_, device_.units - cpu_offset)) {
+	if (cpu_offset != cpu_offset_ || (cpu_count_ != 0u && cpu_count != cpu_count_)) {
+		log_error("invalid queue cpu range [%u, %u) for device with %u units - clamped to [%u, %u)",
+				  cpu_offset_, cpu_offset_ + cpu_count_, device_.units, cpu_offset, cpu_offset + cpu_count);
+	}
+	
+	// start the scheduler thread (must only happen after everything else has been initialized)
+	scheduler_thread = make_unique<thread>(&host_queue::run, this);
+	scheduler_thread_id = scheduler_thread->get_id();
+}
+
+host_queue::~host_queue() {
+	{
+		lock_guard<mutex> lock(commands_lock);
+		shutdown = true;
+	}
+	commands_cv.notify_one();
+	if (scheduler_thread && scheduler_thread->joinable()) {
+		scheduler_thread->join();
+	}
+}
+
+void host_queue::run() {
+	core::set_current_thread_name("host queue");
+	
+	for (;;) {
+		command_t cmd;
+		{
+			unique_lock<mutex> lock(commands_lock);
+			commands_cv.wait(lock, [this] { return (shutdown || !commands.empty()); });
+			if (commands.empty()) {
+				// shutdown and all commands have been executed
+				return;
+			}
+			cmd = move(commands.front());
+			commands.pop_front();
+		}
+		
+		if (cmd.op) {
+			cmd.op();
+		}
+		if (cmd.event) {
+			cmd.event->signal();
+		}
+		
+		{
+			lock_guard<mutex> lock(commands_lock);
+			++completed_count;
+		}
+		finish_cv.notify_all();
+	}
+}
+
+shared_ptr<host_queue::completion_event> host_queue::enqueue(function<void()>&& cmd) const {
+	auto event = make_shared<completion_event>();
+	
+	// nested enqueue from within a command: we can't wait on ourselves -> directly execute
+	if (is_scheduler_thread()) {
+		if (cmd) {
+			cmd();
+		}
+		event->signal();
+		return event;
+	}
+	
+	{
+		lock_guard<mutex> lock(commands_lock);
+		commands.emplace_back(command_t { move(cmd), event });
+		++submitted_count;
+	}
+	commands_cv.notify_one();
+	return event;
+}
+
+void host_queue::submit(function<void()>&& cmd) const {
+	if (is_scheduler_thread()) {
+		if (cmd) {
+			cmd();
+		}
+		return;
+	}
+	
+	{
+		lock_guard<mutex> lock(commands_lock);
+		commands.emplace_back(command_t { move(cmd), nullptr });
+		++submitted_count;
+	}
+	commands_cv.notify_one();
+}
+
+shared_ptr<host_queue::completion_event> host_queue::enqueue_marker() const {
+	// since this is an in-order queue, an empty command signals completion of all prior commands
+	return enqueue({});
 }
 
 void host_queue::finish() const {
-	// nop
+	// when called from within a command, all previously enqueued commands have already completed
+	if (is_scheduler_thread()) {
+		return;
+	}
+	
+	unique_lock<mutex> lock(commands_lock);
+	const auto wait_count = submitted_count;
+	finish_cv.wait(lock, [this, wait_count] { return (completed_count >= wait_count); });
 }
 
 void host_queue::flush() const {
-	// nop
+	// nop: all enqueued commands are immediately visible to the scheduler thread
+}
+
+void host_queue::completion_event::wait() const {
+	if (is_complete()) {
+		return;
+	}
+	unique_lock<mutex> guard(lock);
+	cv.wait(guard, [this] { return is_complete(); });
+}
+
+void host_queue::completion_event::signal() {
+	{
+		lock_guard<mutex> guard(lock);
+		complete.store(true, memory_order_release);
+	}
+	cv.notify_all();
+}
+
+shared_ptr<compute_command_graph> host_queue::create_command_graph() const {
+	return make_shared<host_command_graph>(*this);
 }
 
 const void* host_queue::get_queue_ptr() const {
@@ -44,13 +169,26 @@ static inline uint64_t clock_in_us() {
 }
 
 void host_queue::start_profiling() {
+	// only profile work enqueued from here on
+	finish();
 	profiling_time = clock_in_us();
 }
 
 uint64_t host_queue::stop_profiling() {
+	finish();
 	const auto elapsed_time = clock_in_us() - profiling_time;
 	profiling_time = 0;
 	return elapsed_time;
 }
 
+vector<host_group_scheduler::worker_stats_t> host_queue::get_scheduler_stats() const {
+	lock_guard<mutex> lock(scheduler_stats_lock);
+	return scheduler_stats;
+}
+
+void host_queue::set_scheduler_stats(vector<host_group_scheduler::worker_stats_t>&& stats) const {
+	lock_guard<mutex> lock(scheduler_stats_lock);
+	scheduler_stats = move(stats);
+}
+
 #endif
@@ -25,25 +25,168 @@
 
 #include <floor/compute/compute_queue.hpp>
 #include <floor/compute/host/host_device.hpp>
+#include <floor/compute/host/host_group_scheduler.hpp>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
+//! in-order command queue: all commands (kernel executions, buffer copies/fills, ...) are enqueued and then executed
+//! asynchronously (in order of submission) by a separate scheduler thread
 class host_queue final : public compute_queue {
 public:
-	explicit host_queue(const compute_device& device);
+	//! completion event of a single command (or marker) that has been enqueued into a host_queue
+	class completion_event {
+	public:
+		//! returns true if the command has completed
+		bool is_complete() const {
+			return complete.load(memory_order_acquire);
+		}
+		
+		//! blocks until the command has completed
+		void wait() const;
+		
+	protected:
+		friend host_queue;
+		
+		mutable mutex lock;
+		mutable condition_variable cv;
+		atomic<bool> complete { false };
+		
+		//! signals completion and wakes up all waiters
+		void signal();
+		
+	};
+	
+	//! creates a queue that executes kernels on the CPUs/worker threads [cpu_offset, cpu_offset + cpu_count) of the device,
+	//! with a "cpu_count" of 0 signaling that all CPUs starting at "cpu_offset" should be used
+	//! NOTE: queues with disjoint CPU ranges can execute kernels concurrently
+	explicit host_queue(const compute_device& device, const uint32_t cpu_offset = 0u, const uint32_t cpu_count = 0u);
+	//! NOTE: executes all remaining commands before destruction
+	~host_queue() override;
 	
 	void finish() const override;
 	void flush() const override;
 	
+	//! enqueues the specified command into this queue and returns immediately,
+	//! the returned event can be used to wait for/check the completion of this command
+	//! NOTE: when called from within a command of this queue, the command is executed immediately
+	shared_ptr<completion_event> enqueue(function<void()>&& cmd) const;
+	
+	//! enqueues the specified command into this queue and returns immediately, without creating a completion event
+	//! NOTE: when called from within a command of this queue, the command is executed immediately
+	void submit(function<void()>&& cmd) const;
+	
+	//! enqueues a marker into this queue, the returned event signals completion of all previously enqueued commands
+	shared_ptr<completion_event> enqueue_marker() const;
+	
+	//! returns true if the calling thread is the scheduler thread of this queue (i.e. we're currently inside a command)
+	bool is_scheduler_thread() const {
+		return (this_thread::get_id() == scheduler_thread_id);
+	}
+	
 	const void* get_queue_ptr() const override;
 	void* get_queue_ptr() override;
 	
+	shared_ptr<compute_command_graph> create_command_graph() const override;
+	
 	bool has_profiling_support() const override {
 		return true;
 	}
 	void start_profiling() override;
 	uint64_t stop_profiling() override;
 	
+	bool has_kernel_event_support() const override {
+		return true;
+	}
+	
+	//! adds a completed kernel execution to the event log (called by host_kernel)
+	void add_kernel_event(kernel_event_t&& evt) const {
+		log_kernel_event(move(evt));
+	}
+	
+	//! returns the index of the first CPU/worker thread used by this queue
+	uint32_t get_cpu_offset() const {
+		return cpu_offset;
+	}
+	
+	//! returns the amount of CPUs/worker threads used by this queue
+	uint32_t get_cpu_count() const {
+		return cpu_count;
+	}
+	
+	//! max number of work-groups of a cooperative kernel launch that are executed by a single CPU/worker thread
+	//! NOTE: all work-groups must be resident at once, the work-items of all groups of a worker are fibers that are multiplexed
+	//!       onto the worker thread (the limit exists b/c each resident work-item requires its own fiber stack)
+	static constexpr const uint32_t max_cooperative_groups_per_cpu { 8u };
+	
+	//! returns the max total number of work-groups of a cooperative kernel launch on this queue
+	uint32_t get_max_cooperative_group_count() const {
+		return cpu_count * max_cooperative_groups_per_cpu;
+	}
+	
+	//! sets the amount of work-groups that are taken at once by a worker thread when executing a kernel,
+	//! with 0 signaling that this should be chosen adaptively based on the group and worker count (default)
+	//! NOTE: smaller chunks balance better when groups have a skewed cost, larger chunks have a lower scheduling overhead
+	void set_group_chunk_size(const uint32_t chunk_size) {
+		group_chunk_size = chunk_size;
+	}
+	
+	//! returns the amount of work-groups that are taken at once by a worker thread (0 = adaptive)
+	uint32_t get_group_chunk_size() const {
+		return group_chunk_size;
+	}
+	
+	//! enables or disables the collection of work-group scheduler statistics (per-worker busy/idle time, executed groups
+	//! and steals) for all kernel executions on this queue (disabled by default)
+	//! NOTE: this adds a small timing overhead to each chunk of work-groups that is executed
+	void set_scheduler_stats_collection(const bool enable) {
+		scheduler_stats_collection = enable;
+	}
+	
+	//! returns true if work-group scheduler statistics are collected
+	bool is_scheduler_stats_collection() const {
+		return scheduler_stats_collection;
+	}
+	
+	//! returns the per-worker scheduler statistics of the last non-cooperative kernel execution on this queue for which
+	//! statistics were collected, or an empty vector if there is none
+	vector<host_group_scheduler::worker_stats_t> get_scheduler_stats() const;
+	
+	//! sets the scheduler statistics of the last kernel execution (called by host_kernel)
+	void set_scheduler_stats(vector<host_group_scheduler::worker_stats_t>&& stats) const;
+	
 protected:
 	uint64_t profiling_time { 0 };
+	const uint32_t cpu_offset;
+	const uint32_t cpu_count;
+	atomic<uint32_t> group_chunk_size { 0u };
+	atomic<bool> scheduler_stats_collection { false };
+	mutable mutex scheduler_stats_lock;
+	mutable vector<host_group_scheduler::worker_stats_t> scheduler_stats;
+	
+	struct command_t {
+		function<void()> op;
+		shared_ptr<completion_event> event;
+	};
+	
+	//! all pending commands, "submitted_count" and "completed_count" are used to implement finish()
+	mutable mutex commands_lock;
+	mutable condition_variable commands_cv;
+	mutable condition_variable finish_cv;
+	mutable deque<command_t> commands;
+	mutable uint64_t submitted_count { 0u };
+	mutable uint64_t completed_count { 0u };
+	bool shutdown { false };
+	
+	//! the scheduler thread, draining and executing all commands
+	unique_ptr<thread> scheduler_thread;
+	thread::id scheduler_thread_id;
+	
+	//! scheduler thread run loop
+	void run();
 	
 };
 
@@ -0,0 +1,189 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <floor/compute/host/host_worker_pool.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/core.hpp>
+#include <floor/core/logger.hpp>
+
+#if defined(__APPLE__)
+#include <mach/thread_policy.h>
+#include <mach/thread_act.h>
+#elif defined(__linux__) || defined(__FreeBSD__)
+#include <pthread.h>
+#if defined(__FreeBSD__)
+#include <pthread_np.h>
+#endif
+#endif
+
+#include <floor/core/platform_windows.hpp>
+#include <floor/core/essentials.hpp> // cleanup
+
+void host_worker_pool::set_thread_affinity(const uint32_t affinity) {
+	if (affinity == 0) {
+		return;
+	}
+#if defined(__APPLE__)
+	thread_port_t thread_port = pthread_mach_thread_np(pthread_self());
+	thread_affinity_policy thread_affinity { int(affinity) };
+	thread_policy_set(thread_port, THREAD_AFFINITY_POLICY, (thread_policy_t)&thread_affinity, THREAD_AFFINITY_POLICY_COUNT);
+#elif defined(__linux__) || defined(__FreeBSD__)
+	// use gnu extension
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(affinity - 1, &cpu_set);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+#elif defined(__OpenBSD__)
+	// TODO: pthread gnu extension not available here
+#elif defined(__WINDOWS__)
+	SetThreadAffinityMask(GetCurrentThread(), 1u << (affinity - 1u));
+#endif
+}
+
+static vector<uint32_t> make_linear_worker_cpus(const uint32_t worker_count) {
+	vector<uint32_t> worker_cpus(worker_count);
+	for (uint32_t cpu_idx = 0; cpu_idx < worker_count; ++cpu_idx) {
+		worker_cpus[cpu_idx] = cpu_idx;
+	}
+	return worker_cpus;
+}
+
+host_worker_pool::host_worker_pool(const uint32_t worker_count_) : host_worker_pool(make_linear_worker_cpus(worker_count_)) {}
+
+host_worker_pool::host_worker_pool(const vector<uint32_t>& worker_cpus_) :
+worker_count(uint32_t(worker_cpus_.size())), workers(make_unique<worker_t[]>(worker_cpus_.size())), worker_cpus(worker_cpus_) {
+	for (uint32_t cpu_idx = 0; cpu_idx < worker_count; ++cpu_idx) {
+		workers[cpu_idx].thread_obj = make_unique<thread>(&host_worker_pool::run, this, cpu_idx);
+	}
+}
+
+host_worker_pool::~host_worker_pool() {
+	for (uint32_t cpu_idx = 0; cpu_idx < worker_count; ++cpu_idx) {
+		auto& worker = workers[cpu_idx];
+		{
+			lock_guard<mutex> lock(worker.lock);
+			worker.shutdown = true;
+		}
+		worker.job_cv.notify_one();
+	}
+	for (uint32_t cpu_idx = 0; cpu_idx < worker_count; ++cpu_idx) {
+		if (workers[cpu_idx].thread_obj && workers[cpu_idx].thread_obj->joinable()) {
+			workers[cpu_idx].thread_obj->join();
+		}
+	}
+}
+
+void host_worker_pool::run(const uint32_t cpu_idx) {
+	// set cpu affinity for this thread to a particular cpu to prevent this thread from being constantly moved/scheduled
+	// on different cpus (starting at index 1, with 0 representing no affinity)
+	set_thread_affinity(worker_cpus[cpu_idx] + 1);
+	core::set_current_thread_name("worker #" + to_string(cpu_idx));
+	
+	auto& worker = workers[cpu_idx];
+	for (;;) {
+		// wait for a new job: spin for a short while first (there usually is a continuous stream of kernel executions),
+		// then go to sleep until we're signaled
+		const job_type* job = nullptr;
+		for (uint32_t trial = 0; trial < spin_count; ++trial) {
+			job = worker.job.load(memory_order_acquire);
+			if (job != nullptr) {
+				break;
+			}
+#if defined(__x86_64__) || defined(__i386__)
+			asm volatile("pause" : : : "memory"); // x86
+#else
+			asm volatile("yield" : : : "memory"); // ARM
+#endif
+		}
+		completion_t* completion = nullptr;
+		{
+			unique_lock<mutex> lock(worker.lock);
+			if (job == nullptr) {
+				worker.job_cv.wait(lock, [&worker] {
+					return (worker.shutdown || worker.job.load(memory_order_acquire) != nullptr);
+				});
+				job = worker.job.load(memory_order_acquire);
+				if (job == nullptr) {
+					// shutdown
+					return;
+				}
+			}
+			completion = worker.completion;
+		}
+		
+		// execute
+		(*job)(cpu_idx);
+		
+		// free the job slot (allows other executions to be scheduled on this worker)
+		{
+			lock_guard<mutex> lock(worker.lock);
+			worker.completion = nullptr;
+			worker.job.store(nullptr, memory_order_release);
+		}
+		worker.free_cv.notify_all();
+		
+		// signal completion
+		// NOTE: this must happen while holding the completion lock, the completion object may be destroyed right after
+		{
+			lock_guard<mutex> lock(completion->lock);
+			if (completion->remaining.fetch_sub(1u) == 1u) {
+				completion->cv.notify_one();
+			}
+		}
+	}
+}
+
+void host_worker_pool::execute(const uint32_t cpu_offset, const uint32_t cpu_count, const job_type& job) {
+	if (cpu_count == 0) {
+		return;
+	}
+	if (cpu_offset + cpu_count > worker_count) {
+		log_error("invalid worker range [%u, %u), pool only contains %u workers", cpu_offset, cpu_offset + cpu_count, worker_count);
+		return;
+	}
+	
+	// assign the job to all workers in range
+	completion_t completion;
+	completion.remaining = cpu_count;
+	for (uint32_t cpu_idx = cpu_offset; cpu_idx < cpu_offset + cpu_count; ++cpu_idx) {
+		auto& worker = workers[cpu_idx];
+		{
+			unique_lock<mutex> lock(worker.lock);
+			worker.free_cv.wait(lock, [&worker] { return (worker.job.load(memory_order_acquire) == nullptr); });
+			worker.completion = &completion;
+			worker.job.store(&job, memory_order_release);
+		}
+		worker.job_cv.notify_one();
+	}
+	
+	// wait until all workers are done, again spinning for a short while first
+	for (uint32_t trial = 0; trial < spin_count && completion.remaining.load(memory_order_acquire) > 0u; ++trial) {
+#if defined(__x86_64__) || defined(__i386__)
+		asm volatile("pause" : : : "memory"); // x86
+#else
+		asm volatile("yield" : : : "memory"); // ARM
+#endif
+	}
+	// NOTE: always acquire the lock, even if all workers are already done, so that no worker still holds it on return
+	unique_lock<mutex> lock(completion.lock);
+	completion.cv.wait(lock, [&completion] { return (completion.remaining.load(memory_order_acquire) == 0u); });
+}
+
+#endif
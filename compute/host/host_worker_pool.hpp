@@ -0,0 +1,103 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __FLOOR_HOST_WORKER_POOL_HPP__
+#define __FLOOR_HOST_WORKER_POOL_HPP__
+
+#include <floor/compute/host/host_common.hpp>
+
+#if !defined(FLOOR_NO_HOST_COMPUTE)
+
+#include <floor/core/essentials.hpp>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+using namespace std;
+
+//! persistent pool of worker threads that is used to execute host-compute kernels,
+//! each worker thread is created once and pinned to its own logical CPU ("h/w thread"),
+//! the worker index is the CPU index that is handed to the executed job
+class host_worker_pool {
+public:
+	//! job function type, called with the CPU index of the executing worker thread
+	typedef function<void(const uint32_t cpu_idx)> job_type;
+	
+	//! creates and pins "worker_count" worker threads (to CPU #0 ... #worker_count - 1)
+	explicit host_worker_pool(const uint32_t worker_count);
+	//! creates one worker thread per entry in "worker_cpus", with worker #i being pinned to CPU #worker_cpus[i]
+	explicit host_worker_pool(const vector<uint32_t>& worker_cpus);
+	~host_worker_pool();
+	
+	host_worker_pool(const host_worker_pool&) = delete;
+	host_worker_pool& operator=(const host_worker_pool&) = delete;
+	
+	//! executes "job" on all workers in [cpu_offset, cpu_offset + cpu_count) and blocks until all of them have finished,
+	//! if a worker is still busy with another job, it will be scheduled once that job has finished
+	//! NOTE: "job" is not copied and must stay valid until this returns
+	void execute(const uint32_t cpu_offset, const uint32_t cpu_count, const job_type& job);
+	
+	//! returns the amount of worker threads in this pool
+	uint32_t get_worker_count() const {
+		return worker_count;
+	}
+	
+	//! sets the CPU affinity of the calling thread (starting at index 1, with 0 representing no affinity)
+	static void set_thread_affinity(const uint32_t affinity);
+	
+protected:
+	//! tracks the completion of a single "execute" call
+	struct completion_t {
+		mutex lock;
+		condition_variable cv;
+		atomic<uint32_t> remaining { 0u };
+	};
+	
+	//! per-worker state, each worker has its own job slot so that disjoint CPU ranges never contend with each other
+	struct alignas(128) worker_t {
+		unique_ptr<thread> thread_obj;
+		mutex lock;
+		//! signaled when a new job was assigned to this worker (or on shutdown)
+		condition_variable job_cv;
+		//! signaled when this worker finished its job and the job slot is free again
+		condition_variable free_cv;
+		//! currently assigned job (nullptr if idle)
+		atomic<const job_type*> job { nullptr };
+		completion_t* completion { nullptr };
+		bool shutdown { false };
+	};
+	
+	const uint32_t worker_count;
+	unique_ptr<worker_t[]> workers;
+	//! worker index -> CPU index
+	vector<uint32_t> worker_cpus;
+	
+	//! worker thread run loop
+	void run(const uint32_t cpu_idx);
+	
+	//! amount of spin iterations a worker thread/the executing thread performs before going to sleep
+	static constexpr const uint32_t spin_count { 2048u };
+	
+};
+
+#endif
+
+#endif
@@ -0,0 +1,582 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <floor/compute/image_conversion.hpp>
+#include <floor/constexpr/soft_f16.hpp>
+#include <floor/core/core.hpp>
+#include <thread>
+
+namespace image_conversion {
+
+//! storage element types of uniform 8-bit/16-bit/32-bit image formats
+enum class ELEMENT : uint32_t {
+	U8,
+	S8,
+	U16,
+	S16,
+	U32,
+	S32,
+	F16,
+	F32,
+};
+
+struct format_info {
+	bool valid { false };
+	ELEMENT element { ELEMENT::U8 };
+	bool normalized { false };
+	uint32_t channel_count { 0u };
+	//! memory position -> logical channel (0 = R, 1 = G, 2 = B, 3 = A)
+	array<uint32_t, 4> channel_map {{ 0u, 1u, 2u, 3u }};
+};
+
+static format_info get_format_info(const COMPUTE_IMAGE_TYPE type) {
+	format_info info;
+	if (image_compressed(type) ||
+		has_flag<COMPUTE_IMAGE_TYPE::FLAG_DEPTH>(type) ||
+		has_flag<COMPUTE_IMAGE_TYPE::FLAG_STENCIL>(type)) {
+		return info;
+	}
+	
+	const auto data_type = (type & COMPUTE_IMAGE_TYPE::__DATA_TYPE_MASK);
+	const auto format = (type & COMPUTE_IMAGE_TYPE::__FORMAT_MASK);
+	info.normalized = has_flag<COMPUTE_IMAGE_TYPE::FLAG_NORMALIZED>(type);
+	switch (format) {
+		case COMPUTE_IMAGE_TYPE::FORMAT_8:
+			if (data_type == COMPUTE_IMAGE_TYPE::UINT) info.element = ELEMENT::U8;
+			else if (data_type == COMPUTE_IMAGE_TYPE::INT) info.element = ELEMENT::S8;
+			else return info;
+			break;
+		case COMPUTE_IMAGE_TYPE::FORMAT_16:
+			if (data_type == COMPUTE_IMAGE_TYPE::UINT) info.element = ELEMENT::U16;
+			else if (data_type == COMPUTE_IMAGE_TYPE::INT) info.element = ELEMENT::S16;
+			else if (data_type == COMPUTE_IMAGE_TYPE::FLOAT) info.element = ELEMENT::F16;
+			else return info;
+			break;
+		case COMPUTE_IMAGE_TYPE::FORMAT_32:
+			if (data_type == COMPUTE_IMAGE_TYPE::UINT) info.element = ELEMENT::U32;
+			else if (data_type == COMPUTE_IMAGE_TYPE::INT) info.element = ELEMENT::S32;
+			else if (data_type == COMPUTE_IMAGE_TYPE::FLOAT) info.element = ELEMENT::F32;
+			else return info;
+			break;
+		default: return info;
+	}
+	if (info.element == ELEMENT::F16 || info.element == ELEMENT::F32) {
+		info.normalized = false; // no meaning for float formats
+	}
+	
+	info.channel_count = image_channel_count(type);
+	switch (type & COMPUTE_IMAGE_TYPE::__LAYOUT_MASK) {
+		case COMPUTE_IMAGE_TYPE::LAYOUT_BGRA: info.channel_map = {{ 2u, 1u, 0u, 3u }}; break;
+		case COMPUTE_IMAGE_TYPE::LAYOUT_ABGR: info.channel_map = {{ 3u, 2u, 1u, 0u }}; break;
+		case COMPUTE_IMAGE_TYPE::LAYOUT_ARGB: info.channel_map = {{ 3u, 0u, 1u, 2u }}; break;
+		default: break;
+	}
+	info.valid = true;
+	return info;
+}
+
+//! returns the bit pattern of an opaque alpha value for the specified format
+static uint32_t get_alpha_one(const format_info& info) {
+	switch (info.element) {
+		case ELEMENT::U8: return (info.normalized ? 0xFFu : 1u);
+		case ELEMENT::S8: return (info.normalized ? 0x7Fu : 1u);
+		case ELEMENT::U16: return (info.normalized ? 0xFFFFu : 1u);
+		case ELEMENT::S16: return (info.normalized ? 0x7FFFu : 1u);
+		case ELEMENT::U32: return (info.normalized ? 0xFFFF'FFFFu : 1u);
+		case ELEMENT::S32: return (info.normalized ? 0x7FFF'FFFFu : 1u);
+		case ELEMENT::F16: return 0x3C00u;
+		case ELEMENT::F32: return 0x3F80'0000u;
+	}
+	floor_unreachable();
+}
+
+static uint32_t element_size(const ELEMENT element) {
+	switch (element) {
+		case ELEMENT::U8:
+		case ELEMENT::S8:
+			return 1u;
+		case ELEMENT::U16:
+		case ELEMENT::S16:
+		case ELEMENT::F16:
+			return 2u;
+		case ELEMENT::U32:
+		case ELEMENT::S32:
+		case ELEMENT::F32:
+			return 4u;
+	}
+	floor_unreachable();
+}
+
+//! all supported element conversions
+enum class CONVERSION : uint32_t {
+	IDENTITY_8,
+	IDENTITY_16,
+	IDENTITY_32,
+	UNORM8_TO_FLOAT,
+	SNORM8_TO_FLOAT,
+	UNORM16_TO_FLOAT,
+	SNORM16_TO_FLOAT,
+	FLOAT_TO_UNORM8,
+	FLOAT_TO_SNORM8,
+	FLOAT_TO_UNORM16,
+	FLOAT_TO_SNORM16,
+	HALF_TO_FLOAT,
+	FLOAT_TO_HALF,
+	__MAX_CONVERSION
+};
+
+struct conversion {
+	CONVERSION conv { CONVERSION::__MAX_CONVERSION };
+	uint32_t src_channel_count { 0u };
+	uint32_t dst_channel_count { 0u };
+	size_t src_bytes_per_pixel { 0u };
+	size_t dst_bytes_per_pixel { 0u };
+	//! dst memory position -> src memory position, or -1 if the dst channel is set to a constant
+	array<int32_t, 4> src_index {{ -1, -1, -1, -1 }};
+	//! constant bit pattern for each dst memory position (only used if src_index is -1)
+	array<uint32_t, 4> constant {{ 0u, 0u, 0u, 0u }};
+	
+	bool valid() const {
+		return (conv != CONVERSION::__MAX_CONVERSION);
+	}
+	
+	//! true if src and dst have the same channel count and channel layout
+	bool same_layout() const {
+		if (src_channel_count != dst_channel_count) return false;
+		for (uint32_t i = 0; i < dst_channel_count; ++i) {
+			if (src_index[i] != int32_t(i)) return false;
+		}
+		return true;
+	}
+};
+
+static CONVERSION get_element_conversion(const format_info& src, const format_info& dst) {
+	if (src.element == dst.element && src.normalized == dst.normalized) {
+		switch (element_size(src.element)) {
+			case 1u: return CONVERSION::IDENTITY_8;
+			case 2u: return CONVERSION::IDENTITY_16;
+			default: return CONVERSION::IDENTITY_32;
+		}
+	}
+	if (dst.element == ELEMENT::F32) {
+		if (src.element == ELEMENT::F16) return CONVERSION::HALF_TO_FLOAT;
+		if (src.normalized) {
+			switch (src.element) {
+				case ELEMENT::U8: return CONVERSION::UNORM8_TO_FLOAT;
+				case ELEMENT::S8: return CONVERSION::SNORM8_TO_FLOAT;
+				case ELEMENT::U16: return CONVERSION::UNORM16_TO_FLOAT;
+				case ELEMENT::S16: return CONVERSION::SNORM16_TO_FLOAT;
+				default: break;
+			}
+		}
+	}
+	if (src.element == ELEMENT::F32) {
+		if (dst.element == ELEMENT::F16) return CONVERSION::FLOAT_TO_HALF;
+		if (dst.normalized) {
+			switch (dst.element) {
+				case ELEMENT::U8: return CONVERSION::FLOAT_TO_UNORM8;
+				case ELEMENT::S8: return CONVERSION::FLOAT_TO_SNORM8;
+				case ELEMENT::U16: return CONVERSION::FLOAT_TO_UNORM16;
+				case ELEMENT::S16: return CONVERSION::FLOAT_TO_SNORM16;
+				default: break;
+			}
+		}
+	}
+	return CONVERSION::__MAX_CONVERSION;
+}
+
+static conversion get_conversion(const COMPUTE_IMAGE_TYPE src_type, const COMPUTE_IMAGE_TYPE dst_type) {
+	conversion ret;
+	const auto src = get_format_info(src_type);
+	const auto dst = get_format_info(dst_type);
+	if (!src.valid || !dst.valid) {
+		return ret;
+	}
+	// sRGB <-> linear conversion is not supported (only a plain copy of sRGB data)
+	if (has_flag<COMPUTE_IMAGE_TYPE::FLAG_SRGB>(src_type) != has_flag<COMPUTE_IMAGE_TYPE::FLAG_SRGB>(dst_type)) {
+		return ret;
+	}
+	
+	const auto conv = get_element_conversion(src, dst);
+	if (conv == CONVERSION::__MAX_CONVERSION) {
+		return ret;
+	}
+	ret.src_channel_count = src.channel_count;
+	ret.dst_channel_count = dst.channel_count;
+	ret.src_bytes_per_pixel = element_size(src.element) * src.channel_count;
+	ret.dst_bytes_per_pixel = element_size(dst.element) * dst.channel_count;
+	
+	const auto alpha_one = get_alpha_one(dst);
+	for (uint32_t dst_idx = 0; dst_idx < dst.channel_count; ++dst_idx) {
+		const auto channel = dst.channel_map[dst_idx];
+		for (uint32_t src_idx = 0; src_idx < src.channel_count; ++src_idx) {
+			if (src.channel_map[src_idx] == channel) {
+				ret.src_index[dst_idx] = int32_t(src_idx);
+				break;
+			}
+		}
+		if (ret.src_index[dst_idx] < 0) {
+			ret.constant[dst_idx] = (channel == 3u ? alpha_one : 0u);
+		}
+	}
+	ret.conv = conv;
+	return ret;
+}
+
+//! element converters: each defines the src/dst storage type and a "convert" function
+template <typename storage_type>
+struct conv_identity {
+	typedef storage_type src_type;
+	typedef storage_type dst_type;
+	static floor_inline_always dst_type convert(const src_type val) {
+		return val;
+	}
+};
+
+template <typename int_type>
+struct conv_norm_to_float {
+	typedef int_type src_type;
+	typedef float dst_type;
+	static floor_inline_always dst_type convert(const src_type val) {
+		constexpr const float inv_max = 1.0f / float(numeric_limits<int_type>::max());
+		if constexpr (is_signed_v<int_type>) {
+			// -max-1 and -max both map to -1.0
+			const auto fval = float(val) * inv_max;
+			return (fval < -1.0f ? -1.0f : fval);
+		} else {
+			return float(val) * inv_max;
+		}
+	}
+};
+
+template <typename int_type>
+struct conv_float_to_norm {
+	typedef float src_type;
+	typedef int_type dst_type;
+	static floor_inline_always dst_type convert(const src_type val) {
+		constexpr const float max_val = float(numeric_limits<int_type>::max());
+		constexpr const float min_norm = (is_signed_v<int_type> ? -1.0f : 0.0f);
+		// NOTE: NaN is mapped to 0
+		const auto clamped = (val >= min_norm ? (val <= 1.0f ? val : 1.0f) : (val < min_norm ? min_norm : 0.0f));
+		const auto scaled = clamped * max_val;
+		return dst_type(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+	}
+};
+
+struct conv_half_to_float {
+	typedef uint16_t src_type;
+	typedef float dst_type;
+	static floor_inline_always dst_type convert(const src_type val) {
+		soft_f16 half;
+		half.value = val;
+		return float(half);
+	}
+};
+
+struct conv_float_to_half {
+	typedef float src_type;
+	typedef uint16_t dst_type;
+	static floor_inline_always dst_type convert(const src_type val) {
+		return soft_f16(val).value;
+	}
+};
+
+//! generic per-pixel conversion with a fixed src/dst channel count
+template <typename conv, uint32_t src_channel_count, uint32_t dst_channel_count>
+static void convert_pixels(const conversion& cv, const uint8_t* src_data, uint8_t* dst_data, const size_t pixel_count) {
+	typedef typename conv::src_type src_type;
+	typedef typename conv::dst_type dst_type;
+	const src_type* src = (const src_type*)src_data;
+	dst_type* dst = (dst_type*)dst_data;
+	
+	array<dst_type, dst_channel_count> constant;
+	for (uint32_t i = 0; i < dst_channel_count; ++i) {
+		if constexpr (is_integral_v<dst_type>) {
+			constant[i] = dst_type(cv.constant[i]);
+		} else {
+			memcpy(&constant[i], &cv.constant[i], sizeof(dst_type));
+		}
+	}
+	
+	if (src_channel_count == dst_channel_count && cv.same_layout()) {
+		// flat element-wise conversion
+		const size_t element_count = pixel_count * dst_channel_count;
+		for (size_t i = 0; i < element_count; ++i) {
+			dst[i] = conv::convert(src[i]);
+		}
+		return;
+	}
+	
+	const auto src_index = cv.src_index;
+	for (size_t i = 0; i < pixel_count; ++i, src += src_channel_count, dst += dst_channel_count) {
+		for (uint32_t j = 0; j < dst_channel_count; ++j) {
+			dst[j] = (src_index[j] >= 0 ? conv::convert(src[src_index[j]]) : constant[j]);
+		}
+	}
+}
+
+//! 16-byte vector shuffle of 8-bit channel data: converts 4 pixels at a time (maps to pshufb/tbl or similar)
+typedef uint8_t uchar16_vec __attribute__((vector_size(16)));
+
+//! returns the src channel for the specified dst byte (-1 if it is a constant or unused)
+template <uint32_t src_channel_count, uint32_t dst_channel_count, int32_t i0, int32_t i1, int32_t i2, int32_t i3>
+static constexpr int32_t shuffle_src_byte(const uint32_t dst_byte_idx) {
+	const uint32_t pixel = dst_byte_idx / dst_channel_count;
+	const uint32_t channel = dst_byte_idx % dst_channel_count;
+	if (pixel >= 4u) {
+		return -1;
+	}
+	const int32_t src_channel = (channel == 0 ? i0 : (channel == 1 ? i1 : (channel == 2 ? i2 : i3)));
+	return (src_channel < 0 ? -1 : int32_t(pixel * src_channel_count) + src_channel);
+}
+
+template <uint32_t src_channel_count, uint32_t dst_channel_count, int32_t i0, int32_t i1, int32_t i2, int32_t i3, size_t... indices>
+floor_inline_always static uchar16_vec shuffle_8bit_block(const uchar16_vec& src, const uchar16_vec& constant,
+														  index_sequence<indices...>) {
+	// single-source shuffle, then blend in the constant channels
+	constexpr const uchar16_vec keep_mask {
+		uint8_t(shuffle_src_byte<src_channel_count, dst_channel_count, i0, i1, i2, i3>(indices) >= 0 ? 0xFFu : 0u)...
+	};
+	const uchar16_vec shuffled = __builtin_shufflevector(src, src, std::max(shuffle_src_byte<src_channel_count, dst_channel_count,
+																							 i0, i1, i2, i3>(indices), 0)...);
+	return (shuffled & keep_mask) | constant;
+}
+
+template <uint32_t src_channel_count, uint32_t dst_channel_count, int32_t i0, int32_t i1, int32_t i2, int32_t i3>
+static void shuffle_8bit(const conversion& cv, const uint8_t* src, uint8_t* dst, const size_t pixel_count) {
+	uchar16_vec constant {};
+	for (uint32_t i = 0; i < 4u * dst_channel_count; ++i) {
+		const auto channel = i % dst_channel_count;
+		constant[i] = (cv.src_index[channel] < 0 ? uint8_t(cv.constant[channel]) : 0u);
+	}
+	
+	// 4 pixels per block: all blocks but the last may load/store a full vector without going out-of-bounds
+	// (excess bytes are overwritten by the next block), the last block only loads/stores the exact amount of data
+	constexpr const size_t src_block_size = 4u * src_channel_count;
+	constexpr const size_t dst_block_size = 4u * dst_channel_count;
+	const size_t block_count = pixel_count / 4u;
+	const size_t full_block_count = (block_count > 0u ? block_count - 1u : 0u);
+	for (size_t i = 0; i < full_block_count; ++i, src += src_block_size, dst += dst_block_size) {
+		uchar16_vec src_vec;
+		memcpy(&src_vec, src, sizeof(uchar16_vec));
+		const auto dst_vec = shuffle_8bit_block<src_channel_count, dst_channel_count, i0, i1, i2, i3>
+		(src_vec, constant, make_index_sequence<16>());
+		memcpy(dst, &dst_vec, sizeof(uchar16_vec));
+	}
+	if (block_count > 0u) {
+		uchar16_vec src_vec {};
+		memcpy(&src_vec, src, src_block_size);
+		const auto dst_vec = shuffle_8bit_block<src_channel_count, dst_channel_count, i0, i1, i2, i3>
+		(src_vec, constant, make_index_sequence<16>());
+		memcpy(dst, &dst_vec, dst_block_size);
+		src += src_block_size;
+		dst += dst_block_size;
+	}
+	
+	// remainder
+	const size_t rem_count = pixel_count - block_count * 4u;
+	if (rem_count > 0) {
+		convert_pixels<conv_identity<uint8_t>, src_channel_count, dst_channel_count>(cv, src, dst, rem_count);
+	}
+}
+
+//! tries to use a vector shuffle for 8-bit RGB <-> RGBA / RGBA <-> BGRA conversions, returns false if not applicable
+static bool convert_8bit_shuffle(const conversion& cv, const uint8_t* src, uint8_t* dst, const size_t pixel_count) {
+	const auto& idx = cv.src_index;
+	if (cv.src_channel_count == 3 && cv.dst_channel_count == 4) {
+		if (idx[0] == 0 && idx[1] == 1 && idx[2] == 2 && idx[3] < 0) {
+			shuffle_8bit<3, 4, 0, 1, 2, -1>(cv, src, dst, pixel_count);
+			return true;
+		}
+		if (idx[0] == 2 && idx[1] == 1 && idx[2] == 0 && idx[3] < 0) {
+			shuffle_8bit<3, 4, 2, 1, 0, -1>(cv, src, dst, pixel_count);
+			return true;
+		}
+	} else if (cv.src_channel_count == 4 && cv.dst_channel_count == 4) {
+		if (idx[0] == 2 && idx[1] == 1 && idx[2] == 0 && idx[3] == 3) {
+			shuffle_8bit<4, 4, 2, 1, 0, 3>(cv, src, dst, pixel_count);
+			return true;
+		}
+	} else if (cv.src_channel_count == 4 && cv.dst_channel_count == 3) {
+		if (idx[0] == 0 && idx[1] == 1 && idx[2] == 2) {
+			shuffle_8bit<4, 3, 0, 1, 2, -1>(cv, src, dst, pixel_count);
+			return true;
+		}
+		if (idx[0] == 2 && idx[1] == 1 && idx[2] == 0) {
+			shuffle_8bit<4, 3, 2, 1, 0, -1>(cv, src, dst, pixel_count);
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename conv, uint32_t src_channel_count>
+static void convert_pixels_dispatch_dst(const conversion& cv, const uint8_t* src, uint8_t* dst, const size_t pixel_count) {
+	switch (cv.dst_channel_count) {
+		case 1: convert_pixels<conv, src_channel_count, 1>(cv, src, dst, pixel_count); break;
+		case 2: convert_pixels<conv, src_channel_count, 2>(cv, src, dst, pixel_count); break;
+		case 3: convert_pixels<conv, src_channel_count, 3>(cv, src, dst, pixel_count); break;
+		case 4: convert_pixels<conv, src_channel_count, 4>(cv, src, dst, pixel_count); break;
+		default: floor_unreachable();
+	}
+}
+
+template <typename conv>
+static void convert_pixels_dispatch(const conversion& cv, const uint8_t* src, uint8_t* dst, const size_t pixel_count) {
+	switch (cv.src_channel_count) {
+		case 1: convert_pixels_dispatch_dst<conv, 1>(cv, src, dst, pixel_count); break;
+		case 2: convert_pixels_dispatch_dst<conv, 2>(cv, src, dst, pixel_count); break;
+		case 3: convert_pixels_dispatch_dst<conv, 3>(cv, src, dst, pixel_count); break;
+		case 4: convert_pixels_dispatch_dst<conv, 4>(cv, src, dst, pixel_count); break;
+		default: floor_unreachable();
+	}
+}
+
+//! single-threaded conversion of a range of pixels
+static void convert_range(const conversion& cv, const uint8_t* src, uint8_t* dst, const size_t pixel_count) {
+	switch (cv.conv) {
+		case CONVERSION::IDENTITY_8:
+			if (cv.same_layout()) {
+				memcpy(dst, src, pixel_count * cv.dst_bytes_per_pixel);
+				return;
+			}
+			if (convert_8bit_shuffle(cv, src, dst, pixel_count)) {
+				return;
+			}
+			convert_pixels_dispatch<conv_identity<uint8_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::IDENTITY_16:
+			if (cv.same_layout()) {
+				memcpy(dst, src, pixel_count * cv.dst_bytes_per_pixel);
+				return;
+			}
+			convert_pixels_dispatch<conv_identity<uint16_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::IDENTITY_32:
+			if (cv.same_layout()) {
+				memcpy(dst, src, pixel_count * cv.dst_bytes_per_pixel);
+				return;
+			}
+			convert_pixels_dispatch<conv_identity<uint32_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::UNORM8_TO_FLOAT:
+			convert_pixels_dispatch<conv_norm_to_float<uint8_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::SNORM8_TO_FLOAT:
+			convert_pixels_dispatch<conv_norm_to_float<int8_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::UNORM16_TO_FLOAT:
+			convert_pixels_dispatch<conv_norm_to_float<uint16_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::SNORM16_TO_FLOAT:
+			convert_pixels_dispatch<conv_norm_to_float<int16_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::FLOAT_TO_UNORM8:
+			convert_pixels_dispatch<conv_float_to_norm<uint8_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::FLOAT_TO_SNORM8:
+			convert_pixels_dispatch<conv_float_to_norm<int8_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::FLOAT_TO_UNORM16:
+			convert_pixels_dispatch<conv_float_to_norm<uint16_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::FLOAT_TO_SNORM16:
+			convert_pixels_dispatch<conv_float_to_norm<int16_t>>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::HALF_TO_FLOAT:
+			convert_pixels_dispatch<conv_half_to_float>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::FLOAT_TO_HALF:
+			convert_pixels_dispatch<conv_float_to_half>(cv, src, dst, pixel_count);
+			break;
+		case CONVERSION::__MAX_CONVERSION:
+			floor_unreachable();
+	}
+}
+
+bool is_supported(const COMPUTE_IMAGE_TYPE src_type, const COMPUTE_IMAGE_TYPE dst_type) {
+	return get_conversion(src_type, dst_type).valid();
+}
+
+bool convert(const COMPUTE_IMAGE_TYPE src_type, const COMPUTE_IMAGE_TYPE dst_type,
+			 const void* src, void* dst, const size_t pixel_count,
+			 const bool allow_parallel) {
+	const auto cv = get_conversion(src_type, dst_type);
+	if (!cv.valid()) {
+		return false;
+	}
+	if (pixel_count == 0) {
+		return true;
+	}
+	
+	const auto src_data = (const uint8_t*)src;
+	auto dst_data = (uint8_t*)dst;
+	
+	// split large conversions across multiple threads (at least 4 MiB of dst data per thread)
+	static constexpr const size_t min_parallel_size { 8u * 1024u * 1024u };
+	static constexpr const size_t min_thread_size { 4u * 1024u * 1024u };
+	const auto dst_size = pixel_count * cv.dst_bytes_per_pixel;
+	const auto thread_count = (allow_parallel && dst_size >= min_parallel_size ?
+							   std::min(size_t(core::get_hw_thread_count()), dst_size / min_thread_size) : size_t(1));
+	if (thread_count <= 1) {
+		convert_range(cv, src_data, dst_data, pixel_count);
+		return true;
+	}
+	
+	// keep chunks a multiple of 64 pixels so that vector blocks are never split
+	const auto pixels_per_thread = (((pixel_count + thread_count - 1u) / thread_count) + 63u) & ~size_t(63u);
+	vector<unique_ptr<thread>> threads;
+	threads.reserve(thread_count - 1u);
+	for (size_t offset = pixels_per_thread; offset < pixel_count; offset += pixels_per_thread) {
+		const auto count = std::min(pixels_per_thread, pixel_count - offset);
+		threads.emplace_back(make_unique<thread>([&cv, src_data, dst_data, offset, count] {
+			convert_range(cv, src_data + offset * cv.src_bytes_per_pixel, dst_data + offset * cv.dst_bytes_per_pixel, count);
+		}));
+	}
+	convert_range(cv, src_data, dst_data, std::min(pixels_per_thread, pixel_count));
+	for (auto& th : threads) {
+		th->join();
+	}
+	return true;
+}
+
+bool convert_inplace(const COMPUTE_IMAGE_TYPE src_type, const COMPUTE_IMAGE_TYPE dst_type,
+					 void* data, const size_t pixel_count) {
+	const auto cv = get_conversion(src_type, dst_type);
+	if (!cv.valid() || cv.dst_bytes_per_pixel < cv.src_bytes_per_pixel) {
+		return false;
+	}
+	
+	// dst pixels are at least as large as src pixels -> convert back-to-front in chunks,
+	// using a temporary copy of each src chunk so that src and dst never overlap
+	static constexpr const size_t chunk_pixel_count { 4096u };
+	alignas(16) uint8_t tmp[chunk_pixel_count * 16u /* max bytes per pixel */];
+	auto data_ptr = (uint8_t*)data;
+	size_t end = pixel_count;
+	while (end > 0) {
+		const auto begin = (end > chunk_pixel_count ? end - chunk_pixel_count : 0u);
+		const auto count = end - begin;
+		memcpy(tmp, data_ptr + begin * cv.src_bytes_per_pixel, count * cv.src_bytes_per_pixel);
+		convert_range(cv, tmp, data_ptr + begin * cv.dst_bytes_per_pixel, count);
+		end = begin;
+	}
+	return true;
+}
+
+}
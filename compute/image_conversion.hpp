@@ -0,0 +1,52 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_COMPUTE_IMAGE_CONVERSION_HPP__
+#define __FLOOR_COMPUTE_IMAGE_CONVERSION_HPP__
+
+#include <floor/core/essentials.hpp>
+#include <floor/core/enum_helpers.hpp>
+#include <floor/math/vector_lib.hpp>
+#include <floor/compute/device/image_types.hpp>
+
+//! pixel format conversion of tightly packed image data (used for image uploads/downloads on all backends)
+namespace image_conversion {
+	//! returns true if pixels of "src_type" can be converted to "dst_type", this supports all images with uniform
+	//! 8-bit, 16-bit or 32-bit channels (int/uint, normalized or not, half/float) and
+	//!  * any change of the channel count and channel layout (RGBA/BGRA/ABGR/ARGB),
+	//!    with missing color channels being set to 0 and a missing alpha channel being set to 1 (opaque)
+	//!  * identical channel data types, 8/16-bit normalized <-> 32-bit float, 16-bit half <-> 32-bit float
+	bool is_supported(const COMPUTE_IMAGE_TYPE src_type, const COMPUTE_IMAGE_TYPE dst_type);
+	
+	//! converts "pixel_count" pixels of "src_type" in "src" to "dst_type" in "dst", returns false if unsupported
+	//! NOTE: "src" and "dst" must not overlap
+	//! NOTE: large conversions are split across multiple threads if "allow_parallel" is true
+	bool convert(const COMPUTE_IMAGE_TYPE src_type, const COMPUTE_IMAGE_TYPE dst_type,
+				 const void* src, void* dst, const size_t pixel_count,
+				 const bool allow_parallel = true);
+	
+	//! in-place converts "pixel_count" pixels of "src_type" to "dst_type" in "data", returns false if unsupported
+	//! NOTE: the pixel size of "dst_type" must be >= the pixel size of "src_type" and "data" must be large enough
+	//!       to hold all "dst_type" pixels
+	bool convert_inplace(const COMPUTE_IMAGE_TYPE src_type, const COMPUTE_IMAGE_TYPE dst_type,
+						 void* data, const size_t pixel_count);
+	
+}
+
+#endif
@@ -18,6 +18,7 @@
 
 #include <floor/compute/llvm_toolchain.hpp>
 #include <floor/floor/floor.hpp>
+#include <floor/core/trace.hpp>
 #include <regex>
 #include <climits>
 
@@ -201,6 +202,8 @@ program_data compile_input(const string& input,
 						   const string& cmd_prefix,
 						   const compute_device& device,
 						   const compile_options options) {
+	FLOOR_TRACE_SCOPE("toolchain", "compile");
+	
 	// create the initial clang compilation command
 	string clang_cmd = cmd_prefix;
 	string libcxx_path = " -isystem \"", clang_path = " -isystem \"", floor_path = " -isystem \"";
@@ -568,7 +571,10 @@ program_data compile_input(const string& input,
 				//(!device.double_support ? " -DFLOOR_COMPUTE_NO_DOUBLE" : "")
 				" -DFLOOR_COMPUTE_NO_DOUBLE"
 				" -fno-stack-protector"
+				// emit per-function stack usage estimates (used to size the work-item fiber stacks)
+				" -fstack-size-section"
 			};
+			
 			libcxx_path += floor::get_host_base_path() + "libcxx";
 			clang_path += floor::get_host_base_path() + "clang";
 			floor_path += floor::get_host_base_path() + "floor";
@@ -63,6 +63,9 @@ namespace llvm_toolchain {
 		NONE							= (0u),
 		//! function makes use of soft-printf
 		USES_SOFT_PRINTF				= (1u << 0u),
+		//! function (potentially) makes use of barriers
+		//! NOTE: for Host-Compute, this is determined when loading the binary
+		USES_BARRIER					= (1u << 1u),
 	};
 	floor_global_enum_no_hash_ext(FUNCTION_FLAGS)
 
@@ -402,7 +402,7 @@ namespace metal_args {
 	template <ENCODER_TYPE enc_type>
 	bool set_and_handle_arguments(encoder_selector_t<enc_type> encoder,
 								  const vector<const function_info*>& entries,
-								  const vector<compute_kernel_arg>& args,
+								  const span<const compute_kernel_arg> args,
 								  const vector<compute_kernel_arg>& implicit_args) {
 		const size_t arg_count = args.size() + implicit_args.size();
 		idx_handler idx;
@@ -49,7 +49,7 @@ void metal_kernel::execute(const compute_queue& cqueue,
 						   const uint32_t& dim,
 						   const uint3& global_work_size,
 						   const uint3& local_work_size,
-						   const vector<compute_kernel_arg>& args) const {
+						   const span<const compute_kernel_arg> args) const {
 	// no cooperative support yet
 	if (is_cooperative) {
 		log_error("cooperative kernel execution is not supported for Metal");
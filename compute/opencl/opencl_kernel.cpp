@@ -38,7 +38,7 @@ void opencl_kernel::execute(const compute_queue& cqueue,
 							const uint32_t& work_dim,
 							const uint3& global_work_size,
 							const uint3& local_work_size_,
-							const vector<compute_kernel_arg>& args) const REQUIRES(!args_lock) {
+							const span<const compute_kernel_arg> args) const REQUIRES(!args_lock) {
 	// no cooperative support yet
 	if (is_cooperative) {
 		log_error("cooperative kernel execution is not supported for OpenCL");
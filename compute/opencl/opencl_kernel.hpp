@@ -55,7 +55,7 @@ public:
 				 const uint32_t& dim,
 				 const uint3& global_work_size,
 				 const uint3& local_work_size,
-				 const vector<compute_kernel_arg>& args) const override;
+				 const span<const compute_kernel_arg> args) const override;
 	
 	const kernel_entry* get_kernel_entry(const compute_device& dev) const override;
 	
@@ -26,6 +26,7 @@
 #include <floor/compute/vulkan/vulkan_device.hpp>
 #include <floor/core/file_io.hpp>
 #include <floor/core/core.hpp>
+#include <floor/core/trace.hpp>
 #include <floor/threading/task.hpp>
 #include <floor/floor/floor.hpp>
 
@@ -33,6 +34,8 @@ namespace universal_binary {
 	static constexpr const uint32_t min_required_toolchain_version_v2 { 80000u };
 	
 	unique_ptr<archive> load_archive(const string& file_name) {
+		FLOOR_TRACE_SCOPE("toolchain", "load_archive");
+		
 		string data;
 		if (!file_io::file_to_string(file_name, data)) {
 			return {};
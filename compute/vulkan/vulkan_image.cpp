@@ -385,10 +385,22 @@ bool vulkan_image::create_internal(const bool copy_host_data, const compute_queu
 		if(is_render_target) {
 			log_error("can't initialize a render target with host data!");
 		}
+		else if(shim_image_type != image_type) {
+			// convert the RGB host data directly into the RGBA staging memory (instead of copying + in-place conversion)
+			auto mapped_ptr = map(cqueue, COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE | COMPUTE_MEMORY_MAP_FLAG::BLOCK,
+								  shim_image_data_size, 0);
+			if(mapped_ptr == nullptr) {
+				log_error("failed to initialize image with host data (map failed)");
+				return false;
+			}
+			rgb_to_rgba(image_type, shim_image_type, (const uint8_t*)host_ptr, (uint8_t*)mapped_ptr, generate_mip_maps);
+			shim_data_converted = true;
+			if(!unmap(cqueue, mapped_ptr)) {
+				return false;
+			}
+		}
 		else {
-			if(!write_memory_data(cqueue, host_ptr,
-								  (shim_image_type != image_type ? shim_image_data_size : image_data_size), 0,
-								  (shim_image_type != image_type ? image_data_size : 0),
+			if(!write_memory_data(cqueue, host_ptr, image_data_size, 0, 0,
 								  "failed to initialize image with host data (map failed)")) {
 				return false;
 			}
@@ -598,10 +610,11 @@ void vulkan_image::image_copy_host_to_dev(const compute_queue& cqueue, VkCommand
 			   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 			   VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 	
-	// RGB -> RGBA data conversion if necessary
-	if(image_type != shim_image_type) {
+	// RGB -> RGBA data conversion if necessary (and not already done while writing the data)
+	if(image_type != shim_image_type && !shim_data_converted) {
 		rgb_to_rgba_inplace(image_type, shim_image_type, (uint8_t*)data, generate_mip_maps);
 	}
+	shim_data_converted = false;
 	
 	vector<VkBufferImageCopy> regions;
 	regions.reserve(mip_level_count);
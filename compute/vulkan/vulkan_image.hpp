@@ -155,6 +155,9 @@ protected:
 	VkFormat vk_format { VK_FORMAT_UNDEFINED };
 	VkDeviceSize allocation_size { 0 };
 	bool is_external { false };
+	// set when RGB host data has already been converted to RGBA while writing it to the staging buffer,
+	// so that the in-place conversion in image_copy_host_to_dev can be skipped
+	bool shim_data_converted { false };
 
 	// contains each individual layer of an image array that has been created with aliasing support
 	vector<VkImage> image_aliased_layers;
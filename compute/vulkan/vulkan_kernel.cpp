@@ -272,7 +272,7 @@ static inline void arg_post_handler(const vulkan_kernel::vulkan_kernel_entry& en
 bool vulkan_kernel::set_and_handle_arguments(vulkan_encoder& encoder,
 											 const vector<const vulkan_kernel_entry*>& shader_entries,
 											 idx_handler& idx,
-											 const vector<compute_kernel_arg>& args,
+											 const span<const compute_kernel_arg> args,
 											 const vector<compute_kernel_arg>& implicit_args) const {
 	const size_t arg_count = args.size() + implicit_args.size();
 	size_t explicit_idx = 0, implicit_idx = 0;
@@ -312,13 +312,16 @@ void vulkan_kernel::execute(const compute_queue& cqueue,
 							const uint32_t& dim floor_unused,
 							const uint3& global_work_size,
 							const uint3& local_work_size_,
-							const vector<compute_kernel_arg>& args) const {
+							const span<const compute_kernel_arg> args) const {
 	// no cooperative support yet
 	if (is_cooperative) {
 		log_error("cooperative kernel execution is not supported for Vulkan");
 		return;
 	}
 	
+	// queue time of this execution (only needed when logging kernel events)
+	const auto queued_time = (cqueue.is_kernel_event_logging() ? compute_queue::get_kernel_event_time() : 0u);
+	
 	// find entry for queue device
 	const auto kernel_iter = get_kernel(cqueue);
 	if(kernel_iter == kernels.cend()) {
@@ -396,7 +399,15 @@ void vulkan_kernel::execute(const compute_queue& cqueue,
 	
 	// set dims + pipeline
 	// TODO: check if grid_dim matches compute shader defintion
+	const auto& vk_queue = (const vulkan_queue&)cqueue;
+	const auto log_kernel_event = (vk_queue.is_kernel_event_logging() && vk_queue.has_kernel_event_support());
+	if(log_kernel_event) {
+		vk_queue.write_kernel_event_start(encoder->cmd_buffer);
+	}
 	vkCmdDispatch(encoder->cmd_buffer.cmd_buffer, grid_dim.x, grid_dim.y, grid_dim.z);
+	if(log_kernel_event) {
+		vk_queue.write_kernel_event_end(encoder->cmd_buffer, entry.info->name, queued_time);
+	}
 	
 	// all done here, end + submit
 	VK_CALL_RET(vkEndCommandBuffer(encoder->cmd_buffer.cmd_buffer), "failed to end command buffer")
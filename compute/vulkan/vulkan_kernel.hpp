@@ -91,7 +91,7 @@ public:
 				 const uint32_t& dim,
 				 const uint3& global_work_size,
 				 const uint3& local_work_size,
-				 const vector<compute_kernel_arg>& args) const override;
+				 const span<const compute_kernel_arg> args) const override;
 	
 	const kernel_entry* get_kernel_entry(const compute_device& dev) const override;
 	
@@ -115,7 +115,7 @@ protected:
 	bool set_and_handle_arguments(vulkan_encoder& encoder,
 								  const vector<const vulkan_kernel_entry*>& shader_entries,
 								  idx_handler& idx,
-								  const vector<compute_kernel_arg>& args,
+								  const span<const compute_kernel_arg> args,
 								  const vector<compute_kernel_arg>& implicit_args) const;
 	
 	// actual argument setters
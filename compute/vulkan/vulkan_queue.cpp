@@ -60,6 +60,23 @@ compute_queue(device_), queue(queue_), family_index(family_index_) {
 					"failed to create fence #" + to_string(i))
 	}
 	fences_in_use.reset();
+	
+	// create the timestamp query pool for kernel events (if supported)
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(((const vulkan_device&)device).physical_device, &props);
+	if (props.limits.timestampComputeAndGraphics && props.limits.timestampPeriod > 0.0f) {
+		timestamp_period = double(props.limits.timestampPeriod);
+		const VkQueryPoolCreateInfo query_pool_info {
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = cmd_buffer_count * 2u,
+			.pipelineStatistics = 0,
+		};
+		VK_CALL_RET(vkCreateQueryPool(((const vulkan_device&)device).device, &query_pool_info, nullptr, &timestamp_query_pool),
+					"failed to create timestamp query pool")
+	}
 }
 
 void vulkan_queue::finish() const {
@@ -219,6 +236,40 @@ void vulkan_queue::submit_command_buffer(const vulkan_command_buffer& cmd_buffer
 	}
 }
 
+void vulkan_queue::write_kernel_event_start(const vulkan_command_buffer& cmd_buffer) const {
+	if (timestamp_query_pool == nullptr) {
+		return;
+	}
+	vkCmdResetQueryPool(cmd_buffer.cmd_buffer, timestamp_query_pool, cmd_buffer.index * 2u, 2u);
+	vkCmdWriteTimestamp(cmd_buffer.cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_query_pool, cmd_buffer.index * 2u);
+}
+
+void vulkan_queue::write_kernel_event_end(const vulkan_command_buffer& cmd_buffer, const string& kernel_name,
+										  const uint64_t queued_time) const {
+	if (timestamp_query_pool == nullptr) {
+		return;
+	}
+	vkCmdWriteTimestamp(cmd_buffer.cmd_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_query_pool, cmd_buffer.index * 2u + 1u);
+	
+	// NOTE: the queries of this command buffer can't be reused before the command buffer has completed
+	add_completion_handler(cmd_buffer, [this, query_idx = cmd_buffer.index * 2u, kernel_name, queued_time]() {
+		array<uint64_t, 2> timestamps {};
+		const auto ret = vkGetQueryPoolResults(((const vulkan_device&)device).device, timestamp_query_pool, query_idx, 2u,
+											   sizeof(timestamps), timestamps.data(), sizeof(uint64_t),
+											   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+		if (ret != VK_SUCCESS) {
+			log_error("failed to retrieve kernel event timestamps for kernel \"%s\": %s", kernel_name, vulkan_error_to_string(ret));
+			return;
+		}
+		log_kernel_event({
+			.kernel_name = kernel_name,
+			.queued = queued_time,
+			.start = uint64_t(double(timestamps[0]) * timestamp_period),
+			.end = uint64_t(double(timestamps[1]) * timestamp_period),
+		});
+	});
+}
+
 void vulkan_queue::add_retained_buffers(const vulkan_command_buffer& cmd_buffer,
 										const vector<shared_ptr<compute_buffer>>& buffers) const {
 	GUARD(cmd_buffers_lock);
@@ -113,6 +113,18 @@ public:
 	void add_completion_handler(const vulkan_command_buffer& cmd_buffer,
 								vulkan_completion_handler_t completion_handler) const REQUIRES(!cmd_buffers_lock);
 	
+	bool has_kernel_event_support() const override {
+		return (timestamp_query_pool != nullptr);
+	}
+	
+	//! writes the start timestamp of a kernel event into the specified command buffer (resets its timestamp queries first)
+	void write_kernel_event_start(const vulkan_command_buffer& cmd_buffer) const;
+	
+	//! writes the end timestamp of a kernel event into the specified command buffer and adds a completion handler
+	//! that reads back both timestamps and logs the kernel event
+	void write_kernel_event_end(const vulkan_command_buffer& cmd_buffer, const string& kernel_name,
+								const uint64_t queued_time) const REQUIRES(!cmd_buffers_lock);
+	
 protected:
 	VkQueue queue GUARDED_BY(queue_lock);
 	mutable safe_mutex queue_lock;
@@ -137,6 +149,12 @@ protected:
 	mutable safe_mutex fence_lock;
 	mutable array<VkFence, fence_count> fences GUARDED_BY(fence_lock);
 	mutable bitset<fence_count> fences_in_use GUARDED_BY(fence_lock);
+	
+	//! timestamp queries used for kernel events: two timestamps (start + end) per command buffer, indexed by command buffer index
+	//! NOTE: nullptr if timestamps are not supported by the device
+	VkQueryPool timestamp_query_pool { nullptr };
+	//! amount of nanoseconds per timestamp tick
+	double timestamp_period { 1.0 };
 	pair<VkFence, uint32_t> acquire_fence() const REQUIRES(!fence_lock);
 	void release_fence(VkDevice dev, const pair<VkFence, uint32_t>& fence) const REQUIRES(!fence_lock);
 	
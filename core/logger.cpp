@@ -20,6 +20,7 @@
 #include <sys/time.h>
 #endif
 #include <floor/core/logger.hpp>
+#include <floor/core/trace.hpp>
 #include <floor/threading/thread_base.hpp>
 #include <floor/core/cpp_headers.hpp>
 #include <floor/constexpr/const_math.hpp>
@@ -88,6 +89,9 @@ void logger_thread::run() {
 		return;
 	}
 	
+	floor_trace::counter("logger", "flushed messages", int64_t(log_output_store.size()));
+	FLOOR_TRACE_SCOPE("logger", "flush");
+	
 	// in append mode, close the file and reopen it in append mode
 	if(log_append_mode) {
 		if(log_file->is_open()) {
@@ -0,0 +1,234 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <floor/core/trace.hpp>
+#include <floor/core/core.hpp>
+#include <floor/core/file_io.hpp>
+#include <floor/core/logger.hpp>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <unordered_set>
+#include <cstdio>
+
+atomic<bool> floor_trace::enabled { false };
+
+namespace floor_trace_internal {
+
+struct event_t {
+	//! in ns (steady clock)
+	uint64_t time;
+	const char* category;
+	const char* name;
+	int64_t value;
+	floor_trace::EVENT_TYPE type;
+};
+
+//! per-thread event buffer: a list of fixed-size chunks that is only ever appended to by the owning thread,
+//! the exporting thread can concurrently read all events up to the (atomic) event count of each chunk
+struct thread_buffer_t {
+	static constexpr const uint32_t chunk_event_count { 4096u };
+	//! max amount of chunks per thread (-> ~160MiB per thread), further events are dropped
+	static constexpr const uint32_t max_chunk_count { 1024u };
+	
+	struct chunk_t {
+		event_t events[chunk_event_count];
+		atomic<uint32_t> count { 0u };
+		atomic<chunk_t*> next { nullptr };
+	};
+	
+	uint32_t tid { 0u };
+	string thread_name;
+	chunk_t* first { nullptr };
+	//! only accessed by the owning thread
+	chunk_t* cur { nullptr };
+	uint32_t chunk_count { 0u };
+	atomic<uint64_t> dropped_count { 0u };
+	
+	thread_buffer_t(const uint32_t tid_, string&& thread_name_) : tid(tid_), thread_name(move(thread_name_)) {
+		first = new chunk_t();
+		cur = first;
+		chunk_count = 1;
+	}
+	~thread_buffer_t() {
+		for (auto chunk = first; chunk != nullptr;) {
+			auto next = chunk->next.load();
+			delete chunk;
+			chunk = next;
+		}
+	}
+};
+
+//! all thread buffers (these outlive their threads)
+static mutex buffers_lock;
+static vector<unique_ptr<thread_buffer_t>> buffers;
+static thread_local thread_buffer_t* cur_thread_buffer { nullptr };
+
+//! all interned strings
+static mutex interned_lock;
+static unordered_set<string> interned_strings;
+
+//! events before this time are discarded on export
+static atomic<uint64_t> clear_time { 0u };
+
+static uint64_t now() {
+	return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static thread_buffer_t* register_thread() {
+	lock_guard<mutex> lock(buffers_lock);
+	buffers.emplace_back(make_unique<thread_buffer_t>(uint32_t(buffers.size()) + 1u, core::get_current_thread_name()));
+	cur_thread_buffer = buffers.back().get();
+	return cur_thread_buffer;
+}
+
+//! appends "str" as an escaped JSON string (including quotes)
+static void append_json_string(string& json, const char* str) {
+	json += '"';
+	for (const char* ch = str; *ch != '\0'; ++ch) {
+		switch (*ch) {
+			case '"': json += "\\\""; break;
+			case '\\': json += "\\\\"; break;
+			case '\n': json += "\\n"; break;
+			case '\r': json += "\\r"; break;
+			case '\t': json += "\\t"; break;
+			default:
+				if ((unsigned char)*ch < 0x20u) {
+					char escaped[8];
+					snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)(unsigned char)*ch);
+					json += escaped;
+				} else {
+					json += *ch;
+				}
+				break;
+		}
+	}
+	json += '"';
+}
+
+} // namespace floor_trace_internal
+using namespace floor_trace_internal;
+
+void floor_trace::enable() {
+	enabled = true;
+}
+
+void floor_trace::disable() {
+	enabled = false;
+}
+
+void floor_trace::record(const EVENT_TYPE type, const char* category, const char* name, const int64_t value) {
+	auto buffer = cur_thread_buffer;
+	if (buffer == nullptr) {
+		buffer = register_thread();
+	}
+	
+	auto chunk = buffer->cur;
+	auto idx = chunk->count.load(memory_order_relaxed);
+	if (idx == thread_buffer_t::chunk_event_count) {
+		if (buffer->chunk_count >= thread_buffer_t::max_chunk_count) {
+			buffer->dropped_count.fetch_add(1u, memory_order_relaxed);
+			return;
+		}
+		auto new_chunk = new thread_buffer_t::chunk_t();
+		chunk->next.store(new_chunk, memory_order_release);
+		buffer->cur = new_chunk;
+		++buffer->chunk_count;
+		chunk = new_chunk;
+		idx = 0;
+	}
+	chunk->events[idx] = { now(), category, name, value, type };
+	chunk->count.store(idx + 1u, memory_order_release);
+}
+
+const char* floor_trace::intern(const string_view str) {
+	lock_guard<mutex> lock(interned_lock);
+	return interned_strings.emplace(str).first->c_str();
+}
+
+void floor_trace::clear() {
+	clear_time = now();
+}
+
+string floor_trace::to_json() {
+	string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool is_first = true;
+	const auto min_time = clear_time.load();
+	char num_str[64];
+	
+	lock_guard<mutex> lock(buffers_lock);
+	for (const auto& buffer : buffers) {
+		// thread name metadata
+		if (!is_first) {
+			json += ',';
+		}
+		is_first = false;
+		snprintf(num_str, sizeof(num_str), "%u", buffer->tid);
+		json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+		json += num_str;
+		json += ",\"args\":{\"name\":";
+		append_json_string(json, buffer->thread_name.c_str());
+		json += "}}";
+		
+		for (auto chunk = buffer->first; chunk != nullptr; chunk = chunk->next.load(memory_order_acquire)) {
+			const auto count = chunk->count.load(memory_order_acquire);
+			for (uint32_t i = 0; i < count; ++i) {
+				const auto& evt = chunk->events[i];
+				if (evt.time < min_time) {
+					continue;
+				}
+				
+				json += ",{\"name\":";
+				append_json_string(json, evt.name);
+				json += ",\"cat\":";
+				append_json_string(json, evt.category);
+				switch (evt.type) {
+					case EVENT_TYPE::BEGIN: json += ",\"ph\":\"B\""; break;
+					case EVENT_TYPE::END: json += ",\"ph\":\"E\""; break;
+					case EVENT_TYPE::INSTANT: json += ",\"ph\":\"i\",\"s\":\"t\""; break;
+					case EVENT_TYPE::COUNTER: json += ",\"ph\":\"C\""; break;
+				}
+				// timestamps are in microseconds
+				snprintf(num_str, sizeof(num_str), ",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u",
+						 (unsigned long long)(evt.time / 1000u), (unsigned int)(evt.time % 1000u), buffer->tid);
+				json += num_str;
+				if (evt.type == EVENT_TYPE::COUNTER) {
+					snprintf(num_str, sizeof(num_str), ",\"args\":{\"value\":%lld}", (long long)evt.value);
+					json += num_str;
+				}
+				json += '}';
+			}
+		}
+		
+		if (const auto dropped_count = buffer->dropped_count.load(); dropped_count > 0) {
+			log_warn("trace: dropped %u events of thread \"%s\" (buffer is full)", dropped_count, buffer->thread_name);
+		}
+	}
+	json += "]}";
+	return json;
+}
+
+bool floor_trace::dump_json(const string& file_name) {
+	if (!file_io::string_to_file(file_name, to_json())) {
+		log_error("failed to write trace to \"%s\"", file_name);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,141 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_TRACE_HPP__
+#define __FLOOR_TRACE_HPP__
+
+#include <floor/core/essentials.hpp>
+#include <atomic>
+#include <string>
+#include <string_view>
+using namespace std;
+
+//! low-overhead tracing of runtime activity (kernel executions, memory transfers, compilation, tasks, ...)
+//!
+//! events are recorded into lock-free per-thread buffers (only the first event of a thread takes a lock) and can be
+//! exported as Chrome Trace Event JSON (loadable in chrome://tracing and Perfetto) at any time
+//! NOTE: when tracing is disabled, each trace point only costs a single (predictable) branch
+//! NOTE: "category" and "name" of all events must stay valid until the trace is exported,
+//!       i.e. these should be string literals or interned strings (see intern())
+class floor_trace {
+public:
+	enum class EVENT_TYPE : uint32_t {
+		//! begin of a duration (must be matched by an END event on the same thread)
+		BEGIN,
+		//! end of a duration
+		END,
+		//! a single point in time
+		INSTANT,
+		//! a counter value at a point in time
+		COUNTER,
+	};
+	
+	//! returns true if tracing is currently enabled
+	static bool is_enabled() {
+		return enabled.load(memory_order_relaxed);
+	}
+	
+	//! enables tracing (all subsequent events are recorded)
+	static void enable();
+	//! disables tracing (already recorded events are kept)
+	static void disable();
+	
+	//! records the begin of a duration
+	static void begin(const char* category, const char* name) {
+		if (is_enabled()) {
+			record(EVENT_TYPE::BEGIN, category, name, 0);
+		}
+	}
+	//! records the end of a duration
+	static void end(const char* category, const char* name) {
+		if (is_enabled()) {
+			record(EVENT_TYPE::END, category, name, 0);
+		}
+	}
+	//! records a single point in time
+	static void instant(const char* category, const char* name) {
+		if (is_enabled()) {
+			record(EVENT_TYPE::INSTANT, category, name, 0);
+		}
+	}
+	//! records a counter value
+	static void counter(const char* category, const char* name, const int64_t value) {
+		if (is_enabled()) {
+			record(EVENT_TYPE::COUNTER, category, name, value);
+		}
+	}
+	
+	//! returns a pointer to a string with the same contents as "str" that stays valid until program termination
+	//! NOTE: this takes a lock, only use this for dynamic names (when tracing is enabled)
+	static const char* intern(const string_view str);
+	
+	//! discards all events that have been recorded so far
+	//! NOTE: memory of discarded events is not reclaimed
+	static void clear();
+	
+	//! returns all recorded events as Chrome Trace Event JSON
+	//! NOTE: events that are being recorded concurrently may or may not be included
+	static string to_json();
+	
+	//! writes all recorded events as Chrome Trace Event JSON to the specified file, returns true on success
+	static bool dump_json(const string& file_name);
+	
+	//! RAII helper that records a BEGIN event on construction and the matching END event on destruction
+	class scope {
+	public:
+		scope(const char* category_, const char* name_) : category(category_), name(name_), active(is_enabled()) {
+			if (active) {
+				record(EVENT_TYPE::BEGIN, category, name, 0);
+			}
+		}
+		~scope() {
+			// NOTE: always end a begun duration, even if tracing has been disabled in between
+			if (active) {
+				record(EVENT_TYPE::END, category, name, 0);
+			}
+		}
+		
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+		
+	protected:
+		const char* category;
+		const char* name;
+		const bool active;
+	};
+	
+protected:
+	static atomic<bool> enabled;
+	
+	//! records an event into the buffer of the calling thread
+	static void record(const EVENT_TYPE type, const char* category, const char* name, const int64_t value);
+	
+	// static class
+	floor_trace(const floor_trace&) = delete;
+	~floor_trace() = delete;
+	floor_trace& operator=(const floor_trace&) = delete;
+	
+};
+
+#define FLOOR_TRACE_CONCAT_(a, b) a##b
+#define FLOOR_TRACE_CONCAT(a, b) FLOOR_TRACE_CONCAT_(a, b)
+//! traces the duration of the current scope
+#define FLOOR_TRACE_SCOPE(category, name) floor_trace::scope FLOOR_TRACE_CONCAT(floor_trace_scope_, __LINE__) { category, name }
+
+#endif
@@ -23,6 +23,7 @@
 #include <floor/core/sig_handler.hpp>
 #include <floor/core/json.hpp>
 #include <floor/core/aligned_ptr.hpp>
+#include <floor/core/trace.hpp>
 #include <floor/compute/opencl/opencl_compute.hpp>
 #include <floor/compute/cuda/cuda_compute.hpp>
 #include <floor/compute/metal/metal_compute.hpp>
@@ -344,6 +345,7 @@ bool floor::init(const init_state& state) {
 		config.log_use_color = config_doc.get<bool>("logging.use_color", true);
 		config.log_filename = config_doc.get<string>("logging.log_filename", "");
 		config.msg_filename = config_doc.get<string>("logging.msg_filename", "");
+		config.trace_filename = config_doc.get<string>("logging.trace_filename", "");
 		
 		config.fov = config_doc.get<float>("projection.fov", 72.0f);
 		config.near_far_plane.x = config_doc.get<float>("projection.near", 1.0f);
@@ -667,6 +669,10 @@ bool floor::init(const init_state& state) {
 				 config.log_filename, config.msg_filename);
 	log_debug("$", (FLOOR_VERSION_STRING).c_str());
 	
+	if(!config.trace_filename.empty()) {
+		floor_trace::enable();
+	}
+	
 	// choose the renderer
 	if(state.renderer == RENDERER::DEFAULT) {
 #if !defined(__APPLE__)
@@ -807,6 +813,13 @@ void floor::destroy() {
 	}
 	SDL_Quit();
 	
+	if(!config.trace_filename.empty()) {
+		floor_trace::disable();
+		if(floor_trace::dump_json(config.trace_filename)) {
+			log_debug("wrote trace to \"%s\"", config.trace_filename);
+		}
+	}
+	
 	log_debug("floor destroyed!");
 	floor_init_status = FLOOR_INIT_STATUS::UNINITIALIZED;
 }
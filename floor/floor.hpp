@@ -370,6 +370,8 @@ protected:
 		bool log_use_color = true;
 		string log_filename = "";
 		string msg_filename = "";
+		//! if non-empty, enables runtime tracing and writes a Chrome Trace Event JSON file to this path on destruction
+		string trace_filename = "";
 		
 		// projection
 		float fov = 72.0f;
@@ -39,7 +39,7 @@ public:
 				 const uint32_t& dim,
 				 const uint3& global_work_size,
 				 const uint3& local_work_size,
-				 const vector<compute_kernel_arg>& args) const override;
+				 const span<const compute_kernel_arg> args) const override;
 	
 	//! sets and handles all vertex and fragment shader arguments in the specified encoder
 	void set_shader_arguments(const compute_queue& cqueue,
@@ -47,7 +47,7 @@ public:
 							  id <MTLCommandBuffer> cmd_buffer,
 							  const metal_kernel_entry* vertex_shader,
 							  const metal_kernel_entry* fragment_shader,
-							  const vector<compute_kernel_arg>& args) const;
+							  const span<const compute_kernel_arg> args) const;
 	
 	//! enqueue draw call(s) of the specified primitive type in the specified encoder
 	void draw(id <MTLRenderCommandEncoder> encoder, const PRIMITIVE& primitive,
@@ -35,7 +35,7 @@ void metal_shader::execute(const compute_queue& cqueue floor_unused,
 						   const uint32_t& dim floor_unused,
 						   const uint3& global_work_size floor_unused,
 						   const uint3& local_work_size floor_unused,
-						   const vector<compute_kernel_arg>& args floor_unused) const {
+						   const span<const compute_kernel_arg> args floor_unused) const {
 	log_error("executing a shader is not supported!");
 }
 
@@ -44,7 +44,7 @@ void metal_shader::set_shader_arguments(const compute_queue& cqueue,
 										id <MTLCommandBuffer> cmd_buffer,
 										const metal_kernel_entry* vertex_shader,
 										const metal_kernel_entry* fragment_shader,
-										const vector<compute_kernel_arg>& args) const {
+										const span<const compute_kernel_arg> args) const {
 	// create implicit args
 	vector<compute_kernel_arg> implicit_args;
 
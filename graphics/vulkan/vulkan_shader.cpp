@@ -38,7 +38,7 @@ void vulkan_shader::execute(const compute_queue& cqueue floor_unused,
 							const uint32_t& dim floor_unused,
 							const uint3& global_work_size floor_unused,
 							const uint3& local_work_size floor_unused,
-							const vector<compute_kernel_arg>& args floor_unused) const {
+							const span<const compute_kernel_arg> args floor_unused) const {
 	log_error("executing a shader is not supported!");
 }
 
@@ -50,7 +50,7 @@ void vulkan_shader::draw(const compute_queue& cqueue,
 						 const vulkan_kernel_entry* fragment_shader,
 						 const vector<graphics_renderer::multi_draw_entry>* draw_entries,
 						 const vector<graphics_renderer::multi_draw_indexed_entry>* draw_indexed_entries,
-						 const vector<compute_kernel_arg>& args) const {
+						 const span<const compute_kernel_arg> args) const {
 	if (vertex_shader == nullptr) {
 		log_error("must specify a vertex shader!");
 		return;
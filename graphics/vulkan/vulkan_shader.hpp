@@ -41,7 +41,7 @@ public:
 				 const uint32_t& dim,
 				 const uint3& global_work_size,
 				 const uint3& local_work_size,
-				 const vector<compute_kernel_arg>& args) const override;
+				 const span<const compute_kernel_arg> args) const override;
 	
 	
 	//! sets and handles all vertex and fragment shader arguments and enqueue draw call(s)
@@ -53,7 +53,7 @@ public:
 			  const vulkan_kernel_entry* fragment_shader,
 			  const vector<graphics_renderer::multi_draw_entry>* draw_entries,
 			  const vector<graphics_renderer::multi_draw_indexed_entry>* draw_indexed_entries,
-			  const vector<compute_kernel_arg>& args) const;
+			  const span<const compute_kernel_arg> args) const;
 	
 	//! sets and handles all vertex and fragment shader arguments and enqueue draw call(s)
 	template <typename... Args>
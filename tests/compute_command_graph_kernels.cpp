@@ -0,0 +1,31 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! adds "value" to each element
+kernel void add_value(buffer<uint32_t> data, param<uint32_t> value) {
+	data[global_id.x] += value;
+}
+
+//! multiplies each element by "value"
+kernel void mul_value(buffer<uint32_t> data, param<uint32_t> value) {
+	data[global_id.x] *= value;
+}
@@ -0,0 +1,160 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+#include <floor/compute/compute_command_graph.hpp>
+#include <algorithm>
+
+static constexpr const uint32_t elem_count { 1024u };
+
+//! returns true if all elements of "buf" are equal to "expected"
+static bool check_buffer(compute_buffer& buf, const uint32_t expected) {
+	vector<uint32_t> data(elem_count);
+	buf.read(*floor_test::queue, data.data());
+	return all_of(data.begin(), data.end(), [&expected](const uint32_t& val) { return val == expected; });
+}
+
+//! recording, finalization, replay and arg patching
+static void test_record_replay(const compute_kernel& add_kernel, const compute_kernel& mul_kernel) {
+	auto& queue = *floor_test::queue;
+	auto buf_a = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+	auto buf_b = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+	buf_a->zero(queue);
+	buf_b->zero(queue);
+	
+	auto graph = queue.create_command_graph();
+	test_check(graph != nullptr);
+	if (!graph) {
+		return;
+	}
+	
+	// data = (data + 3) * 2
+	const uint32_t add_val { 3u }, mul_val { 2u };
+	const auto add_cmd = graph->add_kernel(add_kernel, uint1 { elem_count }, uint1 { 64u }, buf_a, add_val);
+	const auto mul_cmd = graph->add_kernel(mul_kernel, uint1 { elem_count }, uint1 { 64u }, buf_a, mul_val);
+	test_check(add_cmd == 0u);
+	test_check(mul_cmd == 1u);
+	test_check(graph->get_command_count() == 2u);
+	test_check(!graph->is_finalized());
+	
+	// replaying before finalization must not execute anything
+	graph->replay();
+	queue.finish();
+	test_check(check_buffer(*buf_a, 0u));
+	
+	test_check(graph->finalize());
+	test_check(graph->is_finalized());
+	// no more commands can be added after finalization
+	test_check(graph->add_kernel(add_kernel, uint1 { elem_count }, uint1 { 64u }, buf_a, add_val) == ~0u);
+	test_check(graph->get_command_count() == 2u);
+	
+	graph->replay();
+	queue.finish();
+	test_check(check_buffer(*buf_a, 6u));
+	graph->replay();
+	queue.finish();
+	test_check(check_buffer(*buf_a, 18u));
+	
+	// generic args are copied on patching -> modifying the source value afterwards must not have an effect
+	uint32_t new_add_val { 5u };
+	test_check(graph->set_arg(add_cmd, 1u, new_add_val));
+	new_add_val = 100u;
+	graph->replay();
+	queue.finish();
+	test_check(check_buffer(*buf_a, 46u));
+	
+	// patch the buffer of both commands
+	test_check(graph->set_arg(add_cmd, 0u, buf_b));
+	test_check(graph->set_arg(mul_cmd, 0u, buf_b));
+	graph->replay();
+	queue.finish();
+	test_check(check_buffer(*buf_a, 46u));
+	test_check(check_buffer(*buf_b, 10u));
+	
+	// invalid patches must be rejected
+	const uint64_t wrong_size_val { 1u };
+	test_check(!graph->set_arg(2u, 0u, buf_b));
+	test_check(!graph->set_arg(add_cmd, 2u, buf_b));
+	test_check(!graph->set_arg(add_cmd, 0u, add_val));
+	test_check(!graph->set_arg(add_cmd, 1u, wrong_size_val));
+	
+	// replays are executed in order with immediate executions
+	graph->replay();
+	queue.execute(add_kernel, uint1 { elem_count }, uint1 { 64u }, buf_b, add_val);
+	graph->replay();
+	queue.finish();
+	test_check(check_buffer(*buf_b, ((((10u + 5u) * 2u) + 3u) + 5u) * 2u));
+}
+
+//! replay vs immediate mode: a "frame" of many small kernel executions on the same buffers
+static void bench_replay(const compute_kernel& add_kernel, const compute_kernel& mul_kernel) {
+	auto& queue = *floor_test::queue;
+	static constexpr const uint32_t iterations { 1000u };
+	for (const auto command_count : { 4u, 32u, 256u }) {
+		auto buf = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+		buf->zero(queue);
+		const uint32_t add_val { 1u }, mul_val { 1u };
+		
+		const auto immediate_time = floor_test::time_us(iterations, [&] {
+			for (uint32_t i = 0; i < command_count; ++i) {
+				if (i % 2u == 0u) {
+					queue.execute(add_kernel, uint1 { elem_count }, uint1 { 64u }, buf, add_val);
+				} else {
+					queue.execute(mul_kernel, uint1 { elem_count }, uint1 { 64u }, buf, mul_val);
+				}
+			}
+			queue.finish();
+		});
+		
+		auto graph = queue.create_command_graph();
+		for (uint32_t i = 0; i < command_count; ++i) {
+			if (i % 2u == 0u) {
+				graph->add_kernel(add_kernel, uint1 { elem_count }, uint1 { 64u }, buf, add_val);
+			} else {
+				graph->add_kernel(mul_kernel, uint1 { elem_count }, uint1 { 64u }, buf, mul_val);
+			}
+		}
+		graph->finalize();
+		const auto replay_time = floor_test::time_us(iterations, [&] {
+			graph->replay();
+			queue.finish();
+		});
+		
+		log_msg("%u commands per frame: immediate: %fus, replay: %fus (%fx faster)",
+				command_count, immediate_time, replay_time, immediate_time / replay_time);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	auto add_kernel = floor_test::get_kernel("add_value");
+	auto mul_kernel = floor_test::get_kernel("mul_value");
+	if (add_kernel && mul_kernel) {
+		test_record_replay(*add_kernel, *mul_kernel);
+		if (floor_test::run_benchmarks) {
+			bench_replay(*add_kernel, *mul_kernel);
+		}
+	}
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,335 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/host/elf_binary.hpp>
+#include <cstring>
+
+#if defined(__x86_64__) && !defined(__WINDOWS__) // elf_binary only supports x86-64 binaries on non-Windows platforms
+
+//! minimal builder for relocatable x86-64 ELF binaries as they are emitted by the host-compute device toolchain:
+//! section #0 is the null section, followed by all user sections, then .symtab and .strtab (which also holds section names)
+namespace test_elf {
+	static constexpr const uint32_t section_type_program_data { 1u };
+	static constexpr const uint32_t section_type_symbol_table { 2u };
+	static constexpr const uint32_t section_type_string_table { 3u };
+	static constexpr const uint32_t section_type_relocation_addend { 4u };
+	static constexpr const uint64_t section_flag_alloc { 0x2u };
+	static constexpr const uint64_t section_flag_exec { 0x4u };
+	static constexpr const uint64_t section_flag_info_link { 0x40u };
+	static constexpr const uint8_t symbol_type_none { 0u };
+	static constexpr const uint8_t symbol_type_code { 2u };
+	static constexpr const uint8_t symbol_type_section { 3u };
+	static constexpr const uint8_t symbol_binding_global { 1u };
+	static constexpr const uint32_t reloc_type_direct_64 { 1u };
+	static constexpr const uint32_t reloc_type_pc32 { 2u };
+	
+	struct section_t {
+		string name;
+		uint32_t type { section_type_program_data };
+		uint64_t flags { 0u };
+		vector<uint8_t> data;
+		//! index of the section the relocations apply to (sh_info, only used for relocation sections)
+		uint32_t info { 0u };
+		uint64_t alignment { 1u };
+	};
+	struct symbol_t {
+		string name;
+		uint8_t type { symbol_type_code };
+		//! 0 = external/undefined
+		uint16_t section_idx { 0u };
+		uint64_t value { 0u };
+		uint64_t size { 0u };
+	};
+	struct relocation_t {
+		uint64_t offset;
+		uint32_t type;
+		//! index into the symbol list (#0 is the null symbol, the user symbols start at #1)
+		uint32_t symbol_idx;
+		int64_t addend { 0 };
+	};
+	
+	//! returns the data of a relocation section containing "relocs"
+	static vector<uint8_t> make_relocations(const vector<relocation_t>& relocs) {
+		vector<uint8_t> data(relocs.size() * 24u);
+		for (size_t i = 0; i < relocs.size(); ++i) {
+			const uint64_t info = (uint64_t(relocs[i].symbol_idx) << 32ull) | uint64_t(relocs[i].type);
+			memcpy(&data[i * 24u], &relocs[i].offset, 8u);
+			memcpy(&data[i * 24u + 8u], &info, 8u);
+			memcpy(&data[i * 24u + 16u], &relocs[i].addend, 8u);
+		}
+		return data;
+	}
+	
+	template <typename T>
+	static void append(vector<uint8_t>& dst, const T& value) {
+		const auto offset = dst.size();
+		dst.resize(offset + sizeof(T));
+		memcpy(&dst[offset], &value, sizeof(T));
+	}
+	
+	static vector<uint8_t> build(const vector<section_t>& sections, const vector<symbol_t>& symbols) {
+		const auto symtab_idx = uint32_t(sections.size() + 1u);
+		const auto strtab_idx = symtab_idx + 1u;
+		const auto section_count = strtab_idx + 1u;
+		
+		// string table: null string, section names, symbol names
+		vector<uint8_t> strtab(1u, 0u);
+		const auto add_string = [&strtab](const string& str) {
+			const auto offset = uint32_t(strtab.size());
+			strtab.insert(strtab.end(), str.begin(), str.end());
+			strtab.emplace_back(0u);
+			return offset;
+		};
+		vector<uint32_t> section_name_offsets;
+		for (const auto& section : sections) {
+			section_name_offsets.emplace_back(add_string(section.name));
+		}
+		const auto symtab_name_offset = add_string(".symtab");
+		const auto strtab_name_offset = add_string(".strtab");
+		
+		// symbol table: null symbol, user symbols
+		vector<uint8_t> symtab(24u, 0u);
+		for (const auto& sym : symbols) {
+			append(symtab, add_string(sym.name));
+			append(symtab, uint8_t((symbol_binding_global << 4u) | sym.type));
+			append(symtab, uint8_t(0u)); // default visibility
+			append(symtab, sym.section_idx);
+			append(symtab, sym.value);
+			append(symtab, sym.size);
+		}
+		
+		// header, then all section contents (16-byte aligned), then the section headers
+		vector<uint8_t> elf(64u, 0u);
+		vector<uint64_t> section_offsets;
+		const auto add_data = [&elf](const vector<uint8_t>& data) {
+			elf.resize((elf.size() + 15u) & ~size_t(15u), 0u);
+			const auto offset = uint64_t(elf.size());
+			elf.insert(elf.end(), data.begin(), data.end());
+			return offset;
+		};
+		for (const auto& section : sections) {
+			section_offsets.emplace_back(add_data(section.data));
+		}
+		const auto symtab_offset = add_data(symtab);
+		const auto strtab_offset = add_data(strtab);
+		elf.resize((elf.size() + 15u) & ~size_t(15u), 0u);
+		const auto section_headers_offset = uint64_t(elf.size());
+		
+		const auto add_section_header = [&elf](const uint32_t name_offset, const uint32_t type, const uint64_t flags,
+											   const uint64_t offset, const uint64_t size, const uint32_t link,
+											   const uint32_t info, const uint64_t alignment, const uint64_t entry_size) {
+			append(elf, name_offset);
+			append(elf, type);
+			append(elf, flags);
+			append(elf, uint64_t(0u)); // address
+			append(elf, offset);
+			append(elf, size);
+			append(elf, link);
+			append(elf, info);
+			append(elf, alignment);
+			append(elf, entry_size);
+		};
+		add_section_header(0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u);
+		for (size_t i = 0; i < sections.size(); ++i) {
+			const auto& section = sections[i];
+			const auto is_reloc = (section.type == section_type_relocation_addend);
+			add_section_header(section_name_offsets[i], section.type, section.flags, section_offsets[i], section.data.size(),
+							   is_reloc ? symtab_idx : 0u, section.info, section.alignment, is_reloc ? 24u : 0u);
+		}
+		add_section_header(symtab_name_offset, section_type_symbol_table, 0u, symtab_offset, symtab.size(),
+						   strtab_idx, 1u, 8u, 24u);
+		add_section_header(strtab_name_offset, section_type_string_table, 0u, strtab_offset, strtab.size(), 0u, 0u, 1u, 0u);
+		
+		// ELF header
+		const uint8_t ident[16] { 0x7F, 'E', 'L', 'F', 2 /* 64-bit */, 1 /* LE */, 1 /* version */ };
+		memcpy(&elf[0], ident, sizeof(ident));
+		const uint16_t type { 1u /* REL */ }, machine { 0x3Eu /* AMD64 */ };
+		const uint32_t version { 1u };
+		memcpy(&elf[16], &type, 2u);
+		memcpy(&elf[18], &machine, 2u);
+		memcpy(&elf[20], &version, 4u);
+		memcpy(&elf[40], &section_headers_offset, 8u);
+		const uint16_t header_sizes[6] { 64u, 0u, 0u, 64u, uint16_t(section_count), uint16_t(strtab_idx) };
+		memcpy(&elf[52], header_sizes, sizeof(header_sizes));
+		return elf;
+	}
+	
+	//! .text with three 16-byte functions (#1 "kernel_a", #2 "helper", #3 "kernel_b") + an external "local_barrier" symbol (#4),
+	//! "kernel_a" calls "helper", which calls "local_barrier", "kernel_b" doesn't call anything
+	//! NOTE: the .text relocations apply to section "rela_text_info" (the .text section is #1)
+	static vector<uint8_t> make_barrier_binary(const uint32_t rela_text_info = 1u) {
+		return build({
+			{ .name = ".text", .flags = section_flag_alloc | section_flag_exec, .data = vector<uint8_t>(48u, 0xC3u), .alignment = 16u },
+			{ .name = ".rodata", .flags = section_flag_alloc, .data = vector<uint8_t>(16u, 0u), .alignment = 16u },
+			{
+				.name = ".rela.text",
+				.type = section_type_relocation_addend,
+				.flags = section_flag_info_link,
+				.data = make_relocations({
+					{ .offset = 4u, .type = reloc_type_pc32, .symbol_idx = 2u, .addend = -4 },
+					{ .offset = 20u, .type = reloc_type_pc32, .symbol_idx = 4u, .addend = -4 },
+				}),
+				.info = rela_text_info,
+				.alignment = 8u,
+			},
+		}, {
+			{ .name = "kernel_a", .section_idx = 1u, .value = 0u, .size = 16u },
+			{ .name = "helper", .section_idx = 1u, .value = 16u, .size = 16u },
+			{ .name = "kernel_b", .section_idx = 1u, .value = 32u, .size = 16u },
+			{ .name = "local_barrier", .type = symbol_type_none },
+		});
+	}
+}
+
+//! appends the ULEB128 encoding of "value" to "dst"
+static void append_uleb128(vector<uint8_t>& dst, uint64_t value) {
+	do {
+		const auto byte = uint8_t(value & 0x7Fu);
+		value >>= 7u;
+		dst.emplace_back(value != 0u ? (byte | 0x80u) : byte);
+	} while (value != 0u);
+}
+
+//! .text with three 16-byte functions (#1 "kernel_a", #2 "helper", #3 "kernel_b") and a .stack_sizes section with one entry
+//! (64-bit function address + ULEB128 stack size) per function: the "kernel_a" and "kernel_b" entries are relocated against
+//! their function symbols, the "helper" entry against the .text section symbol (#4) + offset (as emitted for local functions),
+//! if "truncate_last" is set, the ULEB128 encoding of the last entry is incomplete
+static vector<uint8_t> make_stack_sizes_binary(const uint64_t kernel_a_size, const uint64_t helper_size,
+											   const uint64_t kernel_b_size, const bool truncate_last = false) {
+	vector<uint8_t> stack_sizes;
+	vector<test_elf::relocation_t> relocs;
+	const auto add_entry = [&stack_sizes, &relocs](const uint32_t symbol_idx, const int64_t addend, const uint64_t stack_size) {
+		relocs.emplace_back(test_elf::relocation_t {
+			.offset = stack_sizes.size(),
+			.type = test_elf::reloc_type_direct_64,
+			.symbol_idx = symbol_idx,
+			.addend = addend,
+		});
+		stack_sizes.resize(stack_sizes.size() + 8u, 0u);
+		append_uleb128(stack_sizes, stack_size);
+	};
+	add_entry(1u, 0, kernel_a_size);
+	add_entry(4u, 16, helper_size);
+	add_entry(3u, 0, kernel_b_size);
+	if (truncate_last) {
+		// continuation bit set on the last byte
+		stack_sizes.back() |= 0x80u;
+	}
+	
+	return test_elf::build({
+		{ .name = ".text", .flags = test_elf::section_flag_alloc | test_elf::section_flag_exec, .data = vector<uint8_t>(48u, 0xC3u), .alignment = 16u },
+		{ .name = ".stack_sizes", .data = stack_sizes },
+		{
+			.name = ".rela.stack_sizes",
+			.type = test_elf::section_type_relocation_addend,
+			.flags = test_elf::section_flag_info_link,
+			.data = test_elf::make_relocations(relocs),
+			.info = 2u,
+			.alignment = 8u,
+		},
+	}, {
+		{ .name = "kernel_a", .section_idx = 1u, .value = 0u, .size = 16u },
+		{ .name = "helper", .section_idx = 1u, .value = 16u, .size = 16u },
+		{ .name = "kernel_b", .section_idx = 1u, .value = 32u, .size = 16u },
+		{ .name = "", .type = test_elf::symbol_type_section, .section_idx = 1u },
+	});
+}
+
+//! the ULEB128-encoded stack sizes of all functions must be decoded (single and multi-byte encodings, up to the 10 byte max),
+//! functions without an entry have an unknown (0) stack size, and incomplete encodings must be rejected
+static void test_stack_sizes() {
+	static constexpr const uint64_t kernel_a_size { 0x48u }, helper_size { 70000u }, kernel_b_size { 0xFFFF'FFFF'FFFF'FFFFull };
+	const auto binary_data = make_stack_sizes_binary(kernel_a_size, helper_size, kernel_b_size);
+	elf_binary binary(binary_data.data(), binary_data.size());
+	test_check(binary.is_valid());
+	if (binary.is_valid()) {
+		test_check(binary.get_stack_size("kernel_a") == kernel_a_size);
+		test_check(binary.get_stack_size("helper") == helper_size);
+		test_check(binary.get_stack_size("kernel_b") == kernel_b_size);
+		test_check(binary.get_stack_size("unknown_function") == 0u);
+	}
+	
+	const auto truncated_data = make_stack_sizes_binary(kernel_a_size, helper_size, 300u, true);
+	elf_binary truncated_binary(truncated_data.data(), truncated_data.size());
+	test_check(!truncated_binary.is_valid());
+}
+
+//! barrier usage must be propagated through the call graph: a kernel only calling a barrier through a helper function
+//! must be flagged as well, while kernels without any barrier calls must not be flagged
+static void test_transitive_barrier() {
+	const auto binary_data = test_elf::make_barrier_binary();
+	elf_binary binary(binary_data.data(), binary_data.size());
+	test_check(binary.is_valid());
+	if (!binary.is_valid()) {
+		return;
+	}
+	test_check(binary.uses_barrier("kernel_a"));
+	test_check(binary.uses_barrier("helper"));
+	test_check(!binary.uses_barrier("kernel_b"));
+}
+
+//! the target section of the .text relocations (sh_info) must reference an existing section
+static void test_invalid_relocation_target() {
+	const auto binary_data = test_elf::make_barrier_binary(42u);
+	elf_binary binary(binary_data.data(), binary_data.size());
+	test_check(!binary.is_valid());
+}
+
+#endif
+
+#if defined(__clang__) && defined(__linux__)
+//! function with a large stack frame
+floor_noinline static uint32_t large_stack_frame_function(const uint32_t idx) {
+	volatile uint8_t data[4096];
+	for (uint32_t i = 0; i < uint32_t(size(data)); ++i) {
+		data[i] = uint8_t(i * 7u);
+	}
+	return data[idx % size(data)];
+}
+
+//! the test executables are compiled with -fstack-size-section, so the stack usage of functions in the running executable
+//! must be known (-> host kernels are sized by it)
+static void test_loaded_stack_size() {
+	test_check(large_stack_frame_function(13u) == uint8_t(13u * 7u));
+	const auto stack_size = elf_binary::get_loaded_stack_size((const void*)&large_stack_frame_function);
+	if (stack_size < 4096u) {
+		log_error("unexpected stack size of the large stack frame function: %u", stack_size);
+	}
+	test_check(stack_size >= 4096u);
+	test_check(elf_binary::get_loaded_stack_size(nullptr) == 0u);
+}
+#endif
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+#if defined(__x86_64__) && !defined(__WINDOWS__)
+	test_transitive_barrier();
+	test_invalid_relocation_target();
+	test_stack_sizes();
+#endif
+#if defined(__clang__) && defined(__linux__)
+	test_loaded_stack_size();
+#endif
+	
+	return floor_test::finish();
+}
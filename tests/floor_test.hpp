@@ -0,0 +1,136 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __FLOOR_TESTS_FLOOR_TEST_HPP__
+#define __FLOOR_TESTS_FLOOR_TEST_HPP__
+
+#include <floor/floor/floor.hpp>
+#include <floor/core/logger.hpp>
+#include <floor/compute/host/host_compute.hpp>
+#include <floor/compute/host/host_program.hpp>
+#include <floor/compute/host/host_queue.hpp>
+#include <chrono>
+#include <cstring>
+using namespace std;
+
+//! shared test/benchmark harness: every test executable calls floor_test::init at startup, records failed checks
+//! with test_check(...), only runs its benchmarks if floor_test::run_benchmarks is set ("--bench" argument),
+//! and returns floor_test::finish() from main
+namespace floor_test {
+	//! amount of failed checks
+	inline atomic<uint32_t> failure_count { 0u };
+	//! true if benchmarks should be run
+	inline bool run_benchmarks { false };
+	
+	//! host-compute context, device and (default) queue all tests are run with
+	inline shared_ptr<host_compute> ctx;
+	inline const compute_device* dev { nullptr };
+	inline shared_ptr<compute_queue> queue;
+	//! program containing all in-process kernels of the test executable
+	inline shared_ptr<host_program> prog;
+	
+	//! initializes floor (console-only) and the host-compute context/device/queue, returns false on failure
+	static inline bool init(int argc, char* argv[]) {
+		for (int i = 1; i < argc; ++i) {
+			if (strcmp(argv[i], "--bench") == 0) {
+				run_benchmarks = true;
+			}
+		}
+		
+		if (!floor::init(floor::init_state {
+			.call_path = argv[0],
+			.data_path = "data/",
+			.app_name = "libfloor-test",
+			.console_only = true,
+		})) {
+			return false;
+		}
+		
+		ctx = make_shared<host_compute>();
+		if (!ctx->is_supported()) {
+			log_error("host-compute is not supported");
+			return false;
+		}
+		dev = ctx->get_device(compute_device::TYPE::ANY);
+		if (dev == nullptr) {
+			log_error("no host-compute device");
+			return false;
+		}
+		queue = ctx->create_queue(*dev);
+		prog = ctx->add_program(host_program::program_map_type {});
+		if (!queue || !prog) {
+			log_error("failed to create the host-compute queue or program");
+			return false;
+		}
+		return true;
+	}
+	
+	//! logs the test result, destroys everything and returns the process exit code
+	static inline int finish() {
+		const auto failures = failure_count.load();
+		if (failures == 0) {
+			log_msg("all tests passed");
+		} else {
+			log_error("%u check(s) failed", failures);
+		}
+		prog = nullptr;
+		queue = nullptr;
+		ctx = nullptr;
+		floor::destroy();
+		return (failures == 0 ? 0 : 1);
+	}
+	
+	//! returns the in-process kernel "name" (logs an error and returns nullptr if it doesn't exist)
+	static inline shared_ptr<compute_kernel> get_kernel(const string& name) {
+		auto kernel = prog->get_kernel(name);
+		if (!kernel) {
+			log_error("kernel \"%s\" not found", name);
+			++failure_count;
+		}
+		return kernel;
+	}
+	
+	//! runs "op" once to warm up, then "iterations" times and returns the average time per iteration in microseconds
+	template <typename F>
+	static inline double time_us(const uint32_t iterations, F&& op) {
+		op();
+		const auto start = chrono::steady_clock::now();
+		for (uint32_t i = 0; i < iterations; ++i) {
+			op();
+		}
+		const auto end = chrono::steady_clock::now();
+		return chrono::duration<double, micro>(end - start).count() / double(iterations);
+	}
+	
+	//! returns the throughput in GB/s when processing "bytes" in "time_us" microseconds
+	static inline double gb_per_s(const size_t bytes, const double time_us) {
+		return (double(bytes) / (time_us * 1000.0));
+	}
+	
+}
+
+//! checks "cond" and logs an error (without aborting) if it doesn't hold
+#define test_check(cond) do { \
+	if (!(cond)) { \
+		log_error("check failed: %s", #cond); \
+		++floor_test::failure_count; \
+	} \
+} while (false)
+
+#endif
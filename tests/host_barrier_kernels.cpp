@@ -0,0 +1,129 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! sums up all input values of each work-group, writing the sum to out[group_id]
+template <uint32_t work_group_size>
+floor_inline_always static void reduce_sum(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	local_buffer<uint32_t, compute_algorithm::reduce_local_memory_elements<work_group_size>()> lmem;
+	const auto sum = compute_algorithm::reduce<work_group_size>(in[global_id.x], lmem, plus<> {});
+	if(local_id.x == 0) {
+		out[group_id.x] = sum;
+	}
+}
+
+//! inclusive prefix sum of all input values inside each work-group
+template <uint32_t work_group_size>
+floor_inline_always static void scan_sum(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	local_buffer<uint32_t, compute_algorithm::scan_local_memory_elements<work_group_size>()> lmem;
+	out[global_id.x] = compute_algorithm::inclusive_scan<work_group_size>(in[global_id.x], plus<> {}, lmem);
+}
+
+kernel void reduce_sum_64(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	reduce_sum<64>(in, out);
+}
+kernel void scan_sum_64(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	scan_sum<64>(in, out);
+}
+
+#if !defined(__WINDOWS__) // max work-group size is 64 on Windows
+kernel void reduce_sum_256(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	reduce_sum<256>(in, out);
+}
+kernel void scan_sum_256(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	scan_sum<256>(in, out);
+}
+
+kernel void reduce_sum_1024(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	reduce_sum<1024>(in, out);
+}
+kernel void scan_sum_1024(buffer<const uint32_t> in, buffer<uint32_t> out) {
+	scan_sum<1024>(in, out);
+}
+#endif
+
+//! executes "barrier_count" barriers with a minimal amount of work in between (-> measures the barrier cost)
+kernel void barrier_loop(buffer<uint32_t> out, param<uint32_t> barrier_count) {
+	uint32_t value = local_id.x;
+	for(uint32_t i = 0; i < barrier_count; ++i) {
+		value = value * 3u + i;
+		local_barrier();
+	}
+	out[global_id.x] = value;
+}
+
+//! number of "fiber_deep_frames" recursion levels (frames) below the kernel function
+static constexpr const uint32_t fiber_frame_depth { 6u };
+//! number of values per frame that are kept live across the barriers of "fiber_deep_frames"
+static constexpr const uint32_t fiber_frame_value_count { 8u };
+
+//! returns true if the values of a "fiber_frame" still match the values they were computed from
+floor_inline_always static bool fiber_frame_valid(const uint32_t* frame_values, const float* in_values,
+												  const uint32_t depth, const uint32_t seed,
+												  const double d0, const double d1, const double d2, const double d3) {
+	bool valid = ((size_t(frame_values) % 32u) == 0u);
+	for(uint32_t i = 0; i < fiber_frame_value_count; ++i) {
+		valid &= (frame_values[i] == seed * fiber_frame_value_count + i + depth * 1000u);
+	}
+	// NOTE: "in_values" may have been modified by the barrier call from the compiler's point of view,
+	//       so d0 - d3 must have been kept live (in callee-saved registers or the stack of this fiber)
+	// NOTE: all values are exactly representable, so recomputation is exact even with contracted/fast math
+	valid &= (d0 == double(in_values[0]) * double(seed + 1u));
+	valid &= (d1 == double(in_values[1]) + double(seed));
+	valid &= (d2 == double(in_values[2]) * 0.5 - double(depth));
+	valid &= (d3 == double(in_values[3]) - double(seed) * 0.25);
+	return valid;
+}
+
+//! recursively descends down to depth 0, each frame keeps an over-aligned local array and floating point values live across
+//! the barriers that are executed before and after the descent (i.e. work-items switch fibers in deep call stacks),
+//! returns a bit mask of all frames (bit #depth) in which a misaligned or modified value was detected
+floor_noinline static uint32_t fiber_frame(const float* in, const uint32_t depth, const uint32_t seed) {
+	alignas(32) uint32_t frame_values[fiber_frame_value_count];
+	for(uint32_t i = 0; i < fiber_frame_value_count; ++i) {
+		frame_values[i] = seed * fiber_frame_value_count + i + depth * 1000u;
+	}
+	const auto in_values = &in[depth * fiber_frame_value_count];
+	const auto d0 = double(in_values[0]) * double(seed + 1u);
+	const auto d1 = double(in_values[1]) + double(seed);
+	const auto d2 = double(in_values[2]) * 0.5 - double(depth);
+	const auto d3 = double(in_values[3]) - double(seed) * 0.25;
+	
+	const auto error_bit = 1u << depth;
+	uint32_t error = 0u;
+	local_barrier();
+	if(!fiber_frame_valid(frame_values, in_values, depth, seed, d0, d1, d2, d3)) {
+		error |= error_bit;
+	}
+	if(depth > 0u) {
+		error |= fiber_frame(in, depth - 1u, seed);
+		local_barrier();
+		if(!fiber_frame_valid(frame_values, in_values, depth, seed, d0, d1, d2, d3)) {
+			error |= error_bit;
+		}
+	}
+	return error;
+}
+
+//! writes the "fiber_frame" error mask of each work-item to out[global_id] (0 if all frames were valid)
+kernel void fiber_deep_frames(buffer<const float> in, buffer<uint32_t> out) {
+	out[global_id.x] = fiber_frame(in, fiber_frame_depth, global_id.x);
+}
@@ -0,0 +1,202 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+
+//! all work-group sizes the reduce/scan kernels exist for
+#if !defined(__WINDOWS__)
+static constexpr const uint32_t work_group_sizes[] { 64u, 256u, 1024u };
+#else
+static constexpr const uint32_t work_group_sizes[] { 64u };
+#endif
+static constexpr const uint32_t group_count { 256u };
+
+//! returns the input data of the reduce/scan kernels
+static vector<uint32_t> make_input(const uint32_t elem_count) {
+	vector<uint32_t> data(elem_count);
+	for (uint32_t i = 0; i < elem_count; ++i) {
+		data[i] = (i * 7u) % 13u;
+	}
+	return data;
+}
+
+//! reduce/scan results must match a sequential reference for every work-group size
+static void test_reduce_scan() {
+	auto& queue = *floor_test::queue;
+	for (const auto work_group_size : work_group_sizes) {
+		if (work_group_size > floor_test::dev->max_total_local_size) {
+			continue;
+		}
+		auto reduce_kernel = floor_test::get_kernel("reduce_sum_" + to_string(work_group_size));
+		auto scan_kernel = floor_test::get_kernel("scan_sum_" + to_string(work_group_size));
+		if (!reduce_kernel || !scan_kernel) {
+			continue;
+		}
+		
+		const auto elem_count = work_group_size * group_count;
+		const auto input = make_input(elem_count);
+		auto in_buffer = floor_test::ctx->create_buffer(queue, input);
+		auto reduce_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * group_count);
+		auto scan_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+		
+		queue.execute(*reduce_kernel, uint1 { elem_count }, uint1 { work_group_size }, in_buffer, reduce_buffer);
+		queue.execute(*scan_kernel, uint1 { elem_count }, uint1 { work_group_size }, in_buffer, scan_buffer);
+		
+		vector<uint32_t> reduce_result(group_count), scan_result(elem_count);
+		reduce_buffer->read(queue, reduce_result.data());
+		scan_buffer->read(queue, scan_result.data());
+		
+		bool reduce_valid = true, scan_valid = true;
+		for (uint32_t group = 0; group < group_count; ++group) {
+			uint32_t sum = 0u;
+			for (uint32_t i = 0; i < work_group_size; ++i) {
+				const auto idx = group * work_group_size + i;
+				sum += input[idx];
+				scan_valid &= (scan_result[idx] == sum);
+			}
+			reduce_valid &= (reduce_result[group] == sum);
+		}
+		test_check(reduce_valid);
+		test_check(scan_valid);
+	}
+}
+
+//! work-groups of a single work-item are executed without per-group fiber switches, barriers must be no-ops there
+static void test_single_item_groups() {
+	auto& queue = *floor_test::queue;
+	auto barrier_kernel = floor_test::get_kernel("barrier_loop");
+	if (!barrier_kernel) {
+		return;
+	}
+	
+	static constexpr const uint32_t elem_count { 4096u };
+	const uint32_t barrier_count { 8u };
+	auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+	queue.execute(*barrier_kernel, uint1 { elem_count }, uint1 { 1u }, out_buffer, barrier_count);
+	
+	// local id is always 0
+	uint32_t expected = 0u;
+	for (uint32_t i = 0; i < barrier_count; ++i) {
+		expected = expected * 3u + i;
+	}
+	vector<uint32_t> out(elem_count);
+	out_buffer->read(queue, out.data());
+	bool valid = true;
+	for (const auto& value : out) {
+		valid &= (value == expected);
+	}
+	test_check(valid);
+}
+
+//! work-items that switch fibers at barriers inside deep (recursive) call stacks must keep their over-aligned stack
+//! variables and all live values intact, this covers the context switch of each fiber implementation
+//! (x86-64 and AArch64 assembly, Windows fibers and ucontext)
+static void test_deep_fiber_stacks() {
+	auto& queue = *floor_test::queue;
+	auto kernel = floor_test::get_kernel("fiber_deep_frames");
+	if (!kernel) {
+		return;
+	}
+	
+	// must match the kernel
+	static constexpr const uint32_t fiber_frame_depth { 6u };
+	static constexpr const uint32_t fiber_frame_value_count { 8u };
+	vector<float> input((fiber_frame_depth + 1u) * fiber_frame_value_count);
+	for (uint32_t i = 0; i < uint32_t(input.size()); ++i) {
+		input[i] = float(i) * 1.25f + 0.5f;
+	}
+	auto in_buffer = floor_test::ctx->create_buffer(queue, input);
+	
+	for (const auto work_group_size : { 1u, 3u, 64u, 256u }) {
+		if (work_group_size > floor_test::dev->max_total_local_size) {
+			continue;
+		}
+		const auto elem_count = work_group_size * 16u;
+		auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+		queue.execute(*kernel, uint1 { elem_count }, uint1 { work_group_size }, in_buffer, out_buffer);
+		
+		vector<uint32_t> out(elem_count);
+		out_buffer->read(queue, out.data());
+		bool valid = true;
+		for (uint32_t i = 0; i < elem_count; ++i) {
+			if (out[i] != 0u) {
+				log_error("deep fiber stack: invalid frames %X in work-item %u (work-group size %u)", out[i], i, work_group_size);
+				valid = false;
+				break;
+			}
+		}
+		test_check(valid);
+	}
+}
+
+//! barrier cost: reduce/scan kernels per launch and the raw cost of a barrier per work-item
+static void bench_barriers() {
+	auto& queue = *floor_test::queue;
+	static constexpr const uint32_t iterations { 50u };
+	for (const auto work_group_size : work_group_sizes) {
+		if (work_group_size > floor_test::dev->max_total_local_size) {
+			continue;
+		}
+		auto reduce_kernel = floor_test::get_kernel("reduce_sum_" + to_string(work_group_size));
+		auto scan_kernel = floor_test::get_kernel("scan_sum_" + to_string(work_group_size));
+		auto barrier_kernel = floor_test::get_kernel("barrier_loop");
+		if (!reduce_kernel || !scan_kernel || !barrier_kernel) {
+			continue;
+		}
+		
+		const auto elem_count = work_group_size * group_count;
+		auto in_buffer = floor_test::ctx->create_buffer(queue, make_input(elem_count));
+		auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+		
+		const auto reduce_time = floor_test::time_us(iterations, [&] {
+			queue.execute(*reduce_kernel, uint1 { elem_count }, uint1 { work_group_size }, in_buffer, out_buffer);
+			queue.finish();
+		});
+		const auto scan_time = floor_test::time_us(iterations, [&] {
+			queue.execute(*scan_kernel, uint1 { elem_count }, uint1 { work_group_size }, in_buffer, out_buffer);
+			queue.finish();
+		});
+		const uint32_t barrier_count { 64u };
+		const auto barrier_time = floor_test::time_us(iterations, [&] {
+			queue.execute(*barrier_kernel, uint1 { elem_count }, uint1 { work_group_size }, out_buffer, barrier_count);
+			queue.finish();
+		});
+		
+		log_msg("work-group size %u (%u groups): reduce: %fus, scan: %fus, barrier: %fns per work-item and barrier (wall time)",
+				work_group_size, group_count, reduce_time, scan_time,
+				(barrier_time * 1000.0) / (double(elem_count) * double(barrier_count)));
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_reduce_scan();
+	test_single_item_groups();
+	test_deep_fiber_stacks();
+	
+	if (floor_test::run_benchmarks) {
+		bench_barriers();
+	}
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,42 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! every work-item reads values that were written by the work-items of another work-group before a global barrier,
+//! the values are then overwritten after a second global barrier and read again after a third one,
+//! local memory contents of each work-group must survive all global barriers
+//! -> out[i] = (((i + 2 * local_size) % global_size) + 1) * 2, or has the top bit set if local memory was clobbered
+kernel void grid_exchange(buffer<uint32_t> values, buffer<uint32_t> out) {
+	local_buffer<uint32_t, 64> lmem;
+	lmem[local_id.x] = group_id.x * 1000u + local_id.x;
+	values[global_id.x] = global_id.x + 1u;
+	global_barrier();
+	
+	const auto other = (global_id.x + local_size.x) % global_size.x;
+	const auto other_value = values[other];
+	global_barrier();
+	
+	values[global_id.x] = other_value * 2u;
+	global_barrier();
+	
+	const auto lmem_valid = (lmem[local_id.x] == group_id.x * 1000u + local_id.x);
+	out[global_id.x] = values[other] | (lmem_valid ? 0u : 0x80000000u);
+}
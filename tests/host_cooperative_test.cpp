@@ -0,0 +1,112 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+#include <floor/compute/host/host_queue.hpp>
+
+//! executes "grid_exchange" cooperatively with "group_count" work-groups of "local_size" work-items,
+//! returns true if all outputs match the expected values
+static bool run_grid_exchange(const compute_kernel& kernel, const uint32_t group_count, const uint32_t local_size) {
+	auto& queue = *floor_test::queue;
+	const auto global_size = group_count * local_size;
+	auto values = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * global_size);
+	auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * global_size);
+	out_buffer->zero(queue);
+	
+	queue.execute_cooperative(kernel, uint1 { global_size }, uint1 { local_size }, values, out_buffer);
+	queue.finish();
+	
+	vector<uint32_t> out(global_size);
+	out_buffer->read(queue, out.data());
+	for (uint32_t i = 0; i < global_size; ++i) {
+		const auto expected = (((i + 2u * local_size) % global_size) + 1u) * 2u;
+		if (out[i] != expected) {
+			log_error("grid_exchange mismatch at #%u (%u groups of %u): got %u, expected %u",
+					  i, group_count, local_size, out[i], expected);
+			return false;
+		}
+	}
+	return true;
+}
+
+//! all work-groups of a cooperative execution are resident at once, even when there are more groups than worker threads
+static void test_more_groups_than_workers() {
+	const auto& queue = (const host_queue&)*floor_test::queue;
+	auto kernel = floor_test::get_kernel("grid_exchange");
+	if (!kernel) {
+		return;
+	}
+	
+	const auto worker_count = queue.get_cpu_count();
+	const auto max_group_count = queue.get_max_cooperative_group_count();
+	test_check(max_group_count > worker_count);
+	test_check(floor_test::dev->max_coop_group_count >= max_group_count);
+	
+	// fewer, as many and more groups than workers (uneven distribution), up to the max group count
+	for (const auto group_count : { 2u, worker_count, worker_count * 4u + 1u, max_group_count }) {
+		if (group_count < 2u || group_count > max_group_count) {
+			continue;
+		}
+		test_check(run_grid_exchange(*kernel, group_count, 64u));
+		// single work-item groups
+		test_check(run_grid_exchange(*kernel, group_count, 1u));
+	}
+}
+
+//! a cooperative execution with more groups than can be resident at once must fail without executing anything,
+//! subsequent cooperative executions must not be affected
+static void test_exceeded_group_count() {
+	auto& queue = *floor_test::queue;
+	auto kernel = floor_test::get_kernel("grid_exchange");
+	if (!kernel) {
+		return;
+	}
+	
+	static constexpr const uint32_t local_size { 64u };
+	const auto group_count = ((const host_queue&)queue).get_max_cooperative_group_count() + 1u;
+	const auto global_size = group_count * local_size;
+	auto values = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * global_size);
+	auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * global_size);
+	out_buffer->zero(queue);
+	
+	queue.execute_cooperative(*kernel, uint1 { global_size }, uint1 { local_size }, values, out_buffer);
+	queue.finish();
+	
+	vector<uint32_t> out(global_size);
+	out_buffer->read(queue, out.data());
+	bool untouched = true;
+	for (const auto& value : out) {
+		untouched &= (value == 0u);
+	}
+	test_check(untouched);
+	
+	test_check(run_grid_exchange(*kernel, group_count - 1u, local_size));
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_more_groups_than_workers();
+	test_exceeded_group_count();
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,37 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! counts the executions of each work-group in "group_counts", the first "heavy_group_count" groups perform
+//! "heavy_iterations" iterations of busy work, all other groups are (almost) free
+kernel void imbalanced_work(buffer<uint32_t> group_counts, buffer<uint32_t> out,
+							param<uint32_t> heavy_group_count, param<uint32_t> heavy_iterations) {
+	if(local_id.x == 0) {
+		__atomic_fetch_add(&group_counts[group_id.x], 1u, __ATOMIC_RELAXED);
+	}
+	uint32_t value = global_id.x;
+	if(group_id.x < heavy_group_count) {
+		for(uint32_t i = 0; i < heavy_iterations; ++i) {
+			value = value * 1664525u + 1013904223u;
+		}
+	}
+	out[global_id.x] = value;
+}
@@ -0,0 +1,94 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+#include <floor/compute/host/host_queue.hpp>
+
+//! an imbalanced workload (all expensive groups are initially owned by the first worker) must be balanced by stealing,
+//! with every group still being executed exactly once, the statistics must account for all executed groups
+static void test_imbalanced_stealing() {
+	auto& queue = (host_queue&)*floor_test::queue;
+	auto kernel = floor_test::get_kernel("imbalanced_work");
+	if (!kernel) {
+		return;
+	}
+	
+	const auto worker_count = queue.get_cpu_count();
+	static constexpr const uint32_t local_size { 64u };
+	const auto group_count = std::max(worker_count * 64u, 256u);
+	// the initial group range of the first worker
+	const uint32_t heavy_group_count = group_count / worker_count;
+	const uint32_t heavy_iterations { 100'000u };
+	
+	auto group_counts = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * group_count);
+	auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * group_count * local_size);
+	group_counts->zero(queue);
+	
+	queue.set_group_chunk_size(1u);
+	queue.set_scheduler_stats_collection(true);
+	queue.execute(*kernel, uint1 { group_count * local_size }, uint1 { local_size },
+				  group_counts, out_buffer, heavy_group_count, heavy_iterations);
+	queue.finish();
+	const auto stats = queue.get_scheduler_stats();
+	queue.set_scheduler_stats_collection(false);
+	queue.set_group_chunk_size(0u);
+	
+	vector<uint32_t> counts(group_count);
+	group_counts->read(queue, counts.data());
+	bool all_once = true;
+	for (const auto& count : counts) {
+		all_once &= (count == 1u);
+	}
+	test_check(all_once);
+	
+	test_check(stats.size() == worker_count);
+	uint32_t executed_groups = 0u, steals = 0u;
+	for (const auto& worker_stats : stats) {
+		executed_groups += worker_stats.group_count;
+		steals += worker_stats.steal_count;
+	}
+	test_check(executed_groups == group_count);
+	if (worker_count > 1u) {
+		test_check(steals > 0u);
+	}
+	
+	// statistics are only collected when enabled
+	queue.execute(*kernel, uint1 { group_count * local_size }, uint1 { local_size },
+				  group_counts, out_buffer, 0u, 0u);
+	queue.finish();
+	const auto prev_stats = queue.get_scheduler_stats();
+	test_check(prev_stats.size() == stats.size());
+	bool stats_unchanged = true;
+	for (size_t i = 0; i < std::min(prev_stats.size(), stats.size()); ++i) {
+		stats_unchanged &= (prev_stats[i].group_count == stats[i].group_count &&
+							prev_stats[i].steal_count == stats[i].steal_count);
+	}
+	test_check(stats_unchanged);
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_imbalanced_stealing();
+	
+	return floor_test::finish();
+}
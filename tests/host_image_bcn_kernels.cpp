@@ -0,0 +1,27 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! reads all texels of "src" (nearest, integer coordinates) and writes them to "out" in row-major order
+kernel void read_texels(const_image_2d<float> src, buffer<float4> out) {
+	const int2 coord { int(global_id.x), int(global_id.y) };
+	out[global_id.y * global_size.x + global_id.x] = src.read(coord);
+}
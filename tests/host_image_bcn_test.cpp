@@ -0,0 +1,326 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_image.hpp>
+#include <cmath>
+
+//! little-endian (LSB first) bit writer of a 128-bit block
+struct block_bit_writer {
+	array<uint8_t, 16> data {};
+	uint32_t pos { 0u };
+	
+	void write(const uint32_t value, const uint32_t bit_count) {
+		for (uint32_t i = 0; i < bit_count; ++i, ++pos) {
+			data[pos / 8u] |= uint8_t(((value >> i) & 1u) << (pos % 8u));
+		}
+	}
+};
+
+//! creates a 2D image of "image_type" and size "dim" from the compressed "blocks" and reads back all of its texels
+static vector<float4> read_texels(const compute_kernel& read_kernel, const COMPUTE_IMAGE_TYPE image_type, const uint2 dim,
+								  vector<uint8_t> blocks) {
+	auto img = floor_test::ctx->create_image(*floor_test::queue, uint4 { dim.x, dim.y, 0u, 0u },
+											 COMPUTE_IMAGE_TYPE::IMAGE_2D | image_type | COMPUTE_IMAGE_TYPE::READ, blocks.data(),
+											 COMPUTE_MEMORY_FLAG::READ | COMPUTE_MEMORY_FLAG::HOST_READ_WRITE);
+	auto out_buffer = floor_test::ctx->create_buffer(*floor_test::queue, sizeof(float4) * dim.x * dim.y);
+	vector<float4> texels(dim.x * dim.y);
+	test_check(img != nullptr && out_buffer != nullptr);
+	if (!img || !out_buffer) {
+		return texels;
+	}
+	floor_test::queue->execute(read_kernel, uint2 { dim }, uint2 { 1u, 1u }, img, out_buffer);
+	out_buffer->read(*floor_test::queue, texels.data());
+	return texels;
+}
+
+//! checks all texels against the expected texels (within a tolerance relative to the magnitude of the expected value)
+static void check_texels(const char* name, const vector<float4>& texels, const vector<float4>& expected) {
+	test_check(texels.size() == expected.size());
+	uint32_t mismatch_count = 0u;
+	for (size_t i = 0; i < std::min(texels.size(), expected.size()); ++i) {
+		for (uint32_t ch = 0; ch < 4u; ++ch) {
+			if (std::abs(texels[i][ch] - expected[i][ch]) > 1.0e-5f * std::max(1.0f, std::abs(expected[i][ch]))) {
+				if (mismatch_count == 0u) {
+					log_error("%s: texel #%u: expected %v, got %v", name, i, expected[i], texels[i]);
+				}
+				++mismatch_count;
+			}
+		}
+	}
+	if (mismatch_count > 0u) {
+		log_error("%s: %u mismatching channels", name, mismatch_count);
+	}
+	test_check(mismatch_count == 0u);
+}
+
+//! returns the 4x4 block texels in row-major order as "func(texel_idx)"
+template <typename F>
+static vector<float4> make_block_texels(F&& func) {
+	vector<float4> texels(16u);
+	for (uint32_t i = 0; i < 16u; ++i) {
+		texels[i] = func(i);
+	}
+	return texels;
+}
+
+//! BC1: a 4-color block (c0 > c1) next to a 3-color block (c0 <= c1), whose 4th color is transparent black for BC1 RGBA
+//! and opaque black for BC1 RGB
+static void test_bc1(const compute_kernel& read_kernel) {
+	vector<uint8_t> blocks {
+		// c0 = yellow (0xFFE0), c1 = blue (0x001F), texel indices 0, 1, 2, 3 in each row
+		0xE0, 0xFF, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4,
+		// c0 = blue (0x001F), c1 = red (0xF800)
+		0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4,
+	};
+	for (const bool has_alpha : { false, true }) {
+		const float4 palettes[2][4] {
+			{
+				{ 1.0f, 1.0f, 0.0f, 1.0f },
+				{ 0.0f, 0.0f, 1.0f, 1.0f },
+				{ 2.0f / 3.0f, 2.0f / 3.0f, 1.0f / 3.0f, 1.0f },
+				{ 1.0f / 3.0f, 1.0f / 3.0f, 2.0f / 3.0f, 1.0f },
+			},
+			{
+				{ 0.0f, 0.0f, 1.0f, 1.0f },
+				{ 1.0f, 0.0f, 0.0f, 1.0f },
+				{ 0.5f, 0.0f, 0.5f, 1.0f },
+				{ 0.0f, 0.0f, 0.0f, has_alpha ? 0.0f : 1.0f },
+			},
+		};
+		vector<float4> expected(8u * 4u);
+		for (uint32_t y = 0; y < 4u; ++y) {
+			for (uint32_t x = 0; x < 8u; ++x) {
+				expected[y * 8u + x] = palettes[x / 4u][x % 4u];
+			}
+		}
+		const auto image_type = (has_alpha ? COMPUTE_IMAGE_TYPE::BC1_RGBA : COMPUTE_IMAGE_TYPE::BC1_RGB);
+		check_texels(has_alpha ? "BC1 RGBA" : "BC1 RGB", read_texels(read_kernel, image_type, { 8u, 4u }, blocks), expected);
+	}
+}
+
+//! BC2: explicit 4-bit alpha, the color block always uses the 4-color mode (even if c0 <= c1)
+static void test_bc2(const compute_kernel& read_kernel) {
+	vector<uint8_t> blocks {
+		// alpha of texel #i is i / 15
+		0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE,
+		// c0 = blue (0x001F), c1 = red (0xF800)
+		0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4,
+	};
+	const float3 palette[4] {
+		{ 0.0f, 0.0f, 1.0f },
+		{ 1.0f, 0.0f, 0.0f },
+		{ 1.0f / 3.0f, 0.0f, 2.0f / 3.0f },
+		{ 2.0f / 3.0f, 0.0f, 1.0f / 3.0f },
+	};
+	check_texels("BC2", read_texels(read_kernel, COMPUTE_IMAGE_TYPE::BC2_RGBA, { 4u, 4u }, blocks),
+				 make_block_texels([&palette](const uint32_t i) {
+		return float4 { palette[i % 4u], float(i) / 15.0f };
+	}));
+}
+
+//! BC3: 8-value interpolated alpha (a0 > a1)
+static void test_bc3(const compute_kernel& read_kernel) {
+	block_bit_writer writer;
+	writer.write(200u, 8u);
+	writer.write(10u, 8u);
+	for (uint32_t i = 0; i < 16u; ++i) {
+		writer.write(i % 8u, 3u);
+	}
+	vector<uint8_t> blocks(writer.data.begin(), writer.data.begin() + 8);
+	// c0 = blue (0x001F), c1 = red (0xF800)
+	blocks.insert(blocks.end(), { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4 });
+	
+	const float alpha_palette[8] {
+		200.0f, 10.0f, 1210.0f / 7.0f, 1020.0f / 7.0f, 830.0f / 7.0f, 640.0f / 7.0f, 450.0f / 7.0f, 260.0f / 7.0f,
+	};
+	const float3 palette[4] {
+		{ 0.0f, 0.0f, 1.0f },
+		{ 1.0f, 0.0f, 0.0f },
+		{ 1.0f / 3.0f, 0.0f, 2.0f / 3.0f },
+		{ 2.0f / 3.0f, 0.0f, 1.0f / 3.0f },
+	};
+	check_texels("BC3", read_texels(read_kernel, COMPUTE_IMAGE_TYPE::BC3_RGBA, { 4u, 4u }, blocks),
+				 make_block_texels([&palette, &alpha_palette](const uint32_t i) {
+		return float4 { palette[i % 4u], alpha_palette[i % 8u] / 255.0f };
+	}));
+}
+
+//! returns a BC4 channel block with 3-bit index "index_func(texel_idx)" for each texel
+template <typename F>
+static vector<uint8_t> make_bc4_block(const uint8_t e0, const uint8_t e1, F&& index_func) {
+	block_bit_writer writer;
+	writer.write(e0, 8u);
+	writer.write(e1, 8u);
+	for (uint32_t i = 0; i < 16u; ++i) {
+		writer.write(index_func(i), 3u);
+	}
+	return { writer.data.begin(), writer.data.begin() + 8 };
+}
+
+//! BC4/BC5: unsigned 6-value (with 0 and 1) and 8-value blocks, signed 6-value block with -128 being clamped to -1
+static void test_bc4_bc5(const compute_kernel& read_kernel) {
+	const auto identity_index = [](const uint32_t i) { return i % 8u; };
+	const auto shuffled_index = [](const uint32_t i) { return (i * 3u) % 8u; };
+	const float unsigned_6_palette[8] { 10.0f, 200.0f, 48.0f, 86.0f, 124.0f, 162.0f, 0.0f, 255.0f };
+	const float unsigned_8_palette[8] {
+		200.0f, 10.0f, 1210.0f / 7.0f, 1020.0f / 7.0f, 830.0f / 7.0f, 640.0f / 7.0f, 450.0f / 7.0f, 260.0f / 7.0f,
+	};
+	const float signed_6_palette[8] { -1.0f, 1.0f, -0.6f, -0.2f, 0.2f, 0.6f, -1.0f, 1.0f };
+	
+	check_texels("BC4 unsigned", read_texels(read_kernel, COMPUTE_IMAGE_TYPE::RGTC_RUI, { 4u, 4u },
+											 make_bc4_block(10u, 200u, identity_index)),
+				 make_block_texels([&](const uint32_t i) {
+		return float4 { unsigned_6_palette[identity_index(i)] / 255.0f, 0.0f, 0.0f, 1.0f };
+	}));
+	
+	check_texels("BC4 signed", read_texels(read_kernel, COMPUTE_IMAGE_TYPE::RGTC_RI, { 4u, 4u },
+										   make_bc4_block(0x80u /* -128 */, 0x7Fu /* 127 */, identity_index)),
+				 make_block_texels([&](const uint32_t i) {
+		return float4 { signed_6_palette[identity_index(i)], 0.0f, 0.0f, 1.0f };
+	}));
+	
+	auto bc5_blocks = make_bc4_block(200u, 10u, identity_index);
+	const auto green_block = make_bc4_block(10u, 200u, shuffled_index);
+	bc5_blocks.insert(bc5_blocks.end(), green_block.begin(), green_block.end());
+	check_texels("BC5", read_texels(read_kernel, COMPUTE_IMAGE_TYPE::RGTC_RGUI, { 4u, 4u }, bc5_blocks),
+				 make_block_texels([&](const uint32_t i) {
+		return float4 {
+			unsigned_8_palette[identity_index(i)] / 255.0f,
+			unsigned_6_palette[shuffled_index(i)] / 255.0f,
+			0.0f,
+			1.0f
+		};
+	}));
+}
+
+//! 4-bit index interpolation weights of BC6H/BC7
+static constexpr const uint32_t bptc_weights_4[16] { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+//! BC7 mode 6: single subset, 7-bit RGBA endpoints + per-endpoint p-bit, 4-bit indices
+static void test_bc7(const compute_kernel& read_kernel) {
+	block_bit_writer writer;
+	writer.write(1u << 6u, 7u);
+	// R0, R1, G0, G1, B0, B1, A0, A1
+	for (const uint32_t val : { 0u, 127u, 0u, 64u, 0u, 32u, 127u, 0u }) {
+		writer.write(val, 7u);
+	}
+	// p-bits
+	writer.write(1u, 1u);
+	writer.write(0u, 1u);
+	// index of texel #i is i (texel #0 is the anchor -> 3 bits)
+	for (uint32_t i = 0; i < 16u; ++i) {
+		writer.write(i, i == 0u ? 3u : 4u);
+	}
+	test_check(writer.pos == 128u);
+	
+	// 8-bit endpoints: (value << 1) | p-bit
+	const uint32_t e0[4] { 1u, 1u, 1u, 255u };
+	const uint32_t e1[4] { 254u, 128u, 64u, 0u };
+	const auto expected = make_block_texels([&e0, &e1](const uint32_t i) {
+		float4 texel;
+		for (uint32_t ch = 0; ch < 4u; ++ch) {
+			texel[ch] = float((e0[ch] * (64u - bptc_weights_4[i]) + e1[ch] * bptc_weights_4[i] + 32u) >> 6u) / 255.0f;
+		}
+		return texel;
+	});
+	// both endpoints must be reproduced exactly
+	test_check(expected[0].is_equal(float4 { 1.0f, 1.0f, 1.0f, 255.0f } / 255.0f));
+	test_check(expected[15].is_equal(float4 { 254.0f, 128.0f, 64.0f, 0.0f } / 255.0f));
+	check_texels("BC7", read_texels(read_kernel, COMPUTE_IMAGE_TYPE::BPTC_RGBA,
+									{ 4u, 4u }, { writer.data.begin(), writer.data.end() }), expected);
+}
+
+//! returns the float value of the specified half float bits
+static float half_to_float(const uint16_t bits) {
+	const auto exponent = int((bits >> 10u) & 0x1Fu);
+	const auto mantissa = float(bits & 0x3FFu);
+	const auto magnitude = (exponent == 0 ? ldexp(mantissa, -24) : ldexp(1.0f + mantissa / 1024.0f, exponent - 15));
+	return ((bits & 0x8000u) != 0u ? -magnitude : magnitude);
+}
+
+//! BC6H mode 11: single subset, 10-bit RGB endpoints (not transformed), 4-bit indices,
+//! endpoints are unquantized to 16 bits, interpolated and then scaled to (max) half float range
+static void test_bc6h(const compute_kernel& read_kernel, const bool is_signed) {
+	// unsigned: 0, 1023 (-> max) and 512, signed: -511/511 (-> min/max), -100/100 and 0
+	const int32_t e0[3] { is_signed ? -511 : 0, 0, is_signed ? 100 : 1023 };
+	const int32_t e1[3] { is_signed ? 511 : 1023, is_signed ? -100 : 512, 0 };
+	
+	block_bit_writer writer;
+	writer.write(0x03u, 5u);
+	for (const auto& endpoint : { e0, e1 }) {
+		for (uint32_t ch = 0; ch < 3u; ++ch) {
+			writer.write(uint32_t(endpoint[ch]) & 0x3FFu, 10u);
+		}
+	}
+	for (uint32_t i = 0; i < 16u; ++i) {
+		writer.write(i, i == 0u ? 3u : 4u);
+	}
+	test_check(writer.pos == 128u);
+	
+	const auto unquantize = [is_signed](const int32_t val) {
+		if (!is_signed) {
+			return (val == 0 ? 0 : (val == 1023 ? 0xFFFF : ((val << 16) + 0x8000) >> 10));
+		}
+		const auto abs_val = std::abs(val);
+		const auto unq = (abs_val == 0 ? 0 : (abs_val >= 511 ? 0x7FFF : ((abs_val << 15) + 0x4000) >> 9));
+		return (val < 0 ? -unq : unq);
+	};
+	const auto expected = make_block_texels([&](const uint32_t i) {
+		float4 texel { 0.0f, 0.0f, 0.0f, 1.0f };
+		const auto weight = int32_t(bptc_weights_4[i]);
+		for (uint32_t ch = 0; ch < 3u; ++ch) {
+			const auto val = (unquantize(e0[ch]) * (64 - weight) + unquantize(e1[ch]) * weight + 32) >> 6;
+			const auto half_bits = (!is_signed ? uint16_t((val * 31) >> 6) :
+									(val < 0 ? uint16_t(0x8000u | uint32_t((-val * 31) >> 5)) : uint16_t((val * 31) >> 5)));
+			texel[ch] = half_to_float(half_bits);
+		}
+		return texel;
+	});
+	// endpoints at the end of the range must map to the max half float value
+	if (!is_signed) {
+		test_check(expected[0].is_equal(float4 { 0.0f, 0.0f, 65504.0f, 1.0f }));
+		test_check(expected[15].is_equal(float4 { 65504.0f, 1.5146484375f, 0.0f, 1.0f }));
+	} else {
+		test_check(expected[0].x == -65504.0f && expected[0].y == 0.0f && expected[0].z > 0.0f);
+		test_check(expected[15].x == 65504.0f && expected[15].y == -expected[0].z && expected[15].z == 0.0f);
+	}
+	check_texels(is_signed ? "BC6H signed" : "BC6H unsigned",
+				 read_texels(read_kernel, is_signed ? COMPUTE_IMAGE_TYPE::BPTC_RGBHF : COMPUTE_IMAGE_TYPE::BPTC_RGBUHF,
+							 { 4u, 4u }, { writer.data.begin(), writer.data.end() }), expected);
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	auto read_kernel = floor_test::get_kernel("read_texels");
+	if (read_kernel) {
+		test_bc1(*read_kernel);
+		test_bc2(*read_kernel);
+		test_bc3(*read_kernel);
+		test_bc4_bc5(*read_kernel);
+		test_bc6h(*read_kernel, false);
+		test_bc6h(*read_kernel, true);
+		test_bc7(*read_kernel);
+	}
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,180 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_image.hpp>
+#include <cmath>
+
+//! returns deterministic, non-trivial level #0 data
+template <typename channel_type>
+static vector<channel_type> make_level_data(const size_t count) {
+	vector<channel_type> data(count);
+	for (size_t i = 0; i < count; ++i) {
+		const auto val = (i * 7919u + 13u);
+		if constexpr (is_floating_point_v<channel_type>) {
+			data[i] = channel_type(float(val % 1009u) * 0.125f - 50.0f);
+		} else {
+			// NOTE: limited to 16-bit ranges, so that 32-bit sums can't overflow either
+			const auto range = uint64_t(std::min(double(numeric_limits<channel_type>::max()) -
+												 double(numeric_limits<channel_type>::lowest()), 65535.0)) + 1u;
+			data[i] = channel_type(int64_t(numeric_limits<channel_type>::lowest()) + int64_t(val % range));
+		}
+	}
+	return data;
+}
+
+//! computes a mip-level from its previous level: each texel is the average of the 2/4/8 (1D/2D/3D) texels it covers,
+//! integer formats are rounded to nearest, the last row/column/slice of odd-sized levels is not part of any texel
+template <typename channel_type>
+static vector<channel_type> minify_reference(const vector<channel_type>& src, const uint3 src_dim, const uint3 dst_dim,
+											 const uint32_t dim_count, const uint32_t channel_count, const uint32_t slice_count) {
+	const auto texel_count = size_t(1u << dim_count);
+	vector<channel_type> dst(size_t(dst_dim.x) * size_t(dst_dim.y) * size_t(dst_dim.z) * slice_count * channel_count);
+	const auto src_slice_size = size_t(src_dim.x) * size_t(src_dim.y) * size_t(src_dim.z);
+	const auto dst_slice_size = size_t(dst_dim.x) * size_t(dst_dim.y) * size_t(dst_dim.z);
+	for (uint32_t slice = 0; slice < slice_count; ++slice) {
+		for (uint32_t z = 0; z < dst_dim.z; ++z) {
+			for (uint32_t y = 0; y < dst_dim.y; ++y) {
+				for (uint32_t x = 0; x < dst_dim.x; ++x) {
+					for (uint32_t ch = 0; ch < channel_count; ++ch) {
+						double sum = 0.0;
+						for (uint32_t i = 0; i < texel_count; ++i) {
+							const auto sx = x * 2u + (i & 1u);
+							const auto sy = (dim_count >= 2u ? y * 2u + ((i >> 1u) & 1u) : 0u);
+							const auto sz = (dim_count >= 3u ? z * 2u + (i >> 2u) : 0u);
+							sum += double(src[(slice * src_slice_size + (size_t(sz) * src_dim.y + sy) * src_dim.x + sx) * channel_count + ch]);
+						}
+						auto& dst_val = dst[(slice * dst_slice_size + (size_t(z) * dst_dim.y + y) * dst_dim.x + x) * channel_count + ch];
+						if constexpr (is_floating_point_v<channel_type>) {
+							dst_val = channel_type(sum / double(texel_count));
+						} else {
+							dst_val = channel_type(std::floor((sum + double(texel_count / 2u)) / double(texel_count)));
+						}
+					}
+				}
+			}
+		}
+	}
+	return dst;
+}
+
+//! returns true if the values are equal (floating point: within a relative tolerance)
+template <typename channel_type>
+static bool is_equal_value(const channel_type lhs, const channel_type rhs) {
+	if constexpr (is_floating_point_v<channel_type>) {
+		return (std::abs(lhs - rhs) <= 1.0e-5f * std::max(1.0f, std::abs(rhs)));
+	} else {
+		return (lhs == rhs);
+	}
+}
+
+//! the mip-chain of a non-power-of-two image must consist of levels that are half the size (rounded down) of the previous
+//! level, stored consecutively, and each generated level must contain the filtered texels of the previous level
+template <typename channel_type>
+static void test_mip_chain(const COMPUTE_IMAGE_TYPE base_image_type, const uint4 dim, const bool tiled) {
+	const auto image_type = (base_image_type | COMPUTE_IMAGE_TYPE::FLAG_MIPMAPPED | COMPUTE_IMAGE_TYPE::READ);
+	const auto dim_count = image_dim_count(image_type);
+	const auto channel_count = image_channel_count(image_type);
+	const auto slice_count = image_layer_count(dim, image_type);
+	const auto bytes_per_pixel = sizeof(channel_type) * channel_count;
+	const uint3 level0_dim {
+		dim.x,
+		dim_count >= 2u ? dim.y : 1u,
+		dim_count >= 3u ? dim.z : 1u,
+	};
+	auto level_data = make_level_data<channel_type>(size_t(level0_dim.x) * size_t(level0_dim.y) * size_t(level0_dim.z) *
+													slice_count * channel_count);
+	auto img = floor_test::ctx->create_image(*floor_test::queue, dim, image_type, level_data.data(),
+											 COMPUTE_MEMORY_FLAG::READ | COMPUTE_MEMORY_FLAG::HOST_READ_WRITE |
+											 COMPUTE_MEMORY_FLAG::GENERATE_MIP_MAPS |
+											 (tiled ? COMPUTE_MEMORY_FLAG::HOST_TILED_LAYOUT : COMPUTE_MEMORY_FLAG::NONE));
+	test_check(img != nullptr);
+	if (!img) {
+		return;
+	}
+	
+	// levels down to a max dim of 1 (rounded up to a power-of-two -> the last level may be empty)
+	const auto max_dim = std::max(level0_dim.x, std::max(level0_dim.y, level0_dim.z));
+	uint32_t level_count = 1u;
+	for (auto level_dim = const_math::next_pot(max_dim); level_dim > 1u; level_dim >>= 1u) {
+		++level_count;
+	}
+	test_check(image_mip_level_count(img->get_image_dim(), img->get_image_type()) == level_count);
+	
+	// NOTE: the mapped data always uses the linear layout, with all levels stored consecutively
+	auto mapped_ptr = (const uint8_t*)img->map(*floor_test::queue, COMPUTE_MEMORY_MAP_FLAG::READ | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+	test_check(mapped_ptr != nullptr);
+	if (mapped_ptr == nullptr) {
+		return;
+	}
+	
+	uint3 prev_dim = level0_dim;
+	size_t level_offset = 0u;
+	for (uint32_t level = 0; level < level_count; ++level) {
+		const uint3 level_dim {
+			level == 0u ? level0_dim.x : prev_dim.x >> 1u,
+			level == 0u ? level0_dim.y : (dim_count >= 2u ? prev_dim.y >> 1u : 1u),
+			level == 0u ? level0_dim.z : (dim_count >= 3u ? prev_dim.z >> 1u : 1u),
+		};
+		const auto level_size = size_t(level_dim.x) * size_t(level_dim.y) * size_t(level_dim.z) * slice_count * bytes_per_pixel;
+		
+		// NOTE: levels that are empty in any dimension are not generated
+		if (level > 0u && level_size > 0u) {
+			level_data = minify_reference(level_data, prev_dim, level_dim, dim_count, channel_count, slice_count);
+			const auto level_ptr = (const channel_type*)(mapped_ptr + level_offset);
+			size_t mismatch_count = 0u;
+			for (size_t i = 0; i < level_data.size(); ++i) {
+				if (!is_equal_value(level_ptr[i], level_data[i])) {
+					++mismatch_count;
+				}
+			}
+			if (mismatch_count > 0u) {
+				log_error("image type %X (%s): %u mismatching values in level #%u (%u * %u * %u)",
+						  uint64_t(image_type), tiled ? "tiled" : "linear", mismatch_count, level, level_dim.x, level_dim.y, level_dim.z);
+			}
+			test_check(mismatch_count == 0u);
+		}
+		level_offset += level_size;
+		prev_dim = level_dim;
+	}
+	// the whole chain must consist of exactly these levels
+	test_check(image_data_size_from_types(img->get_image_dim(), img->get_image_type(), false) == level_offset);
+	img->unmap(*floor_test::queue, (void*)mapped_ptr);
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	for (const bool tiled : { false, true }) {
+		// odd sizes in all dimensions, with y becoming empty before x
+		test_mip_chain<uint8_t>(COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RGBA8UI_NORM, uint4 { 13u, 9u, 0u, 0u }, tiled);
+		test_mip_chain<float>(COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32F, uint4 { 37u, 5u, 0u, 0u }, tiled);
+		test_mip_chain<int16_t>(COMPUTE_IMAGE_TYPE::IMAGE_2D_ARRAY | COMPUTE_IMAGE_TYPE::RG16I, uint4 { 11u, 7u, 3u, 0u }, tiled);
+		test_mip_chain<float>(COMPUTE_IMAGE_TYPE::IMAGE_3D | COMPUTE_IMAGE_TYPE::R32F, uint4 { 7u, 5u, 3u, 0u }, tiled);
+		// large enough to be split across the worker threads
+		test_mip_chain<float>(COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32F, uint4 { 723u, 457u, 0u, 0u }, tiled);
+	}
+	// no tiled layout for 1D images
+	test_mip_chain<uint32_t>(COMPUTE_IMAGE_TYPE::IMAGE_1D | COMPUTE_IMAGE_TYPE::R32UI, uint4 { 23u, 0u, 0u, 0u }, false);
+	test_mip_chain<int8_t>(COMPUTE_IMAGE_TYPE::IMAGE_1D_ARRAY | COMPUTE_IMAGE_TYPE::RGBA8I, uint4 { 19u, 4u, 0u, 0u }, false);
+	
+	return floor_test::finish();
+}
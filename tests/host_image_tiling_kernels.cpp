@@ -0,0 +1,68 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! copies "src" to "dst" (both must have the same size)
+kernel void copy_image(const_image_2d<float> src, image_2d<float, true> dst) {
+	const int2 coord { int(global_id.x), int(global_id.y) };
+	dst.write(coord, src.read(coord));
+}
+
+//! bilinearly resamples "src" to the size of "dst"
+kernel void bilinear_resample(const_image_2d<float> src, image_2d<float, true> dst) {
+	const float2 coord {
+		(float(global_id.x) + 0.5f) / float(global_size.x),
+		(float(global_id.y) + 0.5f) / float(global_size.y),
+	};
+	dst.write(int2 { int(global_id.x), int(global_id.y) }, src.read_linear(coord));
+}
+
+//! 3x3 binomial blur (clamp-to-edge), "src" and "dst" must have the same size
+kernel void stencil_3x3(const_image_2d<float> src, image_2d<float, true> dst) {
+	const int2 coord { int(global_id.x), int(global_id.y) };
+	const int2 max_coord { int(global_size.x) - 1, int(global_size.y) - 1 };
+	float4 sum { 0.0f };
+	for(int y = -1; y <= 1; ++y) {
+		for(int x = -1; x <= 1; ++x) {
+			const auto weight = float((x == 0 ? 2 : 1) * (y == 0 ? 2 : 1));
+			sum += src.read((coord + int2 { x, y }).clamped(int2 { 0, 0 }, max_coord)) * weight;
+		}
+	}
+	dst.write(coord, sum * (1.0f / 16.0f));
+}
+
+//! number of results per coordinate that are written by "batch_read"
+static constexpr const uint32_t batch_read_result_count { 6u };
+
+//! reads "coord_count" coordinates per work-item with all batched read variants (nearest/bilinear, clamp-to-edge/repeat)
+//! and with the scalar nearest/bilinear reads, writing the results to consecutive ranges of "coord_count" colors in "out"
+kernel void batch_read(const_image_2d<float> src, buffer<const float2> coords, buffer<float4> out, param<uint32_t> coord_count) {
+	const auto item_coords = &coords[global_id.x * coord_count];
+	const auto item_out = &out[global_id.x * coord_count * batch_read_result_count];
+	src.read_batch(item_coords, item_out, coord_count);
+	src.read_batch_linear(item_coords, item_out + coord_count, coord_count);
+	src.read_batch<HOST_IMAGE_ADDRESS_MODE::REPEAT>(item_coords, item_out + coord_count * 2u, coord_count);
+	src.read_batch_linear<HOST_IMAGE_ADDRESS_MODE::REPEAT>(item_coords, item_out + coord_count * 3u, coord_count);
+	for(uint32_t i = 0; i < coord_count; ++i) {
+		item_out[coord_count * 4u + i] = src.read(item_coords[i]);
+		item_out[coord_count * 5u + i] = src.read_linear(item_coords[i]);
+	}
+}
@@ -0,0 +1,322 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_image.hpp>
+#include <floor/compute/host/host_image.hpp>
+#include <floor/compute/device/host_image_tiling.hpp>
+#include <algorithm>
+
+static constexpr const COMPUTE_IMAGE_TYPE image_type {
+	COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RGBA32F | COMPUTE_IMAGE_TYPE::READ_WRITE
+};
+
+//! creates a linear or tiled RGBA32F image of size "dim", initialized with "data" (if non-empty)
+static shared_ptr<compute_image> make_image(const uint2 dim, const bool tiled, vector<float4>* data = nullptr) {
+	return floor_test::ctx->create_image(*floor_test::queue, uint4 { dim.x, dim.y, 0u, 0u }, image_type,
+										 (data != nullptr ? (void*)data->data() : nullptr),
+										 COMPUTE_MEMORY_FLAG::READ_WRITE | COMPUTE_MEMORY_FLAG::HOST_READ_WRITE |
+										 (tiled ? COMPUTE_MEMORY_FLAG::HOST_TILED_LAYOUT : COMPUTE_MEMORY_FLAG::NONE));
+}
+
+//! returns deterministic, non-trivial image data
+static vector<float4> make_data(const uint2 dim) {
+	vector<float4> data(dim.x * dim.y);
+	for (uint32_t y = 0; y < dim.y; ++y) {
+		for (uint32_t x = 0; x < dim.x; ++x) {
+			data[y * dim.x + x] = float4 { float(x), float(y), float((x * 7u + y * 13u) % 31u), 1.0f };
+		}
+	}
+	return data;
+}
+
+//! returns true if both images contain exactly the same data
+static bool is_equal(const vector<float4>& lhs, const vector<float4>& rhs) {
+	return (lhs.size() == rhs.size() &&
+			equal(lhs.begin(), lhs.end(), rhs.begin(), [](const float4& lhs_val, const float4& rhs_val) {
+				return lhs_val.is_equal(rhs_val);
+			}));
+}
+
+//! reads back the (linear) image data via map
+static vector<float4> read_image(compute_image& img, const uint2 dim) {
+	floor_test::queue->finish();
+	vector<float4> data(dim.x * dim.y);
+	auto mapped_ptr = img.map(*floor_test::queue, COMPUTE_MEMORY_MAP_FLAG::READ | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+	test_check(mapped_ptr != nullptr);
+	if (mapped_ptr != nullptr) {
+		memcpy(data.data(), mapped_ptr, data.size() * sizeof(float4));
+		img.unmap(*floor_test::queue, mapped_ptr);
+	}
+	return data;
+}
+
+//! tiled images must be stored tiled, but must be transparently linear when mapped and when accessed by kernels
+static void test_tiled_layout(const compute_kernel& copy_kernel) {
+	// NOTE: dims are not a multiple of the tile size, so that partial edge tiles are tested as well
+	const uint2 dim { 37u, 23u };
+	auto data = make_data(dim);
+	auto tiled_img = make_image(dim, true, &data);
+	auto linear_img = make_image(dim, false);
+	
+	// initial data must have been converted to the tiled layout
+	const auto tiled_storage = (const float4*)((const host_image*)tiled_img.get())->get_host_image_buffer_ptr();
+	bool is_tiled = true;
+	for (uint32_t y = 0; y < dim.y; ++y) {
+		for (uint32_t x = 0; x < dim.x; ++x) {
+			is_tiled &= tiled_storage[host_image_tiling::texel_index(dim.x, dim.y, x, y)].is_equal(data[y * dim.x + x]);
+		}
+	}
+	test_check(is_tiled);
+	
+	// map must return the linear data
+	test_check(is_equal(read_image(*tiled_img, dim), data));
+	
+	// kernel reads from a tiled image and writes to a tiled image
+	floor_test::queue->execute(copy_kernel, uint2 { dim }, uint2 { 1u, 1u }, tiled_img, linear_img);
+	test_check(is_equal(read_image(*linear_img, dim), data));
+	auto tiled_copy_img = make_image(dim, true);
+	floor_test::queue->execute(copy_kernel, uint2 { dim }, uint2 { 1u, 1u }, linear_img, tiled_copy_img);
+	test_check(is_equal(read_image(*tiled_copy_img, dim), data));
+	
+	// writing through a map must end up in the tiled layout
+	auto mapped_ptr = (float4*)tiled_img->map(*floor_test::queue, COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE |
+																  COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+	test_check(mapped_ptr != nullptr);
+	if (mapped_ptr != nullptr) {
+		for (size_t i = 0; i < data.size(); ++i) {
+			data[i] *= 2.0f;
+			mapped_ptr[i] = data[i];
+		}
+		tiled_img->unmap(*floor_test::queue, mapped_ptr);
+	}
+	floor_test::queue->execute(copy_kernel, uint2 { dim }, uint2 { 1u, 1u }, tiled_img, linear_img);
+	test_check(is_equal(read_image(*linear_img, dim), data));
+}
+
+//! filtering/stencil kernels must produce identical results for both layouts
+static void test_filter_kernels(const compute_kernel& bilinear_kernel, const compute_kernel& stencil_kernel) {
+	const uint2 src_dim { 61u, 45u };
+	const uint2 dst_dim { 97u, 30u };
+	auto data = make_data(src_dim);
+	auto linear_src = make_image(src_dim, false, &data);
+	auto tiled_src = make_image(src_dim, true, &data);
+	
+	auto linear_dst = make_image(dst_dim, false);
+	auto tiled_dst = make_image(dst_dim, true);
+	floor_test::queue->execute(bilinear_kernel, uint2 { dst_dim }, uint2 { 1u, 1u }, linear_src, linear_dst);
+	floor_test::queue->execute(bilinear_kernel, uint2 { dst_dim }, uint2 { 1u, 1u }, tiled_src, tiled_dst);
+	test_check(is_equal(read_image(*linear_dst, dst_dim), read_image(*tiled_dst, dst_dim)));
+	
+	auto linear_stencil = make_image(src_dim, false);
+	auto tiled_stencil = make_image(src_dim, true);
+	floor_test::queue->execute(stencil_kernel, uint2 { src_dim }, uint2 { 1u, 1u }, linear_src, linear_stencil);
+	floor_test::queue->execute(stencil_kernel, uint2 { src_dim }, uint2 { 1u, 1u }, tiled_src, tiled_stencil);
+	const auto stencil_result = read_image(*linear_stencil, src_dim);
+	test_check(is_equal(stencil_result, read_image(*tiled_stencil, src_dim)));
+	
+	// compare against a reference implementation
+	bool stencil_valid = true;
+	for (int y = 0; y < int(src_dim.y); ++y) {
+		for (int x = 0; x < int(src_dim.x); ++x) {
+			float4 sum { 0.0f };
+			for (int sy = -1; sy <= 1; ++sy) {
+				for (int sx = -1; sx <= 1; ++sx) {
+					const auto rx = std::clamp(x + sx, 0, int(src_dim.x) - 1);
+					const auto ry = std::clamp(y + sy, 0, int(src_dim.y) - 1);
+					sum += data[uint32_t(ry) * src_dim.x + uint32_t(rx)] * float((sx == 0 ? 2 : 1) * (sy == 0 ? 2 : 1));
+				}
+			}
+			const auto diff = (sum * (1.0f / 16.0f) - stencil_result[uint32_t(y) * src_dim.x + uint32_t(x)]).absed();
+			stencil_valid &= (diff.max_element() < 1.0e-4f);
+		}
+	}
+	test_check(stencil_valid);
+}
+
+//! applies the clamp-to-edge or repeat address mode to the integer texel coordinate "coord"
+static uint32_t address_coord(const int32_t coord, const int32_t dim, const bool repeat) {
+	if (repeat) {
+		return uint32_t(coord < 0 ? dim - 1 : (coord >= dim ? 0 : coord));
+	}
+	return uint32_t(std::clamp(coord, 0, dim - 1));
+}
+
+//! reference nearest/bilinear sampling of the normalized coordinate "coord" in the image "texels" of size "dim"
+static float4 sample_reference(const vector<float4>& texels, const uint2 dim, float2 coord, const bool linear, const bool repeat) {
+	const auto fdim = dim.cast<float>();
+	if (repeat) {
+		coord.x -= std::floor(coord.x);
+		coord.y -= std::floor(coord.y);
+	}
+	if (!linear) {
+		const auto x = uint32_t(std::clamp(coord.x * fdim.x, 0.0f, fdim.x - 0.5f));
+		const auto y = uint32_t(std::clamp(coord.y * fdim.y, 0.0f, fdim.y - 0.5f));
+		return texels[y * dim.x + x];
+	}
+	const auto fx = std::clamp(coord.x * fdim.x - 0.5f, -1.0f, fdim.x);
+	const auto fy = std::clamp(coord.y * fdim.y - 0.5f, -1.0f, fdim.y);
+	const auto floor_x = std::floor(fx), floor_y = std::floor(fy);
+	const auto tx = fx - floor_x, ty = fy - floor_y;
+	const auto x0 = address_coord(int32_t(floor_x), int32_t(dim.x), repeat);
+	const auto x1 = address_coord(int32_t(floor_x) + 1, int32_t(dim.x), repeat);
+	const auto y0 = address_coord(int32_t(floor_y), int32_t(dim.y), repeat);
+	const auto y1 = address_coord(int32_t(floor_y) + 1, int32_t(dim.y), repeat);
+	const auto row_0 = texels[y0 * dim.x + x0] * (1.0f - tx) + texels[y0 * dim.x + x1] * tx;
+	const auto row_1 = texels[y1 * dim.x + x0] * (1.0f - tx) + texels[y1 * dim.x + x1] * tx;
+	return row_0 * (1.0f - ty) + row_1 * ty;
+}
+
+//! batched image reads (nearest/bilinear, clamp-to-edge/repeat) must match a reference implementation and the scalar reads,
+//! for all specialized batch formats (RGBA8 unorm, R32F, RGBA32F) and a format that uses the generic fallback (RG32F),
+//! with linear and tiled layouts, and batch sizes that are not a multiple of the internal group size
+static void test_batch_read(const compute_kernel& batch_kernel) {
+	// NOTE: must match the kernel
+	static constexpr const uint32_t batch_read_result_count { 6u };
+	static constexpr const uint32_t item_count { 8u }, coord_count { 37u };
+	const uint2 dim { 13u, 9u };
+	
+	// all coordinates are 0.3/0.7 texels away from the texel centers (-> no ambiguous rounding), including out-of-range ones
+	vector<float2> coords(item_count * coord_count);
+	for (uint32_t i = 0; i < uint32_t(coords.size()); ++i) {
+		const auto tx = int32_t(i % (dim.x + 10u)) - 5;
+		const auto ty = int32_t((i * 7u) % (dim.y + 10u)) - 5;
+		coords[i] = { (float(tx) + 0.3f) / float(dim.x), (float(ty) + 0.7f) / float(dim.y) };
+	}
+	auto coords_buffer = floor_test::ctx->create_buffer(*floor_test::queue, coords);
+	auto out_buffer = floor_test::ctx->create_buffer(*floor_test::queue, sizeof(float4) * coords.size() * batch_read_result_count);
+	
+	for (const auto format : { COMPUTE_IMAGE_TYPE::RGBA8UI_NORM, COMPUTE_IMAGE_TYPE::R32F,
+							   COMPUTE_IMAGE_TYPE::RGBA32F, COMPUTE_IMAGE_TYPE::RG32F }) {
+		// create the image data and the expected texels (non-existing channels are 0, alpha is 1)
+		const auto channel_count = image_channel_count(format);
+		const auto is_unorm8 = (format == COMPUTE_IMAGE_TYPE::RGBA8UI_NORM);
+		vector<float4> texels(dim.x * dim.y);
+		vector<uint8_t> data(texels.size() * (is_unorm8 ? 4u : channel_count * sizeof(float)));
+		for (uint32_t i = 0; i < uint32_t(texels.size()); ++i) {
+			for (uint32_t c = 0; c < 4u; ++c) {
+				const auto value = uint8_t((i * 37u + c * 71u + 13u) % 256u);
+				if (c >= channel_count) {
+					texels[i][c] = (c == 3u ? 1.0f : 0.0f);
+				} else if (is_unorm8) {
+					data[i * 4u + c] = value;
+					texels[i][c] = float(value) / 255.0f;
+				} else {
+					texels[i][c] = float(value) / 256.0f;
+					memcpy(&data[(i * channel_count + c) * sizeof(float)], &texels[i][c], sizeof(float));
+				}
+			}
+		}
+		
+		for (const auto tiled : { false, true }) {
+			auto img = floor_test::ctx->create_image(*floor_test::queue, uint4 { dim.x, dim.y, 0u, 0u },
+													 COMPUTE_IMAGE_TYPE::IMAGE_2D | format | COMPUTE_IMAGE_TYPE::READ_WRITE, data.data(),
+													 COMPUTE_MEMORY_FLAG::READ_WRITE | COMPUTE_MEMORY_FLAG::HOST_READ_WRITE |
+													 (tiled ? COMPUTE_MEMORY_FLAG::HOST_TILED_LAYOUT : COMPUTE_MEMORY_FLAG::NONE));
+			test_check(img != nullptr);
+			if (!img) {
+				continue;
+			}
+			floor_test::queue->execute(batch_kernel, uint1 { item_count }, uint1 { 1u }, img, coords_buffer, out_buffer, coord_count);
+			vector<float4> out(coords.size() * batch_read_result_count);
+			out_buffer->read(*floor_test::queue, out.data());
+			
+			bool valid = true;
+			for (uint32_t item = 0; item < item_count && valid; ++item) {
+				const auto item_out = &out[item * coord_count * batch_read_result_count];
+				for (uint32_t i = 0; i < coord_count && valid; ++i) {
+					const auto coord = coords[item * coord_count + i];
+					for (uint32_t variant = 0; variant < 4u; ++variant) {
+						const auto linear = ((variant & 1u) != 0u);
+						const auto repeat = ((variant & 2u) != 0u);
+						const auto batch_color = item_out[variant * coord_count + i];
+						const auto expected = sample_reference(texels, dim, coord, linear, repeat);
+						bool match = ((batch_color - expected).absed().max_element() < 1.0e-5f);
+						// clamp-to-edge batched reads must also match the scalar reads (in all existing channels)
+						if (!repeat) {
+							const auto scalar_color = item_out[(linear ? 5u : 4u) * coord_count + i];
+							for (uint32_t c = 0; c < channel_count; ++c) {
+								match &= (std::abs(batch_color[c] - scalar_color[c]) < 1.0e-5f);
+							}
+						}
+						if (!match) {
+							log_error("batch read mismatch (format %X, %s, %s, %s) at coord %v (#%u): got %v, expected %v",
+									  uint64_t(format), tiled ? "tiled" : "linear", linear ? "bilinear" : "nearest",
+									  repeat ? "repeat" : "clamp", coord, item * coord_count + i, batch_color, expected);
+							valid = false;
+							break;
+						}
+					}
+				}
+			}
+			test_check(valid);
+		}
+	}
+}
+
+//! bilinear/3x3 stencil kernels on linear and tiled images
+static void bench_filter_kernels(const compute_kernel& bilinear_kernel, const compute_kernel& stencil_kernel) {
+	static constexpr const uint32_t iterations { 20u };
+	for (const auto size : { 512u, 2048u, 4096u }) {
+		const uint2 dim { size, size };
+		auto data = make_data(dim);
+		double bilinear_times[2] {}, stencil_times[2] {};
+		for (uint32_t tiled = 0; tiled < 2u; ++tiled) {
+			auto src = make_image(dim, tiled != 0u, &data);
+			auto dst = make_image(dim, tiled != 0u);
+			// NOTE: ~1.5x downscale -> every dst texel reads texels of two different src rows/columns
+			const auto bilinear_size = (((size * 2u) / 3u) / 16u) * 16u;
+			const uint2 bilinear_dim { bilinear_size, bilinear_size };
+			auto bilinear_dst = make_image(bilinear_dim, tiled != 0u);
+			bilinear_times[tiled] = floor_test::time_us(iterations, [&] {
+				floor_test::queue->execute(bilinear_kernel, uint2 { bilinear_dim }, uint2 { 16u, 16u }, src, bilinear_dst);
+				floor_test::queue->finish();
+			});
+			stencil_times[tiled] = floor_test::time_us(iterations, [&] {
+				floor_test::queue->execute(stencil_kernel, uint2 { dim }, uint2 { 16u, 16u }, src, dst);
+				floor_test::queue->finish();
+			});
+		}
+		log_msg("%ux%u RGBA32F: bilinear: linear %fus, tiled %fus (%fx), 3x3 stencil: linear %fus, tiled %fus (%fx)",
+				size, size,
+				bilinear_times[0], bilinear_times[1], bilinear_times[0] / bilinear_times[1],
+				stencil_times[0], stencil_times[1], stencil_times[0] / stencil_times[1]);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	auto copy_kernel = floor_test::get_kernel("copy_image");
+	auto bilinear_kernel = floor_test::get_kernel("bilinear_resample");
+	auto stencil_kernel = floor_test::get_kernel("stencil_3x3");
+	auto batch_kernel = floor_test::get_kernel("batch_read");
+	if (copy_kernel && bilinear_kernel && stencil_kernel && batch_kernel) {
+		test_tiled_layout(*copy_kernel);
+		test_filter_kernels(*bilinear_kernel, *stencil_kernel);
+		test_batch_read(*batch_kernel);
+		if (floor_test::run_benchmarks) {
+			bench_filter_kernels(*bilinear_kernel, *stencil_kernel);
+		}
+	}
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,97 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! NOTE: must match the definitions in host_kernel_args_test.cpp
+struct mixed_arg_t {
+	int32_t a;
+	float b;
+	uint16_t c;
+	uint8_t d[3];
+};
+struct span_arg_t {
+	uint32_t values[5];
+};
+
+//! writes the bit patterns of all args into "out" (more args than are passed in registers on x86-64 and AArch64,
+//! so that the trailing args are passed on the stack, with an odd amount of stack args)
+kernel void mixed_args(buffer<uint32_t> out,
+					   param<int32_t> i0,
+					   param<float> f0,
+					   param<uint64_t> u0,
+					   param<mixed_arg_t> s0,
+					   buffer<const uint32_t> in,
+					   param<int8_t> i1,
+					   param<float> f1,
+					   param<mixed_arg_t> s1,
+					   param<span_arg_t> span0,
+					   param<uint16_t> u1,
+					   param<int32_t> i2,
+					   param<uint8_t> u2) {
+	if(global_id.x != 0) {
+		return;
+	}
+	uint32_t idx = 0;
+	out[idx++] = uint32_t(i0);
+	out[idx++] = __builtin_bit_cast(uint32_t, f0);
+	out[idx++] = uint32_t(u0 & 0xFFFFFFFFu);
+	out[idx++] = uint32_t(u0 >> 32u);
+	for(const auto& s : { s0, s1 }) {
+		out[idx++] = uint32_t(s.a);
+		out[idx++] = __builtin_bit_cast(uint32_t, s.b);
+		out[idx++] = s.c;
+		out[idx++] = uint32_t(s.d[0]) | (uint32_t(s.d[1]) << 8u) | (uint32_t(s.d[2]) << 16u);
+	}
+	out[idx++] = in[0] + in[1];
+	out[idx++] = uint32_t(int32_t(i1));
+	out[idx++] = __builtin_bit_cast(uint32_t, f1);
+	for(uint32_t i = 0; i < 5; ++i) {
+		out[idx++] = span0.values[i];
+	}
+	out[idx++] = u1;
+	out[idx++] = uint32_t(i2);
+	out[idx++] = u2;
+}
+
+//! keeps many integer and floating point values live across barriers (-> these must be kept in callee-saved registers or
+//! spilled to the fiber stack)
+//! NOTE: all multiplications are exact, so that the results don't depend on FMA contraction
+kernel void barrier_live_values(buffer<uint32_t> out_u, buffer<float> out_f, param<uint32_t> iterations) {
+	uint32_t u0 = local_id.x, u1 = u0 + 1u, u2 = u0 + 2u, u3 = u0 + 3u, u4 = u0 + 4u, u5 = u0 + 5u;
+	float f0 = float(local_id.x), f1 = f0 + 1.0f, f2 = f0 + 2.0f, f3 = f0 + 3.0f, f4 = f0 + 4.0f, f5 = f0 + 5.0f;
+	for(uint32_t i = 0; i < iterations; ++i) {
+		u0 = u0 * 3u + u5;
+		u1 = u1 * 5u + u0;
+		u2 = u2 * 7u + u1;
+		u3 = u3 * 9u + u2;
+		u4 = u4 * 11u + u3;
+		u5 = u5 * 13u + u4;
+		f0 = f0 * 0.5f + f5;
+		f1 = f1 * 0.5f + f0;
+		f2 = f2 * 0.5f + f1;
+		f3 = f3 * 0.5f + f2;
+		f4 = f4 * 0.5f + f3;
+		f5 = f5 * 0.5f + f4;
+		local_barrier();
+	}
+	out_u[global_id.x] = u0 ^ u1 ^ u2 ^ u3 ^ u4 ^ u5;
+	out_f[global_id.x] = f0 + f1 + f2 + f3 + f4 + f5;
+}
@@ -0,0 +1,149 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+
+//! NOTE: must match the definitions in host_kernel_args_kernels.cpp
+struct mixed_arg_t {
+	int32_t a;
+	float b;
+	uint16_t c;
+	uint8_t d[3];
+};
+struct span_arg_t {
+	uint32_t values[5];
+};
+
+static uint32_t float_bits(const float value) {
+	uint32_t bits = 0u;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+//! kernel calls with more args than are passed in registers (x86-64: 6, AArch64: 8) must pass all args in order,
+//! regardless of their type (all args are passed as pointers to the arg data)
+static void test_mixed_args() {
+	auto& queue = *floor_test::queue;
+	auto kernel = floor_test::get_kernel("mixed_args");
+	if (!kernel) {
+		return;
+	}
+	
+	static constexpr const uint32_t result_count { 24u };
+	auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * result_count);
+	out_buffer->zero(queue);
+	const vector<uint32_t> input { 0x1000u, 0x0234u };
+	auto in_buffer = floor_test::ctx->create_buffer(queue, input);
+	
+	const int32_t i0 { -7 };
+	const float f0 { 1.5f };
+	const uint64_t u0 { 0x0123456789ABCDEFull };
+	const mixed_arg_t s0 { -42, -0.25f, 0xBEEFu, { 1u, 2u, 3u } };
+	const int8_t i1 { -3 };
+	const float f1 { 1024.75f };
+	const mixed_arg_t s1 { 0x7FFFFFFF, 3.0e10f, 0x1234u, { 0xFFu, 0x80u, 0x7Fu } };
+	const span_arg_t span_data { { 11u, 22u, 33u, 44u, 55u } };
+#if defined(FLOOR_CXX20) // pass as a span arg with CPU storage
+	const span<const span_arg_t> span0 { &span_data, 1u };
+#else
+	const auto& span0 = span_data;
+#endif
+	const uint16_t u1 { 0xFFFEu };
+	const int32_t i2 { 0x12345678 };
+	const uint8_t u2 { 0xA5u };
+	
+	queue.execute(*kernel, uint1 { 4u }, uint1 { 4u },
+				  out_buffer, i0, f0, u0, s0, in_buffer, i1, f1, s1, span0, u1, i2, u2);
+	queue.finish();
+	
+	vector<uint32_t> out(result_count);
+	out_buffer->read(queue, out.data());
+	const vector<uint32_t> expected {
+		uint32_t(i0), float_bits(f0), 0x89ABCDEFu, 0x01234567u,
+		uint32_t(s0.a), float_bits(s0.b), s0.c, 0x030201u,
+		uint32_t(s1.a), float_bits(s1.b), s1.c, 0x7F80FFu,
+		0x1234u, uint32_t(int32_t(i1)), float_bits(f1),
+		11u, 22u, 33u, 44u, 55u,
+		u1, uint32_t(i2), u2,
+		0u,
+	};
+	for (uint32_t i = 0; i < result_count; ++i) {
+		if (out[i] != expected[i]) {
+			log_error("mixed_args: result #%u mismatch: got %X, expected %X", i, out[i], expected[i]);
+		}
+		test_check(out[i] == expected[i]);
+	}
+}
+
+//! integer and floating point values that are live across barriers must survive the fiber switches
+static void test_barrier_live_values() {
+	auto& queue = *floor_test::queue;
+	auto kernel = floor_test::get_kernel("barrier_live_values");
+	if (!kernel) {
+		return;
+	}
+	
+	static constexpr const uint32_t local_size { 64u };
+	static constexpr const uint32_t global_size { local_size * 8u };
+	static constexpr const uint32_t iterations { 13u };
+	auto out_u_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * global_size);
+	auto out_f_buffer = floor_test::ctx->create_buffer(queue, sizeof(float) * global_size);
+	queue.execute(*kernel, uint1 { global_size }, uint1 { local_size }, out_u_buffer, out_f_buffer, iterations);
+	queue.finish();
+	
+	vector<uint32_t> out_u(global_size);
+	vector<float> out_f(global_size);
+	out_u_buffer->read(queue, out_u.data());
+	out_f_buffer->read(queue, out_f.data());
+	bool match = true;
+	for (uint32_t i = 0; i < global_size; ++i) {
+		const auto local_idx = i % local_size;
+		uint32_t u0 = local_idx, u1 = u0 + 1u, u2 = u0 + 2u, u3 = u0 + 3u, u4 = u0 + 4u, u5 = u0 + 5u;
+		float f0 = float(local_idx), f1 = f0 + 1.0f, f2 = f0 + 2.0f, f3 = f0 + 3.0f, f4 = f0 + 4.0f, f5 = f0 + 5.0f;
+		for (uint32_t iter = 0; iter < iterations; ++iter) {
+			u0 = u0 * 3u + u5;
+			u1 = u1 * 5u + u0;
+			u2 = u2 * 7u + u1;
+			u3 = u3 * 9u + u2;
+			u4 = u4 * 11u + u3;
+			u5 = u5 * 13u + u4;
+			f0 = f0 * 0.5f + f5;
+			f1 = f1 * 0.5f + f0;
+			f2 = f2 * 0.5f + f1;
+			f3 = f3 * 0.5f + f2;
+			f4 = f4 * 0.5f + f3;
+			f5 = f5 * 0.5f + f4;
+		}
+		match &= (out_u[i] == (u0 ^ u1 ^ u2 ^ u3 ^ u4 ^ u5));
+		match &= (out_f[i] == f0 + f1 + f2 + f3 + f4 + f5);
+	}
+	test_check(match);
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_mixed_args();
+	test_barrier_live_values();
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,35 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! performs "iterations" dependent integer ops per work-item, so that each execution takes a measurable amount of time
+kernel void event_busy_work(buffer<uint32_t> data, param<uint32_t> iterations) {
+	auto value = data[global_id.x];
+	for(uint32_t i = 0; i < iterations; ++i) {
+		value = value * 1664525u + 1013904223u;
+	}
+	data[global_id.x] = value;
+}
+
+//! trivial kernel, used to check that events are attributed to the correct kernel
+kernel void event_increment(buffer<uint32_t> data) {
+	++data[global_id.x];
+}
@@ -0,0 +1,102 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+
+//! kernel events of an in-order queue must be returned in execution order with ordered and monotonically increasing
+//! timestamps: queued <= start <= end per event, and no execution may start before the previous one has ended
+static void test_kernel_event_order() {
+	auto& queue = *floor_test::queue;
+	auto busy_kernel = floor_test::get_kernel("event_busy_work");
+	auto inc_kernel = floor_test::get_kernel("event_increment");
+	if (!busy_kernel || !inc_kernel) {
+		return;
+	}
+	test_check(queue.has_kernel_event_support());
+	
+	static constexpr const uint32_t global_size { 4096u }, local_size { 64u }, execution_count { 16u };
+	const uint32_t iterations { 1000u };
+	vector<uint32_t> data(global_size, 0u);
+	auto data_buffer = floor_test::ctx->create_buffer(queue, data);
+	
+	// events are only collected while logging is enabled
+	queue.set_kernel_event_logging(false);
+	queue.execute(*inc_kernel, uint1 { global_size }, uint1 { local_size }, data_buffer);
+	queue.finish();
+	test_check(queue.collect_kernel_events().empty());
+	
+	queue.set_kernel_event_logging(true);
+	test_check(queue.is_kernel_event_logging());
+	const auto before_time = compute_queue::get_kernel_event_time();
+	for (uint32_t i = 0; i < execution_count; ++i) {
+		if (i % 2u == 0u) {
+			queue.execute(*busy_kernel, uint1 { global_size }, uint1 { local_size }, data_buffer, iterations);
+		} else {
+			queue.execute(*inc_kernel, uint1 { global_size }, uint1 { local_size }, data_buffer);
+		}
+	}
+	queue.finish();
+	const auto after_time = compute_queue::get_kernel_event_time();
+	queue.set_kernel_event_logging(false);
+	
+	const auto events = queue.collect_kernel_events();
+	test_check(events.size() == execution_count);
+	if (events.size() != execution_count) {
+		return;
+	}
+	// collecting consumes the events
+	test_check(queue.collect_kernel_events().empty());
+	
+	uint64_t prev_queued = before_time, prev_end = before_time;
+	for (uint32_t i = 0; i < execution_count; ++i) {
+		const auto& evt = events[i];
+		const auto expected_name = (i % 2u == 0u ? "event_busy_work" : "event_increment");
+		if (evt.kernel_name != expected_name) {
+			log_error("kernel event #%u: expected kernel \"%s\", got \"%s\"", i, expected_name, evt.kernel_name);
+			test_check(evt.kernel_name == expected_name);
+		}
+		if (!(evt.queued <= evt.start && evt.start <= evt.end)) {
+			log_error("kernel event #%u: timestamps out of order (queued %u, start %u, end %u)",
+					  i, evt.queued, evt.start, evt.end);
+			test_check(evt.queued <= evt.start && evt.start <= evt.end);
+		}
+		if (evt.queued < prev_queued || evt.start < prev_end) {
+			log_error("kernel event #%u: timestamps are not monotonic (queued %u after %u, start %u after end %u)",
+					  i, evt.queued, prev_queued, evt.start, prev_end);
+			test_check(evt.queued >= prev_queued && evt.start >= prev_end);
+		}
+		prev_queued = evt.queued;
+		prev_end = evt.end;
+	}
+	test_check(prev_end <= after_time);
+	
+	// the busy kernel must actually take time
+	test_check(events[0].end > events[0].start);
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_kernel_event_order();
+	
+	return floor_test::finish();
+}
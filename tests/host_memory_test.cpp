@@ -0,0 +1,410 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/host/host_memory.hpp>
+#include <floor/compute/compute_buffer.hpp>
+#include <floor/compute/host/host_buffer.hpp>
+#include <floor/core/file_io.hpp>
+#include <cstdio>
+
+//! returns true if "size" bytes at "data" consist of the repeated "pattern"
+static bool check_pattern(const uint8_t* data, const size_t size, const uint8_t* pattern, const size_t pattern_size) {
+	for (size_t i = 0; i < size; ++i) {
+		if (data[i] != pattern[i % pattern_size]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//! allocations must be page-aligned and at least as large as requested
+static void test_allocate() {
+	for (const size_t size : { size_t(1u), size_t(4097u), size_t(3u * 1024u * 1024u + 17u) }) {
+		auto mem = host_memory::allocate(size, *floor_test::queue);
+		test_check(bool(mem));
+		if (!mem) {
+			continue;
+		}
+		test_check(mem.allocation_size() >= size);
+		test_check((size_t(mem.get()) % 4096u) == 0u);
+		// must be writable in its entirety
+		memset(mem.get(), 0xA5, mem.allocation_size());
+		
+		host_memory moved_mem(move(mem));
+		test_check(!mem);
+		test_check(bool(moved_mem));
+	}
+}
+
+//! the allocation policy must be honored: allocations at/above the huge page threshold are huge page backed
+//! (2 MiB aligned and sized on Linux), smaller ones (or all, when disabled) are regular page-aligned allocations,
+//! and pre-faulted allocations must be usable
+static void test_allocation_policy() {
+	const auto& queue = *floor_test::queue;
+	const auto prev_policy = host_memory::get_policy();
+	static constexpr const size_t huge_page_size { 2u * 1024u * 1024u };
+	static constexpr const size_t large_size { 3u * huge_page_size + 123u };
+	
+	host_memory::set_policy({
+		.huge_page_threshold = huge_page_size,
+		.use_hugetlb = false,
+		.prefault_threshold = 0u,
+	});
+	test_check(host_memory::get_policy().huge_page_threshold == huge_page_size);
+	{
+		auto small_mem = host_memory::allocate(huge_page_size - 1u, queue);
+		test_check(bool(small_mem));
+		test_check(!small_mem.is_huge_page_backed());
+		test_check((size_t(small_mem.get()) % 4096u) == 0u);
+		
+		auto large_mem = host_memory::allocate(large_size, queue);
+		test_check(bool(large_mem));
+		test_check(large_mem.allocation_size() >= large_size);
+#if defined(__linux__)
+		test_check(large_mem.is_huge_page_backed());
+		test_check((size_t(large_mem.get()) % huge_page_size) == 0u);
+		test_check((large_mem.allocation_size() % huge_page_size) == 0u);
+#endif
+		if (large_mem) {
+			memset(large_mem.get(), 0x5A, large_mem.allocation_size());
+		}
+	}
+	
+	// explicit huge pages fall back to transparent huge pages if none are preallocated -> must always succeed
+	host_memory::set_policy({
+		.huge_page_threshold = huge_page_size,
+		.use_hugetlb = true,
+		.prefault_threshold = 0u,
+	});
+	{
+		auto large_mem = host_memory::allocate(large_size, queue);
+		test_check(bool(large_mem));
+#if defined(__linux__)
+		test_check(large_mem.is_huge_page_backed());
+		test_check((size_t(large_mem.get()) % huge_page_size) == 0u);
+#endif
+		if (large_mem) {
+			memset(large_mem.get(), 0x5A, large_size);
+		}
+	}
+	
+	// disabled huge pages + pre-faulting
+	host_memory::set_policy({
+		.huge_page_threshold = 0u,
+		.use_hugetlb = false,
+		.prefault_threshold = 4096u,
+	});
+	{
+		auto large_mem = host_memory::allocate(large_size, queue);
+		test_check(bool(large_mem));
+		test_check(!large_mem.is_huge_page_backed());
+		test_check((size_t(large_mem.get()) % 4096u) == 0u);
+		test_check(large_mem.allocation_size() >= large_size);
+		if (large_mem) {
+			// pre-faulting zeros the first byte of each page
+			test_check(large_mem.get()[0] == 0u);
+			memset(large_mem.get(), 0x5A, large_mem.allocation_size());
+			const uint8_t pattern_byte { 0x5Au };
+			test_check(check_pattern(large_mem.get(), large_mem.allocation_size(), &pattern_byte, 1u));
+		}
+	}
+	
+	host_memory::set_policy(prev_policy);
+}
+
+//! USE_HOST_MEMORY buffers of sufficiently aligned host memory must directly use that memory (zero-copy): kernel writes
+//! and buffer operations are visible in the host memory without a read, and host writes are visible to kernels,
+//! less aligned host memory must fall back to a private copy that is initialized with the host data
+static void test_use_host_memory() {
+	auto& queue = *floor_test::queue;
+	auto kernel = floor_test::get_kernel("add_value");
+	if (!kernel) {
+		return;
+	}
+	
+	static constexpr const uint32_t elem_count { 64u * 1024u };
+	static constexpr const size_t buffer_size { sizeof(uint32_t) * elem_count };
+	const auto buffer_flags = (COMPUTE_MEMORY_FLAG::READ_WRITE |
+							   COMPUTE_MEMORY_FLAG::HOST_READ_WRITE |
+							   COMPUTE_MEMORY_FLAG::USE_HOST_MEMORY);
+	// NOTE: page-aligned, +16 bytes for the unaligned variant
+	auto host_mem = host_memory::allocate(buffer_size + 16u, queue);
+	test_check(bool(host_mem));
+	if (!host_mem) {
+		return;
+	}
+	
+	for (const auto is_aligned : { true, false }) {
+		auto host_data = (uint32_t*)(host_mem.get() + (is_aligned ? 0u : 16u));
+		for (uint32_t i = 0; i < elem_count; ++i) {
+			host_data[i] = i;
+		}
+		
+		auto buf = floor_test::ctx->create_buffer(queue, buffer_size, host_data, buffer_flags);
+		test_check(buf != nullptr);
+		if (!buf) {
+			continue;
+		}
+		const auto& hst_buf = (const host_buffer&)*buf;
+		test_check(hst_buf.is_aliasing_host_memory() == is_aligned);
+		test_check((hst_buf.get_host_buffer_ptr() == (uint8_t*)host_data) == is_aligned);
+		
+		// kernel writes (visible in the host memory when aliased, only in the buffer otherwise)
+		const uint32_t value { 1000u };
+		queue.execute(*kernel, uint1 { elem_count }, uint1 { 64u }, buf, value);
+		queue.finish();
+		bool host_valid = true;
+		for (uint32_t i = 0; i < elem_count; ++i) {
+			host_valid &= (host_data[i] == (is_aligned ? i + value : i));
+		}
+		test_check(host_valid);
+		
+		// host writes (visible to kernels when aliased)
+		host_data[0] = 42u;
+		queue.execute(*kernel, uint1 { elem_count }, uint1 { 64u }, buf, value);
+		vector<uint32_t> data(elem_count);
+		buf->read(queue, data.data());
+		test_check(data[0] == (is_aligned ? 42u + value : 2u * value));
+		bool buffer_valid = true;
+		for (uint32_t i = 1; i < elem_count; ++i) {
+			buffer_valid &= (data[i] == i + 2u * value);
+		}
+		test_check(buffer_valid);
+		
+		// buffer operations
+		test_check(buf->zero(queue));
+		queue.finish();
+		test_check((host_data[elem_count - 1u] == 0u) == is_aligned);
+		
+		// mapping an aliasing buffer returns the host memory itself
+		auto mapped_ptr = buf->map(queue);
+		test_check(mapped_ptr != nullptr);
+		test_check((mapped_ptr == (void*)host_data) == is_aligned);
+		if (mapped_ptr != nullptr) {
+			buf->unmap(queue, mapped_ptr);
+		}
+	}
+}
+
+//! file mappings must contain the file, followed by at least 64 zero bytes, private mappings must not modify the file,
+//! and modifications of write-back mappings must be written back to the file on sync
+static void test_map_file() {
+	static constexpr const char file_name[] { "host_memory_test_map_file.bin" };
+	// NOTE: the sizes right below and at a page boundary can't use the rest of the last page as padding
+	for (const size_t size : { size_t(1u), size_t(4096u - 10u), size_t(4096u), size_t(3u * 4096u + 5u) }) {
+		vector<uint8_t> data(size);
+		for (size_t i = 0; i < size; ++i) {
+			data[i] = uint8_t(i * 29u + 3u);
+		}
+		test_check(file_io::buffer_to_file(file_name, (const char*)data.data(), size));
+		
+		for (const bool write_back : { false, true }) {
+			size_t file_size = 0;
+			auto mem = host_memory::map_file(file_name, write_back, file_size);
+			test_check(bool(mem));
+			if (!mem) {
+				continue;
+			}
+			test_check(file_size == size);
+			test_check(mem.allocation_size() >= size + 64u);
+			test_check(memcmp(mem.get(), data.data(), size) == 0);
+			const uint8_t zero_byte { 0u };
+			test_check(check_pattern(mem.get() + size, 64u, &zero_byte, 1u));
+			
+			// modify the first and last byte of the file and the padding
+			mem.get()[0] = uint8_t(~data[0]);
+			mem.get()[size - 1u] = uint8_t(~data[size - 1u]);
+			mem.get()[size + 63u] = 0xFFu;
+			mem.sync();
+			
+			auto [file_data, file_data_size] = file_io::file_to_buffer(file_name);
+			test_check(file_data_size == size);
+			if (file_data_size == size) {
+				if (write_back) {
+					data[0] = uint8_t(~data[0]);
+					data[size - 1u] = uint8_t(~data[size - 1u]);
+				}
+				test_check(memcmp(file_data.get(), data.data(), size) == 0);
+			}
+			mem.release();
+			test_check(!mem);
+		}
+	}
+	
+	// empty and non-existing files can't be mapped
+	test_check(file_io::buffer_to_file(file_name, nullptr, 0u));
+	size_t file_size = 0;
+	test_check(!host_memory::map_file(file_name, false, file_size));
+	remove(file_name);
+	test_check(!host_memory::map_file(file_name, false, file_size));
+}
+
+//! fill/copy/zero of all kinds of sizes and pattern sizes, including ones that are split across worker threads
+//! and use non-temporal stores, must produce the same result as a trivial implementation
+static void test_bulk_ops() {
+	const auto& queue = *floor_test::queue;
+	static constexpr const size_t max_size { 64u * 1024u * 1024u + 64u };
+	auto src_mem = host_memory::allocate(max_size, queue);
+	auto dst_mem = host_memory::allocate(max_size, queue);
+	test_check(bool(src_mem) && bool(dst_mem));
+	if (!src_mem || !dst_mem) {
+		return;
+	}
+	
+	uint8_t pattern[128];
+	for (uint32_t i = 0; i < size(pattern); ++i) {
+		pattern[i] = uint8_t(i * 37u + 11u);
+	}
+	
+	for (const size_t pattern_size : { 1u, 2u, 3u, 4u, 5u, 8u, 12u, 16u, 24u, 32u, 64u, 100u, 128u }) {
+		for (const size_t fill_count : { size_t(1u), size_t(7u), size_t(1000u), size_t(max_size / 128u) }) {
+			const auto fill_size = pattern_size * fill_count;
+			// unaligned destination
+			auto dst = dst_mem.get() + 3u;
+			host_memory::fill(&queue, dst, pattern, pattern_size, fill_size);
+			test_check(check_pattern(dst, fill_size, pattern, pattern_size));
+		}
+	}
+	
+	for (size_t i = 0; i < max_size; ++i) {
+		src_mem.get()[i] = uint8_t(i * 13u + (i >> 12u));
+	}
+	for (const size_t copy_size : { size_t(1u), size_t(63u), size_t(4096u + 5u), size_t(max_size - 8u) }) {
+		memset(dst_mem.get(), 0, copy_size + 8u);
+		host_memory::copy(&queue, dst_mem.get() + 1u, src_mem.get() + 7u, copy_size);
+		test_check(dst_mem.get()[0] == 0u);
+		test_check(memcmp(dst_mem.get() + 1u, src_mem.get() + 7u, copy_size) == 0);
+		test_check(dst_mem.get()[copy_size + 1u] == 0u);
+	}
+	
+	for (const size_t zero_size : { size_t(1u), size_t(4099u), size_t(max_size - 1u) }) {
+		memset(dst_mem.get(), 0xFF, max_size);
+		host_memory::zero(&queue, dst_mem.get() + 1u, zero_size);
+		test_check(dst_mem.get()[0] == 0xFFu);
+		const uint8_t zero_byte { 0u };
+		test_check(check_pattern(dst_mem.get() + 1u, zero_size, &zero_byte, 1u));
+		if (zero_size + 1u < max_size) {
+			test_check(dst_mem.get()[zero_size + 1u] == 0xFFu);
+		}
+	}
+}
+
+//! large fills (-> split across worker threads and using non-temporal stores) with pattern sizes that are not a power-of-two,
+//! including ones larger than a page and larger than the fill source, with a partial last pattern
+static void test_large_pattern_fill() {
+	const auto& queue = *floor_test::queue;
+	static constexpr const size_t fill_size { 48u * 1024u * 1024u + 17u };
+	auto dst_mem = host_memory::allocate(fill_size + 2u * 64u, queue);
+	test_check(bool(dst_mem));
+	if (!dst_mem) {
+		return;
+	}
+	
+	vector<uint8_t> pattern(40000u);
+	for (size_t i = 0; i < pattern.size(); ++i) {
+		pattern[i] = uint8_t(i * 37u + 11u + (i >> 8u));
+	}
+	
+	const uint8_t guard_byte { 0xEEu };
+	for (const size_t pattern_size : { 3u, 7u, 12u, 100u, 4099u, 40000u }) {
+		memset(dst_mem.get(), guard_byte, fill_size + 2u * 64u);
+		auto dst = dst_mem.get() + 64u + 5u;
+		host_memory::fill(&queue, dst, pattern.data(), pattern_size, fill_size);
+		test_check(check_pattern(dst_mem.get(), 64u + 5u, &guard_byte, 1u));
+		test_check(check_pattern(dst, fill_size, pattern.data(), pattern_size));
+		test_check(check_pattern(dst + fill_size, 64u - 5u, &guard_byte, 1u));
+	}
+}
+
+//! buffer fills with patterns that are not 1/2/4/8/16 bytes in size, at an offset
+static void test_buffer_fill() {
+	auto& queue = *floor_test::queue;
+	static constexpr const size_t buffer_size { 3u * 5u * 7u * 4096u };
+	auto buf = floor_test::ctx->create_buffer(queue, buffer_size);
+	const uint8_t pattern[] { 1u, 2u, 3u, 4u, 5u, 6u, 7u };
+	vector<uint8_t> data(buffer_size);
+	for (const size_t pattern_size : { 3u, 5u, 7u }) {
+		buf->zero(queue);
+		const auto offset = pattern_size * 16u;
+		const auto fill_size = buffer_size - offset * 2u;
+		test_check(buf->fill(queue, pattern, pattern_size, fill_size, offset));
+		buf->read(queue, data.data());
+		const uint8_t zero_byte { 0u };
+		test_check(check_pattern(data.data(), offset, &zero_byte, 1u));
+		test_check(check_pattern(data.data() + offset, fill_size, pattern, pattern_size));
+		test_check(check_pattern(data.data() + offset + fill_size, offset, &zero_byte, 1u));
+	}
+}
+
+//! throughput of fill/copy/zero vs single-threaded memset/memcpy
+static void bench_bulk_ops() {
+	const auto& queue = *floor_test::queue;
+	const uint32_t pattern[] { 0x01234567u, 0x89ABCDEFu, 0xFEDCBA98u };
+	for (const size_t size : { size_t(256u * 1024u), size_t(16u * 1024u * 1024u), size_t(512u * 1024u * 1024u) }) {
+		auto src_mem = host_memory::allocate(size, queue);
+		auto dst_mem = host_memory::allocate(size, queue);
+		if (!src_mem || !dst_mem) {
+			log_error("failed to allocate %u bytes", size);
+			return;
+		}
+		auto src = src_mem.get();
+		auto dst = dst_mem.get();
+		memset(src, 1, size);
+		memset(dst, 1, size);
+		const auto iterations = uint32_t(max(size_t(4u), size_t(4u * 1024u * 1024u * 1024u) / size / 4u));
+		const auto pattern_fill_size = size - (size % sizeof(pattern));
+		
+		const auto memset_time = floor_test::time_us(iterations, [&] { memset(dst, 0, size); });
+		const auto zero_time = floor_test::time_us(iterations, [&] { host_memory::zero(&queue, dst, size); });
+		const auto memcpy_time = floor_test::time_us(iterations, [&] { memcpy(dst, src, size); });
+		const auto copy_time = floor_test::time_us(iterations, [&] { host_memory::copy(&queue, dst, src, size); });
+		const auto fill_time = floor_test::time_us(iterations, [&] {
+			host_memory::fill(&queue, dst, pattern, sizeof(pattern), pattern_fill_size);
+		});
+		
+		log_msg("%u KiB: memset: %f GB/s, zero: %f GB/s, memcpy: %f GB/s, copy: %f GB/s, 12-byte pattern fill: %f GB/s",
+				size / 1024u,
+				floor_test::gb_per_s(size, memset_time),
+				floor_test::gb_per_s(size, zero_time),
+				floor_test::gb_per_s(size, memcpy_time),
+				floor_test::gb_per_s(size, copy_time),
+				floor_test::gb_per_s(pattern_fill_size, fill_time));
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_allocate();
+	test_allocation_policy();
+	test_use_host_memory();
+	test_map_file();
+	test_bulk_ops();
+	test_large_pattern_fill();
+	test_buffer_fill();
+	
+	if (floor_test::run_benchmarks) {
+		bench_bulk_ops();
+	}
+	
+	return floor_test::finish();
+}
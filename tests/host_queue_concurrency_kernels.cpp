@@ -0,0 +1,41 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! increments the shared "counter", then waits (with a timeout) until "participants" executions have incremented it,
+//! "result" is set to 1 if all participants arrived, or to 0 on timeout
+//! NOTE: this can only succeed if all participating kernel executions run at the same time
+kernel void rendezvous(buffer<uint32_t> counter, buffer<uint32_t> result, param<uint32_t> participants) {
+	__atomic_fetch_add(&counter[0], 1u, __ATOMIC_ACQ_REL);
+	uint32_t arrived = 0u;
+	for(uint64_t i = 0; i < 2'000'000'000ull; ++i) {
+		arrived = __atomic_load_n(&counter[0], __ATOMIC_ACQUIRE);
+		if(arrived >= participants) {
+			break;
+		}
+	}
+	result[0] = (arrived >= participants ? 1u : 0u);
+}
+
+//! writes the global id of each work-item to its output element
+kernel void write_id(buffer<uint32_t> out) {
+	out[global_id.x] = global_id.x;
+}
@@ -0,0 +1,120 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+#include <algorithm>
+
+//! create_queue(dev) must always return the shared default queue, which must be usable for kernel executions
+static void test_default_queue() {
+	const auto& ctx = *floor_test::ctx;
+	const auto& dev = *floor_test::dev;
+	auto queue_0 = ctx.create_queue(dev);
+	auto queue_1 = ctx.create_queue(dev);
+	test_check(queue_0 != nullptr);
+	test_check(queue_0 == queue_1);
+	test_check(queue_0.get() == ctx.get_device_default_queue(dev));
+	
+	auto kernel = floor_test::get_kernel("write_id");
+	if (!kernel || !queue_0) {
+		return;
+	}
+	static constexpr const uint32_t elem_count { 4096u };
+	auto buf = ctx.create_buffer(*queue_0, sizeof(uint32_t) * elem_count);
+	queue_0->execute(*kernel, uint1 { elem_count }, uint1 { 64u }, buf);
+	vector<uint32_t> data(elem_count);
+	buf->read(*queue_0, data.data());
+	bool valid = true;
+	for (uint32_t i = 0; i < elem_count; ++i) {
+		valid &= (data[i] == i);
+	}
+	test_check(valid);
+}
+
+//! invalid CPU ranges and NUMA node indices must be rejected
+static void test_invalid_queues() {
+	const auto& ctx = *floor_test::ctx;
+	const auto& dev = *floor_test::dev;
+	test_check(ctx.create_queue(dev, 0u, 0u) == nullptr);
+	test_check(ctx.create_queue(dev, dev.units, 1u) == nullptr);
+	test_check(ctx.create_queue(dev, 0u, dev.units + 1u) == nullptr);
+	test_check(ctx.create_numa_node_queue(dev, ctx.get_numa_node_count()) == nullptr);
+	for (uint32_t node_idx = 0; node_idx < ctx.get_numa_node_count(); ++node_idx) {
+		test_check(ctx.create_numa_node_queue(dev, node_idx) != nullptr);
+	}
+}
+
+//! kernels on queues with disjoint CPU ranges must be executed in parallel:
+//! each queue executes a kernel that only finishes successfully once all other queues are executing it as well
+static void test_concurrent_execution() {
+	const auto& ctx = *floor_test::ctx;
+	const auto& dev = *floor_test::dev;
+	const auto queue_count = std::min(dev.units, 4u);
+	if (queue_count < 2u) {
+		log_warn("need at least 2 CPUs to test concurrent queue execution");
+		return;
+	}
+	auto kernel = floor_test::get_kernel("rendezvous");
+	if (!kernel) {
+		return;
+	}
+	
+	const auto cpus_per_queue = dev.units / queue_count;
+	vector<shared_ptr<compute_queue>> queues;
+	vector<shared_ptr<compute_buffer>> results;
+	for (uint32_t i = 0; i < queue_count; ++i) {
+		auto queue = ctx.create_queue(dev, i * cpus_per_queue, cpus_per_queue);
+		test_check(queue != nullptr);
+		if (!queue) {
+			return;
+		}
+		test_check(queue != ctx.create_queue(dev));
+		results.emplace_back(ctx.create_buffer(*queue, sizeof(uint32_t)));
+		results.back()->zero(*queue);
+		queues.emplace_back(move(queue));
+	}
+	auto counter = ctx.create_buffer(*queues[0], sizeof(uint32_t));
+	counter->zero(*queues[0]);
+	queues[0]->finish();
+	
+	const uint32_t participants { queue_count };
+	for (uint32_t i = 0; i < queue_count; ++i) {
+		queues[i]->execute(*kernel, uint1 { 1u }, uint1 { 1u }, counter, results[i], participants);
+	}
+	for (uint32_t i = 0; i < queue_count; ++i) {
+		uint32_t result { 0u };
+		results[i]->read(*queues[i], &result, sizeof(result));
+		test_check(result == 1u);
+	}
+	uint32_t arrived { 0u };
+	counter->read(*queues[0], &arrived, sizeof(arrived));
+	test_check(arrived == queue_count);
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_default_queue();
+	test_invalid_queues();
+	test_concurrent_execution();
+	
+	return floor_test::finish();
+}
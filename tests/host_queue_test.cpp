@@ -0,0 +1,176 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+#include <algorithm>
+
+static const host_queue& get_host_queue() {
+	return (const host_queue&)*floor_test::queue;
+}
+
+//! enqueue must return before the command has been executed, the event must signal its completion
+static void test_async_completion() {
+	const auto& queue = get_host_queue();
+	mutex gate_lock;
+	condition_variable gate_cv;
+	bool gate_open = false;
+	
+	auto gate_evt = queue.enqueue([&gate_lock, &gate_cv, &gate_open] {
+		unique_lock<mutex> lock(gate_lock);
+		gate_cv.wait(lock, [&gate_open] { return gate_open; });
+	});
+	atomic<bool> executed { false };
+	auto evt = queue.enqueue([&executed] {
+		executed = true;
+	});
+	auto marker = queue.enqueue_marker();
+	
+	// nothing can have completed yet, because the gate command is still blocked
+	test_check(!gate_evt->is_complete());
+	test_check(!evt->is_complete());
+	test_check(!marker->is_complete());
+	test_check(!executed.load());
+	
+	{
+		lock_guard<mutex> lock(gate_lock);
+		gate_open = true;
+	}
+	gate_cv.notify_all();
+	
+	marker->wait();
+	test_check(gate_evt->is_complete());
+	test_check(evt->is_complete());
+	test_check(executed.load());
+}
+
+//! commands must be executed in order of submission, finish must wait for all of them
+static void test_in_order_execution() {
+	const auto& queue = get_host_queue();
+	static constexpr const uint32_t command_count { 10000u };
+	vector<uint32_t> order;
+	order.reserve(command_count);
+	for (uint32_t i = 0; i < command_count; ++i) {
+		queue.submit([&order, i] {
+			order.emplace_back(i);
+		});
+	}
+	queue.finish();
+	test_check(order.size() == command_count);
+	bool in_order = true;
+	for (uint32_t i = 0; i < order.size(); ++i) {
+		in_order &= (order[i] == i);
+	}
+	test_check(in_order);
+}
+
+//! enqueueing from within a command must execute the nested command immediately (and must not dead-lock)
+static void test_nested_enqueue() {
+	const auto& queue = get_host_queue();
+	vector<uint32_t> order;
+	queue.submit([&queue, &order] {
+		test_check(queue.is_scheduler_thread());
+		order.emplace_back(0u);
+		auto nested_evt = queue.enqueue([&order] {
+			order.emplace_back(1u);
+		});
+		test_check(nested_evt->is_complete());
+		order.emplace_back(2u);
+	});
+	queue.finish();
+	test_check(order == (vector<uint32_t> { 0u, 1u, 2u }));
+}
+
+//! asynchronous buffer operations must be executed in order, blocking reads must see all prior operations
+static void test_async_buffer_ops() {
+	auto& queue = *floor_test::queue;
+	static constexpr const uint32_t elem_count { 1024u * 1024u };
+	auto src_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+	auto dst_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+	
+	const uint32_t pattern { 0x12345678u };
+	test_check(src_buffer->fill(queue, &pattern, sizeof(pattern)));
+	dst_buffer->copy(queue, *src_buffer);
+	test_check(src_buffer->zero(queue));
+	
+	vector<uint32_t> data(elem_count);
+	dst_buffer->read(queue, data.data());
+	test_check(all_of(data.begin(), data.end(), [&pattern](const uint32_t& val) { return val == pattern; }));
+	src_buffer->read(queue, data.data());
+	test_check(all_of(data.begin(), data.end(), [](const uint32_t& val) { return val == 0u; }));
+	
+	// buffers with pending operations may be destroyed before the queue has drained
+	for (uint32_t i = 0; i < 16u; ++i) {
+		auto tmp_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * elem_count);
+		tmp_buffer->fill(queue, &pattern, sizeof(pattern));
+		tmp_buffer->copy(queue, *dst_buffer);
+	}
+	queue.finish();
+}
+
+//! overlap of host-side work with queued commands: time of a command sequence when waiting for each command
+//! vs when only waiting at the end
+static void bench_async_overlap() {
+	const auto& queue = get_host_queue();
+	static constexpr const uint32_t batch_count { 64u };
+	const auto work = [] {
+		this_thread::sleep_for(chrono::microseconds(200));
+	};
+	
+	const auto sync_time = floor_test::time_us(4u, [&queue, &work] {
+		for (uint32_t i = 0; i < batch_count; ++i) {
+			work(); // host-side preparation
+			queue.enqueue([&work] { work(); })->wait();
+		}
+	});
+	const auto async_time = floor_test::time_us(4u, [&queue, &work] {
+		for (uint32_t i = 0; i < batch_count; ++i) {
+			work(); // host-side preparation, overlapping with the previous command
+			queue.submit([&work] { work(); });
+		}
+		queue.finish();
+	});
+	log_msg("%u batches: wait per command: %fus, overlapped: %fus", batch_count, sync_time, async_time);
+	
+	static constexpr const uint32_t command_count { 10000u };
+	const auto submit_time = floor_test::time_us(10u, [&queue] {
+		for (uint32_t i = 0; i < command_count; ++i) {
+			queue.submit([] {});
+		}
+		queue.finish();
+	});
+	log_msg("empty command submission: %fus per command", submit_time / double(command_count));
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_async_completion();
+	test_in_order_execution();
+	test_nested_enqueue();
+	test_async_buffer_ops();
+	
+	if (floor_test::run_benchmarks) {
+		bench_async_overlap();
+	}
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,47 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// NOTE: kernels are kept in their own TU, because the device headers redefine common keywords (global, local, ...)
+#include <floor/compute/device/common.hpp>
+
+//! number of results per work-item that are written by "sub_group_ops"
+static constexpr const uint32_t sub_group_result_count { 8u };
+
+//! executes all sub-group operations back-to-back (no barriers in between, i.e. consecutive exchanges alternate between
+//! the exchange buffers) and writes their results to out[global_id * 8 + #op], the compile-time SIMD width is written to
+//! "simd_width", the last operation shuffles the result of the first one back to the original lane
+kernel void sub_group_ops(buffer<const uint32_t> in, buffer<uint32_t> out, buffer<uint32_t> simd_width) {
+	if(global_id.x == 0) {
+		simd_width[0] = FLOOR_COMPUTE_INFO_SIMD_WIDTH;
+	}
+	
+	const auto value = in[global_id.x];
+	const auto lane = get_sub_group_local_id();
+	const auto size = get_sub_group_size();
+	const auto out_idx = global_id.x * sub_group_result_count;
+	const auto next_lane_value = simd_shuffle(value, (lane + 1u) % size);
+	out[out_idx + 0u] = next_lane_value;
+	out[out_idx + 1u] = simd_shuffle_down(value, 1u);
+	out[out_idx + 2u] = simd_shuffle_up(value, 1u);
+	out[out_idx + 3u] = simd_shuffle_xor(value, 1u);
+	out[out_idx + 4u] = compute_algorithm::sub_group_reduce_add(value);
+	out[out_idx + 5u] = compute_algorithm::sub_group_inclusive_scan_add(value);
+	out[out_idx + 6u] = compute_algorithm::sub_group_exclusive_scan_add(value);
+	out[out_idx + 7u] = simd_shuffle(next_lane_value, (lane + size - 1u) % size);
+}
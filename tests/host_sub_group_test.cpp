@@ -0,0 +1,115 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+
+//! number of results per work-item that are written by "sub_group_ops"
+static constexpr const uint32_t sub_group_result_count { 8u };
+
+//! computes the expected "sub_group_ops" results of all work-items in a work-group of "local_size" work-items,
+//! with sub-groups of "simd_width" work-items (the last sub-group may be partial)
+static vector<uint32_t> sub_group_ops_reference(const uint32_t* values, const uint32_t local_size, const uint32_t simd_width) {
+	vector<uint32_t> ret(local_size * sub_group_result_count);
+	for (uint32_t local_idx = 0; local_idx < local_size; ++local_idx) {
+		const auto sub_group_start = local_idx - (local_idx % simd_width);
+		const auto size = std::min(simd_width, local_size - sub_group_start);
+		const auto lane = local_idx - sub_group_start;
+		const auto lanes = &values[sub_group_start];
+		const auto value = lanes[lane];
+		
+		uint32_t reduction = 0u, inclusive_scan = 0u, exclusive_scan = 0u;
+		for (uint32_t i = 0; i < size; ++i) {
+			reduction += lanes[i];
+			inclusive_scan += (i <= lane ? lanes[i] : 0u);
+			exclusive_scan += (i < lane ? lanes[i] : 0u);
+		}
+		
+		auto res = &ret[local_idx * sub_group_result_count];
+		res[0] = lanes[(lane + 1u) % size];
+		res[1] = (lane + 1u < size ? lanes[lane + 1u] : value);
+		res[2] = (lane >= 1u ? lanes[lane - 1u] : value);
+		res[3] = ((lane ^ 1u) < size ? lanes[lane ^ 1u] : value);
+		res[4] = reduction;
+		res[5] = inclusive_scan;
+		res[6] = exclusive_scan;
+		res[7] = value;
+	}
+	return ret;
+}
+
+//! shuffle/reduce/scan results must match the reference for full and partial sub-groups
+//! (local sizes that are not a multiple of the SIMD width, or smaller than it)
+static void test_sub_group_ops() {
+	auto& queue = *floor_test::queue;
+	auto kernel = floor_test::get_kernel("sub_group_ops");
+	if (!kernel) {
+		return;
+	}
+	
+	static constexpr const uint32_t group_count { 16u };
+	for (const auto local_size : { 64u, 61u, 37u, 5u, 3u, 1u }) {
+		const auto global_size = group_count * local_size;
+		vector<uint32_t> input(global_size);
+		for (uint32_t i = 0; i < global_size; ++i) {
+			input[i] = (i * 37u + 11u) % 1000u;
+		}
+		auto in_buffer = floor_test::ctx->create_buffer(queue, input);
+		auto out_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * global_size * sub_group_result_count);
+		auto simd_width_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t));
+		
+		queue.execute(*kernel, uint1 { global_size }, uint1 { local_size }, in_buffer, out_buffer, simd_width_buffer);
+		queue.finish();
+		
+		uint32_t simd_width = 0u;
+		simd_width_buffer->read(queue, &simd_width);
+		test_check(simd_width > 0u);
+		if (simd_width == 0u) {
+			return;
+		}
+		
+		vector<uint32_t> out(global_size * sub_group_result_count);
+		out_buffer->read(queue, out.data());
+		bool match = true;
+		for (uint32_t group = 0; group < group_count && match; ++group) {
+			const auto expected = sub_group_ops_reference(&input[group * local_size], local_size, simd_width);
+			const auto group_out = &out[group * local_size * sub_group_result_count];
+			for (uint32_t i = 0; i < uint32_t(expected.size()); ++i) {
+				if (group_out[i] != expected[i]) {
+					log_error("sub-group op #%u mismatch for work-item %u in group %u (local size %u, SIMD width %u): got %u, expected %u",
+							  i % sub_group_result_count, i / sub_group_result_count, group, local_size, simd_width,
+							  group_out[i], expected[i]);
+					match = false;
+					break;
+				}
+			}
+		}
+		test_check(match);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_sub_group_ops();
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,156 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/host/host_worker_pool.hpp>
+#include <floor/core/core.hpp>
+#include <floor/compute/compute_buffer.hpp>
+
+//! every worker in the executed range must run the job exactly once, workers outside of it must not run it
+static void test_execute_range(host_worker_pool& pool, const uint32_t cpu_offset, const uint32_t cpu_count) {
+	const auto worker_count = pool.get_worker_count();
+	unique_ptr<atomic<uint32_t>[]> counts = make_unique<atomic<uint32_t>[]>(worker_count);
+	for (uint32_t i = 0; i < worker_count; ++i) {
+		counts[i] = 0u;
+	}
+	static constexpr const uint32_t iterations { 100u };
+	const host_worker_pool::job_type job = [&counts](const uint32_t cpu_idx) {
+		++counts[cpu_idx];
+	};
+	for (uint32_t i = 0; i < iterations; ++i) {
+		pool.execute(cpu_offset, cpu_count, job);
+	}
+	for (uint32_t i = 0; i < worker_count; ++i) {
+		const auto expected = (i >= cpu_offset && i < cpu_offset + cpu_count ? iterations : 0u);
+		test_check(counts[i].load() == expected);
+	}
+}
+
+//! executes jobs on disjoint CPU ranges from two threads at once
+static void test_concurrent_ranges(host_worker_pool& pool) {
+	const auto worker_count = pool.get_worker_count();
+	if (worker_count < 2) {
+		return;
+	}
+	const auto half = worker_count / 2u;
+	static constexpr const uint32_t iterations { 1000u };
+	atomic<uint32_t> lower_count { 0u }, upper_count { 0u };
+	const host_worker_pool::job_type lower_job = [&lower_count](const uint32_t) { ++lower_count; };
+	const host_worker_pool::job_type upper_job = [&upper_count](const uint32_t) { ++upper_count; };
+	thread lower_thread([&pool, &lower_job, half] {
+		for (uint32_t i = 0; i < iterations; ++i) {
+			pool.execute(0, half, lower_job);
+		}
+	});
+	thread upper_thread([&pool, &upper_job, half, worker_count] {
+		for (uint32_t i = 0; i < iterations; ++i) {
+			pool.execute(half, worker_count - half, upper_job);
+		}
+	});
+	lower_thread.join();
+	upper_thread.join();
+	test_check(lower_count.load() == iterations * half);
+	test_check(upper_count.load() == iterations * (worker_count - half));
+}
+
+//! many small kernel dispatches must all execute every work-item
+static void test_kernel_dispatch() {
+	auto kernel = floor_test::get_kernel("write_global_id");
+	if (!kernel) {
+		return;
+	}
+	static constexpr const uint32_t item_count { 4096u };
+	auto out_buffer = floor_test::ctx->create_buffer(*floor_test::queue, sizeof(uint32_t) * item_count);
+	vector<uint32_t> out(item_count);
+	for (uint32_t i = 0; i < 100u; ++i) {
+		out_buffer->zero(*floor_test::queue);
+		floor_test::queue->execute(*kernel, uint1 { item_count }, uint1 { 64u }, out_buffer);
+		out_buffer->read(*floor_test::queue, out.data());
+		bool all_valid = true;
+		for (uint32_t j = 0; j < item_count; ++j) {
+			all_valid &= (out[j] == j);
+		}
+		test_check(all_valid);
+	}
+}
+
+//! dispatch overhead of an empty job/kernel:
+//! * per-dispatch thread creation + pinning + join (how kernels were dispatched before the worker pool existed)
+//! * worker pool dispatch
+//! * empty kernel execution on the queue (including queue submission and finish)
+static void bench_dispatch(host_worker_pool& pool) {
+	const auto worker_count = pool.get_worker_count();
+	static constexpr const uint32_t iterations { 2000u };
+	
+	const auto thread_time = floor_test::time_us(iterations / 10u, [worker_count] {
+		vector<thread> threads;
+		threads.reserve(worker_count);
+		for (uint32_t cpu_idx = 0; cpu_idx < worker_count; ++cpu_idx) {
+			threads.emplace_back([cpu_idx] {
+				host_worker_pool::set_thread_affinity(cpu_idx + 1u);
+			});
+		}
+		for (auto& th : threads) {
+			th.join();
+		}
+	});
+	
+	const host_worker_pool::job_type empty_job = [](const uint32_t) {};
+	const auto pool_time = floor_test::time_us(iterations, [&pool, &empty_job, worker_count] {
+		pool.execute(0, worker_count, empty_job);
+	});
+	
+	log_msg("empty dispatch on %u CPUs: thread create/join: %fus, worker pool: %fus (%fx faster)",
+			worker_count, thread_time, pool_time, thread_time / pool_time);
+	
+	auto kernel = floor_test::get_kernel("empty_kernel");
+	if (!kernel) {
+		return;
+	}
+	for (const auto group_count : { 1u, worker_count, worker_count * 16u }) {
+		const auto kernel_time = floor_test::time_us(iterations, [&kernel, group_count] {
+			floor_test::queue->execute(*kernel, uint1 { group_count }, uint1 { 1u });
+			floor_test::queue->finish();
+		});
+		log_msg("empty kernel (%u groups): %fus per dispatch", group_count, kernel_time);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	{
+		host_worker_pool pool(core::get_hw_thread_count());
+		const auto worker_count = pool.get_worker_count();
+		test_execute_range(pool, 0, worker_count);
+		if (worker_count > 2) {
+			test_execute_range(pool, 1, worker_count - 2);
+		}
+		test_concurrent_ranges(pool);
+		test_kernel_dispatch();
+		
+		if (floor_test::run_benchmarks) {
+			bench_dispatch(pool);
+		}
+	}
+	
+	return floor_test::finish();
+}
@@ -0,0 +1,319 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/image_conversion.hpp>
+#include <cmath>
+
+//! returns the logical channel (0 = R, 1 = G, 2 = B, 3 = A) of each memory position of the specified format
+static array<uint32_t, 4> get_channel_map(const COMPUTE_IMAGE_TYPE type) {
+	switch (type & COMPUTE_IMAGE_TYPE::__LAYOUT_MASK) {
+		case COMPUTE_IMAGE_TYPE::LAYOUT_BGRA: return {{ 2u, 1u, 0u, 3u }};
+		case COMPUTE_IMAGE_TYPE::LAYOUT_ABGR: return {{ 3u, 2u, 1u, 0u }};
+		case COMPUTE_IMAGE_TYPE::LAYOUT_ARGB: return {{ 3u, 0u, 1u, 2u }};
+		default: return {{ 0u, 1u, 2u, 3u }};
+	}
+}
+
+//! returns deterministic, non-trivial bytes
+static vector<uint8_t> make_bytes(const size_t size) {
+	vector<uint8_t> data(size);
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = uint8_t((i * 151u + 7u) ^ (i >> 5u));
+	}
+	return data;
+}
+
+//! 8-bit channel count/layout conversions between all formats must move each logical channel to its new position,
+//! set missing color channels to 0 and a missing alpha channel to 0xFF, and converting back to a format with at least
+//! the same channels must restore the original data
+static void test_channel_conversion() {
+	static constexpr const COMPUTE_IMAGE_TYPE argb_type {
+		(COMPUTE_IMAGE_TYPE::RGBA8UI_NORM & ~COMPUTE_IMAGE_TYPE::__LAYOUT_MASK) | COMPUTE_IMAGE_TYPE::LAYOUT_ARGB
+	};
+	const COMPUTE_IMAGE_TYPE types[] {
+		COMPUTE_IMAGE_TYPE::R8UI_NORM,
+		COMPUTE_IMAGE_TYPE::RG8UI_NORM,
+		COMPUTE_IMAGE_TYPE::RGB8UI_NORM,
+		COMPUTE_IMAGE_TYPE::BGR8UI_NORM,
+		COMPUTE_IMAGE_TYPE::RGBA8UI_NORM,
+		COMPUTE_IMAGE_TYPE::BGRA8UI_NORM,
+		COMPUTE_IMAGE_TYPE::ABGR8UI_NORM,
+		argb_type,
+	};
+	// NOTE: includes counts that are not a multiple of the 4 pixel vector blocks
+	for (const size_t pixel_count : { 1u, 3u, 4u, 5u, 8u, 67u, 1027u }) {
+		for (const auto src_type : types) {
+			const auto src_channel_count = image_channel_count(src_type);
+			const auto src_map = get_channel_map(src_type);
+			const auto src = make_bytes(pixel_count * src_channel_count);
+			for (const auto dst_type : types) {
+				const auto dst_channel_count = image_channel_count(dst_type);
+				const auto dst_map = get_channel_map(dst_type);
+				test_check(image_conversion::is_supported(src_type, dst_type));
+				vector<uint8_t> dst(pixel_count * dst_channel_count, 0xCDu);
+				test_check(image_conversion::convert(src_type, dst_type, src.data(), dst.data(), pixel_count));
+				
+				// each dst channel is either the same logical src channel or 0 (color) / 0xFF (alpha)
+				bool has_all_src_channels = true;
+				size_t mismatch_count = 0u;
+				for (uint32_t dst_pos = 0; dst_pos < dst_channel_count; ++dst_pos) {
+					const auto channel = dst_map[dst_pos];
+					int32_t src_pos = -1;
+					for (uint32_t i = 0; i < src_channel_count; ++i) {
+						if (src_map[i] == channel) {
+							src_pos = int32_t(i);
+						}
+					}
+					for (size_t i = 0; i < pixel_count; ++i) {
+						const auto expected = (src_pos >= 0 ? src[i * src_channel_count + uint32_t(src_pos)] :
+											   (channel == 3u ? 0xFFu : 0u));
+						mismatch_count += (dst[i * dst_channel_count + dst_pos] != expected ? 1u : 0u);
+					}
+				}
+				for (uint32_t src_pos = 0; src_pos < src_channel_count; ++src_pos) {
+					has_all_src_channels &= (find(dst_map.begin(), dst_map.begin() + dst_channel_count, src_map[src_pos]) !=
+											 dst_map.begin() + dst_channel_count);
+				}
+				if (mismatch_count > 0u) {
+					log_error("%X -> %X (%u pixels): %u mismatching channels",
+							  uint64_t(src_type), uint64_t(dst_type), pixel_count, mismatch_count);
+				}
+				test_check(mismatch_count == 0u);
+				
+				// round-trip
+				if (has_all_src_channels) {
+					vector<uint8_t> src_again(src.size(), 0xCDu);
+					test_check(image_conversion::convert(dst_type, src_type, dst.data(), src_again.data(), pixel_count));
+					test_check(src_again == src);
+				}
+			}
+		}
+	}
+}
+
+//! channel expansion of non-8-bit formats must set the alpha channel to 1 in the respective format
+static void test_alpha_expansion() {
+	static constexpr const size_t pixel_count { 13u };
+	
+	vector<float> rgb_f32(pixel_count * 3u);
+	for (size_t i = 0; i < rgb_f32.size(); ++i) {
+		rgb_f32[i] = float(i) * 0.25f - 2.0f;
+	}
+	vector<float> rgba_f32(pixel_count * 4u);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGB32F, COMPUTE_IMAGE_TYPE::RGBA32F,
+										 rgb_f32.data(), rgba_f32.data(), pixel_count));
+	vector<float> rgb_f32_again(pixel_count * 3u);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGBA32F, COMPUTE_IMAGE_TYPE::RGB32F,
+										 rgba_f32.data(), rgb_f32_again.data(), pixel_count));
+	test_check(rgb_f32_again == rgb_f32);
+	for (size_t i = 0; i < pixel_count; ++i) {
+		test_check(rgba_f32[i * 4u + 3u] == 1.0f);
+	}
+	
+	// 1.0 as half
+	vector<uint16_t> rgb_f16(pixel_count * 3u, 0x4000u /* 2.0 */);
+	vector<uint16_t> rgba_f16(pixel_count * 4u);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGB16F, COMPUTE_IMAGE_TYPE::RGBA16F,
+										 rgb_f16.data(), rgba_f16.data(), pixel_count));
+	for (size_t i = 0; i < pixel_count; ++i) {
+		test_check(rgba_f16[i * 4u] == 0x4000u && rgba_f16[i * 4u + 3u] == 0x3C00u);
+	}
+	
+	// non-normalized integers: 1
+	vector<uint8_t> rgb_u8(pixel_count * 3u, 42u);
+	vector<uint8_t> rgba_u8(pixel_count * 4u);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGB8UI, COMPUTE_IMAGE_TYPE::RGBA8UI,
+										 rgb_u8.data(), rgba_u8.data(), pixel_count));
+	for (size_t i = 0; i < pixel_count; ++i) {
+		test_check(rgba_u8[i * 4u] == 42u && rgba_u8[i * 4u + 3u] == 1u);
+	}
+}
+
+//! all normalized integer values must convert to the exact float value (signed: clamped to -1) and back
+template <typename int_type>
+static void test_normalized_round_trip(const COMPUTE_IMAGE_TYPE norm_type) {
+	static constexpr const size_t value_count { size_t(1u) << (sizeof(int_type) * 8u) };
+	static constexpr const size_t pixel_count { value_count / 4u };
+	vector<int_type> values(value_count);
+	for (size_t i = 0; i < value_count; ++i) {
+		values[i] = int_type(i);
+	}
+	vector<float> float_values(value_count);
+	test_check(image_conversion::convert(norm_type, COMPUTE_IMAGE_TYPE::RGBA32F, values.data(), float_values.data(), pixel_count));
+	vector<int_type> values_again(value_count);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGBA32F, norm_type, float_values.data(), values_again.data(), pixel_count));
+	
+	size_t float_mismatch_count = 0u, int_mismatch_count = 0u;
+	static constexpr const auto int_max = double(numeric_limits<int_type>::max());
+	for (size_t i = 0; i < value_count; ++i) {
+		const auto expected_float = std::max(double(values[i]) / int_max, -1.0);
+		float_mismatch_count += (std::abs(double(float_values[i]) - expected_float) > 1.0e-6 ? 1u : 0u);
+		// NOTE: for signed types, both the min value and min value + 1 map to -1
+		const auto expected_int = (is_signed_v<int_type> && values[i] == numeric_limits<int_type>::min() ?
+								   int_type(numeric_limits<int_type>::min() + 1) : values[i]);
+		int_mismatch_count += (values_again[i] != expected_int ? 1u : 0u);
+	}
+	if (float_mismatch_count > 0u || int_mismatch_count > 0u) {
+		log_error("%X: %u mismatching float values, %u mismatching round-trip values",
+				  uint64_t(norm_type), float_mismatch_count, int_mismatch_count);
+	}
+	test_check(float_mismatch_count == 0u);
+	test_check(int_mismatch_count == 0u);
+}
+
+//! float -> normalized integer conversion must clamp and round to nearest, with NaN being mapped to 0
+static void test_normalized_clamping() {
+	const float src[] {
+		-1.0f, -0.001f, 0.5f, 1.0f, 2.0f, numeric_limits<float>::quiet_NaN(), numeric_limits<float>::infinity(), 0.25f,
+	};
+	const size_t pixel_count { size(src) / 4u };
+	uint8_t unorm8[size(src)];
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGBA32F, COMPUTE_IMAGE_TYPE::RGBA8UI_NORM, src, unorm8, pixel_count));
+	const uint8_t expected_unorm8[] { 0u, 0u, 128u, 255u, 255u, 0u, 255u, 64u };
+	test_check(memcmp(unorm8, expected_unorm8, sizeof(unorm8)) == 0);
+	
+	int8_t snorm8[size(src)];
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGBA32F, COMPUTE_IMAGE_TYPE::RGBA8I_NORM, src, snorm8, pixel_count));
+	const int8_t expected_snorm8[] { -127, 0, 64, 127, 127, 0, 127, 32 };
+	test_check(memcmp(snorm8, expected_snorm8, sizeof(snorm8)) == 0);
+}
+
+//! all normal and zero half values must convert to the exact float value and back
+static void test_half_round_trip() {
+	vector<uint16_t> values;
+	for (uint32_t sign = 0; sign < 2u; ++sign) {
+		values.emplace_back(uint16_t(sign << 15u));
+		for (uint32_t exponent = 1; exponent < 31u; ++exponent) {
+			for (uint32_t mantissa = 0; mantissa < 1024u; ++mantissa) {
+				values.emplace_back(uint16_t((sign << 15u) | (exponent << 10u) | mantissa));
+			}
+		}
+	}
+	values.resize((values.size() / 4u) * 4u);
+	const auto pixel_count = values.size() / 4u;
+	vector<float> float_values(values.size());
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGBA16F, COMPUTE_IMAGE_TYPE::RGBA32F,
+										 values.data(), float_values.data(), pixel_count));
+	vector<uint16_t> values_again(values.size());
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGBA32F, COMPUTE_IMAGE_TYPE::RGBA16F,
+										 float_values.data(), values_again.data(), pixel_count));
+	size_t float_mismatch_count = 0u;
+	for (size_t i = 0; i < values.size(); ++i) {
+		const auto exponent = int((values[i] >> 10u) & 0x1Fu);
+		const auto mantissa = float(values[i] & 0x3FFu);
+		const auto magnitude = (exponent == 0 ? 0.0f : ldexp(1.0f + mantissa / 1024.0f, exponent - 15));
+		const auto expected_float = ((values[i] & 0x8000u) != 0u ? -magnitude : magnitude);
+		float_mismatch_count += (float_values[i] != expected_float ? 1u : 0u);
+	}
+	test_check(float_mismatch_count == 0u);
+	test_check(values_again == values);
+}
+
+//! sRGB data can only be converted to other sRGB formats (as-is), sRGB <-> linear conversions are unsupported
+static void test_srgb() {
+	const auto rgb_srgb = (COMPUTE_IMAGE_TYPE::RGB8UI_NORM | COMPUTE_IMAGE_TYPE::FLAG_SRGB);
+	const auto rgba_srgb = (COMPUTE_IMAGE_TYPE::RGBA8UI_NORM | COMPUTE_IMAGE_TYPE::FLAG_SRGB);
+	const auto bgra_srgb = (COMPUTE_IMAGE_TYPE::BGRA8UI_NORM | COMPUTE_IMAGE_TYPE::FLAG_SRGB);
+	test_check(!image_conversion::is_supported(rgba_srgb, COMPUTE_IMAGE_TYPE::RGBA8UI_NORM));
+	test_check(!image_conversion::is_supported(COMPUTE_IMAGE_TYPE::RGBA8UI_NORM, rgba_srgb));
+	test_check(!image_conversion::is_supported(rgba_srgb, COMPUTE_IMAGE_TYPE::RGBA32F));
+	
+	static constexpr const size_t pixel_count { 37u };
+	const auto src = make_bytes(pixel_count * 3u);
+	vector<uint8_t> dst(pixel_count * 4u);
+	test_check(!image_conversion::convert(rgb_srgb, COMPUTE_IMAGE_TYPE::RGBA8UI_NORM, src.data(), dst.data(), pixel_count));
+	
+	// sRGB values are not modified
+	test_check(image_conversion::convert(rgb_srgb, bgra_srgb, src.data(), dst.data(), pixel_count));
+	for (size_t i = 0; i < pixel_count; ++i) {
+		test_check(dst[i * 4u] == src[i * 3u + 2u] && dst[i * 4u + 1u] == src[i * 3u + 1u] &&
+				   dst[i * 4u + 2u] == src[i * 3u] && dst[i * 4u + 3u] == 0xFFu);
+	}
+	vector<uint8_t> src_again(src.size());
+	test_check(image_conversion::convert(bgra_srgb, rgb_srgb, dst.data(), src_again.data(), pixel_count));
+	test_check(src_again == src);
+}
+
+//! in-place and multi-threaded conversions must produce the same result as single-threaded out-of-place conversions
+static void test_inplace_and_parallel() {
+	// in-place: more pixels than a single conversion chunk
+	static constexpr const size_t inplace_pixel_count { 10007u };
+	const auto rgb = make_bytes(inplace_pixel_count * 3u);
+	vector<uint8_t> rgba(inplace_pixel_count * 4u);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGB8UI_NORM, COMPUTE_IMAGE_TYPE::RGBA8UI_NORM,
+										 rgb.data(), rgba.data(), inplace_pixel_count, false));
+	vector<uint8_t> inplace_data(inplace_pixel_count * 4u);
+	memcpy(inplace_data.data(), rgb.data(), rgb.size());
+	test_check(image_conversion::convert_inplace(COMPUTE_IMAGE_TYPE::RGB8UI_NORM, COMPUTE_IMAGE_TYPE::RGBA8UI_NORM,
+												 inplace_data.data(), inplace_pixel_count));
+	test_check(inplace_data == rgba);
+	
+	vector<float> rgba_f32(inplace_pixel_count * 4u);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGB8UI_NORM, COMPUTE_IMAGE_TYPE::RGBA32F,
+										 rgb.data(), rgba_f32.data(), inplace_pixel_count, false));
+	vector<float> inplace_f32(inplace_pixel_count * 4u);
+	memcpy(inplace_f32.data(), rgb.data(), rgb.size());
+	test_check(image_conversion::convert_inplace(COMPUTE_IMAGE_TYPE::RGB8UI_NORM, COMPUTE_IMAGE_TYPE::RGBA32F,
+												 inplace_f32.data(), inplace_pixel_count));
+	test_check(inplace_f32 == rgba_f32);
+	
+	// can't shrink in-place
+	test_check(!image_conversion::convert_inplace(COMPUTE_IMAGE_TYPE::RGBA8UI_NORM, COMPUTE_IMAGE_TYPE::RGB8UI_NORM,
+												  inplace_data.data(), inplace_pixel_count));
+	
+	// parallel: > 8 MiB of dst data, not a multiple of the per-thread pixel granularity
+	static constexpr const size_t parallel_pixel_count { 3u * 1024u * 1024u + 5u };
+	const auto src = make_bytes(parallel_pixel_count * 3u);
+	vector<uint8_t> serial_dst(parallel_pixel_count * 4u), parallel_dst(parallel_pixel_count * 4u);
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGB8UI_NORM, COMPUTE_IMAGE_TYPE::BGRA8UI_NORM,
+										 src.data(), serial_dst.data(), parallel_pixel_count, false));
+	test_check(image_conversion::convert(COMPUTE_IMAGE_TYPE::RGB8UI_NORM, COMPUTE_IMAGE_TYPE::BGRA8UI_NORM,
+										 src.data(), parallel_dst.data(), parallel_pixel_count, true));
+	test_check(parallel_dst == serial_dst);
+}
+
+//! conversions that would change the meaning of the data or that need decoding must be rejected
+static void test_unsupported() {
+	test_check(!image_conversion::is_supported(COMPUTE_IMAGE_TYPE::RGBA8UI, COMPUTE_IMAGE_TYPE::RGBA32F));
+	test_check(!image_conversion::is_supported(COMPUTE_IMAGE_TYPE::RGBA8UI, COMPUTE_IMAGE_TYPE::RGBA8I));
+	test_check(!image_conversion::is_supported(COMPUTE_IMAGE_TYPE::RGBA8UI_NORM, COMPUTE_IMAGE_TYPE::RGBA16UI_NORM));
+	test_check(!image_conversion::is_supported(COMPUTE_IMAGE_TYPE::BC1_RGBA, COMPUTE_IMAGE_TYPE::RGBA8UI_NORM));
+	test_check(!image_conversion::is_supported(COMPUTE_IMAGE_TYPE::D32F, COMPUTE_IMAGE_TYPE::R32F));
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_channel_conversion();
+	test_alpha_expansion();
+	test_normalized_round_trip<uint8_t>(COMPUTE_IMAGE_TYPE::RGBA8UI_NORM);
+	test_normalized_round_trip<int8_t>(COMPUTE_IMAGE_TYPE::RGBA8I_NORM);
+	test_normalized_round_trip<uint16_t>(COMPUTE_IMAGE_TYPE::RGBA16UI_NORM);
+	test_normalized_round_trip<int16_t>(COMPUTE_IMAGE_TYPE::RGBA16I_NORM);
+	test_normalized_clamping();
+	test_half_round_trip();
+	test_srgb();
+	test_inplace_and_parallel();
+	test_unsupported();
+	
+	return floor_test::finish();
+}
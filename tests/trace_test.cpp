@@ -0,0 +1,214 @@
+/*
+ *  Flo's Open libRary (floor)
+ *  Copyright (C) 2004 - 2021 Florian Ziesche
+ *  
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "floor_test.hpp"
+#include <floor/compute/compute_buffer.hpp>
+#include <floor/core/trace.hpp>
+#include <floor/core/json.hpp>
+#include <thread>
+#include <unordered_map>
+
+//! returns the member "key" of the JSON object "obj" or nullptr if it doesn't exist
+static const json::json_value* get_member(const json::json_object& obj, const string& key) {
+	const auto member = obj.get(key);
+	return (member.first ? &member.second->second : nullptr);
+}
+
+//! returns the string member "key" of the JSON object "obj" or an empty string if it doesn't exist or isn't a string
+static string get_string_member(const json::json_object& obj, const string& key) {
+	const auto member = get_member(obj, key);
+	return (member != nullptr ? member->get<string>().second : "");
+}
+
+//! a recorded trace (kernel executions + user events from multiple threads) must be exported as valid
+//! Chrome Trace Event JSON: all events must be well-formed, durations must be properly nested per thread,
+//! timestamps must not decrease per thread, and names must be correctly escaped
+static void test_trace_json() {
+	auto& queue = *floor_test::queue;
+	auto kernel = floor_test::get_kernel("trace_fill");
+	if (!kernel) {
+		return;
+	}
+	
+	static constexpr const uint32_t global_size { 1024u }, execution_count { 4u };
+	static constexpr const int64_t counter_value { -42 };
+	// NOTE: contains characters that must be escaped in JSON (the JSON parser keeps escape sequences as-is)
+	static constexpr const char escaped_name[] { "quote\\\"back\\\\slash" };
+	const auto instant_name = floor_trace::intern("quote\"back\\slash");
+	const uint32_t fill_value { 7u };
+	auto data_buffer = floor_test::ctx->create_buffer(queue, sizeof(uint32_t) * global_size);
+	
+	floor_trace::clear();
+	floor_trace::enable();
+	test_check(floor_trace::is_enabled());
+	{
+		FLOOR_TRACE_SCOPE("test", "outer");
+		floor_trace::instant("test", instant_name);
+		floor_trace::counter("test", "counter", counter_value);
+		{
+			FLOOR_TRACE_SCOPE("test", "inner");
+			for (uint32_t i = 0; i < execution_count; ++i) {
+				queue.execute(*kernel, uint1 { global_size }, uint1 { 64u }, data_buffer, fill_value);
+			}
+			queue.finish();
+		}
+	}
+	thread other_thread([] {
+		FLOOR_TRACE_SCOPE("test", "other thread");
+		floor_trace::instant("test", "other instant");
+	});
+	other_thread.join();
+	floor_trace::disable();
+	test_check(!floor_trace::is_enabled());
+	// must not be recorded
+	floor_trace::instant("test", "after disable");
+	
+	const auto trace_json = floor_trace::to_json();
+	const auto doc = json::create_document_from_string(trace_json, "trace");
+	test_check(doc.valid);
+	if (!doc.valid) {
+		return;
+	}
+	const auto root = doc.root.get<json::json_object>();
+	test_check(root.first);
+	if (!root.first) {
+		return;
+	}
+	test_check(get_string_member(root.second, "displayTimeUnit") == "ns");
+	const auto trace_events_value = get_member(root.second, "traceEvents");
+	test_check(trace_events_value != nullptr);
+	if (trace_events_value == nullptr) {
+		return;
+	}
+	const auto trace_events = trace_events_value->get<json::json_array>();
+	test_check(trace_events.first);
+	
+	struct thread_state_t {
+		vector<string> open_durations;
+		double last_ts { 0.0 };
+	};
+	unordered_map<int64_t, thread_state_t> threads;
+	uint32_t kernel_begin_count = 0, kernel_end_count = 0, thread_name_count = 0;
+	bool found_instant = false, found_counter = false, found_other_instant = false;
+	for (const auto& evt_value : trace_events.second) {
+		const auto evt = evt_value.get<json::json_object>();
+		test_check(evt.first);
+		if (!evt.first) {
+			continue;
+		}
+		const auto name = get_string_member(evt.second, "name");
+		const auto ph = get_string_member(evt.second, "ph");
+		const auto pid = get_member(evt.second, "pid");
+		const auto tid = get_member(evt.second, "tid");
+		test_check(!name.empty() && !ph.empty() && pid != nullptr && tid != nullptr);
+		if (name.empty() || ph.empty() || pid == nullptr || tid == nullptr) {
+			continue;
+		}
+		const auto tid_value = tid->get<int64_t>();
+		test_check(tid_value.first);
+		
+		if (ph == "M") {
+			test_check(name == "thread_name");
+			++thread_name_count;
+			continue;
+		}
+		
+		const auto cat = get_string_member(evt.second, "cat");
+		const auto ts = get_member(evt.second, "ts");
+		test_check(!cat.empty() && ts != nullptr);
+		if (cat.empty() || ts == nullptr) {
+			continue;
+		}
+		const auto ts_value = ts->get<double>();
+		test_check(ts_value.first);
+		
+		auto& thread_state = threads[tid_value.second];
+		if (ts_value.second < thread_state.last_ts) {
+			log_error("trace: timestamp of event \"%s\" decreased on thread %u (%f < %f)",
+					  name, tid_value.second, ts_value.second, thread_state.last_ts);
+			test_check(ts_value.second >= thread_state.last_ts);
+		}
+		thread_state.last_ts = ts_value.second;
+		
+		if (ph == "B") {
+			thread_state.open_durations.emplace_back(name);
+			if (cat == "kernel" && name == "trace_fill") {
+				++kernel_begin_count;
+			}
+		} else if (ph == "E") {
+			const auto matches = (!thread_state.open_durations.empty() && thread_state.open_durations.back() == name);
+			if (!matches) {
+				log_error("trace: unmatched end event \"%s\" on thread %u", name, tid_value.second);
+			}
+			test_check(matches);
+			if (!thread_state.open_durations.empty()) {
+				thread_state.open_durations.pop_back();
+			}
+			if (cat == "kernel" && name == "trace_fill") {
+				++kernel_end_count;
+			}
+		} else if (ph == "i") {
+			test_check(name != "after disable");
+			found_instant |= (name == escaped_name);
+			found_other_instant |= (name == "other instant");
+		} else if (ph == "C") {
+			const auto args = get_member(evt.second, "args");
+			test_check(args != nullptr);
+			if (args != nullptr && name == "counter") {
+				const auto args_obj = args->get<json::json_object>();
+				const auto value = (args_obj.first ? get_member(args_obj.second, "value") : nullptr);
+				test_check(value != nullptr && value->get<int64_t>().second == counter_value);
+				found_counter = true;
+			}
+		} else {
+			log_error("trace: unknown event phase \"%s\"", ph);
+			test_check(false);
+		}
+	}
+	
+	// main thread, queue thread and the other thread must have recorded events
+	test_check(threads.size() >= 3u);
+	test_check(thread_name_count >= 3u);
+	for (const auto& thread_state : threads) {
+		test_check(thread_state.second.open_durations.empty());
+	}
+	test_check(kernel_begin_count == execution_count);
+	test_check(kernel_end_count == execution_count);
+	test_check(found_instant);
+	test_check(found_counter);
+	test_check(found_other_instant);
+	
+	// once cleared, no events may be exported anymore
+	floor_trace::clear();
+	const auto cleared_doc = json::create_document_from_string(floor_trace::to_json(), "cleared trace");
+	test_check(cleared_doc.valid);
+	if (cleared_doc.valid) {
+		test_check(cleared_doc.get<json::json_array>("traceEvents").size() <= thread_name_count);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (!floor_test::init(argc, argv)) {
+		return -1;
+	}
+	
+	test_trace_json();
+	
+	return floor_test::finish();
+}
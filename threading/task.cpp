@@ -19,6 +19,7 @@
 #include <floor/threading/task.hpp>
 #include <floor/core/logger.hpp>
 #include <floor/core/core.hpp>
+#include <floor/core/trace.hpp>
 
 task::task(std::function<void()> op_, const string task_name_) :
 op(op_), task_name(task_name_),
@@ -41,6 +42,7 @@ void task::run(task* this_task, std::function<void()> task_op) {
 #if !defined(FLOOR_NO_EXCEPTIONS)
 	try {
 #endif
+		FLOOR_TRACE_SCOPE("task", floor_trace::is_enabled() ? floor_trace::intern(this_task->task_name) : "");
 		// NOTE: this is the function object created above (not the users task op!)
 		task_op();
 #if !defined(FLOOR_NO_EXCEPTIONS)